@@ -62,6 +62,27 @@ namespace spartan
     {
         arguments = args;
 
+        // record every allocation until the first world has loaded, the allocator benchmark replays it
+        if (HasArgument("-allocation_trace"))
+        {
+            Allocator::TraceBegin();
+            SP_SUBSCRIBE_TO_EVENT(EventType::WorldLoaded, SP_EVENT_HANDLER_EXPRESSION_STATIC(
+                Allocator::TraceEnd("allocation_trace.bin");
+            ));
+        }
+
+        // attribute sampled allocations to their call sites, see the profiler's memory section
+        if (HasArgument("-allocation_tracking"))
+        {
+            Allocator::SetTrackingEnabled(true);
+        }
+
+        // once warmed up, world and renderer ticks must not allocate
+        if (HasArgument("-zero_allocations"))
+        {
+            Allocator::SetZeroAllocationMode(true);
+        }
+
         SetFlag(EngineMode::EditorVisible, !HasArgument("-game"));
         SetFlag(EngineMode::Playing,       true);
 
@@ -156,6 +177,7 @@ namespace spartan
         ImageImporter::Shutdown();
         FontImporter::Shutdown();
         Settings::Shutdown();
+        Log::Shutdown(); // last, so everything above can still log through the background writer
     }
 
     void Engine::Tick()
@@ -190,10 +212,16 @@ namespace spartan
         Window::Tick();
         Input::Tick();
         PhysicsWorld::Tick();
-        World::Tick();
+        {
+            AllocationFreeScope allocation_free_scope("World::Tick");
+            World::Tick();
+        }
         PhysicsWorld::DrawDebugVisualization();
         Xr::Tick();
-        Renderer::Tick();
+        {
+            AllocationFreeScope allocation_free_scope("Renderer::Tick");
+            Renderer::Tick();
+        }
         Allocator::Tick();
         SmokeTest::Tick();
 
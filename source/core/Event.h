@@ -75,6 +75,8 @@ namespace spartan
         HdrToggled,                    // HDR output has been toggled on or off
         // World
         WorldLoaded,                   // a world finished loading and entities are ready
+        WorldCellLoaded,               // a streamed world cell finished loading, data is the WorldCell*
+        WorldCellUnloaded,             // a streamed world cell is about to be removed, data is the WorldCell*
         // Max
         Max
     };
@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <thread>
 #include <condition_variable>
 #include <deque>
+#include <optional>
 //============================
 
 //= NAMESPACES =====
@@ -33,101 +34,549 @@ using namespace std;
 
 namespace spartan
 {
+    // the scheduler's view of a counter's internals
+    struct job_counter_access
+    {
+        static atomic<uint32_t>& pending(JobCounter* counter) { return counter->m_pending; }
+        static atomic<void*>& waiting(JobCounter* counter)    { return counter->m_waiting; }
+    };
+
     namespace
     {
+        constexpr uint32_t deque_capacity       = 4096; // power of two, overflow goes to the injection queue
+        constexpr uint32_t max_dependencies     = 4;
+        constexpr uint32_t job_cache_max        = 256;  // per-thread free jobs kept for reuse
+        constexpr uint32_t job_cache_batch      = 64;   // jobs moved between a thread cache and the shared cache at once
+        constexpr uint32_t idle_spin_count      = 64;   // find attempts before a worker goes to sleep
+
+        // m_waiting value of a counter whose current round is complete
+        void* const counter_closed = reinterpret_cast<void*>(uintptr_t(1));
+
+        struct job;
+
+        // intrusive node that parks a job on a dependency's waiting list
+        struct job_link
+        {
+            job* owner     = nullptr;
+            job_link* next = nullptr;
+        };
+
+        struct job
+        {
+            Task function;
+            optional<promise<void>> completion; // only for AddTask, which hands out a future
+            JobCounter* counter = nullptr;
+            atomic<uint32_t> dependencies_remaining = 0;
+            job_link links[max_dependencies];
+        };
+
+        // chase-lev deque (le et al. 2013), the owner pushes and pops at the bottom, thieves steal from the top
+        class work_stealing_deque
+        {
+        public:
+            bool Push(job* j)
+            {
+                const int64_t b = m_bottom.load(memory_order_relaxed);
+                const int64_t t = m_top.load(memory_order_acquire);
+                if (b - t >= static_cast<int64_t>(deque_capacity))
+                {
+                    return false;
+                }
+
+                m_buffer[b & (deque_capacity - 1)].store(j, memory_order_relaxed);
+                atomic_thread_fence(memory_order_release);
+                m_bottom.store(b + 1, memory_order_relaxed);
+                return true;
+            }
+
+            job* Pop()
+            {
+                const int64_t b = m_bottom.load(memory_order_relaxed) - 1;
+                m_bottom.store(b, memory_order_relaxed);
+                atomic_thread_fence(memory_order_seq_cst);
+                int64_t t = m_top.load(memory_order_relaxed);
+
+                if (t > b)
+                {
+                    m_bottom.store(b + 1, memory_order_relaxed);
+                    return nullptr;
+                }
+
+                job* j = m_buffer[b & (deque_capacity - 1)].load(memory_order_relaxed);
+                if (t == b)
+                {
+                    // last item, race the thieves for it
+                    if (!m_top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed))
+                    {
+                        j = nullptr;
+                    }
+                    m_bottom.store(b + 1, memory_order_relaxed);
+                }
+
+                return j;
+            }
+
+            job* Steal()
+            {
+                int64_t t = m_top.load(memory_order_acquire);
+                atomic_thread_fence(memory_order_seq_cst);
+                const int64_t b = m_bottom.load(memory_order_acquire);
+                if (t >= b)
+                {
+                    return nullptr;
+                }
+
+                job* j = m_buffer[t & (deque_capacity - 1)].load(memory_order_relaxed);
+                if (!m_top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed))
+                {
+                    return nullptr;
+                }
+
+                return j;
+            }
+
+            bool IsEmpty() const
+            {
+                return m_bottom.load(memory_order_relaxed) <= m_top.load(memory_order_relaxed);
+            }
+
+        private:
+            alignas(64) atomic<int64_t> m_top    = 0;
+            alignas(64) atomic<int64_t> m_bottom = 0;
+            atomic<job*> m_buffer[deque_capacity] = {};
+        };
+
         uint32_t thread_count           = 0;
         atomic<uint32_t> working_count  = 0;
         atomic<uint32_t> pending_count  = 0;
-        bool stopping                   = false;
+        atomic<bool> stopping           = false;
+        vector<thread> threads;
 
-        mutex task_mutex;
-        condition_variable task_cv;      // signaled when tasks are added or stopping
-        condition_variable idle_cv;      // signaled when a task completes
+        // one deque per worker plus one for the thread that initialized the pool (main thread)
+        unique_ptr<work_stealing_deque[]> deques;
+        uint32_t deque_count = 0;
 
-        vector<thread> threads;
-        deque<Task> tasks;
+        // jobs scheduled from threads that don't own a deque, or that overflowed one
+        mutex injection_mutex;
+        deque<job*> injection_queue;
+        atomic<uint32_t> injection_count = 0;
+
+        // idle workers
+        mutex sleep_mutex;
+        condition_variable sleep_cv;
+        atomic<uint32_t> sleeping_count = 0;
+
+        // threads outside the pool blocked on a counter or a flush
+        mutex wait_mutex;
+        condition_variable wait_cv;
+        atomic<uint32_t> blocked_count = 0;
+
+        // shared pool of free jobs, refilled by threads whose cache overflows
+        mutex job_cache_mutex;
+        vector<job*> job_cache_shared;
 
-        thread_local bool is_worker_thread = false;
-        // nested ParallelLoop from inside a pool task must run inline, otherwise workers
-        // wait on futures that can only run on the same exhausted pool and the load freezes
-        thread_local uint32_t parallel_depth = 0;
+        thread_local int32_t deque_index      = -1;
+        thread_local bool is_worker_thread    = false;
+        thread_local uint32_t steal_seed      = 0;
 
-        bool execute_queued_task()
+        struct job_cache
         {
-            Task task;
+            vector<job*> jobs;
+
+            ~job_cache()
             {
-                lock_guard<mutex> lock(task_mutex);
-                if (tasks.empty())
+                for (job* j : jobs)
                 {
-                    return false;
+                    delete j;
                 }
+            }
+        };
+        thread_local job_cache tl_job_cache;
 
-                task = std::move(tasks.front());
-                tasks.pop_front();
-                // count work before releasing the mutex so flush cannot see empty+idle in the pop gap
-                working_count.fetch_add(1, memory_order_relaxed);
+        job* job_acquire()
+        {
+            vector<job*>& cache = tl_job_cache.jobs;
+            if (cache.empty())
+            {
+                lock_guard<mutex> lock(job_cache_mutex);
+                const size_t count = min<size_t>(job_cache_batch, job_cache_shared.size());
+                cache.insert(cache.end(), job_cache_shared.end() - count, job_cache_shared.end());
+                job_cache_shared.resize(job_cache_shared.size() - count);
             }
 
-            task();
-            working_count.fetch_sub(1, memory_order_relaxed);
-            pending_count.fetch_sub(1, memory_order_relaxed);
-            idle_cv.notify_all();
-            return true;
+            if (!cache.empty())
+            {
+                job* j = cache.back();
+                cache.pop_back();
+                return j;
+            }
+
+            return new job();
         }
-    }
 
-    static void thread_loop()
-    {
-        is_worker_thread = true;
+        void job_release(job* j)
+        {
+            // drop captures now so whatever they reference is released before any waiter resumes
+            j->function   = nullptr;
+            j->completion.reset();
+            j->counter    = nullptr;
+
+            vector<job*>& cache = tl_job_cache.jobs;
+            if (cache.capacity() == 0)
+            {
+                cache.reserve(job_cache_max);
+            }
+            cache.push_back(j);
+
+            // hand a batch to the shared pool, jobs are mostly freed by workers but acquired by the main thread
+            if (cache.size() >= job_cache_max)
+            {
+                lock_guard<mutex> lock(job_cache_mutex);
+                job_cache_shared.insert(job_cache_shared.end(), cache.end() - job_cache_batch, cache.end());
+                cache.resize(cache.size() - job_cache_batch);
+            }
+        }
 
-        while (true)
+        void notify_blocked()
         {
-            Task task;
+            atomic_thread_fence(memory_order_seq_cst);
+            if (blocked_count.load(memory_order_relaxed) > 0)
             {
-                unique_lock<mutex> lock(task_mutex);
+                lock_guard<mutex> lock(wait_mutex);
+                wait_cv.notify_all();
+            }
+        }
 
-                task_cv.wait(lock, [] { return !tasks.empty() || stopping; });
+        // block a thread outside the pool until the predicate holds
+        template <typename Predicate>
+        void block_until(Predicate predicate)
+        {
+            blocked_count.fetch_add(1, memory_order_relaxed);
+            atomic_thread_fence(memory_order_seq_cst);
+            {
+                unique_lock<mutex> lock(wait_mutex);
+                while (!predicate())
+                {
+                    // timeout is only a safety net, completions notify
+                    wait_cv.wait_for(lock, chrono::milliseconds(1));
+                }
+            }
+            blocked_count.fetch_sub(1, memory_order_relaxed);
+        }
+
+        bool has_queued_work()
+        {
+            if (injection_count.load(memory_order_relaxed) > 0)
+            {
+                return true;
+            }
 
-                if (stopping && tasks.empty())
+            for (uint32_t i = 0; i < deque_count; i++)
+            {
+                if (!deques[i].IsEmpty())
                 {
-                    return;
+                    return true;
                 }
+            }
 
-                task = std::move(tasks.front());
-                tasks.pop_front();
-                // count work before releasing the mutex so flush cannot see empty+idle in the pop gap
-                working_count.fetch_add(1, memory_order_relaxed);
+            return false;
+        }
+
+        void enqueue(job* j)
+        {
+            if (deque_index < 0 || !deques[deque_index].Push(j))
+            {
+                lock_guard<mutex> lock(injection_mutex);
+                injection_queue.push_back(j);
+                injection_count.fetch_add(1, memory_order_relaxed);
             }
 
-            // execute task - exceptions are handled by packaged_task if one is used
-            task();
+            // wake a sleeping worker, the fence pairs with the one a worker issues before its last look for work
+            atomic_thread_fence(memory_order_seq_cst);
+            if (sleeping_count.load(memory_order_relaxed) > 0)
+            {
+                lock_guard<mutex> lock(sleep_mutex);
+                sleep_cv.notify_one();
+            }
+        }
+
+        job* find_job()
+        {
+            // own deque first (lifo, cache warm)
+            if (is_worker_thread)
+            {
+                if (job* j = deques[deque_index].Pop())
+                {
+                    return j;
+                }
+            }
+
+            if (injection_count.load(memory_order_relaxed) > 0)
+            {
+                lock_guard<mutex> lock(injection_mutex);
+                if (!injection_queue.empty())
+                {
+                    job* j = injection_queue.front();
+                    injection_queue.pop_front();
+                    injection_count.fetch_sub(1, memory_order_relaxed);
+                    return j;
+                }
+            }
+
+            // steal from a random victim onwards
+            steal_seed ^= steal_seed << 13;
+            steal_seed ^= steal_seed >> 17;
+            steal_seed ^= steal_seed << 5;
+            const uint32_t start = steal_seed % deque_count;
+            for (uint32_t i = 0; i < deque_count; i++)
+            {
+                const uint32_t victim = (start + i) % deque_count;
+                if (static_cast<int32_t>(victim) == deque_index && is_worker_thread)
+                {
+                    continue;
+                }
+
+                if (job* j = deques[victim].Steal())
+                {
+                    return j;
+                }
+            }
+
+            return nullptr;
+        }
+
+        void counter_add(JobCounter* counter);
+        void counter_signal(JobCounter* counter);
+        bool counter_attach(JobCounter* counter, job_link* link);
+
+        void complete(job* j)
+        {
+            JobCounter* counter = j->counter;
+            job_release(j);
+
+            if (counter)
+            {
+                counter_signal(counter);
+            }
+
+            if (pending_count.fetch_sub(1, memory_order_acq_rel) == 1)
+            {
+                notify_blocked();
+            }
+        }
+
+        void execute(job* j)
+        {
+            working_count.fetch_add(1, memory_order_relaxed);
+
+            if (j->completion)
+            {
+                // exceptions travel through the future, like they did with packaged_task
+                try
+                {
+                    j->function();
+                    j->completion->set_value();
+                }
+                catch (...)
+                {
+                    j->completion->set_exception(current_exception());
+                }
+            }
+            else
+            {
+                j->function();
+            }
 
             working_count.fetch_sub(1, memory_order_relaxed);
-            pending_count.fetch_sub(1, memory_order_relaxed);
+            complete(j);
+        }
 
-            // wake up any thread waiting in flush()
-            idle_cv.notify_all();
+        // a discarded job completes without running, its future (if any) reports a broken promise
+        void discard(job* j)
+        {
+            complete(j);
+        }
+
+        void dependency_resolved(job* j)
+        {
+            if (j->dependencies_remaining.fetch_sub(1, memory_order_acq_rel) == 1)
+            {
+                enqueue(j);
+            }
+        }
+
+        void submit(job* j, JobCounter* counter, const initializer_list<JobCounter*>& dependencies)
+        {
+            SP_ASSERT_MSG(dependencies.size() <= max_dependencies, "too many job dependencies, group them under one counter");
+
+            j->counter = counter;
+            if (counter)
+            {
+                counter_add(counter);
+            }
+            pending_count.fetch_add(1, memory_order_relaxed);
+
+            // the extra count keeps the job from launching while its links are still being attached
+            j->dependencies_remaining.store(static_cast<uint32_t>(dependencies.size()) + 1, memory_order_relaxed);
+            uint32_t resolved = 1;
+            uint32_t link_index = 0;
+            for (JobCounter* dependency : dependencies)
+            {
+                job_link* link = &j->links[link_index++];
+                link->owner    = j;
+                if (!dependency || !counter_attach(dependency, link))
+                {
+                    resolved++;
+                }
+            }
+
+            if (j->dependencies_remaining.fetch_sub(resolved, memory_order_acq_rel) == resolved)
+            {
+                enqueue(j);
+            }
+        }
+
+        void counter_add(JobCounter* counter)
+        {
+            if (job_counter_access::pending(counter).fetch_add(1, memory_order_acq_rel) == 0)
+            {
+                // the previous round's last job may still be closing it, let it finish before re-opening
+                while (job_counter_access::waiting(counter).load(memory_order_acquire) != counter_closed)
+                {
+                    this_thread::yield();
+                }
+                job_counter_access::waiting(counter).store(nullptr, memory_order_release);
+            }
+        }
+
+        void counter_signal(JobCounter* counter)
+        {
+            if (job_counter_access::pending(counter).fetch_sub(1, memory_order_acq_rel) != 1)
+            {
+                return;
+            }
+
+            // closing is the last access to the counter, a waiter may destroy it right after
+            job_link* link = static_cast<job_link*>(job_counter_access::waiting(counter).exchange(counter_closed, memory_order_acq_rel));
+            while (link)
+            {
+                job_link* next = link->next; // read before the owner can run and be recycled
+                dependency_resolved(link->owner);
+                link = next;
+            }
+
+            notify_blocked();
+        }
+
+        // returns false if the counter is already done, in which case the link is not parked
+        bool counter_attach(JobCounter* counter, job_link* link)
+        {
+            void* head = job_counter_access::waiting(counter).load(memory_order_acquire);
+            while (true)
+            {
+                if (head == counter_closed)
+                {
+                    if (job_counter_access::pending(counter).load(memory_order_acquire) == 0)
+                    {
+                        return false;
+                    }
+
+                    // being re-opened by the thread scheduling into it
+                    this_thread::yield();
+                    head = job_counter_access::waiting(counter).load(memory_order_acquire);
+                    continue;
+                }
+
+                link->next = static_cast<job_link*>(head);
+                if (job_counter_access::waiting(counter).compare_exchange_weak(head, link, memory_order_release, memory_order_acquire))
+                {
+                    return true;
+                }
+            }
+        }
+
+        void thread_loop(uint32_t index)
+        {
+            deque_index      = static_cast<int32_t>(index);
+            is_worker_thread = true;
+            steal_seed       = index * 2654435761u + 1;
+
+            uint32_t idle_spins = 0;
+            while (true)
+            {
+                if (job* j = find_job())
+                {
+                    execute(j);
+                    idle_spins = 0;
+                    continue;
+                }
+
+                if (stopping.load(memory_order_acquire))
+                {
+                    return;
+                }
+
+                if (++idle_spins < idle_spin_count)
+                {
+                    this_thread::yield();
+                    continue;
+                }
+
+                // sleep until a job is enqueued, the fence pairs with the one in enqueue() so either
+                // the scheduler sees this worker sleeping or this worker sees the job
+                sleeping_count.fetch_add(1, memory_order_relaxed);
+                atomic_thread_fence(memory_order_seq_cst);
+                {
+                    unique_lock<mutex> lock(sleep_mutex);
+                    sleep_cv.wait_for(lock, chrono::milliseconds(10), [] { return has_queued_work() || stopping.load(memory_order_relaxed); });
+                }
+                sleeping_count.fetch_sub(1, memory_order_relaxed);
+                idle_spins = 0;
+            }
         }
     }
 
-    void ThreadPool::Initialize()
+    JobCounter::JobCounter() : m_waiting(counter_closed)
+    {
+
+    }
+
+    bool JobCounter::IsDone() const
+    {
+        return m_pending.load(memory_order_acquire) == 0 && m_waiting.load(memory_order_acquire) == counter_closed;
+    }
+
+    void ThreadPool::Initialize(uint32_t thread_count_override)
     {
         stopping = false;
 
-        uint32_t hw_threads = thread::hardware_concurrency();
-        if (hw_threads == 0)
+        if (thread_count_override > 0)
         {
-            hw_threads = 4;
+            thread_count = thread_count_override;
         }
+        else
+        {
+            uint32_t hw_threads = thread::hardware_concurrency();
+            if (hw_threads == 0)
+            {
+                hw_threads = 4;
+            }
 
-        // assume half are physical cores, then scale for mixed workloads
-        uint32_t core_count = max(1u, hw_threads / 2);
-        thread_count        = min(core_count * 2, core_count + 4);
+            // assume half are physical cores, then scale for mixed workloads
+            uint32_t core_count = max(1u, hw_threads / 2);
+            thread_count        = min(core_count * 2, core_count + 4);
+        }
+
+        // the initializing thread owns the last deque so its jobs skip the injection queue
+        deque_count = thread_count + 1;
+        deques      = make_unique<work_stealing_deque[]>(deque_count);
+        deque_index = static_cast<int32_t>(thread_count);
+        steal_seed  = 0x9e3779b9u;
 
         threads.reserve(thread_count);
         for (uint32_t i = 0; i < thread_count; i++)
         {
-            threads.emplace_back(thread_loop);
+            threads.emplace_back(thread_loop, i);
         }
 
         SP_LOG_INFO("%d threads have been created", thread_count);
@@ -138,11 +587,11 @@ namespace spartan
         Flush(true);
 
         {
-            lock_guard<mutex> lock(task_mutex);
+            lock_guard<mutex> lock(sleep_mutex);
             stopping = true;
         }
 
-        task_cv.notify_all();
+        sleep_cv.notify_all();
 
         for (thread& t : threads)
         {
@@ -153,125 +602,214 @@ namespace spartan
         }
 
         threads.clear();
+        deques.reset();
+        {
+            lock_guard<mutex> lock(job_cache_mutex);
+            for (job* j : job_cache_shared)
+            {
+                delete j;
+            }
+            job_cache_shared.clear();
+        }
+        deque_count = 0;
+        deque_index = -1;
         working_count.store(0, memory_order_relaxed);
         pending_count.store(0, memory_order_relaxed);
         thread_count = 0;
     }
 
-    future<void> ThreadPool::AddTask(Task&& task)
+    void ThreadPool::Schedule(Task&& task, JobCounter* counter, initializer_list<JobCounter*> dependencies)
     {
-        auto packaged = make_shared<packaged_task<void()>>(std::forward<Task>(task));
-        future<void> result = packaged->get_future();
+        if (stopping.load(memory_order_relaxed))
+        {
+            SP_LOG_WARNING("ThreadPool::Schedule() called while pool is stopping");
+            return;
+        }
 
+        // no threads available - run on calling thread, dependencies can only be done already
+        if (threads.empty())
         {
-            lock_guard<mutex> lock(task_mutex);
+            task();
+            return;
+        }
+
+        job* j     = job_acquire();
+        j->function = std::move(task);
+        submit(j, counter, dependencies);
+    }
 
-            if (stopping)
+    void ThreadPool::Wait(JobCounter& counter)
+    {
+        uint32_t idle_spins = 0;
+        while (!counter.IsDone())
+        {
+            if (is_worker_thread)
             {
-                SP_LOG_WARNING("ThreadPool::AddTask() called while pool is stopping");
-                return result;
+                // keep the core busy, this is what makes nested parallelism work
+                if (job* j = find_job())
+                {
+                    execute(j);
+                    idle_spins = 0;
+                }
+                else if (++idle_spins < idle_spin_count)
+                {
+                    this_thread::yield();
+                }
+                else
+                {
+                    block_until([&counter] { return counter.IsDone() || has_queued_work(); });
+                }
+            }
+            else
+            {
+                // threads outside the pool don't pick up foreign jobs, those can be long (e.g. a world load)
+                block_until([&counter] { return counter.IsDone(); });
             }
+        }
+    }
 
-            pending_count.fetch_add(1, memory_order_relaxed);
-            tasks.emplace_back([packaged]() { (*packaged)(); });
+    future<void> ThreadPool::AddTask(Task&& task)
+    {
+        if (stopping.load(memory_order_relaxed))
+        {
+            SP_LOG_WARNING("ThreadPool::AddTask() called while pool is stopping");
+            promise<void> abandoned;
+            return abandoned.get_future();
         }
 
-        task_cv.notify_one();
+        job* j = job_acquire();
+        j->function = std::move(task);
+        j->completion.emplace();
+        future<void> result = j->completion->get_future();
+
+        // not initialized yet - run on calling thread
+        if (threads.empty())
+        {
+            try
+            {
+                j->function();
+                j->completion->set_value();
+            }
+            catch (...)
+            {
+                j->completion->set_exception(current_exception());
+            }
+            job_release(j);
+            return result;
+        }
+
+        submit(j, nullptr, {});
         return result;
     }
 
     void ThreadPool::ParallelLoop(function<void(uint32_t, uint32_t)>&& work_fn, const uint32_t work_total)
     {
         SP_ASSERT_MSG(work_total > 0, "parallel loop requires work_total > 0");
+        ParallelFor(work_total, work_fn);
+    }
 
-        // no threads available - run on calling thread
-        if (threads.empty())
+    uint32_t ThreadPool::GetParticipantCount(uint32_t work_total, uint32_t min_chunk)
+    {
+        const uint32_t chunk_count = (work_total + min_chunk - 1) / min_chunk;
+        return min({ thread_count + 1, chunk_count, max_parallel_participants });
+    }
+
+    void ThreadPool::RunParallel(parallel_range& range)
+    {
+        // guided self-scheduling, every participant claims remaining / (2 * participants) items at a time
+        // the chunk sequence only depends on the range so chunk boundaries are deterministic, only their thread isn't
+        auto run_chunks = [](parallel_range& range, uint32_t slot)
         {
-            work_fn(0, work_total);
-            return;
-        }
+            const uint32_t divisor = range.participants * 2;
+            uint32_t start         = range.next.load(memory_order_relaxed);
+            while (start < range.total)
+            {
+                const uint32_t remaining = range.total - start;
+                const uint32_t chunk     = min(remaining, max(range.min_chunk, remaining / divisor));
+                if (range.next.compare_exchange_weak(start, start + chunk, memory_order_relaxed))
+                {
+                    range.invoke(range.context, start, start + chunk, slot);
+                    start = range.next.load(memory_order_relaxed);
+                }
+            }
+        };
 
-        // nested ParallelLoop from inside a chunk must run inline, scheduling more pool
-        // tasks while every worker waits on futures freezes world load (dreamcore at ~89%)
-        if (parallel_depth > 0)
+        // no threads available or not worth splitting - run on calling thread
+        if (threads.empty() || range.participants <= 1)
         {
-            work_fn(0, work_total);
+            range.participants = 1;
+            range.invoke(range.context, 0, range.total, 0);
             return;
         }
 
-        struct depth_scope
+        // helpers that start after the range drained return immediately, nested calls from a worker push
+        // their helpers onto its own deque where idle workers steal them
+        JobCounter counter;
+        for (uint32_t i = 1; i < range.participants; i++)
         {
-            depth_scope()  { parallel_depth++; }
-            ~depth_scope() { parallel_depth--; }
-        };
-
-        uint32_t workers   = min(thread_count, work_total);
-        uint32_t base_work = work_total / workers;
-        uint32_t remainder = work_total % workers;
-
-        // one shared copy so every chunk invokes the same callable
-        // alias keeps msvc from treating the comma in void(uint32_t, uint32_t) as template args
-        using parallel_fn = function<void(uint32_t, uint32_t)>;
-        const shared_ptr<parallel_fn> shared_fn = make_shared<parallel_fn>(std::move(work_fn));
-
-        vector<future<void>> futures;
-        futures.reserve(workers);
+            Schedule([&range, run_chunks]() { run_chunks(range, range.next_slot.fetch_add(1, memory_order_relaxed)); }, &counter);
+        }
 
-        depth_scope caller_depth;
+        run_chunks(range, 0);
+        Wait(counter);
+    }
 
-        uint32_t work_index = 0;
-        for (uint32_t i = 0; i < workers; ++i)
+    void ThreadPool::Flush(bool remove_queued)
+    {
+        if (remove_queued && deques)
         {
-            uint32_t work_count = base_work + (i < remainder ? 1u : 0u);
-            uint32_t start      = work_index;
-            uint32_t end        = work_index + work_count;
+            // jobs under a counter belong to a loop or group someone is waiting on, those are in-flight work and stay
+            vector<job*> kept;
+            {
+                lock_guard<mutex> lock(injection_mutex);
+                for (job* j : injection_queue)
+                {
+                    j->counter ? kept.push_back(j) : discard(j);
+                }
+                injection_count.fetch_sub(static_cast<uint32_t>(injection_queue.size()), memory_order_relaxed);
+                injection_queue.clear();
+            }
 
-            // chunks inherit nesting depth so ParallelLoop inside them stays inline
-            futures.emplace_back(AddTask([shared_fn, start, end]()
+            for (uint32_t i = 0; i < deque_count; i++)
             {
-                depth_scope chunk_depth;
-                (*shared_fn)(start, end);
-            }));
-            work_index = end;
-        }
+                while (job* j = deques[i].Steal())
+                {
+                    j->counter ? kept.push_back(j) : discard(j);
+                }
+            }
 
-        for (future<void>& f : futures)
-        {
-            while (
-                is_worker_thread &&
-                f.wait_for(chrono::seconds(0)) != future_status::ready
-            )
+            if (!kept.empty())
             {
-                if (!execute_queued_task())
                 {
-                    unique_lock<mutex> lock(task_mutex);
-                    // wait on task_cv so AddTask wakes us, idle_cv only signals completions
-                    task_cv.wait_for(
-                        lock,
-                        chrono::microseconds(100),
-                        [] { return !tasks.empty() || stopping; }
-                    );
+                    lock_guard<mutex> lock(injection_mutex);
+                    injection_queue.insert(injection_queue.end(), kept.begin(), kept.end());
+                    injection_count.fetch_add(static_cast<uint32_t>(kept.size()), memory_order_relaxed);
                 }
+
+                lock_guard<mutex> lock(sleep_mutex);
+                sleep_cv.notify_all();
             }
-            f.get();
         }
-    }
 
-    void ThreadPool::Flush(bool remove_queued)
-    {
-        if (remove_queued)
+        // wait for all in-flight work to complete
+        while (pending_count.load(memory_order_acquire) > 0)
         {
-            lock_guard<mutex> lock(task_mutex);
-            uint32_t removed = static_cast<uint32_t>(tasks.size());
-            tasks.clear();
-            pending_count.fetch_sub(removed, memory_order_relaxed);
+            if (is_worker_thread)
+            {
+                if (job* j = find_job())
+                {
+                    execute(j);
+                }
+                else
+                {
+                    this_thread::yield();
+                }
+            }
+            else
+            {
+                block_until([] { return pending_count.load(memory_order_acquire) == 0; });
+            }
         }
-
-        // wait for all in-flight work to complete using condition variable (no spin)
-        unique_lock<mutex> lock(task_mutex);
-        idle_cv.wait(lock, [] {
-            return tasks.empty() && working_count.load(memory_order_relaxed) == 0;
-        });
     }
 
     uint32_t ThreadPool::GetThreadCount()
@@ -279,6 +817,11 @@ namespace spartan
         return thread_count;
     }
 
+    int32_t ThreadPool::GetWorkerIndex()
+    {
+        return is_worker_thread ? deque_index : -1;
+    }
+
     uint32_t ThreadPool::GetWorkingThreadCount()
     {
         return working_count.load(memory_order_relaxed);
@@ -21,27 +21,140 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES ========
+//= INCLUDES ================
 #include <future>
 #include <functional>
-//===================
+#include <atomic>
+#include <initializer_list>
+#include <new>
+#include <type_traits>
+//===========================
 
 namespace spartan
 {
     using Task = std::function<void()>;
 
+    // completion counter for a group of jobs, it's also the handle jobs use to depend on each other
+    // every job scheduled against it increments it and decrements it once done, so waiting on it
+    // (or depending on it) means waiting for the whole group, it must outlive the jobs it tracks
+    class JobCounter
+    {
+    public:
+        JobCounter();
+        JobCounter(const JobCounter&)            = delete;
+        JobCounter& operator=(const JobCounter&) = delete;
+
+        bool IsDone() const;
+
+    private:
+        friend struct job_counter_access;
+        std::atomic<uint32_t> m_pending = 0;
+        std::atomic<void*> m_waiting;          // jobs parked until m_pending reaches zero
+    };
+
     class ThreadPool
     {
     public:
-        static void Initialize();
+        // thread_count of 0 picks a count based on the hardware
+        static void Initialize(uint32_t thread_count = 0);
         static void Shutdown();
 
+        // schedule a job, it starts once every dependency is done and decrements counter (if any) when it completes
+        static void Schedule(Task&& task, JobCounter* counter = nullptr, std::initializer_list<JobCounter*> dependencies = {});
+
+        // wait for a counter to reach zero, pool threads keep executing other jobs while waiting
+        static void Wait(JobCounter& counter);
+
         // add a task
         static std::future<void> AddTask(Task&& task);
 
         // spread execution of a given function across all available threads
         static void ParallelLoop(std::function<void(uint32_t work_index_start, uint32_t work_index_end)>&& function, const uint32_t work_total);
 
+        // allocation-free parallel loop, function(start, end) runs on chunks that shrink as the range drains
+        // so uneven per-item cost still balances out, min_chunk keeps chunks worth the claim for very cheap items
+        template <typename Function>
+        static void ParallelFor(const uint32_t work_total, Function&& function, const uint32_t min_chunk = 1)
+        {
+            if (work_total == 0)
+            {
+                return;
+            }
+
+            using function_type = std::remove_reference_t<Function>;
+
+            parallel_range range;
+            range.total        = work_total;
+            range.min_chunk    = min_chunk > 0 ? min_chunk : 1;
+            range.participants = GetParticipantCount(work_total, range.min_chunk);
+            range.context      = const_cast<void*>(static_cast<const void*>(&function));
+            range.invoke       = [](void* context, uint32_t start, uint32_t end, uint32_t)
+            {
+                (*static_cast<function_type*>(context))(start, end);
+            };
+
+            RunParallel(range);
+        }
+
+        // allocation-free parallel reduction, every participating thread folds its chunks into its own copy
+        // of identity through function(start, end, accumulator), then combine(result, partial) merges the copies
+        template <typename T, typename Function, typename Combine>
+        static T ParallelReduce(const uint32_t work_total, const T& identity, Function&& function, Combine&& combine, const uint32_t min_chunk = 1)
+        {
+            if (work_total == 0)
+            {
+                return identity;
+            }
+
+            // a cache line apart so threads don't false-share their accumulators
+            struct alignas(64) partial
+            {
+                T value;
+            };
+
+            struct reduce_context
+            {
+                std::remove_reference_t<Function>* function;
+                partial* partials;
+            };
+
+            alignas(partial) unsigned char storage[sizeof(partial) * max_parallel_participants];
+            partial* partials = reinterpret_cast<partial*>(storage);
+
+            parallel_range range;
+            range.total        = work_total;
+            range.min_chunk    = min_chunk > 0 ? min_chunk : 1;
+            range.participants = GetParticipantCount(work_total, range.min_chunk);
+            const uint32_t partial_count = range.participants;
+            for (uint32_t i = 0; i < partial_count; i++)
+            {
+                new (&partials[i]) partial{ identity };
+            }
+
+            reduce_context context = { &function, partials };
+            range.context          = &context;
+            range.invoke           = [](void* context, uint32_t start, uint32_t end, uint32_t slot)
+            {
+                reduce_context* reduce = static_cast<reduce_context*>(context);
+                (*reduce->function)(start, end, reduce->partials[slot].value);
+            };
+
+            RunParallel(range);
+
+            T result = std::move(partials[0].value);
+            for (uint32_t i = 1; i < partial_count; i++)
+            {
+                combine(result, partials[i].value);
+            }
+
+            for (uint32_t i = 0; i < partial_count; i++)
+            {
+                partials[i].~partial();
+            }
+
+            return result;
+        }
+
         // wait for all threads to finish work
         static void Flush(bool remove_queued = false);
 
@@ -50,5 +163,26 @@ namespace spartan
         static uint32_t GetWorkingThreadCount();
         static uint32_t GetIdleThreadCount();
         static bool AreTasksRunning();
+
+        // index of the calling worker thread, -1 on any other thread
+        static int32_t GetWorkerIndex();
+
+    private:
+        static constexpr uint32_t max_parallel_participants = 64;
+
+        // shared state of a ParallelFor/ParallelReduce, lives on the caller's stack for the duration of the call
+        struct parallel_range
+        {
+            std::atomic<uint32_t> next      = 0; // first index not claimed yet
+            std::atomic<uint32_t> next_slot = 1; // slot 0 belongs to the calling thread
+            uint32_t total                  = 0;
+            uint32_t min_chunk              = 1;
+            uint32_t participants           = 1;
+            void (*invoke)(void* context, uint32_t start, uint32_t end, uint32_t slot) = nullptr;
+            void* context                   = nullptr;
+        };
+
+        static uint32_t GetParticipantCount(uint32_t work_total, uint32_t min_chunk);
+        static void RunParallel(parallel_range& range);
     };
 }
@@ -37,6 +37,7 @@ SOFTWARE.
 #include "world/Entity.h"
 #include "world/Prefab.h"
 #include "world/World.h"
+#include "world/WorldFile.h"
 #include "world/components/Camera.h"
 #include "world/components/Light.h"
 #include "world/components/Render.h"
@@ -6005,7 +6006,12 @@ void AssetViewer::ScanLibraryCleanup()
 
         m_cleanup.reference_files.push_back(path);
         pugi::xml_document document;
-        if (!document.load_file(path.c_str()))
+        // worlds may be binary, read them back as xml so their references are followed too
+        const bool loaded =
+            extension == EXTENSION_WORLD ?
+            WorldFile::ReadAsXml(path, document) :
+            static_cast<bool>(document.load_file(path.c_str()));
+        if (!loaded)
         {
             continue;
         }
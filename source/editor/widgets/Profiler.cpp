@@ -37,6 +37,9 @@ using namespace spartan::math;
 
 namespace
 {
+    // about ten seconds at 60 fps, long enough to catch hitches while streaming through a level
+    const uint32_t trace_frame_count = 600;
+
     bool toggle_button(const char* label, const bool active)
     {
         if (active)
@@ -256,6 +259,48 @@ void Profiler::OnTickVisible()
         );
     }
 
+    ImGui::SameLine();
+    const bool is_tracing =
+        spartan::Profiler::IsTracing();
+    if (is_tracing)
+    {
+        if (ImGuiSp::button("Stop Trace"))
+        {
+            spartan::Profiler::StopTrace();
+        }
+        ImGui::SameLine();
+        ImGui::TextDisabled(
+            "%llu frames",
+            spartan::Profiler::
+                GetTracedFrameCount()
+        );
+    }
+    else if (ImGuiSp::button("Trace"))
+    {
+        spartan::Profiler::StartTrace(
+            trace_frame_count
+        );
+    }
+    ImGuiSp::tooltip(
+        "Stream the cpu and gpu blocks of the next "
+        "frames into a chrome trace event file, "
+        "open it in ui.perfetto.dev or chrome://tracing"
+    );
+
+    if (spartan::HardwareCounters::IsSupported())
+    {
+        ImGui::SameLine();
+        if (toggle_button("Counters", spartan::HardwareCounters::IsEnabled()))
+        {
+            spartan::HardwareCounters::SetEnabled(!spartan::HardwareCounters::IsEnabled());
+        }
+        ImGuiSp::tooltip(
+            "Count cycles, instructions, cache and branch "
+            "misses per cpu block (perf_event), shows IPC "
+            "and misses per thousand instructions"
+        );
+    }
+
     if (mode_view == 1)
     {
         ImGui::SameLine();
@@ -380,6 +425,7 @@ void Profiler::OnTickVisible()
                 if (
                     block.GetType() ==
                         spartan::TimeBlockType::Cpu &&
+                    block.GetThreadLane() == 0 &&
                     block.IsComplete() &&
                     strcmp(block.GetName(), name) == 0
                 )
@@ -517,12 +563,20 @@ void Profiler::OnTickVisible()
             });
         }
 
+        // counter columns for cpu blocks, misses are per thousand instructions
+        const bool show_counters = type == spartan::TimeBlockType::Cpu && spartan::HardwareCounters::IsEnabled();
+
         uint32_t visible_count = 0;
         ImGui::EditorUi::push_table_style();
-        if (ImGui::BeginTable("##profile_list", 3, ImGuiTableFlags_BordersInnerH | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable | ImGuiTableFlags_SizingStretchProp))
+        if (ImGui::BeginTable("##profile_list", show_counters ? 5 : 3, ImGuiTableFlags_BordersInnerH | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable | ImGuiTableFlags_SizingStretchProp))
         {
             ImGui::TableSetupColumn("Block", ImGuiTableColumnFlags_WidthStretch, 0.55f);
             ImGui::TableSetupColumn("Duration", ImGuiTableColumnFlags_WidthFixed, 100.0f * dpi);
+            if (show_counters)
+            {
+                ImGui::TableSetupColumn("IPC", ImGuiTableColumnFlags_WidthFixed, 50.0f * dpi);
+                ImGui::TableSetupColumn("L1d / LLC / Br MPKI", ImGuiTableColumnFlags_WidthFixed, 150.0f * dpi);
+            }
             ImGui::TableSetupColumn("% Wall", ImGuiTableColumnFlags_WidthStretch, 0.25f);
             ImGui::TableHeadersRow();
 
@@ -546,7 +600,26 @@ void Profiler::OnTickVisible()
                 ImGui::TableSetColumnIndex(1);
                 ImGui::Text("%.3f ms", block.GetDuration());
 
-                ImGui::TableSetColumnIndex(2);
+                if (show_counters)
+                {
+                    const spartan::HardwareCounterValues& counters = block.GetCounters();
+                    ImGui::TableSetColumnIndex(2);
+                    if (counters.Has(spartan::HardwareCounter::Instructions))
+                    {
+                        ImGui::Text("%.2f", counters.GetIpc());
+                        ImGui::TableSetColumnIndex(3);
+                        ImGui::Text("%.1f / %.2f / %.2f",
+                            counters.GetMpki(spartan::HardwareCounter::CacheL1dMisses),
+                            counters.GetMpki(spartan::HardwareCounter::CacheLlcMisses),
+                            counters.GetMpki(spartan::HardwareCounter::BranchMisses));
+                    }
+                    else
+                    {
+                        ImGui::TextDisabled("-");
+                    }
+                }
+
+                ImGui::TableSetColumnIndex(show_counters ? 4 : 2);
                 const float fraction =
                     m_frozen_time_frame > 0.0f ?
                         ImClamp(
@@ -590,38 +663,69 @@ void Profiler::OnTickVisible()
         // build lane info
         struct LaneInfo
         {
-            const char*              label;
+            string                   label;
             spartan::TimeBlockType   block_type;
             spartan::RHI_Queue_Type  queue_filter;
             bool                     use_depth;
+            uint32_t                 thread_lane;
+            uint32_t                 max_depth;
         };
 
         vector<LaneInfo> lanes;
-        uint32_t max_depth = 0;
 
         if (type == spartan::TimeBlockType::Gpu)
         {
-            lanes.push_back({"Graphics", spartan::TimeBlockType::Gpu, spartan::RHI_Queue_Type::Graphics, false});
-            lanes.push_back({"Compute",  spartan::TimeBlockType::Gpu, spartan::RHI_Queue_Type::Compute,  false});
-            lanes.push_back({"Copy",     spartan::TimeBlockType::Gpu, spartan::RHI_Queue_Type::Copy,     false});
+            lanes.push_back({"Graphics", spartan::TimeBlockType::Gpu, spartan::RHI_Queue_Type::Graphics, false, 0, 0});
+            lanes.push_back({"Compute",  spartan::TimeBlockType::Gpu, spartan::RHI_Queue_Type::Compute,  false, 0, 0});
+            lanes.push_back({"Copy",     spartan::TimeBlockType::Gpu, spartan::RHI_Queue_Type::Copy,     false, 0, 0});
         }
         else
         {
+            // one lane per thread that recorded blocks, labeled with how busy it was over the sampled frame
+            const uint32_t thread_lane_count = spartan::Profiler::GetThreadLaneCount();
+            vector<uint32_t> lane_max_depth(thread_lane_count, 0);
+            vector<float> lane_busy_ms(thread_lane_count, 0.0f);
+            vector<bool> lane_used(thread_lane_count, false);
+            lane_used[0] = true; // the main thread is always shown
             for (uint32_t i = 0; i < time_block_count; i++)
             {
-                if (time_blocks[i].GetType() == spartan::TimeBlockType::Cpu && time_blocks[i].IsComplete() && m_block_filter.PassFilter(time_blocks[i].GetName()))
+                const spartan::TimeBlock& block = time_blocks[i];
+                if (block.GetType() != spartan::TimeBlockType::Cpu || !block.IsComplete() || block.GetThreadLane() >= thread_lane_count)
+                {
+                    continue;
+                }
+
+                if (!block.HasParent())
                 {
-                    max_depth = max(max_depth, time_blocks[i].GetTreeDepth());
+                    lane_busy_ms[block.GetThreadLane()] += block.GetDuration();
+                }
+
+                if (m_block_filter.PassFilter(block.GetName()))
+                {
+                    lane_used[block.GetThreadLane()]      = true;
+                    lane_max_depth[block.GetThreadLane()] = max(lane_max_depth[block.GetThreadLane()], block.GetTreeDepth());
                 }
             }
-            lanes.push_back({"CPU", spartan::TimeBlockType::Cpu, spartan::RHI_Queue_Type::Max, true});
+
+            for (uint32_t thread_lane = 0; thread_lane < thread_lane_count; thread_lane++)
+            {
+                if (!lane_used[thread_lane])
+                {
+                    continue;
+                }
+
+                char label[64];
+                const float utilisation = m_frozen_time_frame > 0.0f ? ImClamp(lane_busy_ms[thread_lane] / m_frozen_time_frame, 0.0f, 1.0f) : 0.0f;
+                snprintf(label, sizeof(label), "%s %.0f%%", spartan::Profiler::GetThreadLaneName(thread_lane), utilisation * 100.0f);
+                lanes.push_back({label, spartan::TimeBlockType::Cpu, spartan::RHI_Queue_Type::Max, true, thread_lane, lane_max_depth[thread_lane]});
+            }
         }
 
         // compute total timeline height for the invisible button
         float total_lanes_height = 0.0f;
         for (const auto& lane : lanes)
         {
-            uint32_t depth_count = lane.use_depth ? (max_depth + 1) : 1;
+            uint32_t depth_count = lane.use_depth ? (lane.max_depth + 1) : 1;
             total_lanes_height += lane_height * depth_count + lane_padding;
         }
         float total_timeline_height = ruler_height + total_lanes_height;
@@ -897,7 +1001,7 @@ void Profiler::OnTickVisible()
         {
             const auto& lane = lanes[lane_idx];
 
-            uint32_t lane_depth_count = lane.use_depth ? (max_depth + 1) : 1;
+            uint32_t lane_depth_count = lane.use_depth ? (lane.max_depth + 1) : 1;
             float total_lane_height   = lane_height * lane_depth_count;
 
             // lane label area
@@ -915,7 +1019,7 @@ void Profiler::OnTickVisible()
                     text_y
                 ),
                 text_color,
-                lane.label
+                lane.label.c_str()
             );
 
             // vertical divider between labels and timeline
@@ -957,6 +1061,12 @@ void Profiler::OnTickVisible()
                     }
                 }
 
+                // and by thread for cpu lanes
+                if (lane.block_type == spartan::TimeBlockType::Cpu && block.GetThreadLane() != lane.thread_lane)
+                {
+                    continue;
+                }
+
                 float block_start = block.GetStartMs();
                 float block_end   = block.GetEndMs();
 
@@ -1045,6 +1155,20 @@ void Profiler::OnTickVisible()
             ImGui::Text("duration: %.3f ms", tooltip_block->GetDuration());
             ImGui::Text("start:    %.3f ms", tooltip_block->GetStartMs());
             ImGui::Text("end:      %.3f ms", tooltip_block->GetEndMs());
+            if (tooltip_block->GetType() == spartan::TimeBlockType::Cpu)
+            {
+                ImGui::Text("thread:   %s", spartan::Profiler::GetThreadLaneName(tooltip_block->GetThreadLane()));
+
+                const spartan::HardwareCounterValues& counters = tooltip_block->GetCounters();
+                if (counters.Has(spartan::HardwareCounter::Instructions))
+                {
+                    ImGui::Separator();
+                    ImGui::Text("ipc:      %.2f (%llu instructions)", counters.GetIpc(), static_cast<unsigned long long>(counters.Get(spartan::HardwareCounter::Instructions)));
+                    ImGui::Text("l1d mpki: %.2f", counters.GetMpki(spartan::HardwareCounter::CacheL1dMisses));
+                    ImGui::Text("llc mpki: %.2f", counters.GetMpki(spartan::HardwareCounter::CacheLlcMisses));
+                    ImGui::Text("br mpki:  %.2f", counters.GetMpki(spartan::HardwareCounter::BranchMisses));
+                }
+            }
             if (tooltip_block->GetType() == spartan::TimeBlockType::Gpu)
             {
                 const char* queue_name = "unknown";
@@ -1148,5 +1272,85 @@ void Profiler::OnTickVisible()
         float total     = is_vram ? spartan::RHI_Device::MemoryGetTotalMb()     : spartan::Allocator::GetMemoryTotalMb();
 
         show_memory_bar(is_vram ? "VRAM" : "RAM", allocated, available, total, ImVec2(-1, 32));
+
+        // per-frame scratch memory by subsystem, last frame and high-water mark
+        if (!is_vram && ImGui::TreeNode("Frame arena"))
+        {
+            for (uint32_t i = 0; i < static_cast<uint32_t>(spartan::MemoryTag::Count); i++)
+            {
+                const spartan::MemoryTag tag = static_cast<spartan::MemoryTag>(i);
+                ImGui::Text(
+                    "%-10s %.2f MB (peak %.2f MB)",
+                    spartan::Allocator::GetTagName(tag),
+                    spartan::Allocator::GetFrameMemoryByTagMb(tag),
+                    spartan::Allocator::GetFrameMemoryPeakByTagMb(tag)
+                );
+            }
+            ImGui::TreePop();
+        }
+
+        // heap allocations per frame, and where they come from when tracking is enabled (-allocation_tracking)
+        if (!is_vram && ImGui::TreeNode("Allocations"))
+        {
+            spartan::FrameAllocationStats history[256];
+            const uint32_t frame_count = spartan::Allocator::GetFrameAllocationHistory(history, 256);
+
+            array<float, 256> counts = {};
+            float count_max          = 1.0f;
+            for (uint32_t i = 0; i < frame_count; i++)
+            {
+                counts[i] = static_cast<float>(history[i].count);
+                count_max = max(count_max, counts[i]);
+            }
+
+            const spartan::FrameAllocationStats last = spartan::Allocator::GetFrameAllocations();
+            ImGui::Text("Last frame: %u allocations, %.1f KB", last.count, static_cast<float>(last.bytes) / 1024.0f);
+            ImGui::PlotHistogram("##allocations_plot", counts.data(), static_cast<int>(frame_count), 0, "", 0.0f, count_max, ImVec2(ImGui::GetContentRegionAvail().x, 60));
+
+            if (spartan::Allocator::IsTrackingEnabled())
+            {
+                // resolving symbols is slow, refresh the list on demand
+                static vector<spartan::AllocationCallSite> call_sites;
+                static vector<string> call_site_names;
+                if (ImGui::Button("Refresh call sites") || call_sites.empty())
+                {
+                    spartan::Allocator::GetCallSites(call_sites);
+                    call_sites.resize(min<size_t>(call_sites.size(), 32));
+
+                    call_site_names.clear();
+                    for (const spartan::AllocationCallSite& site : call_sites)
+                    {
+                        // the innermost frame is the caller of operator new, or the container that allocated for it
+                        call_site_names.emplace_back(site.frame_count ? spartan::Allocator::GetCallSiteSymbol(site.frames[0]) : "unknown");
+                    }
+                }
+
+                const uint32_t sample_rate = spartan::Allocator::GetTrackingSampleRate();
+                for (size_t i = 0; i < call_sites.size(); i++)
+                {
+                    const spartan::AllocationCallSite& site = call_sites[i];
+                    ImGui::Text("~%llu allocs, %.1f KB  %s",
+                        static_cast<unsigned long long>(site.samples * sample_rate),
+                        static_cast<float>(site.bytes * sample_rate) / 1024.0f,
+                        call_site_names[i].c_str());
+
+                    if (ImGui::IsItemHovered())
+                    {
+                        ImGui::BeginTooltip();
+                        for (uint32_t frame = 0; frame < site.frame_count; frame++)
+                        {
+                            ImGui::TextUnformatted(spartan::Allocator::GetCallSiteSymbol(site.frames[frame]).c_str());
+                        }
+                        ImGui::EndTooltip();
+                    }
+                }
+            }
+            else
+            {
+                ImGui::TextDisabled("Launch with -allocation_tracking to attribute allocations to call sites");
+            }
+
+            ImGui::TreePop();
+        }
     }
 }
@@ -218,7 +218,7 @@ namespace
             {
                 if (copied_component && copied_component->GetType() == component->GetType())
                 {
-                    component->SetAttributes(copied_component->GetAttributes());
+                    component->CopyAttributes(copied_component);
                 }
             }
             ImGui::EndDisabled();
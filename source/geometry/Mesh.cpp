@@ -143,7 +143,7 @@ namespace spartan
 
     Mesh::~Mesh()
     {
-
+        ReleaseGpuBuffers();
     }
 
     void Mesh::RegisterForScripting(sol::state_view State)
@@ -172,7 +172,7 @@ namespace spartan
 
     void Mesh::Clear()
     {
-        m_ready_for_blas = false;
+        ReleaseGpuBuffers();
 
         m_indices.clear();
         m_indices.shrink_to_fit();
@@ -679,6 +679,7 @@ namespace spartan
         }
 
         {
+            // held across the writes so the defragmenter never moves this mesh with stale cpu geometry
             lock_guard lock(m_mutex);
             if (
                 m_sub_meshes.size() != 1 ||
@@ -687,43 +688,40 @@ namespace spartan
             {
                 return false;
             }
-        }
 
-        // gpu bounds store global unique/micro offsets
-        vector<Sb_MeshletBounds> gpu_meshlets = meshlets;
-        for (Sb_MeshletBounds& bounds : gpu_meshlets)
-        {
-            offset_meshlet_unique_ranges(bounds, m_global_meshlet_vertex_offset, m_global_meshlet_micro_offset);
-        }
+            // gpu bounds store global unique/micro offsets
+            vector<Sb_MeshletBounds> gpu_meshlets = meshlets;
+            for (Sb_MeshletBounds& bounds : gpu_meshlets)
+            {
+                offset_meshlet_unique_ranges(bounds, m_global_meshlet_vertex_offset, m_global_meshlet_micro_offset);
+            }
 
-        GeometryBuffer::UpdateVertices(
-            vertices.data(),
-            m_global_vertex_offset,
-            static_cast<uint32_t>(vertices.size())
-        );
-        GeometryBuffer::UpdateIndices(
-            indices.data(),
-            m_global_index_offset,
-            static_cast<uint32_t>(indices.size())
-        );
-        GeometryBuffer::UpdateMeshletBounds(
-            gpu_meshlets.data(),
-            m_global_meshlet_offset,
-            static_cast<uint32_t>(gpu_meshlets.size())
-        );
-        GeometryBuffer::UpdateMeshletVertices(
-            unique_vertices.data(),
-            m_global_meshlet_vertex_offset,
-            static_cast<uint32_t>(unique_vertices.size())
-        );
-        GeometryBuffer::UpdateMeshletMicroIndices(
-            micro_indices.data(),
-            m_global_meshlet_micro_offset,
-            static_cast<uint32_t>(micro_indices.size())
-        );
+            GeometryBuffer::UpdateVertices(
+                vertices.data(),
+                m_global_vertex_offset,
+                static_cast<uint32_t>(vertices.size())
+            );
+            GeometryBuffer::UpdateIndices(
+                indices.data(),
+                m_global_index_offset,
+                static_cast<uint32_t>(indices.size())
+            );
+            GeometryBuffer::UpdateMeshletBounds(
+                gpu_meshlets.data(),
+                m_global_meshlet_offset,
+                static_cast<uint32_t>(gpu_meshlets.size())
+            );
+            GeometryBuffer::UpdateMeshletVertices(
+                unique_vertices.data(),
+                m_global_meshlet_vertex_offset,
+                static_cast<uint32_t>(unique_vertices.size())
+            );
+            GeometryBuffer::UpdateMeshletMicroIndices(
+                micro_indices.data(),
+                m_global_meshlet_micro_offset,
+                static_cast<uint32_t>(micro_indices.size())
+            );
 
-        {
-            lock_guard lock(m_mutex);
             m_vertices              = vertices;
             m_indices               = indices;
             m_meshlets              = meshlets;
@@ -805,14 +803,35 @@ namespace spartan
         }
 
         // share index/meshlet gpu slices, allocate a private vertex slice for skinning
-        instance->m_global_index_offset           = m_global_index_offset;
-        instance->m_global_index_capacity         = m_global_index_capacity;
-        instance->m_global_meshlet_offset         = m_global_meshlet_offset;
-        instance->m_global_meshlet_capacity       = m_global_meshlet_capacity;
-        instance->m_global_meshlet_vertex_offset  = m_global_meshlet_vertex_offset;
-        instance->m_global_meshlet_vertex_capacity = m_global_meshlet_vertex_capacity;
-        instance->m_global_meshlet_micro_offset   = m_global_meshlet_micro_offset;
-        instance->m_global_meshlet_micro_capacity = m_global_meshlet_micro_capacity;
+        // each shared slice gets a reference, which also pins it, under the lock so the defragmenter can't move it in between
+        {
+            lock_guard lock(m_mutex);
+            instance->m_global_index_offset           = m_global_index_offset;
+            instance->m_global_index_capacity         = m_global_index_capacity;
+            instance->m_global_meshlet_offset         = m_global_meshlet_offset;
+            instance->m_global_meshlet_capacity       = m_global_meshlet_capacity;
+            instance->m_global_meshlet_vertex_offset  = m_global_meshlet_vertex_offset;
+            instance->m_global_meshlet_vertex_capacity = m_global_meshlet_vertex_capacity;
+            instance->m_global_meshlet_micro_offset   = m_global_meshlet_micro_offset;
+            instance->m_global_meshlet_micro_capacity = m_global_meshlet_micro_capacity;
+
+            if (m_global_index_capacity > 0)
+            {
+                GeometryBuffer::AddReference(GeometryPool::Index, m_global_index_offset);
+            }
+            if (m_global_meshlet_capacity > 0)
+            {
+                GeometryBuffer::AddReference(GeometryPool::MeshletBounds, m_global_meshlet_offset);
+            }
+            if (m_global_meshlet_vertex_capacity > 0)
+            {
+                GeometryBuffer::AddReference(GeometryPool::MeshletVertex, m_global_meshlet_vertex_offset);
+            }
+            if (m_global_meshlet_micro_capacity > 0)
+            {
+                GeometryBuffer::AddReference(GeometryPool::MeshletMicro, m_global_meshlet_micro_offset);
+            }
+        }
 
         auto get_dynamic_capacity = [](const size_t count) -> uint32_t
         {
@@ -866,6 +885,20 @@ namespace spartan
             return capacity;
         };
 
+        // static blocks can be moved by the defragmenter, dynamic ones are rewritten in place so they stay pinned
+        auto relocation = [this](const GeometryPool pool) -> GeometryRelocation
+        {
+            if (m_dynamic)
+            {
+                return nullptr;
+            }
+
+            return [this, pool](const uint32_t offset) { return RelocateGpuBlock(pool, offset); };
+        };
+
+        // held until every offset is final, a relocation in between would patch bounds that don't exist yet
+        lock_guard lock(m_mutex);
+
         m_global_vertex_capacity =
             m_dynamic
             ? get_dynamic_capacity(m_vertices.size())
@@ -908,11 +941,13 @@ namespace spartan
         {
             m_global_meshlet_vertex_offset = GeometryBuffer::AppendMeshletVertices(
                 m_meshlet_vertices.data(),
-                m_global_meshlet_vertex_capacity
+                m_global_meshlet_vertex_capacity,
+                relocation(GeometryPool::MeshletVertex)
             );
             m_global_meshlet_micro_offset = GeometryBuffer::AppendMeshletMicroIndices(
                 m_meshlet_micro_indices.data(),
-                m_global_meshlet_micro_capacity
+                m_global_meshlet_micro_capacity,
+                relocation(GeometryPool::MeshletMicro)
             );
         }
 
@@ -949,16 +984,19 @@ namespace spartan
         {
             m_global_vertex_offset = GeometryBuffer::AppendVertices(
                 m_vertices.data(),
-                m_global_vertex_capacity
+                m_global_vertex_capacity,
+                relocation(GeometryPool::Vertex)
             );
             m_global_index_offset = GeometryBuffer::AppendIndices(
                 m_indices.data(),
-                m_global_index_capacity
+                m_global_index_capacity,
+                relocation(GeometryPool::Index)
             );
             m_global_meshlet_offset =
                 GeometryBuffer::AppendMeshletBounds(
                     gpu_meshlets.data(),
-                    m_global_meshlet_capacity
+                    m_global_meshlet_capacity,
+                    relocation(GeometryPool::MeshletBounds)
                 );
         }
 
@@ -979,6 +1017,109 @@ namespace spartan
         m_ready_for_blas.store(true, std::memory_order_release);
     }
 
+    void Mesh::ReleaseGpuBuffers()
+    {
+        // under the lock so the defragmenter can't move a block between reading its offset and freeing it
+        lock_guard lock(m_mutex);
+        if (!m_ready_for_blas.exchange(false))
+        {
+            return;
+        }
+
+        if (m_global_vertex_capacity > 0)
+        {
+            GeometryBuffer::Free(GeometryPool::Vertex, m_global_vertex_offset);
+        }
+        if (m_global_index_capacity > 0)
+        {
+            GeometryBuffer::Free(GeometryPool::Index, m_global_index_offset);
+        }
+        if (m_global_meshlet_capacity > 0)
+        {
+            GeometryBuffer::Free(GeometryPool::MeshletBounds, m_global_meshlet_offset);
+        }
+        if (m_global_meshlet_vertex_capacity > 0)
+        {
+            GeometryBuffer::Free(GeometryPool::MeshletVertex, m_global_meshlet_vertex_offset);
+        }
+        if (m_global_meshlet_micro_capacity > 0)
+        {
+            GeometryBuffer::Free(GeometryPool::MeshletMicro, m_global_meshlet_micro_offset);
+        }
+
+        m_global_vertex_capacity         = 0;
+        m_global_index_capacity          = 0;
+        m_global_meshlet_capacity        = 0;
+        m_global_meshlet_vertex_capacity = 0;
+        m_global_meshlet_micro_capacity  = 0;
+    }
+
+    bool Mesh::RelocateGpuBlock(const GeometryPool pool, const uint32_t offset)
+    {
+        // called from GeometryBuffer::BuildIfDirty, a mesh that is busy on another thread is asked again next frame
+        unique_lock lock(m_mutex, try_to_lock);
+        if (!lock.owns_lock())
+        {
+            return false;
+        }
+
+        // the cpu geometry is the only copy left to re-upload from
+        if (
+            m_vertices.size()              != m_global_vertex_capacity         ||
+            m_indices.size()               != m_global_index_capacity          ||
+            m_meshlets.size()              != m_global_meshlet_capacity        ||
+            m_meshlet_vertices.size()      != m_global_meshlet_vertex_capacity ||
+            m_meshlet_micro_indices.size() != m_global_meshlet_micro_capacity
+        )
+        {
+            return false;
+        }
+
+        switch (pool)
+        {
+            case GeometryPool::Vertex:
+                GeometryBuffer::UpdateVertices(m_vertices.data(), offset, m_global_vertex_capacity);
+                m_global_vertex_offset = offset;
+                return true;
+
+            case GeometryPool::Index:
+                GeometryBuffer::UpdateIndices(m_indices.data(), offset, m_global_index_capacity);
+                m_global_index_offset = offset;
+                return true;
+
+            case GeometryPool::MeshletBounds:
+                m_global_meshlet_offset = offset;
+                break;
+
+            case GeometryPool::MeshletVertex:
+                GeometryBuffer::UpdateMeshletVertices(m_meshlet_vertices.data(), offset, m_global_meshlet_vertex_capacity);
+                m_global_meshlet_vertex_offset = offset;
+                break;
+
+            case GeometryPool::MeshletMicro:
+                GeometryBuffer::UpdateMeshletMicroIndices(m_meshlet_micro_indices.data(), offset, m_global_meshlet_micro_capacity);
+                m_global_meshlet_micro_offset = offset;
+                break;
+
+            default:
+                return false;
+        }
+
+        // the bounds carry global unique/micro offsets, so they follow those blocks around
+        vector<Sb_MeshletBounds> gpu_meshlets = m_meshlets;
+        for (Sb_MeshletBounds& bounds : gpu_meshlets)
+        {
+            offset_meshlet_unique_ranges(bounds, m_global_meshlet_vertex_offset, m_global_meshlet_micro_offset);
+        }
+
+        if (!gpu_meshlets.empty())
+        {
+            GeometryBuffer::UpdateMeshletBounds(gpu_meshlets.data(), m_global_meshlet_offset, static_cast<uint32_t>(gpu_meshlets.size()));
+        }
+
+        return true;
+    }
+
     RHI_Buffer* Mesh::GetVertexBuffer()
     {
         return GeometryBuffer::GetVertexBuffer();
@@ -46,6 +46,7 @@ namespace spartan
     class RHI_AccelerationStructure;
     class RHI_CommandList;
     struct Skeleton;
+    enum class GeometryPool : uint8_t;
 
     enum class MeshFlags : uint32_t
     {
@@ -179,6 +180,10 @@ namespace spartan
         bool CanRefitBlas(uint32_t sub_mesh_index) const;
 
     private:
+        // global geometry buffer blocks
+        void ReleaseGpuBuffers();
+        bool RelocateGpuBlock(GeometryPool pool, uint32_t offset);
+
         // geometry
         std::vector<RHI_Vertex_PosTexNorTan> m_vertices; // all vertices of a model file
         std::vector<uint32_t> m_indices;                 // all indices of a model file
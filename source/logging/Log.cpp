@@ -22,9 +22,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =================
 #include "pch.h"
 #include <algorithm>
-#include <fstream>
 #include <filesystem>
 #include <system_error>
+#include <thread>
 #include "../core/Debugging.h"
 //============================
 
@@ -41,50 +41,333 @@ namespace spartan
         string log_file_name = "log.txt";
         ILogger* logger      = nullptr;
         bool log_to_file     = true;
-        mutex log_output_mutex;
+        mutex log_output_mutex; // held by whoever drains the queues, the background thread or a flush
         constexpr uint32_t history_max_count = 2000;
 
-        void write_to_file(string text, const LogType type)
+        // queue settings, every level has its own bounded queue so an info flood can't push out errors
+        constexpr uint32_t log_queue_capacity  = 128;
+        constexpr uint32_t log_level_count     = 3;
+        constexpr uint64_t repeat_window_ms    = 1000; // identical messages within this window are only counted
+
+        // a queued message, the turn tells producers and the consumer whose move it is
+        // even: free for the producer of that lap, odd: published and waiting for the consumer
+        struct log_entry
+        {
+            atomic<uint64_t> turn = 0;
+            uint64_t order        = 0; // global submission order, queues are merged on it
+            char text[SP_LOG_BUFFER_SIZE];
+        };
+
+        // bounded multi-producer single-consumer queue, zero initialized so it works before any constructor runs
+        struct log_queue
+        {
+            log_entry entries[log_queue_capacity];
+            alignas(64) atomic<uint64_t> head = 0; // next position producers claim
+            alignas(64) uint64_t tail         = 0; // next position the consumer reads, guarded by log_output_mutex
+            atomic<uint64_t> dropped          = 0;
+            uint64_t dropped_reported         = 0;
+        };
+
+        // the last message of a level, used to collapse repeats
+        struct log_repeat
         {
-            const string prefix = (type == LogType::Info) ? "Info:" : (type == LogType::Warning) ? "Warning:" : "Error:";
-            text = prefix + " " + text;
+            atomic<uint64_t> hash    = 0;
+            atomic<uint64_t> time_ms = 0;
+            atomic<uint32_t> count   = 0;
+        };
 
-            // the log being replaced here is the only record of why the last run died, and the restart
-            // after a gpu crash is what lands on this path, so it is rotated rather than deleted
-            static bool is_first_log = true;
-            if (is_first_log)
+        log_queue queues[log_level_count];
+        log_repeat repeats[log_level_count];
+        atomic<uint64_t> log_order = 0;
+
+        // background writer
+        FILE* log_file           = nullptr;
+        bool log_file_rotated    = false;
+        string log_file_batch;
+        atomic<uint32_t> log_signal  = 0;
+        atomic<bool> worker_running  = false;
+        thread worker;
+
+        const char* get_prefix(const LogType type)
+        {
+            return (type == LogType::Info) ? "Info:" : (type == LogType::Warning) ? "Warning:" : "Error:";
+        }
+
+        size_t write_timestamp(char* buffer)
+        {
+            auto t = time(nullptr);
+            tm tm_struct{};
+            localtime_s(&tm_struct, &t);
+            return strftime(buffer, SP_LOG_BUFFER_SIZE, "[%H:%M:%S]: ", &tm_struct);
+        }
+
+        FILE* get_log_file()
+        {
+            if (!log_file)
             {
-                error_code ignored;
-                filesystem::rename(log_file_name, "log_previous.txt", ignored);
-                FileSystem::Delete(log_file_name);
-                is_first_log = false;
+                // the log being replaced here is the only record of why the last run died, and the restart
+                // after a gpu crash is what lands on this path, so it is rotated rather than deleted
+                if (!log_file_rotated)
+                {
+                    error_code ignored;
+                    filesystem::rename(log_file_name, "log_previous.txt", ignored);
+                    FileSystem::Delete(log_file_name);
+                    log_file_rotated = true;
+                }
+
+                // stays open, the writer only appends and flushes
+                log_file = fopen(log_file_name.c_str(), "ab");
             }
 
-            // open/create a log file to write the log into
-            ofstream fout;
-            fout.open(log_file_name, ofstream::out | ofstream::app);
+            return log_file;
+        }
 
-            if (fout.is_open())
+        void close_log_file()
+        {
+            if (log_file)
             {
-                fout << text << endl;
-                fout.close();
+                fclose(log_file);
+                log_file = nullptr;
             }
         }
-    }
 
-    std::array<char[SP_LOG_BUFFER_SIZE], SP_LOG_BUFFER_COUNT> Log::m_buffers;
-    std::array<std::mutex, SP_LOG_BUFFER_COUNT> Log::m_buffer_mutexes;
-    size_t Log::m_current_buffer = 0;
+        // caller holds log_output_mutex
+        void process(const char* text, const LogType type)
+        {
+            history.emplace_back(text, type);
+            if (history.size() > history_max_count)
+            {
+                history.erase(history.begin(), history.begin() + (history.size() - history_max_count));
+            }
+
+            if (log_to_file || !logger || Debugging::IsLoggingToFileEnabled())
+            {
+                logs.emplace_back(text, type);
+
+                log_file_batch += get_prefix(type);
+                log_file_batch += ' ';
+                log_file_batch += text;
+                log_file_batch += '\n';
+            }
+
+            if (logger)
+            {
+                logger->Log(text, static_cast<uint32_t>(type));
+            }
+        }
+
+        // write out everything published so far in submission order, caller holds log_output_mutex
+        void drain()
+        {
+            while (true)
+            {
+                // the oldest published message across the queues goes next
+                log_entry* next  = nullptr;
+                uint32_t level   = 0;
+                for (uint32_t i = 0; i < log_level_count; i++)
+                {
+                    log_queue& queue = queues[i];
+                    log_entry& entry = queue.entries[queue.tail % log_queue_capacity];
+                    if (entry.turn.load(memory_order_acquire) != 2 * (queue.tail / log_queue_capacity) + 1)
+                    {
+                        continue;
+                    }
+
+                    if (!next || entry.order < next->order)
+                    {
+                        next  = &entry;
+                        level = i;
+                    }
+                }
+
+                if (!next)
+                {
+                    break;
+                }
+
+                log_queue& queue = queues[level];
+                process(next->text, static_cast<LogType>(level));
+                next->turn.store(2 * (queue.tail / log_queue_capacity) + 2, memory_order_release);
+                queue.tail++;
+            }
+
+            for (uint32_t i = 0; i < log_level_count; i++)
+            {
+                log_queue& queue       = queues[i];
+                const uint64_t dropped = queue.dropped.load(memory_order_relaxed);
+                if (dropped != queue.dropped_reported)
+                {
+                    static const char* level_names[] = { "info", "warning", "error" };
+
+                    char text[SP_LOG_BUFFER_SIZE];
+                    const size_t timestamp_len = write_timestamp(text);
+                    snprintf(text + timestamp_len, sizeof(text) - timestamp_len, "%llu %s messages were dropped, the log queue was full",
+                        static_cast<unsigned long long>(dropped - queue.dropped_reported), level_names[i]);
+                    process(text, LogType::Warning);
+                    queue.dropped_reported = dropped;
+                }
+            }
+
+            if (!log_file_batch.empty())
+            {
+                if (FILE* file = get_log_file())
+                {
+                    fwrite(log_file_batch.data(), 1, log_file_batch.size(), file);
+                    fflush(file);
+                }
+                log_file_batch.clear();
+            }
+        }
+
+        // claim a slot, stamp and copy the message, then publish it, returns false if the queue is full
+        bool enqueue(const char* text, const LogType type)
+        {
+            log_queue& queue = queues[static_cast<uint32_t>(type)];
+
+            uint64_t position = queue.head.load(memory_order_relaxed);
+            log_entry* entry  = nullptr;
+            while (true)
+            {
+                entry = &queue.entries[position % log_queue_capacity];
+                const uint64_t turn     = entry->turn.load(memory_order_acquire);
+                const uint64_t expected = 2 * (position / log_queue_capacity);
+                if (turn == expected)
+                {
+                    if (queue.head.compare_exchange_weak(position, position + 1, memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (turn < expected)
+                {
+                    // the consumer hasn't freed this slot since the last lap
+                    return false;
+                }
+                else
+                {
+                    position = queue.head.load(memory_order_relaxed);
+                }
+            }
+
+            // add timestamp directly to the entry
+            size_t timestamp_len = write_timestamp(entry->text);
+            size_t available_len = SP_LOG_BUFFER_SIZE - timestamp_len - 1; // -1 for null terminator
+
+            // append text after timestamp
+            strncpy_s(entry->text + timestamp_len, available_len + 1, text, _TRUNCATE);
+
+            entry->order = log_order.fetch_add(1, memory_order_relaxed);
+            entry->turn.store(2 * (position / log_queue_capacity) + 1, memory_order_release);
+
+            return true;
+        }
+
+        // bypasses the queues when producers refill them faster than a flush empties them, what is queued goes out first to keep the order
+        void write_direct(const char* text, const LogType type)
+        {
+            lock_guard<mutex> guard(log_output_mutex);
+            drain();
+
+            char stamped[SP_LOG_BUFFER_SIZE];
+            const size_t timestamp_len = write_timestamp(stamped);
+            strncpy_s(stamped + timestamp_len, SP_LOG_BUFFER_SIZE - timestamp_len, text, _TRUNCATE);
+            process(stamped, type);
+
+            // writes the file batch
+            drain();
+        }
+
+        uint64_t hash_text(const char* text)
+        {
+            // fnv-1a
+            uint64_t hash = 14695981039346656037ull;
+            for (; *text; text++)
+            {
+                hash = (hash ^ static_cast<unsigned char>(*text)) * 1099511628211ull;
+            }
+            return hash;
+        }
+
+        // returns true if the message repeats the level's last one within the window and should only be counted
+        // otherwise returns how many times the previous message was suppressed
+        bool collapse_repeat(const char* text, const LogType type, uint32_t& suppressed)
+        {
+            log_repeat& repeat    = repeats[static_cast<uint32_t>(type)];
+            const uint64_t hash   = hash_text(text);
+            const uint64_t now_ms = static_cast<uint64_t>(chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count());
+
+            if (hash == repeat.hash.load(memory_order_relaxed) && now_ms - repeat.time_ms.load(memory_order_relaxed) < repeat_window_ms)
+            {
+                repeat.count.fetch_add(1, memory_order_relaxed);
+                return true;
+            }
+
+            repeat.hash.store(hash, memory_order_relaxed);
+            repeat.time_ms.store(now_ms, memory_order_relaxed);
+            suppressed = repeat.count.exchange(0, memory_order_relaxed);
+            return false;
+        }
+
+        void worker_loop()
+        {
+            while (worker_running.load(memory_order_acquire))
+            {
+                const uint32_t signal = log_signal.load(memory_order_acquire);
+                {
+                    lock_guard<mutex> guard(log_output_mutex);
+                    drain();
+                }
+                log_signal.wait(signal, memory_order_acquire);
+            }
+        }
+
+        void worker_stop()
+        {
+            if (worker.joinable())
+            {
+                worker_running.store(false, memory_order_release);
+                log_signal.fetch_add(1, memory_order_release);
+                log_signal.notify_all();
+                worker.join();
+            }
+        }
+
+        // a process that exits without Log::Shutdown() must not destroy a joinable thread
+        struct worker_guard
+        {
+            ~worker_guard()
+            {
+                worker_stop();
+            }
+        } worker_exit;
+    }
 
     void Log::Initialize()
     {
         // keep writing log.txt for the whole session, console is additive not a replacement
+        if (!worker.joinable())
+        {
+            worker_running.store(true, memory_order_release);
+            worker = thread(worker_loop);
+        }
+    }
+
+    void Log::Shutdown()
+    {
+        worker_stop();
+
+        lock_guard<mutex> guard(log_output_mutex);
+        drain();
+        close_log_file();
     }
 
     void Log::SetLogger(ILogger* logger_in)
     {
         lock_guard<mutex> guard(log_output_mutex);
 
+        // anything still queued belongs to the previous logger
+        drain();
+
         logger = logger_in;
 
         // flush the log buffer, if needed
@@ -114,14 +397,11 @@ namespace spartan
         {
             // the log that gets truncated here is the only record of why the last run died, so it is kept as
             // log_previous.txt. a crash is only diagnosable if its log survives the restart that follows it
+            close_log_file();
             error_code ignored;
             filesystem::rename(log_file_name, "log_previous.txt", ignored);
-
-            ofstream file(log_file_name, ios::out | ios::trunc);
-            if (file.is_open())
-            {
-                file.close();
-            }
+            log_file         = fopen(log_file_name.c_str(), "wb");
+            log_file_rotated = true;
         }
     }
 
@@ -134,56 +414,69 @@ namespace spartan
         return vector<LogCmd>(history.begin() + start, history.end());
     }
 
+    void Log::Flush()
+    {
+        lock_guard<mutex> guard(log_output_mutex);
+        drain();
+    }
+
+    uint64_t Log::GetDroppedCount()
+    {
+        uint64_t dropped = 0;
+        for (const log_queue& queue : queues)
+        {
+            dropped += queue.dropped.load(memory_order_relaxed);
+        }
+        return dropped;
+    }
+
     void Log::WriteBuffer(const char* text, const LogType type)
     {
         SP_ASSERT_MSG(text != nullptr, "Text is null");
-    
-        // get a buffer
-        size_t buffer_index;
-        {
-            static std::mutex buffer_select_mutex;
-            std::lock_guard<std::mutex> guard(buffer_select_mutex);
-            buffer_index = m_current_buffer;
-            m_current_buffer = (m_current_buffer + 1) % SP_LOG_BUFFER_COUNT;
-        }
-    
-        // lock the selected buffer
-        std::lock_guard<std::mutex> guard(m_buffer_mutexes[buffer_index]);
-        char* buffer = m_buffers[buffer_index];
-    
-        // add timestamp directly to buffer
-        auto t = time(nullptr);
-        tm tm_struct{};
-        localtime_s(&tm_struct, &t);
-        size_t timestamp_len = strftime(buffer, SP_LOG_BUFFER_SIZE, "[%H:%M:%S]: ", &tm_struct);
-        size_t available_len = SP_LOG_BUFFER_SIZE - timestamp_len - 1; // -1 for null terminator
-    
-        // append text to buffer after timestamp
-        strncpy_s(buffer + timestamp_len, available_len + 1, text, _TRUNCATE);
-    
-        // serialize access to the shared log vector, file, and logger
-        {
-            lock_guard<mutex> output_guard(log_output_mutex);
-
-            history.emplace_back(buffer, type);
-            if (history.size() > history_max_count)
-            {
-                history.erase(history.begin(), history.begin() + (history.size() - history_max_count));
-            }
 
-            if (log_to_file || !logger || Debugging::IsLoggingToFileEnabled())
+        uint32_t suppressed = 0;
+        if (collapse_repeat(text, type, suppressed))
+        {
+            return;
+        }
+
+        // without the background thread, before Initialize() or after Shutdown(), the caller writes
+        const bool is_async = worker_running.load(memory_order_acquire);
+
+        if (suppressed > 0)
+        {
+            char summary[64];
+            snprintf(summary, sizeof(summary), "previous message repeated %u more times", suppressed);
+            enqueue(summary, type);
+        }
+
+        if (!enqueue(text, type))
+        {
+            if (is_async && type != LogType::Error)
             {
-                logs.emplace_back(buffer, type);
-                write_to_file(buffer, type);
+                queues[static_cast<uint32_t>(type)].dropped.fetch_add(1, memory_order_relaxed);
+                return;
             }
 
-            if (logger)
+            // errors are never dropped, make room by writing out what's queued
+            Flush();
+            if (!enqueue(text, type))
             {
-                logger->Log(buffer, static_cast<uint32_t>(type));
+                write_direct(text, type);
+                return;
             }
         }
-    }
 
+        // errors are written before returning, the crash reports log right before the process dies
+        if (!is_async || type == LogType::Error)
+        {
+            Flush();
+            return;
+        }
+
+        log_signal.fetch_add(1, memory_order_release);
+        log_signal.notify_one();
+    }
     void Log::FormatBuffer(char* buffer, const char* function, const char* text, ...)
     {
         va_list args;
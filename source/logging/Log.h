@@ -32,7 +32,6 @@ namespace spartan
 {
     // macros for easy logging across the engine
     #define SP_LOG_BUFFER_SIZE 2048
-    #define SP_LOG_BUFFER_COUNT 16
     #define SP_LOG_INFO(text, ...)    { char buffer[SP_LOG_BUFFER_SIZE]; spartan::Log::FormatBuffer(buffer, __FUNCTION__, text, ##__VA_ARGS__); spartan::Log::WriteBuffer(buffer, spartan::LogType::Info); }
     #define SP_LOG_WARNING(text, ...) { char buffer[SP_LOG_BUFFER_SIZE]; spartan::Log::FormatBuffer(buffer, __FUNCTION__, text, ##__VA_ARGS__); spartan::Log::WriteBuffer(buffer, spartan::LogType::Warning); }
     #define SP_LOG_ERROR(text, ...)   { char buffer[SP_LOG_BUFFER_SIZE]; spartan::Log::FormatBuffer(buffer, __FUNCTION__, text, ##__VA_ARGS__); spartan::Log::WriteBuffer(buffer, spartan::LogType::Error); }
@@ -75,18 +74,21 @@ namespace spartan
 
         // misc
         static void Initialize();
+        static void Shutdown();
         static void SetLogger(ILogger* logger);
         static void SetLogToFile(const bool log_to_file);
         static void Clear();
         static std::vector<LogCmd> GetRecentEntries(uint32_t count);
 
-        // buffer-based logging
+        // writes everything queued so far to the file and the logger before returning
+        static void Flush();
+
+        // messages lost because their level's queue was full
+        static uint64_t GetDroppedCount();
+
+        // buffer-based logging, messages are queued and written by a background thread
+        // errors are flushed before the call returns so a crash can't cut them off
         static void WriteBuffer(const char* text, LogType type);
         static void FormatBuffer(char* buffer, const char* function, const char* text, ...);
-
-    private:
-        static std::array<char[SP_LOG_BUFFER_SIZE], SP_LOG_BUFFER_COUNT> m_buffers;
-        static std::array<std::mutex, SP_LOG_BUFFER_COUNT> m_buffer_mutexes;
-        static size_t m_current_buffer;
     };
 }
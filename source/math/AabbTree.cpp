@@ -0,0 +1,500 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ========
+#include "pch.h"
+#include "AabbTree.h"
+#include "Frustum.h"
+//===================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace spartan::math
+{
+    namespace
+    {
+        // leaves are fattened by this much so small movements stay inside the stored box
+        constexpr float aabb_margin = 0.5f;
+
+        // deep enough for any balanced tree the 32 bit proxies can address
+        constexpr uint32_t stack_size = 256;
+
+        // frustum planes in structure of arrays form, padded to 8 lanes with planes that never reject
+        struct frustum_planes
+        {
+            alignas(32) float nx[8];
+            alignas(32) float ny[8];
+            alignas(32) float nz[8];
+            alignas(32) float ax[8]; // absolute normals, for the projected box radius
+            alignas(32) float ay[8];
+            alignas(32) float az[8];
+            alignas(32) float d[8];
+        };
+
+        void load_planes(const Frustum& frustum, frustum_planes& planes)
+        {
+            for (uint32_t i = 0; i < 8; i++)
+            {
+                const Plane plane = i < 6 ? frustum.GetPlane(i) : Plane(Vector3::Zero, FLT_MAX);
+                planes.nx[i]      = plane.normal.x;
+                planes.ny[i]      = plane.normal.y;
+                planes.nz[i]      = plane.normal.z;
+                planes.ax[i]      = abs(plane.normal.x);
+                planes.ay[i]      = abs(plane.normal.y);
+                planes.az[i]      = abs(plane.normal.z);
+                planes.d[i]       = plane.d;
+            }
+        }
+
+        // tests a box against every plane in mask at once, returns false when the box is outside any of them,
+        // otherwise mask is narrowed to the planes the box straddles, so an empty mask means fully inside
+        bool classify(const frustum_planes& planes, const Vector3& center, const Vector3& extent, uint32_t& mask)
+        {
+        #ifdef __AVX2__
+            const __m256 cx   = _mm256_set1_ps(center.x);
+            const __m256 cy   = _mm256_set1_ps(center.y);
+            const __m256 cz   = _mm256_set1_ps(center.z);
+            const __m256 ex   = _mm256_set1_ps(extent.x);
+            const __m256 ey   = _mm256_set1_ps(extent.y);
+            const __m256 ez   = _mm256_set1_ps(extent.z);
+            const __m256 zero = _mm256_setzero_ps();
+
+            // signed distance of the center and projected radius of the box, for all planes
+            __m256 distance = _mm256_load_ps(planes.d);
+            distance        = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_load_ps(planes.nx), cx));
+            distance        = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_load_ps(planes.ny), cy));
+            distance        = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_load_ps(planes.nz), cz));
+            __m256 radius   = _mm256_mul_ps(_mm256_load_ps(planes.ax), ex);
+            radius          = _mm256_add_ps(radius, _mm256_mul_ps(_mm256_load_ps(planes.ay), ey));
+            radius          = _mm256_add_ps(radius, _mm256_mul_ps(_mm256_load_ps(planes.az), ez));
+
+            const uint32_t outside  = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_add_ps(distance, radius), zero, _CMP_LT_OQ)));
+            const uint32_t straddle = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_sub_ps(distance, radius), zero, _CMP_LT_OQ)));
+            if (outside & mask)
+            {
+                return false;
+            }
+
+            mask &= straddle;
+            return true;
+        #else
+            uint32_t straddle = 0;
+            for (uint32_t i = 0; i < 6; i++)
+            {
+                if (!(mask & (1u << i)))
+                {
+                    continue;
+                }
+
+                const float distance = planes.nx[i] * center.x + planes.ny[i] * center.y + planes.nz[i] * center.z + planes.d[i];
+                const float radius   = planes.ax[i] * extent.x + planes.ay[i] * extent.y + planes.az[i] * extent.z;
+                if (distance + radius < 0.0f)
+                {
+                    return false;
+                }
+
+                if (distance - radius < 0.0f)
+                {
+                    straddle |= 1u << i;
+                }
+            }
+
+            mask = straddle;
+            return true;
+        #endif
+        }
+
+        float surface_area(const Vector3& min, const Vector3& max)
+        {
+            const Vector3 size = max - min;
+            return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+        }
+
+        bool is_beyond_reach(const Vector3& min, const Vector3& max, const float reach, const Vector3* origin)
+        {
+            if (!origin)
+            {
+                return false;
+            }
+
+            const Vector3 closest = Vector3::Max(min, Vector3::Min(*origin, max));
+            return Vector3::DistanceSquared(*origin, closest) > reach * reach;
+        }
+    }
+
+    uint32_t AabbTree::Insert(const BoundingBox& box, const float reach, const uint32_t user_id)
+    {
+        const uint32_t proxy = AllocateNode();
+        Node& node           = m_nodes[proxy];
+        node.min             = box.GetMin() - Vector3(aabb_margin);
+        node.max             = box.GetMax() + Vector3(aabb_margin);
+        node.reach           = reach;
+        node.user_id         = user_id;
+        node.height          = 0;
+
+        InsertLeaf(proxy);
+        m_leaf_count++;
+
+        return proxy;
+    }
+
+    void AabbTree::Remove(const uint32_t proxy)
+    {
+        SP_ASSERT(proxy < m_nodes.size() && m_nodes[proxy].IsLeaf());
+
+        RemoveLeaf(proxy);
+        FreeNode(proxy);
+        m_leaf_count--;
+    }
+
+    bool AabbTree::Update(const uint32_t proxy, const BoundingBox& box, const float reach)
+    {
+        SP_ASSERT(proxy < m_nodes.size() && m_nodes[proxy].IsLeaf());
+
+        if (Fits(proxy, box, reach))
+        {
+            return false;
+        }
+
+        RemoveLeaf(proxy);
+
+        Node& moved = m_nodes[proxy];
+        moved.min   = box.GetMin() - Vector3(aabb_margin);
+        moved.max   = box.GetMax() + Vector3(aabb_margin);
+        moved.reach = reach;
+
+        InsertLeaf(proxy);
+
+        return true;
+    }
+
+    bool AabbTree::Fits(const uint32_t proxy, const BoundingBox& box, const float reach) const
+    {
+        const Node& node = m_nodes[proxy];
+        return node.reach == reach && BoundingBox(node.min, node.max).Intersects(box) == Intersection::Inside;
+    }
+
+    void AabbTree::Clear()
+    {
+        m_nodes.clear();
+        m_root       = invalid;
+        m_free       = invalid;
+        m_leaf_count = 0;
+    }
+
+    void AabbTree::Cull(const Frustum& frustum, const Vector3* origin, const bool ignore_depth, vector<uint32_t>& user_ids_out) const
+    {
+        if (m_root == invalid)
+        {
+            return;
+        }
+
+        frustum_planes planes;
+        load_planes(frustum, planes);
+
+        // near and far are the first two planes
+        const uint32_t planes_all = ignore_depth ? 0b111100 : 0b111111;
+
+        // each entry carries the planes its parent still straddled, a child can't cross a plane its parent is inside of
+        struct entry
+        {
+            uint32_t node;
+            uint32_t mask;
+        };
+        entry stack[stack_size];
+        uint32_t stack_count = 0;
+        stack[stack_count++] = { m_root, planes_all };
+
+        while (stack_count > 0)
+        {
+            const entry current = stack[--stack_count];
+            const Node& node    = m_nodes[current.node];
+
+            if (is_beyond_reach(node.min, node.max, node.reach, origin))
+            {
+                continue;
+            }
+
+            uint32_t mask = current.mask;
+            if (mask != 0 && !classify(planes, (node.min + node.max) * 0.5f, (node.max - node.min) * 0.5f, mask))
+            {
+                continue;
+            }
+
+            if (node.IsLeaf())
+            {
+                user_ids_out.push_back(node.user_id);
+                continue;
+            }
+
+            if (mask == 0)
+            {
+                GatherLeaves(current.node, origin, user_ids_out);
+                continue;
+            }
+
+            SP_ASSERT(stack_count + 2 <= stack_size);
+            stack[stack_count++] = { node.child_a, mask };
+            stack[stack_count++] = { node.child_b, mask };
+        }
+    }
+
+    void AabbTree::GatherLeaves(const uint32_t index, const Vector3* origin, vector<uint32_t>& user_ids_out) const
+    {
+        uint32_t stack[stack_size];
+        uint32_t stack_count = 0;
+        stack[stack_count++] = index;
+
+        while (stack_count > 0)
+        {
+            const Node& node = m_nodes[stack[--stack_count]];
+            if (is_beyond_reach(node.min, node.max, node.reach, origin))
+            {
+                continue;
+            }
+
+            if (node.IsLeaf())
+            {
+                user_ids_out.push_back(node.user_id);
+                continue;
+            }
+
+            SP_ASSERT(stack_count + 2 <= stack_size);
+            stack[stack_count++] = node.child_a;
+            stack[stack_count++] = node.child_b;
+        }
+    }
+
+    uint32_t AabbTree::AllocateNode()
+    {
+        if (m_free == invalid)
+        {
+            m_nodes.emplace_back();
+            return static_cast<uint32_t>(m_nodes.size() - 1);
+        }
+
+        const uint32_t index = m_free;
+        m_free               = m_nodes[index].parent;
+        m_nodes[index]       = Node();
+
+        return index;
+    }
+
+    void AabbTree::FreeNode(const uint32_t index)
+    {
+        m_nodes[index]        = Node();
+        m_nodes[index].parent = m_free;
+        m_free                = index;
+    }
+
+    void AabbTree::InsertLeaf(const uint32_t leaf)
+    {
+        if (m_root == invalid)
+        {
+            m_root               = leaf;
+            m_nodes[leaf].parent = invalid;
+            return;
+        }
+
+        // walk down towards the sibling whose box grows the least, stop once pairing here beats descending
+        const Vector3 leaf_min = m_nodes[leaf].min;
+        const Vector3 leaf_max = m_nodes[leaf].max;
+        uint32_t index         = m_root;
+        while (!m_nodes[index].IsLeaf())
+        {
+            const Node& node = m_nodes[index];
+
+            const float area          = surface_area(node.min, node.max);
+            const float area_combined = surface_area(Vector3::Min(node.min, leaf_min), Vector3::Max(node.max, leaf_max));
+
+            // cost of a new parent for this node and the leaf, and the growth every ancestor inherits on descent
+            const float cost             = 2.0f * area_combined;
+            const float cost_inheritance = 2.0f * (area_combined - area);
+
+            auto descend_cost = [&](const uint32_t child_index)
+            {
+                const Node& child = m_nodes[child_index];
+                const float area_new = surface_area(Vector3::Min(child.min, leaf_min), Vector3::Max(child.max, leaf_max));
+                return (child.IsLeaf() ? area_new : area_new - surface_area(child.min, child.max)) + cost_inheritance;
+            };
+
+            const float cost_a = descend_cost(node.child_a);
+            const float cost_b = descend_cost(node.child_b);
+            if (cost < cost_a && cost < cost_b)
+            {
+                break;
+            }
+
+            index = cost_a < cost_b ? node.child_a : node.child_b;
+        }
+
+        // the new parent can reallocate the nodes, so nothing is referenced across it
+        const uint32_t sibling    = index;
+        const uint32_t parent_old = m_nodes[sibling].parent;
+        const uint32_t parent_new = AllocateNode();
+
+        m_nodes[parent_new].parent  = parent_old;
+        m_nodes[parent_new].child_a = sibling;
+        m_nodes[parent_new].child_b = leaf;
+        m_nodes[sibling].parent     = parent_new;
+        m_nodes[leaf].parent        = parent_new;
+        Refit(parent_new);
+
+        if (parent_old == invalid)
+        {
+            m_root = parent_new;
+        }
+        else if (m_nodes[parent_old].child_a == sibling)
+        {
+            m_nodes[parent_old].child_a = parent_new;
+        }
+        else
+        {
+            m_nodes[parent_old].child_b = parent_new;
+        }
+
+        // fix up boxes, reach and heights on the way back to the root
+        index = m_nodes[leaf].parent;
+        while (index != invalid)
+        {
+            index = Balance(index);
+            Refit(index);
+            index = m_nodes[index].parent;
+        }
+    }
+
+    void AabbTree::RemoveLeaf(const uint32_t leaf)
+    {
+        if (leaf == m_root)
+        {
+            m_root = invalid;
+            return;
+        }
+
+        const uint32_t parent      = m_nodes[leaf].parent;
+        const uint32_t grandparent = m_nodes[parent].parent;
+        const uint32_t sibling     = m_nodes[parent].child_a == leaf ? m_nodes[parent].child_b : m_nodes[parent].child_a;
+
+        // the sibling takes the parent's place
+        if (grandparent == invalid)
+        {
+            m_root                  = sibling;
+            m_nodes[sibling].parent = invalid;
+            FreeNode(parent);
+            return;
+        }
+
+        if (m_nodes[grandparent].child_a == parent)
+        {
+            m_nodes[grandparent].child_a = sibling;
+        }
+        else
+        {
+            m_nodes[grandparent].child_b = sibling;
+        }
+        m_nodes[sibling].parent = grandparent;
+        FreeNode(parent);
+
+        uint32_t index = grandparent;
+        while (index != invalid)
+        {
+            index = Balance(index);
+            Refit(index);
+            index = m_nodes[index].parent;
+        }
+    }
+
+    uint32_t AabbTree::Balance(const uint32_t index_a)
+    {
+        // rotates the taller grandchild side up when the children's heights differ by more than one
+        Node& a = m_nodes[index_a];
+        if (a.IsLeaf() || a.height < 2)
+        {
+            return index_a;
+        }
+
+        const uint32_t index_b = a.child_a;
+        const uint32_t index_c = a.child_b;
+        const int32_t balance  = m_nodes[index_c].height - m_nodes[index_b].height;
+        if (balance >= -1 && balance <= 1)
+        {
+            return index_a;
+        }
+
+        // the taller child takes a's place and a adopts the shorter of its grandchildren
+        const bool rotate_c     = balance > 1;
+        const uint32_t index_up = rotate_c ? index_c : index_b;
+        Node& up                = m_nodes[index_up];
+        const uint32_t index_f  = up.child_a;
+        const uint32_t index_g  = up.child_b;
+
+        up.child_a = index_a;
+        up.parent  = a.parent;
+        a.parent   = index_up;
+
+        if (up.parent == invalid)
+        {
+            m_root = index_up;
+        }
+        else if (m_nodes[up.parent].child_a == index_a)
+        {
+            m_nodes[up.parent].child_a = index_up;
+        }
+        else
+        {
+            m_nodes[up.parent].child_b = index_up;
+        }
+
+        const bool keep_f         = m_nodes[index_f].height > m_nodes[index_g].height;
+        const uint32_t index_keep = keep_f ? index_f : index_g;
+        const uint32_t index_give = keep_f ? index_g : index_f;
+
+        up.child_b                 = index_keep;
+        m_nodes[index_give].parent = index_a;
+        if (rotate_c)
+        {
+            a.child_b = index_give;
+        }
+        else
+        {
+            a.child_a = index_give;
+        }
+
+        Refit(index_a);
+        Refit(index_up);
+
+        return index_up;
+    }
+
+    void AabbTree::Refit(const uint32_t index)
+    {
+        Node& node          = m_nodes[index];
+        const Node& child_a = m_nodes[node.child_a];
+        const Node& child_b = m_nodes[node.child_b];
+
+        node.min    = Vector3::Min(child_a.min, child_b.min);
+        node.max    = Vector3::Max(child_a.max, child_b.max);
+        node.reach  = max(child_a.reach, child_b.reach);
+        node.height = 1 + max(child_a.height, child_b.height);
+    }
+}
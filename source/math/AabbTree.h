@@ -0,0 +1,90 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =========
+#include <cstdint>
+#include <vector>
+#include "BoundingBox.h"
+//====================
+
+namespace spartan::math
+{
+    class Frustum;
+
+    // dynamic bounding volume hierarchy over axis aligned boxes, leaves carry a user id and are stored fattened
+    // by a margin so objects that move a little don't touch the tree, a leaf is reinserted only once its box
+    // escapes the fat one, insertion picks the cheapest sibling by surface area and rotations keep it balanced
+    // each node also carries the largest reach (max visible distance) of its subtree so distance culling
+    // rejects whole branches too
+    class AabbTree
+    {
+    public:
+        static constexpr uint32_t invalid = UINT32_MAX;
+
+        uint32_t Insert(const BoundingBox& box, float reach, uint32_t user_id);
+        void Remove(uint32_t proxy);
+        // returns true when the leaf had to be reinserted
+        bool Update(uint32_t proxy, const BoundingBox& box, float reach);
+        // true while the box is still inside the leaf's fat box and the reach is unchanged, so Update() would be a no-op
+        bool Fits(uint32_t proxy, const BoundingBox& box, float reach) const;
+        void Clear();
+
+        // appends the user id of every leaf that touches the frustum and, when an origin is given, lies within
+        // its reach of it, subtrees fully inside the frustum are gathered without testing their leaves
+        // leaves are tested with their fat box so the result is conservative by the margin, read only so
+        // several frustums (shadow cascades) can cull the same tree concurrently
+        void Cull(const Frustum& frustum, const Vector3* origin, bool ignore_depth, std::vector<uint32_t>& user_ids_out) const;
+
+        bool IsEmpty() const          { return m_root == invalid; }
+        uint32_t GetLeafCount() const { return m_leaf_count; }
+        uint32_t GetHeight() const    { return m_root == invalid ? 0 : static_cast<uint32_t>(m_nodes[m_root].height); }
+
+    private:
+        struct Node
+        {
+            Vector3 min        = Vector3::Zero;
+            Vector3 max        = Vector3::Zero;
+            float reach        = 0.0f;
+            uint32_t parent    = invalid; // next free node while the node is unused
+            uint32_t child_a   = invalid;
+            uint32_t child_b   = invalid;
+            uint32_t user_id   = invalid;
+            int32_t height     = -1;      // 0 for leaves, -1 for free nodes
+
+            bool IsLeaf() const { return child_a == invalid; }
+        };
+
+        uint32_t AllocateNode();
+        void FreeNode(uint32_t index);
+        void InsertLeaf(uint32_t leaf);
+        void RemoveLeaf(uint32_t leaf);
+        uint32_t Balance(uint32_t index);
+        void Refit(uint32_t index);
+        void GatherLeaves(uint32_t index, const Vector3* origin, std::vector<uint32_t>& user_ids_out) const;
+
+        std::vector<Node> m_nodes;
+        uint32_t m_root       = invalid;
+        uint32_t m_free       = invalid;
+        uint32_t m_leaf_count = 0;
+    };
+}
@@ -77,6 +77,191 @@ namespace spartan::math
         m_planes[5].Normalize();
     }
 
+    void FrustumBatch::Clear()
+    {
+        center_x.clear();
+        center_y.clear();
+        center_z.clear();
+        extent_x.clear();
+        extent_y.clear();
+        extent_z.clear();
+        max_distance_squared.clear();
+    }
+
+    void FrustumBatch::Reserve(const uint32_t count)
+    {
+        center_x.reserve(count);
+        center_y.reserve(count);
+        center_z.reserve(count);
+        extent_x.reserve(count);
+        extent_y.reserve(count);
+        extent_z.reserve(count);
+        max_distance_squared.reserve(count);
+    }
+
+    void FrustumBatch::Add(const Vector3& center, const Vector3& extent, const float max_distance)
+    {
+        center_x.push_back(center.x);
+        center_y.push_back(center.y);
+        center_z.push_back(center.z);
+        extent_x.push_back(min(extent.x, FLT_MAX));
+        extent_y.push_back(min(extent.y, FLT_MAX));
+        extent_z.push_back(min(extent.z, FLT_MAX));
+        max_distance_squared.push_back(max_distance * max_distance);
+    }
+
+    void Frustum::CullBatch(const FrustumBatch& boxes, vector<uint64_t>& visibility_out, const bool ignore_depth, const Vector3* origin) const
+    {
+        const uint32_t count = boxes.GetCount();
+        visibility_out.assign((count + 63) / 64, 0);
+
+        // near and far are the first two planes
+        const uint32_t plane_start = ignore_depth ? 2 : 0;
+
+        // a box is visible when it isn't fully behind any plane and, with an origin, its closest point is within
+        // reach, comparisons against nan fail, so a non finite box comes out invisible like it does in CheckCube()
+        auto is_visible = [&](const uint32_t i)
+        {
+            for (uint32_t p = plane_start; p < 6; p++)
+            {
+                const Plane& plane   = m_planes[p];
+                const float distance = plane.normal.x * boxes.center_x[i] + plane.normal.y * boxes.center_y[i] + plane.normal.z * boxes.center_z[i] + plane.d;
+                const float radius   = abs(plane.normal.x) * boxes.extent_x[i] + abs(plane.normal.y) * boxes.extent_y[i] + abs(plane.normal.z) * boxes.extent_z[i];
+                if (!(distance + radius >= 0.0f))
+                {
+                    return false;
+                }
+            }
+
+            if (origin)
+            {
+                const float dx = max(abs(origin->x - boxes.center_x[i]) - boxes.extent_x[i], 0.0f);
+                const float dy = max(abs(origin->y - boxes.center_y[i]) - boxes.extent_y[i], 0.0f);
+                const float dz = max(abs(origin->z - boxes.center_z[i]) - boxes.extent_z[i], 0.0f);
+                return dx * dx + dy * dy + dz * dz <= boxes.max_distance_squared[i];
+            }
+
+            return true;
+        };
+
+        uint32_t i = 0;
+
+    #if defined(__AVX2__)
+        // one plane broadcast per lane group, eight boxes per iteration, the mask lands in the bitset as a byte
+        __m256 plane_nx[6], plane_ny[6], plane_nz[6], plane_ax[6], plane_ay[6], plane_az[6], plane_d[6];
+        for (uint32_t p = 0; p < 6; p++)
+        {
+            plane_nx[p] = _mm256_set1_ps(m_planes[p].normal.x);
+            plane_ny[p] = _mm256_set1_ps(m_planes[p].normal.y);
+            plane_nz[p] = _mm256_set1_ps(m_planes[p].normal.z);
+            plane_ax[p] = _mm256_set1_ps(abs(m_planes[p].normal.x));
+            plane_ay[p] = _mm256_set1_ps(abs(m_planes[p].normal.y));
+            plane_az[p] = _mm256_set1_ps(abs(m_planes[p].normal.z));
+            plane_d[p]  = _mm256_set1_ps(m_planes[p].d);
+        }
+        const __m256 zero      = _mm256_setzero_ps();
+        const __m256 sign_mask = _mm256_set1_ps(-0.0f);
+        const __m256 origin_x  = _mm256_set1_ps(origin ? origin->x : 0.0f);
+        const __m256 origin_y  = _mm256_set1_ps(origin ? origin->y : 0.0f);
+        const __m256 origin_z  = _mm256_set1_ps(origin ? origin->z : 0.0f);
+
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256 cx = _mm256_loadu_ps(&boxes.center_x[i]);
+            const __m256 cy = _mm256_loadu_ps(&boxes.center_y[i]);
+            const __m256 cz = _mm256_loadu_ps(&boxes.center_z[i]);
+            const __m256 ex = _mm256_loadu_ps(&boxes.extent_x[i]);
+            const __m256 ey = _mm256_loadu_ps(&boxes.extent_y[i]);
+            const __m256 ez = _mm256_loadu_ps(&boxes.extent_z[i]);
+
+            __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (uint32_t p = plane_start; p < 6; p++)
+            {
+                __m256 distance = _mm256_fmadd_ps(plane_nx[p], cx, plane_d[p]);
+                distance        = _mm256_fmadd_ps(plane_ny[p], cy, distance);
+                distance        = _mm256_fmadd_ps(plane_nz[p], cz, distance);
+                __m256 radius   = _mm256_mul_ps(plane_ax[p], ex);
+                radius          = _mm256_fmadd_ps(plane_ay[p], ey, radius);
+                radius          = _mm256_fmadd_ps(plane_az[p], ez, radius);
+                visible         = _mm256_and_ps(visible, _mm256_cmp_ps(_mm256_add_ps(distance, radius), zero, _CMP_GE_OQ));
+            }
+
+            if (origin)
+            {
+                const __m256 dx = _mm256_max_ps(_mm256_sub_ps(_mm256_andnot_ps(sign_mask, _mm256_sub_ps(origin_x, cx)), ex), zero);
+                const __m256 dy = _mm256_max_ps(_mm256_sub_ps(_mm256_andnot_ps(sign_mask, _mm256_sub_ps(origin_y, cy)), ey), zero);
+                const __m256 dz = _mm256_max_ps(_mm256_sub_ps(_mm256_andnot_ps(sign_mask, _mm256_sub_ps(origin_z, cz)), ez), zero);
+                __m256 distance_squared = _mm256_mul_ps(dx, dx);
+                distance_squared        = _mm256_fmadd_ps(dy, dy, distance_squared);
+                distance_squared        = _mm256_fmadd_ps(dz, dz, distance_squared);
+                visible = _mm256_and_ps(visible, _mm256_cmp_ps(distance_squared, _mm256_loadu_ps(&boxes.max_distance_squared[i]), _CMP_LE_OQ));
+            }
+
+            visibility_out[i >> 6] |= static_cast<uint64_t>(_mm256_movemask_ps(visible)) << (i & 63);
+        }
+    #elif defined(__SSE2__) || defined(_M_X64)
+        // four boxes per iteration, same math as the avx2 path without fused multiply add
+        __m128 plane_nx[6], plane_ny[6], plane_nz[6], plane_ax[6], plane_ay[6], plane_az[6], plane_d[6];
+        for (uint32_t p = 0; p < 6; p++)
+        {
+            plane_nx[p] = _mm_set1_ps(m_planes[p].normal.x);
+            plane_ny[p] = _mm_set1_ps(m_planes[p].normal.y);
+            plane_nz[p] = _mm_set1_ps(m_planes[p].normal.z);
+            plane_ax[p] = _mm_set1_ps(abs(m_planes[p].normal.x));
+            plane_ay[p] = _mm_set1_ps(abs(m_planes[p].normal.y));
+            plane_az[p] = _mm_set1_ps(abs(m_planes[p].normal.z));
+            plane_d[p]  = _mm_set1_ps(m_planes[p].d);
+        }
+        const __m128 zero      = _mm_setzero_ps();
+        const __m128 sign_mask = _mm_set1_ps(-0.0f);
+        const __m128 origin_x  = _mm_set1_ps(origin ? origin->x : 0.0f);
+        const __m128 origin_y  = _mm_set1_ps(origin ? origin->y : 0.0f);
+        const __m128 origin_z  = _mm_set1_ps(origin ? origin->z : 0.0f);
+
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128 cx = _mm_loadu_ps(&boxes.center_x[i]);
+            const __m128 cy = _mm_loadu_ps(&boxes.center_y[i]);
+            const __m128 cz = _mm_loadu_ps(&boxes.center_z[i]);
+            const __m128 ex = _mm_loadu_ps(&boxes.extent_x[i]);
+            const __m128 ey = _mm_loadu_ps(&boxes.extent_y[i]);
+            const __m128 ez = _mm_loadu_ps(&boxes.extent_z[i]);
+
+            __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (uint32_t p = plane_start; p < 6; p++)
+            {
+                __m128 distance = _mm_add_ps(_mm_mul_ps(plane_nx[p], cx), plane_d[p]);
+                distance        = _mm_add_ps(_mm_mul_ps(plane_ny[p], cy), distance);
+                distance        = _mm_add_ps(_mm_mul_ps(plane_nz[p], cz), distance);
+                __m128 radius   = _mm_mul_ps(plane_ax[p], ex);
+                radius          = _mm_add_ps(_mm_mul_ps(plane_ay[p], ey), radius);
+                radius          = _mm_add_ps(_mm_mul_ps(plane_az[p], ez), radius);
+                visible         = _mm_and_ps(visible, _mm_cmpge_ps(_mm_add_ps(distance, radius), zero));
+            }
+
+            if (origin)
+            {
+                const __m128 dx = _mm_max_ps(_mm_sub_ps(_mm_andnot_ps(sign_mask, _mm_sub_ps(origin_x, cx)), ex), zero);
+                const __m128 dy = _mm_max_ps(_mm_sub_ps(_mm_andnot_ps(sign_mask, _mm_sub_ps(origin_y, cy)), ey), zero);
+                const __m128 dz = _mm_max_ps(_mm_sub_ps(_mm_andnot_ps(sign_mask, _mm_sub_ps(origin_z, cz)), ez), zero);
+                const __m128 distance_squared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+                visible = _mm_and_ps(visible, _mm_cmple_ps(distance_squared, _mm_loadu_ps(&boxes.max_distance_squared[i])));
+            }
+
+            visibility_out[i >> 6] |= static_cast<uint64_t>(_mm_movemask_ps(visible)) << (i & 63);
+        }
+    #endif
+
+        // the remainder, and every box on targets without sse
+        for (; i < count; i++)
+        {
+            if (is_visible(i))
+            {
+                visibility_out[i >> 6] |= 1ull << (i & 63);
+            }
+        }
+    }
+
     bool Frustum::IsVisible(const Vector3& center, const Vector3& extent, bool ignore_depth /*= false*/) const
     {
         return CheckCube(center, extent, ignore_depth) != Intersection::Outside;
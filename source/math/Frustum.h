@@ -22,6 +22,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 //= INCLUDES =============
+#include <vector>
 #include "../math/Plane.h"
 #include "Matrix.h"
 #include "Vector3.h"
@@ -29,6 +30,24 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace spartan::math
 {
+    // axis aligned boxes in structure of arrays form, the input of Frustum::CullBatch()
+    // infinite extents are clamped to the largest float so unbounded boxes stay visible through the plane math
+    struct FrustumBatch
+    {
+        void Clear();
+        void Reserve(uint32_t count);
+        void Add(const Vector3& center, const Vector3& extent, float max_distance = FLT_MAX);
+        uint32_t GetCount() const { return static_cast<uint32_t>(center_x.size()); }
+
+        std::vector<float> center_x;
+        std::vector<float> center_y;
+        std::vector<float> center_z;
+        std::vector<float> extent_x;
+        std::vector<float> extent_y;
+        std::vector<float> extent_z;
+        std::vector<float> max_distance_squared;
+    };
+
     class Frustum
     {
     public:
@@ -38,6 +57,13 @@ namespace spartan::math
 
         bool IsVisible(const Vector3& center, const Vector3& extent, bool ignore_depth = false) const;
 
+        // visibility of every box in the batch, bit i of visibility_out is box i, 8 boxes per step with avx2,
+        // 4 with sse, when an origin is given boxes whose closest point lies beyond their max distance are rejected too
+        void CullBatch(const FrustumBatch& boxes, std::vector<uint64_t>& visibility_out, bool ignore_depth = false, const Vector3* origin = nullptr) const;
+
+        // near, far, left, right, top, bottom, normals point inwards
+        const Plane& GetPlane(const uint32_t index) const { return m_planes[index]; }
+
     private:
         Intersection CheckCube(const Vector3& center, const Vector3& extent, float ignore_depth = false) const;
         Intersection CheckSphere(const Vector3& center, float radius, float ignore_depth = false) const;
@@ -2565,9 +2565,8 @@ namespace spartan
             return "{\"unsupported_type\":" + json_string(type_name) + "}";
         }
 
-        bool attribute_type_is_writable(const std::any& value)
+        bool attribute_type_is_writable(const std::type_info& type)
         {
-            const std::type_info& type = value.type();
             return type == typeid(bool) ||
                 type == typeid(float) ||
                 type == typeid(double) ||
@@ -2595,7 +2594,7 @@ namespace spartan
 
         bool parse_attribute_value(const Attribute& attribute, const std::string& value, std::any& parsed, std::string& error)
         {
-            const std::type_info& type = attribute.getter().type();
+            const std::type_info& type = *attribute.type_id;
 
             if (type == typeid(bool))
             {
@@ -2876,7 +2875,7 @@ namespace spartan
 
             for (const Attribute& attribute : component->GetAttributes())
             {
-                const std::any value = attribute.getter();
+                const std::any value = attribute.get(component);
                 if (!first)
                 {
                     json += ",";
@@ -2886,7 +2885,7 @@ namespace spartan
                 json += "\"property\":" + json_string(attribute_property_name(attribute));
                 json += ",\"member\":" + json_string(attribute.name);
                 json += ",\"type\":" + json_string(attribute.type);
-                json += ",\"writable\":" + json_bool(attribute_type_is_writable(value));
+                json += ",\"writable\":" + json_bool(attribute_type_is_writable(*attribute.type_id));
                 json += ",\"value\":" + attribute_value_to_json(value, attribute.type);
                 json += "}";
             }
@@ -3046,12 +3045,11 @@ namespace spartan
 
         ComponentMetadata component_member_metadata(const Attribute& attribute)
         {
-            const std::any value = attribute.getter();
             ComponentMetadata metadata;
             metadata.property = attribute_property_name(attribute);
             metadata.member   = attribute.name;
             metadata.type     = attribute.type;
-            metadata.writable = attribute_type_is_writable(value);
+            metadata.writable = attribute_type_is_writable(*attribute.type_id);
             if (!metadata.writable)
             {
                 metadata.read_only_reason = "unsupported member type for component_set";
@@ -3087,7 +3085,7 @@ namespace spartan
 
             for (const Attribute& attribute : component->GetAttributes())
             {
-                const std::any value = attribute.getter();
+                const std::any value = attribute.get(component);
                 if (!first)
                 {
                     json += ",";
@@ -3117,7 +3115,7 @@ namespace spartan
 
                 try
                 {
-                    attribute.setter(parsed);
+                    attribute.set(component, parsed);
                 }
                 catch (const std::bad_any_cast&)
                 {
@@ -24,13 +24,19 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "pch.h"
 #include "Allocator.h"
 #include <cstring>
+#include <bit>
+#include <thread>
 #if defined(_WIN32)
 #include <Windows.h>
 #include <psapi.h>
+#include <DbgHelp.h>
 #pragma comment(lib, "psapi.lib")
+#pragma comment(lib, "dbghelp.lib")
 #elif defined(__linux__)
 #include <unistd.h>
+#include <execinfo.h>
 #include <sys/resource.h>
+#include <sys/mman.h>
 #endif
 //===============================
 
@@ -50,20 +56,36 @@ namespace spartan
         constexpr unsigned char poison_allocated = 0xCD; // freshly allocated memory
         constexpr unsigned char poison_freed     = 0xDD; // freed memory
 
-        // thread-local cache settings
-        constexpr size_t cache_max_size       = 256;  // max allocation size to cache
-        constexpr size_t cache_max_entries    = 32;   // max entries per size class
-        constexpr size_t cache_size_classes   = 8;    // number of size classes: 32, 64, 96, 128, 160, 192, 224, 256
-        constexpr size_t cache_size_granularity = 32; // size class granularity
+        // slab settings, small untagged requests are served from size-segregated slabs carved out of one reserved address range
+        constexpr size_t slab_size            = 64 * 1024;                      // slabs are aligned to their size
+        constexpr size_t slab_region_size     = size_t(32) * 1024 * 1024 * 1024; // reserved, pages are committed as slabs are carved
+        constexpr size_t slab_max_size        = 4096;                           // larger requests take the header path
+        constexpr size_t slab_alignment       = 16;                             // every size class is a multiple of this
+        constexpr uint32_t size_class_count   = 28;                             // 16 to 128 in steps of 16, then 4 classes per power of two up to 4096
+        constexpr uint32_t slab_magic         = 0x51AB51AB;
+        constexpr uint32_t slab_live_words    = static_cast<uint32_t>(slab_size / slab_alignment / 64); // one bit per block of the smallest class
+        constexpr uint32_t max_heaps          = 256;                            // threads past this use the header path
+        constexpr uint32_t remote_batch_size  = 64;                             // frees of other threads' blocks are returned in batches
+
+        // frame arena settings
+        constexpr size_t frame_arena_block_size = 1024 * 1024; // larger requests get a dedicated block
 
         // global counters
         atomic<size_t> bytes_allocated      = 0;
         atomic<size_t> bytes_allocated_peak = 0;
         atomic<size_t> allocation_count     = 0;
+        atomic<uint64_t> allocations_header = 0; // cumulative, the slab path counts per heap
+        atomic<uint64_t> bytes_header_total = 0; // cumulative, the slab path counts per heap
 
         // per-tag counters
         atomic<size_t> bytes_by_tag[static_cast<size_t>(MemoryTag::Count)] = {};
 
+        // frame arena counters, the frame index selects which half of every thread's arena is live
+        atomic<uint64_t> frame_index = 0;
+        atomic<size_t> frame_bytes_by_tag[static_cast<size_t>(MemoryTag::Count)]      = {};
+        atomic<size_t> frame_bytes_last_by_tag[static_cast<size_t>(MemoryTag::Count)] = {};
+        atomic<size_t> frame_bytes_peak_by_tag[static_cast<size_t>(MemoryTag::Count)] = {};
+
         // header stores allocation metadata
         struct allocation_header
         {
@@ -74,73 +96,837 @@ namespace spartan
             uint8_t   padding[7]; // pad to maintain alignment
         };
 
-        // thread-local cache entry
-        struct cache_entry
+        // a free slab block, only the link lives in the block, whether it's handed out is tracked in the slab
+        struct free_block
         {
-            void*  ptr;
-            size_t size;
+            free_block* next;
         };
 
-        // thread-local free list for small allocations
-        struct thread_cache
+        // a slab holds blocks of a single size class, the header sits at the start of the slab
+        // the first cache line belongs to the owning thread, the second is written by other threads
+        struct slab
         {
-            cache_entry entries[cache_size_classes][cache_max_entries];
-            size_t      count[cache_size_classes] = {};
+            uint32_t magic          = slab_magic;
+            uint32_t size_class     = 0;
+            uint32_t block_size     = 0;
+            uint32_t block_count    = 0;
+            uint32_t bump           = 0;       // blocks past this were never handed out
+            uint32_t used           = 0;       // blocks handed out and not yet returned to the owner
+            free_block* local_free  = nullptr; // blocks freed by the owner
+            slab* next              = nullptr; // link in the owner's active or full list
+            atomic<uint32_t> owner  = 0;       // heap id, 0 while abandoned
+            atomic<bool> in_full    = false;   // the owner moved it to its full list
+
+            alignas(64) atomic<free_block*> remote_free = nullptr; // blocks freed by other threads
+
+            // a bit per handed out block, kept out of the blocks so no payload can pass for a freed block,
+            // any thread may free, so the bits are atomic
+            atomic<uint64_t> live[slab_live_words] = {};
         };
 
-        thread_local thread_cache tl_cache = {};
+        constexpr size_t slab_header_size = (sizeof(slab) + 63) & ~size_t(63);
+
+        // per-thread slab cache, heaps live in a static table so other threads can always reach them
+        struct alignas(64) thread_heap
+        {
+            atomic<bool> in_use                            = false;
+            uint32_t id                                    = 0;
+            slab* active[size_class_count]                 = {};
+            slab* full[size_class_count]                   = {};
+            atomic<bool> reclaimable[size_class_count]     = {}; // a full slab may have free blocks again
+            free_block* remote_pending[remote_batch_size]  = {};
+            uint32_t remote_pending_count                  = 0;
+            atomic<int64_t> bytes                          = 0; // net bytes this thread allocated and freed
+            atomic<uint64_t> allocations                   = 0; // every slab allocation this heap ever served
+            atomic<uint64_t> bytes_total                   = 0; // bytes of those allocations
+        };
 
-        // get size class index (0-7 for sizes 1-256)
-        size_t get_size_class(size_t size)
+        // protects the slab pool, the abandoned lists and the region reservation
+        struct spin_lock
         {
-            if (size == 0)
+            atomic_flag flag;
+
+            void lock()
             {
-                return 0;
+                while (flag.test_and_set(memory_order_acquire))
+                {
+                    this_thread::yield();
+                }
+            }
+
+            void unlock()
+            {
+                flag.clear(memory_order_release);
+            }
+        };
+
+        thread_heap heaps[max_heaps];
+        spin_lock slab_lock;
+        atomic<char*> slab_region    = nullptr;
+        atomic<bool> slab_region_failed = false;
+        atomic<size_t> slab_region_used = 0;
+        slab* slab_pool              = nullptr;            // free slabs of any class
+        slab* slab_abandoned[size_class_count] = {};       // slabs with live blocks whose thread exited
+        atomic<int64_t> slab_bytes_heapless = 0;           // frees from threads without a heap
+
+        thread_local thread_heap* tl_heap = nullptr;
+        thread_local bool tl_heap_dead    = false;
+
+        void heap_abandon(thread_heap* heap);
+
+        // returns the thread's heap when the thread exits, the constructor is trivial so the heap can be set up from inside operator new
+        struct thread_heap_guard
+        {
+            thread_heap* heap = nullptr;
+
+            ~thread_heap_guard()
+            {
+                if (heap)
+                {
+                    tl_heap      = nullptr;
+                    tl_heap_dead = true;
+                    heap_abandon(heap);
+                }
+            }
+        };
+
+        thread_local thread_heap_guard tl_heap_guard;
+
+        // allocation trace recording
+        atomic<bool> trace_enabled            = false;
+        spin_lock trace_lock;
+        AllocationTraceEvent* trace_events    = nullptr;
+        size_t trace_count                    = 0;
+        size_t trace_capacity                 = 0;
+        uint8_t trace_thread_count            = 0;
+        thread_local int trace_thread         = -1;
+        constexpr char trace_file_magic[4]    = { 'S', 'P', 'A', 'T' };
+        constexpr uint32_t trace_file_version = 1;
+
+        // call site tracking, sampled stacks go to a table the c runtime owns so tracking never re-enters itself
+        constexpr uint32_t call_site_capacity    = 4096; // power of two, samples of new sites are dropped once it's 3/4 full
+        constexpr uint32_t call_site_skip_frames = 2;    // capture_stack() and Allocator::Allocate()
+        atomic<bool> tracking_enabled            = false;
+        atomic<uint32_t> tracking_sample_rate    = 64;
+        spin_lock call_site_lock;
+        AllocationCallSite* call_sites           = nullptr;
+        uint32_t call_site_count                 = 0;
+        thread_local uint32_t tl_sample_countdown = 0;
+        thread_local bool tl_capturing            = false; // set while this thread captures or reads stacks
+
+        // per-frame allocation counts, written by Tick()
+        constexpr uint32_t frame_history_size         = 256;
+        FrameAllocationStats frame_history[frame_history_size] = {};
+        uint64_t frame_history_count                  = 0;
+        uint64_t frame_allocations_last               = 0;
+        uint64_t frame_bytes_total_last               = 0;
+
+        // zero allocation mode, allocations inside an AllocationFreeScope fail once it's armed
+        atomic<bool> zero_mode_enabled                = false;
+        atomic<bool> zero_mode_armed                  = false;
+        atomic<uint64_t> zero_mode_arm_frame          = 0;
+        thread_local uint64_t tl_allocations          = 0;
+        thread_local const char* tl_free_scope        = nullptr; // innermost open scope
+        thread_local const char* tl_violation_scope   = nullptr; // scope of the first offending allocation
+        thread_local size_t tl_violation_size         = 0;
+        thread_local uint32_t tl_violation_frame_count = 0;
+        thread_local void* tl_violation_frames[AllocationCallSite::frame_count_max];
+
+        // a chunk of arena memory, the usable bytes follow the struct
+        struct frame_arena_block
+        {
+            frame_arena_block* next = nullptr;
+            size_t capacity         = 0;
+        };
+
+        // one half of a thread's double-buffered frame arena
+        struct frame_arena_buffer
+        {
+            frame_arena_block* blocks  = nullptr; // blocks in use, the head is the one being bumped
+            frame_arena_block* spare   = nullptr; // standard sized blocks kept from earlier frames
+            size_t offset              = 0;       // bump offset into the head block
+            uint64_t frame             = 0;
+
+            void reset()
+            {
+                while (blocks)
+                {
+                    frame_arena_block* next = blocks->next;
+                    if (blocks->capacity == frame_arena_block_size)
+                    {
+                        blocks->next = spare;
+                        spare        = blocks;
+                    }
+                    else
+                    {
+                        Allocator::Free(blocks);
+                    }
+                    blocks = next;
+                }
+                offset = 0;
+            }
+
+            void release()
+            {
+                reset();
+                while (spare)
+                {
+                    frame_arena_block* next = spare->next;
+                    Allocator::Free(spare);
+                    spare = next;
+                }
+            }
+        };
+
+        struct frame_arena
+        {
+            frame_arena_buffer buffers[2];
+
+            ~frame_arena()
+            {
+                buffers[0].release();
+                buffers[1].release();
+            }
+        };
+
+        thread_local frame_arena tl_frame_arena;
+
+        // round up to next multiple of alignment
+        size_t align_up(size_t value, size_t alignment)
+        {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+
+        // size class index, 0-7 cover 1-128 in steps of 16, after that each power of two is split in 4
+        uint32_t get_size_class(size_t size)
+        {
+            if (size <= 128)
+            {
+                return size == 0 ? 0 : static_cast<uint32_t>((size - 1) >> 4);
+            }
+
+            const uint32_t power = static_cast<uint32_t>(bit_width(size - 1)); // 2^(power - 1) < size <= 2^power
+            const size_t base    = size_t(1) << (power - 1);
+            const size_t step    = base >> 2;
+            return 8 + (power - 8) * 4 + static_cast<uint32_t>((size - base - 1) / step);
+        }
+
+        // block size of a size class
+        constexpr uint32_t get_size_for_class(uint32_t size_class)
+        {
+            if (size_class < 8)
+            {
+                return (size_class + 1) * 16;
+            }
+
+            const uint32_t power = 8 + (size_class - 8) / 4;
+            const uint32_t base  = 1u << (power - 1);
+            return base + ((size_class - 8) % 4 + 1) * (base >> 2);
+        }
+
+        static_assert(get_size_for_class(size_class_count - 1) == slab_max_size);
+
+        slab* slab_from_block(const void* ptr)
+        {
+            return reinterpret_cast<slab*>(reinterpret_cast<uintptr_t>(ptr) & ~(slab_size - 1));
+        }
+
+        bool is_slab_memory(const void* ptr)
+        {
+            const char* region = slab_region.load(memory_order_relaxed);
+            const char* p      = static_cast<const char*>(ptr);
+            return region && p >= region && p < region + slab_region_size;
+        }
+
+        // reserve the address range all slabs are carved from, once
+        char* slab_region_reserve()
+        {
+            char* region = slab_region.load(memory_order_acquire);
+            if (region || slab_region_failed.load(memory_order_relaxed))
+            {
+                return region;
+            }
+
+            lock_guard<spin_lock> lock(slab_lock);
+            region = slab_region.load(memory_order_relaxed);
+            if (region)
+            {
+                return region;
+            }
+
+#if defined(_WIN32)
+            // reservations are 64 KB aligned, which is the slab size
+            region = static_cast<char*>(VirtualAlloc(nullptr, slab_region_size, MEM_RESERVE, PAGE_NOACCESS));
+#elif defined(__linux__)
+            // no reserve, pages only count once a slab touches them
+            void* memory = mmap(nullptr, slab_region_size + slab_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            if (memory != MAP_FAILED)
+            {
+                region = reinterpret_cast<char*>(align_up(reinterpret_cast<uintptr_t>(memory), slab_size));
+            }
+#endif
+            if (!region)
+            {
+                // everything falls back to the header path
+                slab_region_failed.store(true, memory_order_relaxed);
+                return nullptr;
             }
 
-            return min((size - 1) / cache_size_granularity, cache_size_classes - 1);
+            slab_region.store(region, memory_order_release);
+            return region;
         }
 
-        // get actual size for a size class
-        size_t get_size_for_class(size_t size_class)
+        // carve a fresh slab from the reserved region
+        void* slab_carve()
         {
-            return (size_class + 1) * cache_size_granularity;
+            char* region = slab_region_reserve();
+            if (!region)
+            {
+                return nullptr;
+            }
+
+            const size_t offset = slab_region_used.fetch_add(slab_size, memory_order_relaxed);
+            if (offset + slab_size > slab_region_size)
+            {
+                return nullptr;
+            }
+
+            char* memory = region + offset;
+#if defined(_WIN32)
+            if (!VirtualAlloc(memory, slab_size, MEM_COMMIT, PAGE_READWRITE))
+            {
+                return nullptr;
+            }
+#endif
+            return memory;
         }
 
-        // try to get from thread-local cache
-        void* cache_try_get(size_t size)
+        // a slab with no live blocks goes back to the pool, any class can reuse it
+        void slab_release(slab* s)
         {
-            if (size > cache_max_size)
+            lock_guard<spin_lock> lock(slab_lock);
+            s->next   = slab_pool;
+            slab_pool = s;
+        }
+
+        // adopt an abandoned slab of the class, otherwise format a pooled or fresh one
+        slab* slab_acquire(thread_heap* heap, uint32_t size_class)
+        {
+            void* memory = nullptr;
+            {
+                lock_guard<spin_lock> lock(slab_lock);
+                if (slab* s = slab_abandoned[size_class])
+                {
+                    slab_abandoned[size_class] = s->next;
+                    s->next = nullptr;
+                    s->owner.store(heap->id, memory_order_relaxed);
+                    return s;
+                }
+
+                if (slab_pool)
+                {
+                    memory    = slab_pool;
+                    slab_pool = slab_pool->next;
+                }
+            }
+
+            if (!memory)
+            {
+                memory = slab_carve();
+                if (!memory)
+                {
+                    return nullptr;
+                }
+            }
+
+            slab* s        = new (memory) slab();
+            s->size_class  = size_class;
+            s->block_size  = get_size_for_class(size_class);
+            s->block_count = static_cast<uint32_t>((slab_size - slab_header_size) / s->block_size);
+            s->owner.store(heap->id, memory_order_relaxed);
+            return s;
+        }
+
+        // move blocks other threads freed onto the owner's free list
+        void slab_collect(slab* s)
+        {
+            free_block* block = s->remote_free.exchange(nullptr, memory_order_acquire);
+            while (block)
+            {
+                free_block* next = block->next;
+                block->next      = s->local_free;
+                s->local_free    = block;
+                s->used--;
+                block = next;
+            }
+        }
+
+        // owner only, returns nullptr when the slab is exhausted
+        free_block* slab_pop(slab* s)
+        {
+            if (!s->local_free && s->remote_free.load(memory_order_relaxed))
+            {
+                slab_collect(s);
+            }
+
+            free_block* block = s->local_free;
+            if (block)
+            {
+                s->local_free = block->next;
+            }
+            else if (s->bump < s->block_count)
+            {
+                block = reinterpret_cast<free_block*>(reinterpret_cast<char*>(s) + slab_header_size + static_cast<size_t>(s->bump) * s->block_size);
+                s->bump++;
+            }
+            else
             {
                 return nullptr;
             }
 
-            size_t size_class = get_size_class(size);
-            if (tl_cache.count[size_class] > 0)
+            s->used++;
+            return block;
+        }
+
+        // hand a chain of freed blocks back to the slab's owner
+        void slab_push_remote(slab* s, free_block* head, free_block* tail)
+        {
+            free_block* expected = s->remote_free.load(memory_order_relaxed);
+            do
+            {
+                tail->next = expected;
+            } while (!s->remote_free.compare_exchange_weak(expected, head, memory_order_seq_cst, memory_order_relaxed));
+
+            // the owner only revisits full slabs when told to, pairs with the re-check in slab_allocate()
+            if (s->in_full.load(memory_order_seq_cst))
+            {
+                const uint32_t owner = s->owner.load(memory_order_relaxed);
+                if (owner != 0)
+                {
+                    heaps[owner - 1].reclaimable[s->size_class].store(true, memory_order_relaxed);
+                }
+            }
+        }
+
+        // return batched remote frees, sorted so blocks of the same slab go back as one chain
+        void heap_flush_remote(thread_heap* heap)
+        {
+            free_block** pending = heap->remote_pending;
+            const uint32_t count = heap->remote_pending_count;
+            sort(pending, pending + count);
+
+            uint32_t i = 0;
+            while (i < count)
+            {
+                slab* s          = slab_from_block(pending[i]);
+                free_block* head = pending[i];
+                free_block* tail = head;
+                for (i++; i < count && slab_from_block(pending[i]) == s; i++)
+                {
+                    tail->next = pending[i];
+                    tail       = pending[i];
+                }
+                slab_push_remote(s, head, tail);
+            }
+
+            heap->remote_pending_count = 0;
+        }
+
+        // give a full slab with freed blocks back to the active list, or to the pool once it's empty
+        void heap_reclaim(thread_heap* heap, uint32_t size_class)
+        {
+            slab** link = &heap->full[size_class];
+            while (slab* s = *link)
+            {
+                slab_collect(s);
+                if (!s->local_free)
+                {
+                    link = &s->next;
+                    continue;
+                }
+
+                *link = s->next;
+                s->in_full.store(false, memory_order_relaxed);
+                if (s->used == 0 && heap->active[size_class])
+                {
+                    slab_release(s);
+                }
+                else
+                {
+                    s->next = heap->active[size_class];
+                    heap->active[size_class] = s;
+                }
+            }
+        }
+
+        // called when the owning thread exits, slabs with live blocks wait for another thread to adopt them
+        void heap_abandon(thread_heap* heap)
+        {
+            heap_flush_remote(heap);
+
+            for (uint32_t size_class = 0; size_class < size_class_count; size_class++)
             {
-                tl_cache.count[size_class]--;
-                return tl_cache.entries[size_class][tl_cache.count[size_class]].ptr;
+                for (slab* list : { heap->active[size_class], heap->full[size_class] })
+                {
+                    while (list)
+                    {
+                        slab* s = list;
+                        list    = s->next;
+
+                        slab_collect(s);
+                        if (s->used == 0)
+                        {
+                            slab_release(s);
+                            continue;
+                        }
+
+                        s->owner.store(0, memory_order_relaxed);
+                        s->in_full.store(false, memory_order_relaxed);
+
+                        lock_guard<spin_lock> lock(slab_lock);
+                        s->next = slab_abandoned[size_class];
+                        slab_abandoned[size_class] = s;
+                    }
+                }
+
+                heap->active[size_class] = nullptr;
+                heap->full[size_class]   = nullptr;
+                heap->reclaimable[size_class].store(false, memory_order_relaxed);
             }
+
+            heap->in_use.store(false, memory_order_release);
+        }
+
+        // the calling thread's heap, claimed on first use
+        thread_heap* heap_get()
+        {
+            if (tl_heap || tl_heap_dead)
+            {
+                return tl_heap;
+            }
+
+            for (uint32_t i = 0; i < max_heaps; i++)
+            {
+                bool expected = false;
+                if (heaps[i].in_use.compare_exchange_strong(expected, true, memory_order_acquire, memory_order_relaxed))
+                {
+                    heaps[i].id        = i + 1;
+                    tl_heap            = &heaps[i];
+                    tl_heap_guard.heap = tl_heap; // registers the exit hook
+                    return tl_heap;
+                }
+            }
+
+            tl_heap_dead = true;
             return nullptr;
         }
 
-        // try to put into thread-local cache, returns true if cached
-        bool cache_try_put(void* ptr, size_t size)
+        void heap_add_bytes(thread_heap* heap, int64_t bytes, uint64_t allocations)
         {
-            if (size > cache_max_size)
+            // only the owning thread writes, so a plain load and store is enough
+            heap->bytes.store(heap->bytes.load(memory_order_relaxed) + bytes, memory_order_relaxed);
+            heap->allocations.store(heap->allocations.load(memory_order_relaxed) + allocations, memory_order_relaxed);
+
+            // frees pass no allocations and only move the net bytes
+            if (allocations != 0)
             {
-                return false;
+                heap->bytes_total.store(heap->bytes_total.load(memory_order_relaxed) + bytes, memory_order_relaxed);
             }
+        }
+
+        void* slab_allocate(thread_heap* heap, size_t size)
+        {
+            const uint32_t size_class = get_size_class(size);
 
-            size_t size_class = get_size_class(size);
-            if (tl_cache.count[size_class] < cache_max_entries)
+            free_block* block = nullptr;
+            while (slab* s = heap->active[size_class])
             {
-                tl_cache.entries[size_class][tl_cache.count[size_class]].ptr  = ptr;
-                tl_cache.entries[size_class][tl_cache.count[size_class]].size = size;
-                tl_cache.count[size_class]++;
-                return true;
+                block = slab_pop(s);
+                if (block)
+                {
+                    break;
+                }
+
+                // exhausted, park it until blocks come back
+                heap->active[size_class] = s->next;
+                s->next                  = heap->full[size_class];
+                heap->full[size_class]   = s;
+                s->in_full.store(true, memory_order_seq_cst);
+                if (s->remote_free.load(memory_order_seq_cst))
+                {
+                    heap->reclaimable[size_class].store(true, memory_order_relaxed);
+                }
             }
-            return false;
+
+            if (!block)
+            {
+                if (heap->reclaimable[size_class].exchange(false, memory_order_relaxed))
+                {
+                    heap_reclaim(heap, size_class);
+                }
+
+                if (!heap->active[size_class])
+                {
+                    // a good moment to hand back blocks owned by others, before taking more address space
+                    heap_flush_remote(heap);
+
+                    slab* s = slab_acquire(heap, size_class);
+                    if (!s)
+                    {
+                        return nullptr;
+                    }
+                    heap->active[size_class] = s;
+                }
+
+                block = slab_pop(heap->active[size_class]);
+                if (!block)
+                {
+                    return nullptr;
+                }
+            }
+
+            slab* s                   = slab_from_block(block);
+            const uint32_t block_size = s->block_size;
+            const uint32_t index      = static_cast<uint32_t>((reinterpret_cast<char*>(block) - reinterpret_cast<char*>(s) - slab_header_size) / block_size);
+            s->live[index / 64].fetch_or(1ull << (index % 64), memory_order_relaxed);
+            heap_add_bytes(heap, block_size, 1);
+
+#if defined(_DEBUG) || defined(DEBUG)
+            // poison allocated memory in debug builds to catch uninitialized reads
+            memset(block, poison_allocated, size);
+#endif
+
+            return block;
+        }
+
+        void slab_free(void* ptr)
+        {
+            slab* s = slab_from_block(ptr);
+            const uintptr_t offset = reinterpret_cast<uintptr_t>(ptr) - reinterpret_cast<uintptr_t>(s);
+
+            // check for corruption, the pointer has to be the start of a block in a live slab
+            if (s->magic != slab_magic || offset < slab_header_size || (offset - slab_header_size) % s->block_size != 0)
+            {
+                SP_LOG_ERROR("Memory corruption detected at address %p (slab magic: 0x%08X)", ptr, s->magic);
+                SP_ASSERT(false && "memory corruption detected");
+                return;
+            }
+
+            // check for double-free, clearing the live bit and finding it already clear means the block was free
+            const uint32_t index = static_cast<uint32_t>((offset - slab_header_size) / s->block_size);
+            const uint64_t bit   = 1ull << (index % 64);
+            if ((s->live[index / 64].fetch_and(~bit, memory_order_relaxed) & bit) == 0)
+            {
+                SP_LOG_ERROR("Double-free detected at address %p", ptr);
+                SP_ASSERT(false && "double-free detected");
+                return;
+            }
+
+#if defined(_DEBUG) || defined(DEBUG)
+            // poison freed memory in debug builds to catch use-after-free
+            memset(ptr, poison_freed, s->block_size);
+#endif
+            free_block* block = static_cast<free_block*>(ptr);
+
+            thread_heap* heap = tl_heap;
+            if (!heap)
+            {
+                // exited or heapless thread, return the block directly
+                slab_bytes_heapless.fetch_sub(s->block_size, memory_order_relaxed);
+                slab_push_remote(s, block, block);
+                return;
+            }
+
+            heap_add_bytes(heap, -static_cast<int64_t>(s->block_size), 0);
+
+            if (s->owner.load(memory_order_relaxed) == heap->id)
+            {
+                block->next   = s->local_free;
+                s->local_free = block;
+                s->used--;
+                if (s->in_full.load(memory_order_relaxed))
+                {
+                    heap->reclaimable[s->size_class].store(true, memory_order_relaxed);
+                }
+                return;
+            }
+
+            heap->remote_pending[heap->remote_pending_count++] = block;
+            if (heap->remote_pending_count == remote_batch_size)
+            {
+                heap_flush_remote(heap);
+            }
+        }
+
+        // slab bytes are counted per thread, fold them into the global counters
+        int64_t get_slab_bytes()
+        {
+            int64_t bytes = slab_bytes_heapless.load(memory_order_relaxed);
+            for (const thread_heap& heap : heaps)
+            {
+                bytes += heap.bytes.load(memory_order_relaxed);
+            }
+            return bytes;
+        }
+
+        uint64_t get_allocation_count()
+        {
+            uint64_t count = allocations_header.load(memory_order_relaxed);
+            for (const thread_heap& heap : heaps)
+            {
+                count += heap.allocations.load(memory_order_relaxed);
+            }
+            return count;
+        }
+
+        uint64_t get_allocation_bytes()
+        {
+            uint64_t bytes = bytes_header_total.load(memory_order_relaxed);
+            for (const thread_heap& heap : heaps)
+            {
+                bytes += heap.bytes_total.load(memory_order_relaxed);
+            }
+            return bytes;
+        }
+
+        uint32_t capture_stack(void** frames, uint32_t capacity)
+        {
+#if defined(_WIN32)
+            return static_cast<uint32_t>(RtlCaptureStackBackTrace(call_site_skip_frames, capacity, frames, nullptr));
+#elif defined(__linux__)
+            void* captured[AllocationCallSite::frame_count_max + call_site_skip_frames];
+            const int count = backtrace(captured, static_cast<int>(min(capacity, AllocationCallSite::frame_count_max) + call_site_skip_frames));
+            if (count <= static_cast<int>(call_site_skip_frames))
+            {
+                return 0;
+            }
+
+            const uint32_t frame_count = static_cast<uint32_t>(count) - call_site_skip_frames;
+            memcpy(frames, captured + call_site_skip_frames, frame_count * sizeof(void*));
+            return frame_count;
+#else
+            return 0;
+#endif
+        }
+
+        void call_site_record(void** frames, uint32_t frame_count, size_t size)
+        {
+            // fnv-1a over the return addresses
+            uint64_t hash = 14695981039346656037ull;
+            for (uint32_t i = 0; i < frame_count; i++)
+            {
+                hash = (hash ^ reinterpret_cast<uintptr_t>(frames[i])) * 1099511628211ull;
+            }
+
+            lock_guard<spin_lock> lock(call_site_lock);
+            if (!call_sites)
+            {
+                call_sites = static_cast<AllocationCallSite*>(calloc(call_site_capacity, sizeof(AllocationCallSite)));
+                if (!call_sites)
+                {
+                    return;
+                }
+            }
+
+            for (uint32_t probe = 0; probe < call_site_capacity; probe++)
+            {
+                AllocationCallSite& site = call_sites[(hash + probe) & (call_site_capacity - 1)];
+                if (site.samples == 0)
+                {
+                    if (call_site_count >= call_site_capacity / 4 * 3)
+                    {
+                        return;
+                    }
+
+                    memcpy(site.frames, frames, frame_count * sizeof(void*));
+                    site.frame_count = frame_count;
+                    call_site_count++;
+                }
+                else if (site.frame_count != frame_count || memcmp(site.frames, frames, frame_count * sizeof(void*)) != 0)
+                {
+                    continue;
+                }
+
+                site.samples++;
+                site.bytes += size;
+                return;
+            }
+        }
+
+        // every nth allocation of a thread is sampled, so the cost per allocation stays a decrement
+        void tracking_sample(size_t size)
+        {
+            if (tl_capturing)
+            {
+                return;
+            }
+
+            if (tl_sample_countdown > 1)
+            {
+                tl_sample_countdown--;
+                return;
+            }
+            tl_sample_countdown = tracking_sample_rate.load(memory_order_relaxed);
+
+            tl_capturing = true;
+            void* frames[AllocationCallSite::frame_count_max];
+            const uint32_t frame_count = capture_stack(frames, AllocationCallSite::frame_count_max);
+            call_site_record(frames, frame_count, size);
+            tl_capturing = false;
+        }
+
+        // only the first offending allocation of a scope is captured, the rest are counted
+        void free_scope_violation(size_t size)
+        {
+            if (tl_violation_scope || tl_capturing)
+            {
+                return;
+            }
+
+            tl_capturing             = true;
+            tl_violation_scope       = tl_free_scope;
+            tl_violation_size        = size;
+            tl_violation_frame_count = capture_stack(tl_violation_frames, AllocationCallSite::frame_count_max);
+            tl_capturing             = false;
+        }
+
+        size_t get_bytes_allocated()
+        {
+            return static_cast<size_t>(static_cast<int64_t>(bytes_allocated.load(memory_order_relaxed)) + get_slab_bytes());
+        }
+
+        void trace_record(const void* ptr, size_t size, size_t alignment, bool is_free)
+        {
+            lock_guard<spin_lock> lock(trace_lock);
+            if (!trace_enabled.load(memory_order_relaxed))
+            {
+                return;
+            }
+
+            if (trace_thread < 0)
+            {
+                trace_thread = trace_thread_count++;
+            }
+
+            // the buffer comes from the c runtime so recording never re-enters the allocator
+            if (trace_count == trace_capacity)
+            {
+                const size_t capacity = max<size_t>(trace_capacity * 2, 64 * 1024);
+                void* events          = realloc(trace_events, capacity * sizeof(AllocationTraceEvent));
+                if (!events)
+                {
+                    return;
+                }
+                trace_events   = static_cast<AllocationTraceEvent*>(events);
+                trace_capacity = capacity;
+            }
+
+            AllocationTraceEvent& event = trace_events[trace_count++];
+            event.address   = reinterpret_cast<uintptr_t>(ptr);
+            event.size      = is_free ? 0 : static_cast<uint32_t>(min<size_t>(size, UINT32_MAX));
+            event.alignment = is_free ? 0 : static_cast<uint16_t>(min<size_t>(alignment, UINT16_MAX));
+            event.is_free   = is_free ? 1 : 0;
+            event.thread    = static_cast<uint8_t>(trace_thread);
         }
 
         // atomically update peak if current value is higher
@@ -153,12 +939,6 @@ namespace spartan
             }
         }
 
-        // round up to next multiple of alignment
-        size_t align_up(size_t value, size_t alignment)
-        {
-            return (value + alignment - 1) & ~(alignment - 1);
-        }
-
         // perform the actual allocation (bypassing cache)
         void* allocate_internal(size_t size, size_t alignment, MemoryTag tag)
         {
@@ -202,6 +982,8 @@ namespace spartan
             size_t current = bytes_allocated.fetch_add(size, memory_order_relaxed) + size;
             update_peak(current);
             allocation_count.fetch_add(1, memory_order_relaxed);
+            allocations_header.fetch_add(1, memory_order_relaxed);
+            bytes_header_total.fetch_add(size, memory_order_relaxed);
             bytes_by_tag[static_cast<size_t>(tag)].fetch_add(size, memory_order_relaxed);
 
             return user_ptr;
@@ -261,35 +1043,39 @@ namespace spartan
 
     void* Allocator::Allocate(size_t size, size_t alignment, MemoryTag tag)
     {
-        // try thread-local cache first for small allocations with default alignment
-        if (alignment <= alignof(allocation_header) && size <= cache_max_size)
+        void* ptr = nullptr;
+
+        // small untagged requests come from the calling thread's slabs, tagged ones need the header to carry the tag
+        if (size <= slab_max_size && alignment <= slab_alignment && tag == MemoryTag::Untagged)
         {
-            size_t size_class   = get_size_class(size);
-            size_t padded_size  = get_size_for_class(size_class);
-            void*  cached       = cache_try_get(padded_size);
-            if (cached)
+            if (thread_heap* heap = heap_get())
             {
-                // update header with new tag (size stays the same since it's from same size class)
-                const size_t header_size  = sizeof(allocation_header);
-                allocation_header* header = reinterpret_cast<allocation_header*>(static_cast<char*>(cached) - header_size);
-                
-                // re-activate the allocation
-                header->magic = allocation_magic_active;
-                header->tag   = tag;
+                ptr = slab_allocate(heap, size);
+            }
+        }
 
-                // update tag counter (size is already counted from original allocation)
-                bytes_by_tag[static_cast<size_t>(tag)].fetch_add(header->size, memory_order_relaxed);
+        if (!ptr)
+        {
+            ptr = allocate_internal(size, alignment, tag);
+        }
 
-#if defined(_DEBUG) || defined(DEBUG)
-                memset(cached, poison_allocated, header->size);
-#endif
-                return cached;
-            }
-            // cache miss - allocate with padded size for future caching
-            return allocate_internal(padded_size, alignment, tag);
+        if (trace_enabled.load(memory_order_relaxed) && ptr)
+        {
+            trace_record(ptr, size, alignment, false);
+        }
+
+        tl_allocations++;
+        if (tl_free_scope)
+        {
+            free_scope_violation(size);
+        }
+
+        if (tracking_enabled.load(memory_order_relaxed))
+        {
+            tracking_sample(size);
         }
 
-        return allocate_internal(size, alignment, tag);
+        return ptr;
     }
 
     void Allocator::Free(void* ptr)
@@ -299,53 +1085,116 @@ namespace spartan
             return;
         }
 
-        const size_t header_size = sizeof(allocation_header);
-        allocation_header* header = reinterpret_cast<allocation_header*>(static_cast<char*>(ptr) - header_size);
-
-        // validate before accessing other fields
-        if (header->magic == allocation_magic_freed)
+        // recorded before the address can be handed out again
+        if (trace_enabled.load(memory_order_relaxed))
         {
-            SP_LOG_ERROR("Double-free detected at address %p", ptr);
-            SP_ASSERT(false && "double-free detected");
-            return;
+            trace_record(ptr, 0, 0, true);
         }
-        if (header->magic != allocation_magic_active)
+
+        if (is_slab_memory(ptr))
         {
-            SP_LOG_ERROR("Memory corruption detected at address %p (magic: 0x%08X)", ptr, header->magic);
-            SP_ASSERT(false && "memory corruption detected");
+            slab_free(ptr);
             return;
         }
 
-        size_t size = header->size;
-
-        // update tag counter before potential caching
-        bytes_by_tag[static_cast<size_t>(header->tag)].fetch_sub(size, memory_order_relaxed);
+        free_internal(ptr);
+    }
 
-        // try to cache small allocations
-        if (size <= cache_max_size)
+    void* Allocator::AllocateFrame(size_t size, size_t alignment, MemoryTag tag)
+    {
+        // the half used two frames ago is no longer referenced, reclaim it on first use this frame
+        const uint64_t frame       = frame_index.load(memory_order_relaxed);
+        frame_arena_buffer& buffer = tl_frame_arena.buffers[frame & 1];
+        if (buffer.frame != frame)
         {
-            // mark as freed but keep in cache
-            header->magic = allocation_magic_freed;
+            buffer.reset();
+            buffer.frame = frame;
+        }
 
-#if defined(_DEBUG) || defined(DEBUG)
-            memset(ptr, poison_freed, size);
-#endif
+        const size_t header_size = align_up(sizeof(frame_arena_block), alignof(max_align_t));
+        size = max<size_t>(size, 1);
 
-            if (cache_try_put(ptr, size))
+        // bump within the head block
+        if (buffer.blocks)
+        {
+            char* data           = reinterpret_cast<char*>(buffer.blocks) + header_size;
+            const uintptr_t base = reinterpret_cast<uintptr_t>(data);
+            const size_t offset  = align_up(base + buffer.offset, alignment) - base;
+            if (offset + size <= buffer.blocks->capacity)
             {
-                // successfully cached - don't actually free
-                // note: counters stay as-is since memory is still "allocated" from system perspective
-                return;
+                buffer.offset = offset + size;
+                frame_bytes_by_tag[static_cast<size_t>(tag)].fetch_add(size, memory_order_relaxed);
+                return data + offset;
             }
-            // cache full - restore magic and fall through to actual free
-            header->magic = allocation_magic_active;
         }
 
-        free_internal(ptr);
+        // start a new block, reuse a spare one when the request fits
+        frame_arena_block* block = nullptr;
+        const size_t capacity    = size + alignment;
+        if (capacity <= frame_arena_block_size && buffer.spare)
+        {
+            block        = buffer.spare;
+            buffer.spare = block->next;
+        }
+        else
+        {
+            const size_t block_capacity = max(capacity, frame_arena_block_size);
+            void* raw = Allocate(header_size + block_capacity, alignof(max_align_t), MemoryTag::Untagged);
+            if (!raw)
+            {
+                return nullptr;
+            }
+            block           = new (raw) frame_arena_block();
+            block->capacity = block_capacity;
+        }
+
+        block->next   = buffer.blocks;
+        buffer.blocks = block;
+
+        char* data           = reinterpret_cast<char*>(block) + header_size;
+        const uintptr_t base = reinterpret_cast<uintptr_t>(data);
+        const size_t offset  = align_up(base, alignment) - base;
+        buffer.offset        = offset + size;
+        frame_bytes_by_tag[static_cast<size_t>(tag)].fetch_add(size, memory_order_relaxed);
+
+        return data + offset;
     }
 
     void Allocator::Tick()
     {
+        // close the frame arena's frame, fold its per-tag usage into the high-water marks
+        for (size_t i = 0; i < static_cast<size_t>(MemoryTag::Count); i++)
+        {
+            const size_t bytes = frame_bytes_by_tag[i].exchange(0, memory_order_relaxed);
+            frame_bytes_last_by_tag[i].store(bytes, memory_order_relaxed);
+            if (bytes > frame_bytes_peak_by_tag[i].load(memory_order_relaxed))
+            {
+                frame_bytes_peak_by_tag[i].store(bytes, memory_order_relaxed);
+            }
+        }
+        frame_index.fetch_add(1, memory_order_relaxed);
+        update_peak(get_bytes_allocated());
+
+        // close the frame's allocation counts
+        {
+            const uint64_t allocations  = get_allocation_count();
+            const uint64_t bytes        = get_allocation_bytes();
+            FrameAllocationStats& stats = frame_history[frame_history_count % frame_history_size];
+            stats.count                 = static_cast<uint32_t>(min<uint64_t>(allocations - frame_allocations_last, UINT32_MAX));
+            stats.bytes                 = bytes - frame_bytes_total_last;
+            frame_allocations_last      = allocations;
+            frame_bytes_total_last      = bytes;
+            frame_history_count++;
+        }
+
+        // arm zero allocation mode once the warm-up frames have passed
+        if (zero_mode_enabled.load(memory_order_relaxed) && !zero_mode_armed.load(memory_order_relaxed) &&
+            frame_index.load(memory_order_relaxed) >= zero_mode_arm_frame.load(memory_order_relaxed))
+        {
+            zero_mode_armed.store(true, memory_order_relaxed);
+            SP_LOG_INFO("Zero allocation mode armed, allocation free scopes will now assert");
+        }
+
         static bool has_warned                    = false; // only warn once per threshold crossing
         constexpr float warning_threshold_percent = 90.0f; // 90%
     
@@ -374,7 +1223,9 @@ namespace spartan
 
     float Allocator::GetMemoryAllocatedMb()
     {
-         return static_cast<float>(bytes_allocated) / (1024.0f * 1024.0f);
+        const size_t current = get_bytes_allocated();
+        update_peak(current);
+        return static_cast<float>(current) / (1024.0f * 1024.0f);
     }
 
     float Allocator::GetMemoryProcessUsedMb()
@@ -442,8 +1293,37 @@ namespace spartan
 #endif
     }
 
+    float Allocator::GetMemoryProcessPeakMb()
+    {
+    #if defined(_WIN32)
+        PROCESS_MEMORY_COUNTERS pmc;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        {
+            return static_cast<float>(pmc.PeakWorkingSetSize) / (1024.0f * 1024.0f);
+        }
+        return 0.0f;
+    #elif defined(__linux__)
+        // ru_maxrss is in kilobytes on linux
+        rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0)
+        {
+            return static_cast<float>(usage.ru_maxrss) / 1024.0f;
+        }
+        return 0.0f;
+    #else
+        return 0.0f; // unsupported platform
+    #endif
+    }
+
+    uint64_t Allocator::GetAllocationCount()
+    {
+        return get_allocation_count();
+    }
+
     float Allocator::GetMemoryAllocatedPeakMb()
     {
+        // slab allocations only fold into the peak when sampled
+        update_peak(get_bytes_allocated());
         return static_cast<float>(bytes_allocated_peak) / (1024.0f * 1024.0f);
     }
 
@@ -454,7 +1334,32 @@ namespace spartan
         {
             return 0.0f;
         }
-        return static_cast<float>(bytes_by_tag[index].load(memory_order_relaxed)) / (1024.0f * 1024.0f);
+        int64_t bytes = static_cast<int64_t>(bytes_by_tag[index].load(memory_order_relaxed));
+        if (tag == MemoryTag::Untagged)
+        {
+            bytes += get_slab_bytes();
+        }
+        return static_cast<float>(bytes) / (1024.0f * 1024.0f);
+    }
+
+    float Allocator::GetFrameMemoryByTagMb(MemoryTag tag)
+    {
+        size_t index = static_cast<size_t>(tag);
+        if (index >= static_cast<size_t>(MemoryTag::Count))
+        {
+            return 0.0f;
+        }
+        return static_cast<float>(frame_bytes_last_by_tag[index].load(memory_order_relaxed)) / (1024.0f * 1024.0f);
+    }
+
+    float Allocator::GetFrameMemoryPeakByTagMb(MemoryTag tag)
+    {
+        size_t index = static_cast<size_t>(tag);
+        if (index >= static_cast<size_t>(MemoryTag::Count))
+        {
+            return 0.0f;
+        }
+        return static_cast<float>(frame_bytes_peak_by_tag[index].load(memory_order_relaxed)) / (1024.0f * 1024.0f);
     }
 
     const char* Allocator::GetTagName(MemoryTag tag)
@@ -478,4 +1383,250 @@ namespace spartan
         }
         return tag_names[index];
     }
+
+    void Allocator::TraceBegin()
+    {
+        lock_guard<spin_lock> lock(trace_lock);
+        trace_count = 0;
+        trace_enabled.store(true, memory_order_relaxed);
+    }
+
+    bool Allocator::TraceEnd(const char* file_path)
+    {
+        size_t count = 0;
+        AllocationTraceEvent* events = nullptr;
+        {
+            lock_guard<spin_lock> lock(trace_lock);
+            if (!trace_enabled.load(memory_order_relaxed))
+            {
+                return false;
+            }
+            trace_enabled.store(false, memory_order_relaxed);
+
+            count          = trace_count;
+            events         = trace_events;
+            trace_events   = nullptr;
+            trace_count    = 0;
+            trace_capacity = 0;
+        }
+
+        bool written = false;
+        if (FILE* file = fopen(file_path, "wb"))
+        {
+            const uint64_t event_count = count;
+            written = fwrite(trace_file_magic, sizeof(trace_file_magic), 1, file) == 1 &&
+                      fwrite(&trace_file_version, sizeof(trace_file_version), 1, file) == 1 &&
+                      fwrite(&event_count, sizeof(event_count), 1, file) == 1 &&
+                      (count == 0 || fwrite(events, sizeof(AllocationTraceEvent), count, file) == count);
+            fclose(file);
+        }
+        free(events);
+
+        if (!written)
+        {
+            SP_LOG_ERROR("Failed to write allocation trace to \"%s\"", file_path);
+            return false;
+        }
+
+        SP_LOG_INFO("Wrote %llu allocation events to \"%s\"", static_cast<unsigned long long>(count), file_path);
+        return true;
+    }
+
+    bool Allocator::TraceLoad(const char* file_path, vector<AllocationTraceEvent>& events)
+    {
+        FILE* file = fopen(file_path, "rb");
+        if (!file)
+        {
+            return false;
+        }
+
+        char magic[sizeof(trace_file_magic)] = {};
+        uint32_t version     = 0;
+        uint64_t event_count = 0;
+        bool loaded = fread(magic, sizeof(magic), 1, file) == 1 &&
+                      memcmp(magic, trace_file_magic, sizeof(magic)) == 0 &&
+                      fread(&version, sizeof(version), 1, file) == 1 &&
+                      version == trace_file_version &&
+                      fread(&event_count, sizeof(event_count), 1, file) == 1;
+
+        if (loaded)
+        {
+            events.resize(static_cast<size_t>(event_count));
+            loaded = event_count == 0 || fread(events.data(), sizeof(AllocationTraceEvent), events.size(), file) == events.size();
+        }
+        fclose(file);
+
+        if (!loaded)
+        {
+            SP_LOG_ERROR("\"%s\" is not a valid allocation trace", file_path);
+            events.clear();
+        }
+
+        return loaded;
+    }
+
+    FrameAllocationStats Allocator::GetFrameAllocations()
+    {
+        if (frame_history_count == 0)
+        {
+            return {};
+        }
+
+        return frame_history[(frame_history_count - 1) % frame_history_size];
+    }
+
+    uint32_t Allocator::GetFrameAllocationHistory(FrameAllocationStats* history, uint32_t capacity)
+    {
+        const uint32_t count = static_cast<uint32_t>(min<uint64_t>({ frame_history_count, frame_history_size, capacity }));
+        const uint64_t first = frame_history_count - count;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            history[i] = frame_history[(first + i) % frame_history_size];
+        }
+
+        return count;
+    }
+
+    void Allocator::SetTrackingEnabled(bool enabled, uint32_t sample_rate)
+    {
+        tracking_sample_rate.store(max(sample_rate, 1u), memory_order_relaxed);
+        tracking_enabled.store(enabled, memory_order_relaxed);
+    }
+
+    bool Allocator::IsTrackingEnabled()
+    {
+        return tracking_enabled.load(memory_order_relaxed);
+    }
+
+    uint32_t Allocator::GetTrackingSampleRate()
+    {
+        return tracking_sample_rate.load(memory_order_relaxed);
+    }
+
+    void Allocator::GetCallSites(vector<AllocationCallSite>& sites)
+    {
+        sites.clear();
+
+        // the vector allocates, keep those allocations out of the table while it's locked
+        tl_capturing = true;
+        {
+            lock_guard<spin_lock> lock(call_site_lock);
+            sites.reserve(call_site_count);
+            for (uint32_t i = 0; call_sites && i < call_site_capacity; i++)
+            {
+                if (call_sites[i].samples != 0)
+                {
+                    sites.push_back(call_sites[i]);
+                }
+            }
+        }
+        tl_capturing = false;
+
+        sort(sites.begin(), sites.end(), [](const AllocationCallSite& a, const AllocationCallSite& b)
+        {
+            return a.bytes > b.bytes;
+        });
+    }
+
+    string Allocator::GetCallSiteSymbol(const void* address)
+    {
+#if defined(_WIN32)
+        // dbghelp is single threaded, symbols are only resolved for display
+        static mutex symbol_mutex;
+        lock_guard<mutex> lock(symbol_mutex);
+
+        HANDLE process          = GetCurrentProcess();
+        static bool initialized = SymInitialize(process, nullptr, TRUE) == TRUE;
+        if (initialized)
+        {
+            char symbol_buffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME * sizeof(TCHAR)];
+            PSYMBOL_INFO symbol  = reinterpret_cast<PSYMBOL_INFO>(symbol_buffer);
+            symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+            symbol->MaxNameLen   = MAX_SYM_NAME;
+
+            DWORD64 displacement = 0;
+            if (SymFromAddr(process, reinterpret_cast<DWORD64>(address), &displacement, symbol))
+            {
+                string name = symbol->Name;
+
+                IMAGEHLP_LINE64 line;
+                line.SizeOfStruct       = sizeof(IMAGEHLP_LINE64);
+                DWORD displacement_line = 0;
+                if (SymGetLineFromAddr64(process, reinterpret_cast<DWORD64>(address), &displacement_line, &line))
+                {
+                    name += " [" + string(line.FileName) + ":" + to_string(line.LineNumber) + "]";
+                }
+
+                return name;
+            }
+        }
+#elif defined(__linux__)
+        void* frames[1] = { const_cast<void*>(address) };
+        if (char** symbols = backtrace_symbols(frames, 1))
+        {
+            string name = symbols[0];
+            free(symbols);
+            return name;
+        }
+#endif
+
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%p", address);
+        return buffer;
+    }
+
+    void Allocator::SetZeroAllocationMode(bool enabled, uint32_t warm_up_frames)
+    {
+        zero_mode_arm_frame.store(frame_index.load(memory_order_relaxed) + warm_up_frames, memory_order_relaxed);
+        zero_mode_armed.store(false, memory_order_relaxed);
+        zero_mode_enabled.store(enabled, memory_order_relaxed);
+    }
+
+    bool Allocator::IsZeroAllocationModeArmed()
+    {
+        return zero_mode_armed.load(memory_order_relaxed);
+    }
+
+    AllocationFreeScope::AllocationFreeScope(const char* name)
+    {
+        m_armed = zero_mode_armed.load(memory_order_relaxed);
+        if (!m_armed)
+        {
+            return;
+        }
+
+        m_name        = name;
+        m_parent      = tl_free_scope;
+        m_allocations = tl_allocations;
+        tl_free_scope = name;
+    }
+
+    AllocationFreeScope::~AllocationFreeScope()
+    {
+        if (!m_armed)
+        {
+            return;
+        }
+
+        // nested scopes report through the outermost one
+        tl_free_scope = m_parent;
+        if (m_parent || !tl_violation_scope)
+        {
+            return;
+        }
+
+        const uint64_t allocations = tl_allocations - m_allocations;
+        const char* scope          = tl_violation_scope;
+        tl_violation_scope         = nullptr;
+
+        string callstack;
+        for (uint32_t i = 0; i < tl_violation_frame_count; i++)
+        {
+            callstack += to_string(i) + ": " + Allocator::GetCallSiteSymbol(tl_violation_frames[i]) + "\n";
+        }
+
+        SP_LOG_ERROR("%s allocated %llu times in steady state, the first allocation was %zu bytes in %s:\n%s",
+            m_name, static_cast<unsigned long long>(allocations), tl_violation_size, scope, callstack.c_str());
+        SP_ASSERT_MSG(allocations == 0, "allocation in an allocation free scope");
+    }
 }
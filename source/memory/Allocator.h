@@ -24,6 +24,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =====
 #include <cstddef>
 #include <cstdint>
+#include <new>
+#include <vector>
+#include <string>
 //================
 
 namespace spartan
@@ -42,6 +45,34 @@ namespace spartan
         Count
     };
 
+    // one record of an allocation trace, see Allocator::TraceBegin()
+    struct AllocationTraceEvent
+    {
+        uint64_t address;   // identifies the allocation, a free refers back to it
+        uint32_t size;      // zero for frees
+        uint16_t alignment; // zero for frees
+        uint8_t  is_free;
+        uint8_t  thread;    // small per-thread index, assigned in order of first traced call
+    };
+
+    // a call stack that sampled allocations were attributed to, see Allocator::SetTrackingEnabled()
+    struct AllocationCallSite
+    {
+        static constexpr uint32_t frame_count_max = 24;
+
+        void* frames[frame_count_max] = {};
+        uint32_t frame_count          = 0;
+        uint64_t samples              = 0; // multiply by the sample rate for an estimate of the real count
+        uint64_t bytes                = 0; // sampled bytes, same scale as samples
+    };
+
+    // what the engine allocated during one frame
+    struct FrameAllocationStats
+    {
+        uint32_t count = 0;
+        uint64_t bytes = 0;
+    };
+
     class Allocator
     {
     public:
@@ -51,6 +82,10 @@ namespace spartan
         // free previously allocated memory
         static void Free(void* ptr);
 
+        // bump-allocate scratch memory from the calling thread's frame arena, there is no free
+        // the arena is double-buffered so memory stays valid until the end of the next frame
+        static void* AllocateFrame(std::size_t size, std::size_t alignment = alignof(std::max_align_t), MemoryTag tag = MemoryTag::Untagged);
+
         // called once per frame
         static void Tick();
 
@@ -63,6 +98,12 @@ namespace spartan
         // total memory used by the process including engine, dlls, drivers, os allocations, etc.
         static float GetMemoryProcessUsedMb();
 
+        // the most physical memory the process has used so far
+        static float GetMemoryProcessPeakMb();
+
+        // number of Allocate() calls since startup, frees don't decrease it
+        static uint64_t GetAllocationCount();
+
         // available physical system memory
         static float GetMemoryAvailableMb();
 
@@ -72,7 +113,88 @@ namespace spartan
         // memory allocated by a specific tag/subsystem
         static float GetMemoryAllocatedByTagMb(MemoryTag tag);
 
+        // frame arena memory a specific tag/subsystem used last frame, and the most it ever used in one frame
+        static float GetFrameMemoryByTagMb(MemoryTag tag);
+        static float GetFrameMemoryPeakByTagMb(MemoryTag tag);
+
         // get tag name as string
         static const char* GetTagName(MemoryTag tag);
+
+        // allocations and bytes of the last frame, and a history of them, index 0 is the oldest frame
+        static FrameAllocationStats GetFrameAllocations();
+        static uint32_t GetFrameAllocationHistory(FrameAllocationStats* history, uint32_t capacity);
+
+        // capture the call stack of every nth allocation and attribute it to its call site, off by default
+        static void SetTrackingEnabled(bool enabled, uint32_t sample_rate = 64);
+        static bool IsTrackingEnabled();
+        static uint32_t GetTrackingSampleRate();
+        static void GetCallSites(std::vector<AllocationCallSite>& sites); // most bytes first
+        static std::string GetCallSiteSymbol(const void* address);
+
+        // once warm_up_frames have passed, any allocation inside an AllocationFreeScope fails an assertion
+        static void SetZeroAllocationMode(bool enabled, uint32_t warm_up_frames = 300);
+        static bool IsZeroAllocationModeArmed();
+
+        // record every Allocate() and Free() until TraceEnd(), which writes the trace to a file
+        // recording serializes all allocations, it's meant for capturing a workload to replay, not for normal runs
+        static void TraceBegin();
+        static bool TraceEnd(const char* file_path);
+        static bool TraceLoad(const char* file_path, std::vector<AllocationTraceEvent>& events);
     };
+
+    // marks code that must not allocate in steady state, e.g. World::Tick() and Renderer::Tick()
+    // only the calling thread is checked, nothing is checked unless zero allocation mode is armed
+    class AllocationFreeScope
+    {
+    public:
+        explicit AllocationFreeScope(const char* name);
+        ~AllocationFreeScope();
+
+    private:
+        const char* m_name         = nullptr;
+        const char* m_parent       = nullptr;
+        uint64_t m_allocations     = 0;
+        bool m_armed               = false;
+    };
+
+    // stl allocator for per-frame scratch containers, backed by Allocator::AllocateFrame()
+    // deallocate is a no-op, so a container using it must not outlive the next frame
+    template <typename T, MemoryTag Tag = MemoryTag::Untagged>
+    class FrameAllocator
+    {
+    public:
+        using value_type = T;
+
+        template <typename U>
+        struct rebind
+        {
+            using other = FrameAllocator<U, Tag>;
+        };
+
+        FrameAllocator() noexcept = default;
+
+        template <typename U>
+        FrameAllocator(const FrameAllocator<U, Tag>&) noexcept {}
+
+        T* allocate(std::size_t count)
+        {
+            void* ptr = Allocator::AllocateFrame(count * sizeof(T), alignof(T), Tag);
+            if (!ptr)
+            {
+                throw std::bad_alloc();
+            }
+            return static_cast<T*>(ptr);
+        }
+
+        void deallocate(T*, std::size_t) noexcept {}
+
+        template <typename U>
+        bool operator==(const FrameAllocator<U, Tag>&) const noexcept { return true; }
+
+        template <typename U>
+        bool operator!=(const FrameAllocator<U, Tag>&) const noexcept { return false; }
+    };
+
+    template <typename T, MemoryTag Tag = MemoryTag::Untagged>
+    using FrameVector = std::vector<T, FrameAllocator<T, Tag>>;
 }
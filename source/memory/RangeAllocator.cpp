@@ -0,0 +1,346 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES =============
+#include "pch.h"
+#include "RangeAllocator.h"
+#include <bit>
+//========================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace spartan
+{
+    uint32_t RangeAllocator::BinRoundDown(const uint32_t size)
+    {
+        // below one group the bin is the size itself, above it the exponent picks the group and the
+        // bits under the leading one the bin within it, so every range in a bin is at least its value
+        if (size < bins_per_group)
+        {
+            return size;
+        }
+
+        const uint32_t highest = 31 - static_cast<uint32_t>(countl_zero(size));
+        const uint32_t shift   = highest - mantissa_bits;
+        return ((shift + 1) << mantissa_bits) | ((size >> shift) & (bins_per_group - 1));
+    }
+
+    uint32_t RangeAllocator::BinRoundUp(const uint32_t size)
+    {
+        // the first bin whose every range can hold the size, a mantissa carry rolls into the next group
+        if (size < bins_per_group)
+        {
+            return size;
+        }
+
+        const uint32_t highest = 31 - static_cast<uint32_t>(countl_zero(size));
+        const uint32_t shift   = highest - mantissa_bits;
+        uint32_t bin           = ((shift + 1) << mantissa_bits) | ((size >> shift) & (bins_per_group - 1));
+        if (size & ((1u << shift) - 1))
+        {
+            bin++;
+        }
+
+        return bin;
+    }
+
+    void RangeAllocator::Initialize(const uint32_t capacity)
+    {
+        Clear();
+        Grow(capacity);
+    }
+
+    void RangeAllocator::Grow(const uint32_t capacity)
+    {
+        if (capacity <= m_capacity)
+        {
+            return;
+        }
+
+        const uint32_t extra = capacity - m_capacity;
+        if (m_last != invalid && !m_nodes[m_last].used)
+        {
+            RemoveFree(m_last);
+            m_nodes[m_last].size += extra;
+            InsertFree(m_last);
+        }
+        else
+        {
+            const uint32_t node           = NewNode();
+            m_nodes[node].offset          = m_capacity;
+            m_nodes[node].size            = extra;
+            m_nodes[node].neighbor_prev   = m_last;
+            if (m_last != invalid)
+            {
+                m_nodes[m_last].neighbor_next = node;
+            }
+            m_last = node;
+            InsertFree(node);
+        }
+
+        m_capacity = capacity;
+    }
+
+    void RangeAllocator::Clear()
+    {
+        m_nodes.clear();
+        for (uint32_t& head : m_bin_heads)
+        {
+            head = invalid;
+        }
+        for (uint8_t& mask : m_bin_masks)
+        {
+            mask = 0;
+        }
+        m_group_mask       = 0;
+        m_recycled         = invalid;
+        m_last             = invalid;
+        m_capacity         = 0;
+        m_used             = 0;
+        m_allocation_count = 0;
+    }
+
+    RangeAllocation RangeAllocator::Allocate(const uint32_t count)
+    {
+        if (count == 0)
+        {
+            return {};
+        }
+
+        const uint32_t bin = FindBin(BinRoundUp(count));
+        if (bin == invalid)
+        {
+            return {};
+        }
+
+        const uint32_t node = m_bin_heads[bin];
+        RemoveFree(node);
+
+        // the tail goes back as its own free range, NewNode() can grow m_nodes so no references are held across it
+        if (m_nodes[node].size > count)
+        {
+            const uint32_t remainder         = NewNode();
+            m_nodes[remainder].offset        = m_nodes[node].offset + count;
+            m_nodes[remainder].size          = m_nodes[node].size - count;
+            m_nodes[remainder].neighbor_prev = node;
+            m_nodes[remainder].neighbor_next = m_nodes[node].neighbor_next;
+            if (m_nodes[node].neighbor_next != invalid)
+            {
+                m_nodes[m_nodes[node].neighbor_next].neighbor_prev = remainder;
+            }
+            else
+            {
+                m_last = remainder;
+            }
+            m_nodes[node].neighbor_next = remainder;
+            m_nodes[node].size          = count;
+            InsertFree(remainder);
+        }
+
+        m_nodes[node].used = true;
+        m_used            += count;
+        m_allocation_count++;
+
+        return { m_nodes[node].offset, node };
+    }
+
+    void RangeAllocator::Free(const RangeAllocation& allocation)
+    {
+        if (!allocation.IsValid())
+        {
+            return;
+        }
+
+        uint32_t node = allocation.node;
+        SP_ASSERT(node < m_nodes.size() && m_nodes[node].used && m_nodes[node].offset == allocation.offset);
+
+        m_nodes[node].used  = false;
+        m_used             -= m_nodes[node].size;
+        m_allocation_count--;
+
+        // merge into a free left neighbour
+        const uint32_t prev = m_nodes[node].neighbor_prev;
+        if (prev != invalid && !m_nodes[prev].used)
+        {
+            RemoveFree(prev);
+            m_nodes[prev].size          += m_nodes[node].size;
+            m_nodes[prev].neighbor_next  = m_nodes[node].neighbor_next;
+            if (m_nodes[node].neighbor_next != invalid)
+            {
+                m_nodes[m_nodes[node].neighbor_next].neighbor_prev = prev;
+            }
+            else
+            {
+                m_last = prev;
+            }
+            RecycleNode(node);
+            node = prev;
+        }
+
+        // and absorb a free right one
+        const uint32_t next = m_nodes[node].neighbor_next;
+        if (next != invalid && !m_nodes[next].used)
+        {
+            RemoveFree(next);
+            m_nodes[node].size          += m_nodes[next].size;
+            m_nodes[node].neighbor_next  = m_nodes[next].neighbor_next;
+            if (m_nodes[next].neighbor_next != invalid)
+            {
+                m_nodes[m_nodes[next].neighbor_next].neighbor_prev = node;
+            }
+            else
+            {
+                m_last = node;
+            }
+            RecycleNode(next);
+        }
+
+        InsertFree(node);
+    }
+
+    uint32_t RangeAllocator::GetHighWater() const
+    {
+        if (m_last == invalid)
+        {
+            return 0;
+        }
+
+        return m_nodes[m_last].used ? m_capacity : m_nodes[m_last].offset;
+    }
+
+    RangeAllocatorStats RangeAllocator::GetStats() const
+    {
+        RangeAllocatorStats stats;
+        stats.capacity    = m_capacity;
+        stats.used        = m_used;
+        stats.free        = m_capacity - m_used;
+        stats.allocations = m_allocation_count;
+
+        for (uint32_t node = m_last; node != invalid; node = m_nodes[node].neighbor_prev)
+        {
+            if (!m_nodes[node].used)
+            {
+                stats.free_ranges++;
+                stats.largest_free = max(stats.largest_free, m_nodes[node].size);
+            }
+        }
+
+        return stats;
+    }
+
+    uint32_t RangeAllocator::NewNode()
+    {
+        if (m_recycled != invalid)
+        {
+            const uint32_t node = m_recycled;
+            m_recycled          = m_nodes[node].bin_next;
+            m_nodes[node]       = Node();
+            return node;
+        }
+
+        m_nodes.emplace_back();
+        return static_cast<uint32_t>(m_nodes.size() - 1);
+    }
+
+    void RangeAllocator::RecycleNode(const uint32_t node)
+    {
+        m_nodes[node]          = Node();
+        m_nodes[node].bin_next = m_recycled;
+        m_recycled             = node;
+    }
+
+    void RangeAllocator::InsertFree(const uint32_t node)
+    {
+        const uint32_t bin      = BinRoundDown(m_nodes[node].size);
+        const uint32_t head     = m_bin_heads[bin];
+        m_nodes[node].bin_prev  = invalid;
+        m_nodes[node].bin_next  = head;
+        if (head != invalid)
+        {
+            m_nodes[head].bin_prev = node;
+        }
+        m_bin_heads[bin] = node;
+
+        const uint32_t group  = bin / bins_per_group;
+        m_bin_masks[group]   |= static_cast<uint8_t>(1u << (bin % bins_per_group));
+        m_group_mask         |= 1u << group;
+    }
+
+    void RangeAllocator::RemoveFree(const uint32_t node)
+    {
+        const uint32_t bin  = BinRoundDown(m_nodes[node].size);
+        const uint32_t prev = m_nodes[node].bin_prev;
+        const uint32_t next = m_nodes[node].bin_next;
+
+        if (prev != invalid)
+        {
+            m_nodes[prev].bin_next = next;
+        }
+        else
+        {
+            m_bin_heads[bin] = next;
+        }
+        if (next != invalid)
+        {
+            m_nodes[next].bin_prev = prev;
+        }
+        m_nodes[node].bin_prev = invalid;
+        m_nodes[node].bin_next = invalid;
+
+        if (m_bin_heads[bin] == invalid)
+        {
+            const uint32_t group  = bin / bins_per_group;
+            m_bin_masks[group]   &= static_cast<uint8_t>(~(1u << (bin % bins_per_group)));
+            if (m_bin_masks[group] == 0)
+            {
+                m_group_mask &= ~(1u << group);
+            }
+        }
+    }
+
+    uint32_t RangeAllocator::FindBin(const uint32_t bin_min) const
+    {
+        const uint32_t group = bin_min / bins_per_group;
+        if (group >= group_count)
+        {
+            return invalid;
+        }
+
+        // the rest of the bins in the same group first, then the lowest non empty group above it
+        const uint32_t in_group = m_bin_masks[group] & (0xFFu << (bin_min % bins_per_group));
+        if (in_group)
+        {
+            return group * bins_per_group + static_cast<uint32_t>(countr_zero(in_group));
+        }
+
+        const uint32_t groups_above = group + 1 < group_count ? m_group_mask & (~0u << (group + 1)) : 0;
+        if (!groups_above)
+        {
+            return invalid;
+        }
+
+        const uint32_t group_found = static_cast<uint32_t>(countr_zero(groups_above));
+        return group_found * bins_per_group + static_cast<uint32_t>(countr_zero(static_cast<uint32_t>(m_bin_masks[group_found])));
+    }
+}
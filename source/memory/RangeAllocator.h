@@ -0,0 +1,121 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES =====
+#include <cstdint>
+#include <vector>
+//================
+
+namespace spartan
+{
+    // one allocation handed out by RangeAllocator, node identifies it for Free() without a lookup
+    struct RangeAllocation
+    {
+        uint32_t offset = UINT32_MAX;
+        uint32_t node   = UINT32_MAX;
+
+        bool IsValid() const { return node != UINT32_MAX; }
+    };
+
+    struct RangeAllocatorStats
+    {
+        uint32_t capacity     = 0;
+        uint32_t used         = 0;
+        uint32_t free         = 0;
+        uint32_t largest_free = 0;
+        uint32_t free_ranges  = 0;
+        uint32_t allocations  = 0;
+
+        // 0 when all free space is one range, approaches 1 as it splinters into small ones
+        float GetFragmentation() const { return free ? 1.0f - static_cast<float>(largest_free) / static_cast<float>(free) : 0.0f; }
+    };
+
+    // two level segregated fit (tlsf) allocator over an abstract range of units, it owns no memory, it only
+    // hands out offsets, so it suits gpu buffers where the units are elements of a buffer
+    // free ranges are binned by a small float of their size, 3 mantissa bits below each power of two, and two
+    // bitmasks find the first non empty bin that fits in constant time, neighbours merge on free
+    class RangeAllocator
+    {
+    public:
+        static constexpr uint32_t invalid = UINT32_MAX;
+
+        RangeAllocator() { Clear(); }
+
+        void Initialize(uint32_t capacity);
+        // extends the range, the new units join the free range at the end
+        void Grow(uint32_t capacity);
+        void Clear();
+
+        RangeAllocation Allocate(uint32_t count);
+        void Free(const RangeAllocation& allocation);
+
+        uint32_t GetCapacity() const { return m_capacity; }
+        uint32_t GetUsed() const     { return m_used; }
+        // end of the highest allocation, everything past it is free
+        uint32_t GetHighWater() const;
+        RangeAllocatorStats GetStats() const;
+
+        // walks ranges from the highest offset down, free and used alike, for compaction passes
+        uint32_t GetLastNode() const                  { return m_last; }
+        uint32_t GetPreviousNode(uint32_t node) const { return m_nodes[node].neighbor_prev; }
+        uint32_t GetNodeOffset(uint32_t node) const   { return m_nodes[node].offset; }
+        uint32_t GetNodeSize(uint32_t node) const     { return m_nodes[node].size; }
+        bool IsNodeUsed(uint32_t node) const          { return m_nodes[node].used; }
+
+    private:
+        struct Node
+        {
+            uint32_t offset        = 0;
+            uint32_t size          = 0;
+            uint32_t bin_prev      = invalid;
+            uint32_t bin_next      = invalid; // next unused node while the node is recycled
+            uint32_t neighbor_prev = invalid;
+            uint32_t neighbor_next = invalid;
+            bool used              = false;
+        };
+
+        static constexpr uint32_t mantissa_bits  = 3;
+        static constexpr uint32_t bins_per_group = 1u << mantissa_bits;
+        static constexpr uint32_t group_count    = 32;
+        static constexpr uint32_t bin_count      = group_count * bins_per_group;
+
+        static uint32_t BinRoundDown(uint32_t size);
+        static uint32_t BinRoundUp(uint32_t size);
+        uint32_t NewNode();
+        void RecycleNode(uint32_t node);
+        void InsertFree(uint32_t node);
+        void RemoveFree(uint32_t node);
+        uint32_t FindBin(uint32_t bin_min) const;
+
+        std::vector<Node> m_nodes;
+        uint32_t m_bin_heads[bin_count];
+        uint32_t m_group_mask                  = 0;
+        uint8_t m_bin_masks[group_count]       = {};
+        uint32_t m_recycled                    = invalid;
+        uint32_t m_last                        = invalid;
+        uint32_t m_capacity                    = 0;
+        uint32_t m_used                        = 0;
+        uint32_t m_allocation_count            = 0;
+    };
+}
@@ -0,0 +1,243 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==============
+#include "pch.h"
+#include "HardwareCounters.h"
+#if defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+//=========================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace spartan
+{
+    bool HardwareCounters::m_enabled = false;
+
+    namespace
+    {
+        constexpr uint32_t counter_count = static_cast<uint32_t>(HardwareCounter::Max);
+
+#if defined(__linux__)
+        atomic<bool> open_failure_logged = false;
+
+        // the counters of one thread are opened as a single group, so one read() returns all of them at once
+        struct thread_counters
+        {
+            int leader                   = -1;
+            int fds[counter_count]       = { -1, -1, -1, -1, -1 };
+            uint32_t valid_mask          = 0;
+            uint32_t group_index[counter_count] = {}; // position of each counter in the group's read() layout
+            uint32_t group_size          = 0;
+            bool opened                  = false;
+
+            ~thread_counters()
+            {
+                for (int fd : fds)
+                {
+                    if (fd >= 0)
+                    {
+                        close(fd);
+                    }
+                }
+            }
+        };
+
+        thread_local thread_counters tl_counters;
+
+        void set_event_config(HardwareCounter counter, perf_event_attr& attr)
+        {
+            attr.type = PERF_TYPE_HARDWARE;
+            switch (counter)
+            {
+                case HardwareCounter::Cycles:         attr.config = PERF_COUNT_HW_CPU_CYCLES;    break;
+                case HardwareCounter::Instructions:   attr.config = PERF_COUNT_HW_INSTRUCTIONS;  break;
+                case HardwareCounter::CacheLlcMisses: attr.config = PERF_COUNT_HW_CACHE_MISSES;  break; // last level cache on x86
+                case HardwareCounter::BranchMisses:   attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+                case HardwareCounter::CacheL1dMisses:
+                    attr.type   = PERF_TYPE_HW_CACHE;
+                    attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                    break;
+                default: break;
+            }
+        }
+
+        void open_thread_counters(thread_counters& counters)
+        {
+            counters.opened = true;
+
+            int first_error = 0;
+            for (uint32_t i = 0; i < counter_count; i++)
+            {
+                perf_event_attr attr = {};
+                attr.size            = sizeof(perf_event_attr);
+                set_event_config(static_cast<HardwareCounter>(i), attr);
+                attr.exclude_kernel  = 1; // allowed at the default perf_event_paranoid level
+                attr.exclude_hv      = 1;
+                attr.read_format     = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+                // the first counter that opens leads the group, the calling thread on any cpu is counted
+                const int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, counters.leader, 0));
+                if (fd < 0)
+                {
+                    first_error = first_error ? first_error : errno;
+                    continue;
+                }
+
+                if (counters.leader < 0)
+                {
+                    counters.leader = fd;
+                }
+                counters.fds[i]          = fd;
+                counters.group_index[i]  = counters.group_size++;
+                counters.valid_mask     |= 1u << i;
+            }
+
+            if (first_error != 0 && !open_failure_logged.exchange(true))
+            {
+                SP_LOG_WARNING("Hardware counters: %u of %u available (%s), check /proc/sys/kernel/perf_event_paranoid",
+                    counters.group_size, counter_count, strerror(first_error));
+            }
+        }
+#endif
+    }
+
+    float HardwareCounterValues::GetIpc() const
+    {
+        if (!Has(HardwareCounter::Cycles) || !Has(HardwareCounter::Instructions) || Get(HardwareCounter::Cycles) == 0)
+        {
+            return 0.0f;
+        }
+
+        return static_cast<float>(static_cast<double>(Get(HardwareCounter::Instructions)) / static_cast<double>(Get(HardwareCounter::Cycles)));
+    }
+
+    float HardwareCounterValues::GetMpki(HardwareCounter counter) const
+    {
+        if (!Has(counter) || !Has(HardwareCounter::Instructions) || Get(HardwareCounter::Instructions) == 0)
+        {
+            return 0.0f;
+        }
+
+        return static_cast<float>(static_cast<double>(Get(counter)) * 1000.0 / static_cast<double>(Get(HardwareCounter::Instructions)));
+    }
+
+    HardwareCounterValues HardwareCounterValues::Delta(const HardwareCounterValues& start) const
+    {
+        HardwareCounterValues delta;
+        delta.valid_mask = valid_mask & start.valid_mask;
+        for (uint32_t i = 0; i < counter_count; i++)
+        {
+            delta.values[i] = values[i] >= start.values[i] ? values[i] - start.values[i] : 0;
+        }
+
+        return delta;
+    }
+
+    void HardwareCounters::SetEnabled(const bool enabled)
+    {
+        if (enabled && !IsSupported())
+        {
+            SP_LOG_WARNING("Hardware counters are only supported on linux");
+            return;
+        }
+
+        m_enabled = enabled;
+    }
+
+    bool HardwareCounters::IsSupported()
+    {
+#if defined(__linux__)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    bool HardwareCounters::Read(HardwareCounterValues& values)
+    {
+        values.valid_mask = 0;
+
+#if defined(__linux__)
+        if (!m_enabled)
+        {
+            return false;
+        }
+
+        thread_counters& counters = tl_counters;
+        if (!counters.opened)
+        {
+            open_thread_counters(counters);
+        }
+
+        if (counters.leader < 0)
+        {
+            return false;
+        }
+
+        // nr, time enabled, time running, then one value per counter in the group
+        uint64_t buffer[3 + counter_count] = {};
+        const ssize_t size = read(counters.leader, buffer, sizeof(buffer));
+        if (size < static_cast<ssize_t>((3 + counters.group_size) * sizeof(uint64_t)) || buffer[2] == 0)
+        {
+            return false;
+        }
+
+        // the kernel multiplexes when the group doesn't fit the pmu, extrapolate to the full time
+        const uint64_t time_enabled = buffer[1];
+        const uint64_t time_running = buffer[2];
+        for (uint32_t i = 0; i < counter_count; i++)
+        {
+            if (counters.valid_mask & (1u << i))
+            {
+                const uint64_t value = buffer[3 + counters.group_index[i]];
+                values.values[i]     = time_running == time_enabled ? value : static_cast<uint64_t>(static_cast<double>(value) * time_enabled / time_running);
+            }
+        }
+        values.valid_mask = counters.valid_mask;
+
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    const char* HardwareCounters::GetName(const HardwareCounter counter)
+    {
+        switch (counter)
+        {
+            case HardwareCounter::Cycles:         return "cycles";
+            case HardwareCounter::Instructions:   return "instructions";
+            case HardwareCounter::CacheL1dMisses: return "l1d_misses";
+            case HardwareCounter::CacheLlcMisses: return "llc_misses";
+            case HardwareCounter::BranchMisses:   return "branch_misses";
+            default:                              return "unknown";
+        }
+    }
+}
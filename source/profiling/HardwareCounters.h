@@ -0,0 +1,77 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ======
+#include <cstdint>
+//=================
+
+namespace spartan
+{
+    enum class HardwareCounter : uint8_t
+    {
+        Cycles,
+        Instructions,
+        CacheL1dMisses,
+        CacheLlcMisses,
+        BranchMisses,
+        Max
+    };
+
+    // counter values of one thread, a bit in valid_mask is set for every counter the cpu could count
+    struct HardwareCounterValues
+    {
+        uint64_t values[static_cast<uint32_t>(HardwareCounter::Max)] = {};
+        uint32_t valid_mask                                          = 0;
+
+        bool Has(HardwareCounter counter) const { return valid_mask & (1u << static_cast<uint32_t>(counter)); }
+        uint64_t Get(HardwareCounter counter) const { return values[static_cast<uint32_t>(counter)]; }
+
+        // instructions per cycle, 0 when either wasn't counted
+        float GetIpc() const;
+
+        // misses per thousand instructions, 0 when either wasn't counted
+        float GetMpki(HardwareCounter counter) const;
+
+        // the counts between two reads of the same thread
+        HardwareCounterValues Delta(const HardwareCounterValues& start) const;
+    };
+
+    // hardware performance counters of the calling thread, linux only (perf_event_open)
+    // counters are opened lazily per thread, when the kernel refuses them (perf_event_paranoid, no pmu in a vm)
+    // reads simply fail and the profiler shows timings only
+    class HardwareCounters
+    {
+    public:
+        static void SetEnabled(bool enabled);
+        static bool IsEnabled() { return m_enabled; }
+        static bool IsSupported();
+
+        // false when disabled or the calling thread has no counters
+        static bool Read(HardwareCounterValues& values);
+
+        static const char* GetName(HardwareCounter counter);
+
+    private:
+        static bool m_enabled;
+    };
+}
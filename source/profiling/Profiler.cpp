@@ -22,6 +22,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =========================
 #include "pch.h"
 #include "Profiler.h"
+#include "TraceWriter.h"
 #include "../rhi/RHI_Device.h"
 #include "../rhi/RHI_CommandList.h"
 #include "../rhi/RHI_Implementation.h"
@@ -30,6 +31,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../core/Debugging.h"
 #include "../core/Timer.h"
 #include "../rendering/Renderer.h"
+#include "../rendering/GeometryBuffer.h"
 #include "../rhi/RHI_Viewport.h"
 #include "../display/Display.h"
 #include "../memory/Allocator.h"
@@ -66,6 +68,10 @@ namespace spartan
     uint32_t Profiler::m_rhi_descriptor_set_count       = 0;
     uint32_t Profiler::m_rhi_timestamps_dropped         = 0;
 
+    // metrics - world
+    float Profiler::m_play_boot_ms                      = 0.0f;
+    uint32_t Profiler::m_play_boot_frames               = 0;
+
     namespace
     {
         // profiling
@@ -110,6 +116,155 @@ namespace spartan
         bool is_visualized = false;
         thread::id profiling_thread_id;
 
+        // cpu blocks of other threads, each thread writes completed blocks into its own lane without locking
+        // and the main thread merges them into the read buffer when a frame is sampled
+        constexpr uint32_t thread_lane_max        = 64;   // threads past this aren't profiled
+        constexpr uint32_t thread_event_capacity  = 2048; // per thread, between two merges
+        constexpr uint32_t thread_scope_depth_max = 64;
+
+        struct thread_event
+        {
+            const char* name = nullptr;
+            chrono::high_resolution_clock::time_point start;
+            chrono::high_resolution_clock::time_point end;
+            uint32_t depth   = 0;
+            HardwareCounterValues counters;
+        };
+
+        // single producer (the owning thread), single consumer (the main thread)
+        struct thread_lane
+        {
+            thread_event events[thread_event_capacity];
+            alignas(64) atomic<uint32_t> write = 0;
+            alignas(64) atomic<uint32_t> read  = 0;
+            atomic<uint32_t> dropped           = 0;
+            char name[32]                      = {};
+        };
+
+        struct thread_scope
+        {
+            const char* name = nullptr;
+            chrono::high_resolution_clock::time_point start;
+            bool recorded    = false;
+            HardwareCounterValues counters;
+        };
+
+        unique_ptr<thread_lane> thread_lanes[thread_lane_max]; // index + 1 is the lane number
+        atomic<uint32_t> thread_lane_count = 0;
+        atomic<bool> poll_threads          = false; // other threads record blocks that start while this is set
+        uint32_t thread_events_dropped     = 0;
+        vector<thread_event> thread_events_merge;
+
+        thread_local thread_lane* tl_lane            = nullptr;
+        thread_local bool tl_lane_unavailable        = false;
+        thread_local thread_scope tl_scopes[thread_scope_depth_max];
+        thread_local uint32_t tl_scope_depth         = 0;
+
+        thread_lane* get_thread_lane()
+        {
+            if (tl_lane || tl_lane_unavailable)
+            {
+                return tl_lane;
+            }
+
+            const uint32_t index = thread_lane_count.load(memory_order_relaxed);
+            if (index >= thread_lane_max)
+            {
+                tl_lane_unavailable = true;
+                return nullptr;
+            }
+
+            // name it before publishing, the main thread reads the name once the count covers it
+            unique_ptr<thread_lane> lane = make_unique<thread_lane>();
+            const int32_t worker_index   = ThreadPool::GetWorkerIndex();
+            if (worker_index >= 0)
+            {
+                snprintf(lane->name, sizeof(lane->name), "Worker %d", worker_index);
+            }
+            else
+            {
+                snprintf(lane->name, sizeof(lane->name), "Thread %zu", hash<thread::id>()(this_thread::get_id()) % 10000);
+            }
+
+            // claimed once per thread, so a lock is fine
+            static mutex lane_mutex;
+            lock_guard<mutex> lock(lane_mutex);
+            const uint32_t slot = thread_lane_count.load(memory_order_relaxed);
+            if (slot >= thread_lane_max)
+            {
+                tl_lane_unavailable = true;
+                return nullptr;
+            }
+            tl_lane            = lane.get();
+            thread_lanes[slot] = move(lane);
+            thread_lane_count.store(slot + 1, memory_order_release);
+
+            return tl_lane;
+        }
+
+        void thread_scope_begin(const char* name)
+        {
+            const uint32_t depth = tl_scope_depth++;
+            if (depth >= thread_scope_depth_max)
+            {
+                return;
+            }
+
+            // the clock is only read while a frame is being sampled
+            thread_scope& scope = tl_scopes[depth];
+            scope.name          = name;
+            scope.recorded      = profile_cpu && poll_threads.load(memory_order_relaxed);
+            if (scope.recorded)
+            {
+                if (!HardwareCounters::IsEnabled() || !HardwareCounters::Read(scope.counters))
+                {
+                    scope.counters = HardwareCounterValues();
+                }
+                scope.start = chrono::high_resolution_clock::now();
+            }
+        }
+
+        void thread_scope_end()
+        {
+            if (tl_scope_depth == 0)
+            {
+                return;
+            }
+
+            const uint32_t depth = --tl_scope_depth;
+            if (depth >= thread_scope_depth_max || !tl_scopes[depth].recorded)
+            {
+                return;
+            }
+
+            thread_lane* lane = get_thread_lane();
+            if (!lane)
+            {
+                return;
+            }
+
+            const uint32_t write = lane->write.load(memory_order_relaxed);
+            if (write - lane->read.load(memory_order_acquire) >= thread_event_capacity)
+            {
+                lane->dropped.fetch_add(1, memory_order_relaxed);
+                return;
+            }
+
+            thread_event& event = lane->events[write % thread_event_capacity];
+            event.name          = tl_scopes[depth].name;
+            event.start         = tl_scopes[depth].start;
+            event.end           = chrono::high_resolution_clock::now();
+            event.depth         = depth;
+            event.counters      = HardwareCounterValues();
+
+            HardwareCounterValues counters_end;
+            if (tl_scopes[depth].counters.valid_mask != 0 && HardwareCounters::Read(counters_end))
+            {
+                event.counters = counters_end.Delta(tl_scopes[depth].counters);
+            }
+            lane->write.store(write + 1, memory_order_release);
+        }
+
         // command lists used during the current poll frame (for deferred timestamp readback)
         vector<RHI_CommandList*> cmd_lists_used;
 
@@ -135,6 +290,27 @@ namespace spartan
             1024 * 1024;
         float capture_write_time_ms = 0.0f;
 
+        // trace capture
+        uint32_t trace_frames_left = 0;
+        bool trace_this_frame = false;
+        uint64_t trace_frame_count = 0;
+        string trace_file_path;
+        chrono::high_resolution_clock::time_point trace_start;
+
+        void close_trace()
+        {
+            trace_frames_left = 0;
+            trace_this_frame  = false;
+            if (TraceWriter::End())
+            {
+                SP_LOG_INFO("profiler trace of %llu frames saved to %s", trace_frame_count, trace_file_path.c_str());
+            }
+            else
+            {
+                SP_LOG_ERROR("failed to write profiler trace, partial trace is at %s", trace_file_path.c_str());
+            }
+        }
+
         // cpu
         const char* cpu_name = "N/A";
         bool is_cpu_wait(const char* name)
@@ -252,11 +428,19 @@ namespace spartan
             CaptureColumn_RamProcessMb,
             CaptureColumn_RamAvailableMb,
             CaptureColumn_RamTotalMb,
+            CaptureColumn_RamFrameAllocations,
+            CaptureColumn_RamFrameAllocationBytes,
             CaptureColumn_Api,
             CaptureColumn_Mode,
             CaptureColumn_GpuTimingEnabled,
             CaptureColumn_GpuTimingValid,
             CaptureColumn_CpuScope,
+            CaptureColumn_Cycles,
+            CaptureColumn_Instructions,
+            CaptureColumn_Ipc,
+            CaptureColumn_L1dMpki,
+            CaptureColumn_LlcMpki,
+            CaptureColumn_BranchMpki,
             CaptureColumn_Count
         };
 
@@ -354,6 +538,7 @@ namespace spartan
                     block.IsComplete() &&
                     block.GetType() ==
                         TimeBlockType::Cpu &&
+                    block.GetThreadLane() == 0 &&
                     block.GetName() &&
                     strcmp(
                         block.GetName(),
@@ -495,7 +680,11 @@ namespace spartan
                             "0";
                 }
                 fields[CaptureColumn_CpuScope] =
-                    "main_thread";
+                    block.GetThreadLane() == 0 ?
+                        "main_thread" :
+                        Profiler::GetThreadLaneName(
+                            block.GetThreadLane()
+                        );
                 fields[
                     CaptureColumn_RhiTimestampsDropped
                 ] =
@@ -503,6 +692,38 @@ namespace spartan
                         Profiler::
                             m_rhi_timestamps_dropped
                     );
+
+                // left empty when the block wasn't counted, misses are per thousand instructions
+                const HardwareCounterValues& counters =
+                    block.GetCounters();
+                if (counters.Has(HardwareCounter::Cycles))
+                {
+                    fields[CaptureColumn_Cycles] =
+                        to_string(
+                            counters.Get(HardwareCounter::Cycles)
+                        );
+                }
+                if (counters.Has(HardwareCounter::Instructions))
+                {
+                    fields[CaptureColumn_Instructions] =
+                        to_string(
+                            counters.Get(HardwareCounter::Instructions)
+                        );
+                    fields[CaptureColumn_Ipc] =
+                        format_float(counters.GetIpc());
+                    fields[CaptureColumn_L1dMpki] =
+                        counters.Has(HardwareCounter::CacheL1dMisses) ?
+                            format_float(counters.GetMpki(HardwareCounter::CacheL1dMisses)) :
+                            "";
+                    fields[CaptureColumn_LlcMpki] =
+                        counters.Has(HardwareCounter::CacheLlcMisses) ?
+                            format_float(counters.GetMpki(HardwareCounter::CacheLlcMisses)) :
+                            "";
+                    fields[CaptureColumn_BranchMpki] =
+                        counters.Has(HardwareCounter::BranchMisses) ?
+                            format_float(counters.GetMpki(HardwareCounter::BranchMisses)) :
+                            "";
+                }
                 append_capture_row(
                     block_rows,
                     fields
@@ -759,6 +980,14 @@ namespace spartan
                 format_float(
                     Allocator::GetMemoryTotalMb()
                 );
+            fields[CaptureColumn_RamFrameAllocations] =
+                to_string(
+                    Allocator::GetFrameAllocations().count
+                );
+            fields[CaptureColumn_RamFrameAllocationBytes] =
+                to_string(
+                    Allocator::GetFrameAllocations().bytes
+                );
             fields[CaptureColumn_Api] = api;
             fields[CaptureColumn_Mode] =
                 capture_mode;
@@ -901,6 +1130,12 @@ namespace spartan
         profiling_thread_id =
             this_thread::get_id();
         cpu_name = get_cpu_name();
+
+        // cycles, instructions, cache and branch misses per cpu block
+        if (Engine::HasArgument("-hardware_counters"))
+        {
+            HardwareCounters::SetEnabled(true);
+        }
     }
 
     void Profiler::Shutdown()
@@ -909,6 +1144,11 @@ namespace spartan
         {
             close_capture();
         }
+
+        if (TraceWriter::IsActive())
+        {
+            close_trace();
+        }
     }
 
     bool Profiler::StartRecording()
@@ -977,9 +1217,12 @@ namespace spartan
             "vram_available_mb,vram_total_mb,"
             "ram_allocated_mb,ram_peak_mb,"
             "ram_process_mb,ram_available_mb,"
-            "ram_total_mb,api,capture_mode,"
+            "ram_total_mb,ram_frame_allocations,"
+            "ram_frame_allocation_bytes,"
+            "api,capture_mode,"
             "gpu_timing_enabled,gpu_timing_valid,"
-            "cpu_scope\n";
+            "cpu_scope,cycles,instructions,ipc,"
+            "l1d_mpki,llc_mpki,branch_mpki\n";
         if (!write_capture_buffer())
         {
             close_capture();
@@ -1031,6 +1274,51 @@ namespace spartan
         return capture_error;
     }
 
+    bool Profiler::StartTrace(const uint32_t frame_count)
+    {
+        if (frame_count == 0 || TraceWriter::IsActive())
+        {
+            return false;
+        }
+
+        trace_file_path = FileSystem::GetExecutableDirectory() + "/profiler_trace.json";
+        if (!TraceWriter::Begin(trace_file_path))
+        {
+            return false;
+        }
+
+        trace_frames_left = frame_count;
+        trace_frame_count = 0;
+        trace_start       = chrono::high_resolution_clock::now();
+        SP_LOG_INFO("profiler trace recording %u frames to %s", frame_count, trace_file_path.c_str());
+
+        return true;
+    }
+
+    void Profiler::StopTrace()
+    {
+        // the trace is closed at the end of the current frame
+        if (trace_frames_left > 1)
+        {
+            trace_frames_left = 1;
+        }
+    }
+
+    bool Profiler::IsTracing()
+    {
+        return TraceWriter::IsActive();
+    }
+
+    uint64_t Profiler::GetTracedFrameCount()
+    {
+        return trace_frame_count;
+    }
+
+    const string& Profiler::GetTraceFilePath()
+    {
+        return trace_file_path;
+    }
+
     void Profiler::FrameStart()
     {
         frame_start_cpu = chrono::high_resolution_clock::now();
@@ -1043,18 +1331,28 @@ namespace spartan
             capture_reset_metrics_pending = false;
         }
         capture_this_frame = capture_requested;
+        trace_this_frame   = trace_frames_left > 0;
         // sample gpu periodically during capture so csv busy time stays honest without stalling every frame
+        // a trace follows the same cadence, the frames in between carry cpu blocks only
+        const uint64_t sampled_frame_count =
+            capture_this_frame ?
+                capture_frame_count :
+                trace_frame_count;
         capture_gpu_sample_this_frame =
-            capture_this_frame &&
+            (
+                capture_this_frame ||
+                trace_this_frame
+            ) &&
             Debugging::IsGpuTimingEnabled() &&
             (
-                capture_frame_count == 0 ||
-                (capture_frame_count % 30) == 0
+                sampled_frame_count == 0 ||
+                (sampled_frame_count % 30) == 0
             );
-        if (capture_this_frame)
+        if (capture_this_frame || trace_this_frame)
         {
             poll = true;
         }
+        poll_threads.store(poll, memory_order_relaxed);
     }
 
     float Profiler::GetCpuOffsetMs(const chrono::high_resolution_clock::time_point& time_point)
@@ -1063,6 +1361,26 @@ namespace spartan
         return static_cast<float>(ms.count());
     }
 
+    uint32_t Profiler::GetThreadLaneCount()
+    {
+        return thread_lane_count.load(memory_order_acquire) + 1;
+    }
+
+    const char* Profiler::GetThreadLaneName(const uint32_t lane)
+    {
+        if (lane == 0)
+        {
+            return "Main";
+        }
+
+        return lane < GetThreadLaneCount() ? thread_lanes[lane - 1]->name : "";
+    }
+
+    uint32_t Profiler::GetThreadEventsDropped()
+    {
+        return thread_events_dropped;
+    }
+
     float Profiler::GetFrameDurationMs()
     {
         return frame_duration_ms;
@@ -1096,9 +1414,11 @@ namespace spartan
                     Timer::GetPacingTimeMs()
                 );
             poll = false;
+            poll_threads.store(false, memory_order_relaxed);
             const auto readback_start =
                 chrono::high_resolution_clock::now();
             ReadTimeBlocks();
+            ReadThreadLanes();
             if (capture_this_frame)
             {
                 profiler_readback_ms =
@@ -1122,9 +1442,11 @@ namespace spartan
                 {
                     continue;
                 }
+                // cpu time is the main thread's, the other lanes are shown but not summed
                 if (
                     time_block.GetType() ==
-                        TimeBlockType::Cpu
+                        TimeBlockType::Cpu &&
+                    time_block.GetThreadLane() == 0
                 )
                 {
                     if (!time_block.HasParent())
@@ -1269,6 +1591,30 @@ namespace spartan
             );
         }
 
+        if (
+            trace_this_frame &&
+            sampled_frame
+        )
+        {
+            const double frame_start_us =
+                chrono::duration<double, micro>(
+                    frame_start_cpu -
+                    trace_start
+                ).count();
+            TraceWriter::AppendFrame(
+                Renderer::GetFrameNumber(),
+                frame_start_us,
+                frame_duration_ms,
+                m_time_blocks_read
+            );
+            trace_frame_count++;
+            trace_frames_left--;
+            if (trace_frames_left == 0)
+            {
+                close_trace();
+            }
+        }
+
         if (capture_stop_pending)
         {
             close_capture();
@@ -1307,7 +1653,8 @@ namespace spartan
         if (
             (
                 is_visualized &&
-                !capture_this_frame
+                !capture_this_frame &&
+                !trace_this_frame
             ) ||
             capture_gpu_sample_this_frame
         )
@@ -1412,19 +1759,85 @@ namespace spartan
         cmd_lists_used.clear();
     }
 
+    void Profiler::ReadThreadLanes()
+    {
+        thread_events_dropped = 0;
+
+        // ids continue after the main thread's blocks of this frame
+        uint32_t next_id = m_rhi_timeblock_count;
+
+        const uint32_t lane_count = thread_lane_count.load(memory_order_acquire);
+        for (uint32_t lane_index = 0; lane_index < lane_count; lane_index++)
+        {
+            thread_lane& lane    = *thread_lanes[lane_index];
+            const uint32_t read  = lane.read.load(memory_order_relaxed);
+            const uint32_t write = lane.write.load(memory_order_acquire);
+
+            // blocks that started before this frame were opened in an earlier sampled frame, they are stale
+            thread_events_merge.clear();
+            for (uint32_t i = read; i != write; i++)
+            {
+                const thread_event& event = lane.events[i % thread_event_capacity];
+                if (event.start >= frame_start_cpu)
+                {
+                    thread_events_merge.push_back(event);
+                }
+            }
+            lane.read.store(write, memory_order_release);
+            thread_events_dropped += lane.dropped.exchange(0, memory_order_relaxed);
+
+            // blocks are written as they close, children first, so order by start to visit parents first
+            sort(thread_events_merge.begin(), thread_events_merge.end(), [](const thread_event& a, const thread_event& b)
+            {
+                return a.start != b.start ? a.start < b.start : a.depth < b.depth;
+            });
+
+            uint32_t parents[thread_scope_depth_max] = {};
+            uint32_t parent_count                    = 0;
+            for (const thread_event& event : thread_events_merge)
+            {
+                const uint32_t id        = ++next_id;
+                const uint32_t parent_id = (event.depth > 0 && event.depth <= parent_count) ? parents[event.depth - 1] : 0;
+                parents[event.depth]     = id;
+                parent_count             = event.depth + 1;
+
+                m_time_blocks_read.emplace_back();
+                m_time_blocks_read.back().Record(
+                    id,
+                    event.name,
+                    lane_index + 1,
+                    parent_id,
+                    event.depth,
+                    GetCpuOffsetMs(event.start),
+                    GetCpuOffsetMs(event.end),
+                    event.counters
+                );
+            }
+        }
+    }
+
     void Profiler::TimeBlockStart(const char* func_name, TimeBlockType type, RHI_CommandList* cmd_list /*= nullptr*/, RHI_Queue_Type queue_type /*= RHI_Queue_Type::Max*/)
     {
-        if (
-            !poll ||
-            this_thread::get_id() !=
-                profiling_thread_id
-        )
+        // other threads only time cpu blocks, into their own lane
+        if (this_thread::get_id() != profiling_thread_id)
+        {
+            if (type == TimeBlockType::Cpu)
+            {
+                thread_scope_begin(func_name);
+            }
+            return;
+        }
+
+        if (!poll)
         {
             return;
         }
 
         if (
-            capture_this_frame &&
+            (
+                capture_this_frame ||
+                trace_this_frame
+            ) &&
             !capture_gpu_sample_this_frame &&
             type == TimeBlockType::Gpu
         )
@@ -1484,11 +1897,12 @@ namespace spartan
 
     void Profiler::TimeBlockEnd(TimeBlockType type /*= TimeBlockType::Max*/, RHI_CommandList* cmd_list /*= nullptr*/)
     {
-        if (
-            this_thread::get_id() !=
-            profiling_thread_id
-        )
+        if (this_thread::get_id() != profiling_thread_id)
         {
+            if (type != TimeBlockType::Gpu)
+            {
+                thread_scope_end();
+            }
             return;
         }
 
@@ -1692,16 +2106,58 @@ namespace spartan
             );
             SP_ASSERT(offset < sizeof(metrics_buffer));
 
-            // memory
+            // world, play mode boot is spread over frames so a single frame time never shows it
+            offset += snprintf(metrics_buffer + offset, sizeof(metrics_buffer) - offset,
+                "World\n"
+                "Play boot:\t%.2f ms (%u frames)\n\n",
+                m_play_boot_ms,
+                m_play_boot_frames);
+            SP_ASSERT(offset < sizeof(metrics_buffer));
+
+            // geometry, occupancy of each pool in elements and how splintered its free space is
+            static const char* pool_names[] = { "Vertices:\t", "Indices:\t", "Meshlets:\t", "Meshlet verts:", "Meshlet tris:", "Instances:\t" };
+            static_assert(size(pool_names) == static_cast<size_t>(GeometryPool::Max));
+            offset += snprintf(metrics_buffer + offset, sizeof(metrics_buffer) - offset, "Geometry\n");
+            for (uint32_t i = 0; i < static_cast<uint32_t>(GeometryPool::Max); i++)
+            {
+                const RangeAllocatorStats stats = GeometryBuffer::GetStats(static_cast<GeometryPool>(i));
+                offset += snprintf(metrics_buffer + offset, sizeof(metrics_buffer) - offset,
+                    "%s\t%u/%u (Largest free: %u, Fragmentation: %.0f%%)\n",
+                    pool_names[i],
+                    stats.used,
+                    stats.capacity,
+                    stats.largest_free,
+                    stats.GetFragmentation() * 100.0f);
+            }
+            offset += snprintf(metrics_buffer + offset, sizeof(metrics_buffer) - offset, "\n");
+            SP_ASSERT(offset < sizeof(metrics_buffer));
+
+            // memory, allocations per frame are averaged over the allocator's history
+            FrameAllocationStats allocation_history[256];
+            const uint32_t allocation_frames = Allocator::GetFrameAllocationHistory(allocation_history, 256);
+            uint64_t allocations_sum         = 0;
+            uint32_t allocations_max         = 0;
+            for (uint32_t i = 0; i < allocation_frames; i++)
+            {
+                allocations_sum += allocation_history[i].count;
+                allocations_max  = max(allocations_max, allocation_history[i].count);
+            }
+            const FrameAllocationStats allocations_last = Allocator::GetFrameAllocations();
+
             offset += snprintf(metrics_buffer + offset, sizeof(metrics_buffer) - offset,
                 "Memory\n"
                 "Allocated:\t%.2f MB (Peak: %.2f MB)\n"
-                "Process:\t\t%.2f MB (Avail: %.2f MB, Total: %.2f MB)\n\n",
+                "Process:\t\t%.2f MB (Avail: %.2f MB, Total: %.2f MB)\n"
+                "Allocations:\t%u/frame, %.1f KB (Avg: %.0f, Max: %u)\n\n",
                 Allocator::GetMemoryAllocatedMb(),
                 Allocator::GetMemoryAllocatedPeakMb(),
                 Allocator::GetMemoryProcessUsedMb(),
                 Allocator::GetMemoryAvailableMb(),
-                Allocator::GetMemoryTotalMb());
+                Allocator::GetMemoryTotalMb(),
+                allocations_last.count,
+                static_cast<double>(allocations_last.bytes) / 1024.0,
+                allocation_frames ? static_cast<double>(allocations_sum) / allocation_frames : 0.0,
+                allocations_max);
             SP_ASSERT(offset < sizeof(metrics_buffer));
 
             // display
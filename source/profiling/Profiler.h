@@ -79,8 +79,20 @@ namespace spartan
         static const std::string& GetRecordingFilePath();
         static const std::string& GetRecordingError();
 
+        // trace capture, streams the next n frames into a chrome trace event json file
+        static bool StartTrace(uint32_t frame_count);
+        static void StopTrace();
+        static bool IsTracing();
+        static uint64_t GetTracedFrameCount();
+        static const std::string& GetTraceFilePath();
+
         // timeline helpers
         static float GetCpuOffsetMs(const std::chrono::high_resolution_clock::time_point& time_point);
+
+        // thread lanes, lane 0 is the main thread, every other thread that records a cpu block gets its own
+        static uint32_t GetThreadLaneCount();
+        static const char* GetThreadLaneName(uint32_t lane);
+        static uint32_t GetThreadEventsDropped();
         
         // metrics - rhi
         static uint32_t m_rhi_draw;
@@ -103,8 +115,13 @@ namespace spartan
         static uint32_t m_rhi_descriptor_set_count;
         static uint32_t m_rhi_timestamps_dropped;
 
+        // metrics - world, the last play mode boot
+        static float m_play_boot_ms;
+        static uint32_t m_play_boot_frames;
+
     private:
         static void ReadTimeBlocks();
+        static void ReadThreadLanes();
 
         static void ClearRhiMetrics()
         {
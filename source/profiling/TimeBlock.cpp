@@ -68,6 +68,14 @@ namespace spartan
                 0;
         m_max_tree_depth        = max(m_max_tree_depth, m_tree_depth);
 
+        m_counters              = HardwareCounterValues();
+
+        // counters first so they exclude the clock read, the clock excludes the counter read
+        if (type == TimeBlockType::Cpu && HardwareCounters::IsEnabled())
+        {
+            HardwareCounters::Read(m_counters);
+        }
+
         // record cpu time for timeline position
         m_start    = chrono::high_resolution_clock::now();
         m_start_ms = Profiler::GetCpuOffsetMs(m_start);
@@ -83,6 +91,16 @@ namespace spartan
         if (m_type == TimeBlockType::Cpu)
         {
             m_end = chrono::high_resolution_clock::now();
+
+            HardwareCounterValues counters_end;
+            if (m_counters.valid_mask != 0 && HardwareCounters::Read(counters_end))
+            {
+                m_counters = counters_end.Delta(m_counters);
+            }
+            else
+            {
+                m_counters = HardwareCounterValues();
+            }
         }
         else if (m_type == TimeBlockType::Gpu)
         {
@@ -106,6 +124,31 @@ namespace spartan
         m_is_complete = true;
     }
 
+    void TimeBlock::Record(
+        const uint32_t id,
+        const char* name,
+        const uint32_t thread_lane,
+        const uint32_t parent_id,
+        const uint32_t tree_depth,
+        const float start_ms,
+        const float end_ms,
+        const HardwareCounterValues& counters
+    )
+    {
+        m_id             = id;
+        m_name           = name;
+        m_type           = TimeBlockType::Cpu;
+        m_thread_lane    = thread_lane;
+        m_parent_id      = parent_id;
+        m_tree_depth     = tree_depth;
+        m_start_ms       = start_ms;
+        m_end_ms         = end_ms;
+        m_duration       = end_ms - start_ms;
+        m_counters       = counters;
+        m_is_complete    = true;
+        m_max_tree_depth = max(m_max_tree_depth, m_tree_depth);
+    }
+
     void TimeBlock::ResolveGpuTimestamps(uint64_t global_reference_tick, float timestamp_period, uint64_t end_tick_override /*= 0*/)
     {
         if (m_type != TimeBlockType::Gpu || !m_cmd_list)
@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ======================
 #include <chrono>
+#include "HardwareCounters.h"
 #include "../rhi/RHI_Definitions.h"
 //=================================
 
@@ -52,6 +53,19 @@ namespace spartan
                 RHI_Queue_Type::Max
         );
         void End();
+
+        // a cpu block that was timed on another thread and is complete already
+        void Record(
+            uint32_t id,
+            const char* name,
+            uint32_t thread_lane,
+            uint32_t parent_id,
+            uint32_t tree_depth,
+            float start_ms,
+            float end_ms,
+            const HardwareCounterValues& counters = HardwareCounterValues()
+        );
+
         void ResolveGpuTimestamps(uint64_t global_reference_tick, float timestamp_period, uint64_t end_tick_override = 0);
         void ResolveGpuDuration(uint64_t end_tick_override = 0);
 
@@ -68,8 +82,10 @@ namespace spartan
         float GetEndMs()               const { return m_end_ms; }
         RHI_Queue_Type GetQueueType()  const { return m_queue_type; }
         RHI_CommandList* GetCmdList()  const { return m_cmd_list; }
+        uint32_t GetThreadLane()       const { return m_thread_lane; }
         uint32_t GetTimestampIndexStart() const { return m_timestamp_index_start; }
         uint32_t GetTimestampIndexEnd()   const { return m_timestamp_index_end; }
+        const HardwareCounterValues& GetCounters() const { return m_counters; }
 
     private:    
         static uint32_t m_max_tree_depth;
@@ -88,6 +104,7 @@ namespace spartan
         float m_start_ms           = 0.0f;
         float m_end_ms             = 0.0f;
         RHI_Queue_Type m_queue_type = RHI_Queue_Type::Max;
+        uint32_t m_thread_lane      = 0; // 0 is the main thread, see Profiler::GetThreadLaneName()
 
         // dependencies
         RHI_CommandList* m_cmd_list = nullptr;
@@ -95,5 +112,8 @@ namespace spartan
         // cpu timing
         std::chrono::high_resolution_clock::time_point m_start;
         std::chrono::high_resolution_clock::time_point m_end;
+
+        // hardware counters, the values at begin until the block ends, then the counts of the block
+        HardwareCounterValues m_counters;
     };
 }
@@ -0,0 +1,324 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ================
+#include "pch.h"
+#include "TraceWriter.h"
+#include "Profiler.h"
+#include <condition_variable>
+#include <fstream>
+#include <thread>
+//===========================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace spartan
+{
+    namespace
+    {
+        enum class trace_category : uint8_t
+        {
+            Cpu,
+            Gpu,
+            Frame
+        };
+
+        // process ids in the trace, cpu threads and gpu queues show up as two separate groups
+        const uint32_t pid_cpu = 1;
+        const uint32_t pid_gpu = 2;
+
+        struct trace_event
+        {
+            double start_us;
+            float duration_us;
+            uint32_t name; // index into the name table, or the frame number for frame events
+            uint16_t tid;
+            trace_category category;
+        };
+
+        struct trace_batch
+        {
+            vector<trace_event> events;
+            vector<string> names; // names first seen in this batch, they extend the writer's table in order
+
+            bool empty() const { return events.empty() && names.empty(); }
+            void clear() { events.clear(); names.clear(); }
+        };
+
+        // main thread
+        bool active = false;
+        trace_batch batch_main;
+        unordered_map<const char*, uint32_t> name_ids;
+
+        // shared
+        mutex batch_mutex;
+        condition_variable batch_condition;
+        trace_batch batch_pending;
+        bool writer_stop = false;
+        atomic<bool> write_failed = false;
+
+        // writer thread
+        thread writer;
+        ofstream stream;
+        trace_batch batch_writing;
+        vector<string> names_written;
+        string text;
+        bool first_event = true;
+
+        // flushing once the text grows past this keeps the number of writes low
+        const size_t text_flush_size = 1024 * 1024;
+
+        string escape(const char* value)
+        {
+            string escaped;
+            for (const char* c = value ? value : "N/A"; *c; c++)
+            {
+                if (*c == '"' || *c == '\\')
+                {
+                    escaped += '\\';
+                    escaped += *c;
+                }
+                else if (static_cast<unsigned char>(*c) >= 0x20)
+                {
+                    escaped += *c;
+                }
+            }
+            return escaped;
+        }
+
+        void append_separator()
+        {
+            text += first_event ? "\n" : ",\n";
+            first_event = false;
+        }
+
+        void append_event(const trace_event& event)
+        {
+            char buffer[128];
+            append_separator();
+            if (event.category == trace_category::Frame)
+            {
+                snprintf(buffer, sizeof(buffer), "{\"name\":\"frame\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":%u,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%u}}",
+                    pid_cpu, event.start_us, event.duration_us, event.name);
+                text += buffer;
+                return;
+            }
+
+            const bool is_gpu = event.category == trace_category::Gpu;
+            text += "{\"name\":\"";
+            text += names_written[event.name];
+            snprintf(buffer, sizeof(buffer), "\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                is_gpu ? "gpu" : "cpu", is_gpu ? pid_gpu : pid_cpu, static_cast<uint32_t>(event.tid), event.start_us, event.duration_us);
+            text += buffer;
+        }
+
+        void append_metadata(const char* type, const uint32_t pid, const uint32_t tid, const char* name)
+        {
+            char buffer[96];
+            append_separator();
+            snprintf(buffer, sizeof(buffer), "{\"name\":\"%s\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"", type, pid, tid);
+            text += buffer;
+            text += escape(name);
+            text += "\"}}";
+        }
+
+        void write_text()
+        {
+            if (text.empty())
+            {
+                return;
+            }
+
+            stream.write(text.data(), static_cast<streamsize>(text.size()));
+            if (!stream.good())
+            {
+                write_failed.store(true, memory_order_relaxed);
+            }
+            text.clear();
+        }
+
+        void writer_loop()
+        {
+            while (true)
+            {
+                {
+                    unique_lock<mutex> lock(batch_mutex);
+                    batch_condition.wait(lock, [] { return writer_stop || !batch_pending.empty(); });
+                    if (batch_pending.empty())
+                    {
+                        break;
+                    }
+                    swap(batch_pending, batch_writing);
+                }
+
+                for (const string& name : batch_writing.names)
+                {
+                    names_written.push_back(escape(name.c_str()));
+                }
+
+                for (const trace_event& event : batch_writing.events)
+                {
+                    append_event(event);
+                }
+                batch_writing.clear();
+
+                if (text.size() >= text_flush_size)
+                {
+                    write_text();
+                }
+            }
+
+            write_text();
+        }
+
+        uint32_t get_name_id(const char* name)
+        {
+            auto it = name_ids.find(name);
+            if (it != name_ids.end())
+            {
+                return it->second;
+            }
+
+            // names are static strings, so interning by pointer is enough, the writer keeps its own copy
+            const uint32_t id = static_cast<uint32_t>(name_ids.size());
+            name_ids[name]    = id;
+            batch_main.names.emplace_back(name ? name : "N/A");
+            return id;
+        }
+    }
+
+    bool TraceWriter::Begin(const string& file_path)
+    {
+        if (active)
+        {
+            return false;
+        }
+
+        stream.open(file_path, ios::binary | ios::out | ios::trunc);
+        if (!stream.is_open())
+        {
+            SP_LOG_ERROR("failed to open trace file %s", file_path.c_str());
+            return false;
+        }
+
+        name_ids.clear();
+        names_written.clear();
+        batch_main.clear();
+        batch_pending.clear();
+        batch_writing.clear();
+        text.clear();
+        text.reserve(text_flush_size * 2);
+        first_event  = true;
+        writer_stop  = false;
+        write_failed = false;
+
+        text = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        writer = thread(writer_loop);
+        active = true;
+
+        return true;
+    }
+
+    void TraceWriter::AppendFrame(const uint64_t frame, const double frame_start_us, const float frame_duration_ms, const vector<TimeBlock>& blocks)
+    {
+        if (!active)
+        {
+            return;
+        }
+
+        batch_main.events.push_back({ frame_start_us, frame_duration_ms * 1000.0f, static_cast<uint32_t>(frame), 0, trace_category::Frame });
+        for (const TimeBlock& block : blocks)
+        {
+            if (!block.IsComplete())
+            {
+                continue;
+            }
+
+            // gpu blocks are relative to the first gpu timestamp of the frame, there is no calibrated cpu/gpu clock
+            // so they are laid out from the start of the cpu frame, durations and the order within a queue are exact
+            const bool is_gpu = block.GetType() == TimeBlockType::Gpu;
+            trace_event event;
+            event.start_us    = frame_start_us + static_cast<double>(block.GetStartMs()) * 1000.0;
+            event.duration_us = block.GetDuration() * 1000.0f;
+            event.name        = get_name_id(block.GetName());
+            event.tid         = static_cast<uint16_t>(is_gpu ? static_cast<uint32_t>(block.GetQueueType()) : block.GetThreadLane());
+            event.category    = is_gpu ? trace_category::Gpu : trace_category::Cpu;
+            batch_main.events.push_back(event);
+        }
+
+        // hand the batch over, if the writer is still busy with the previous one keep appending to it
+        {
+            lock_guard<mutex> lock(batch_mutex);
+            if (batch_pending.empty())
+            {
+                swap(batch_pending, batch_main);
+            }
+            else
+            {
+                batch_pending.events.insert(batch_pending.events.end(), batch_main.events.begin(), batch_main.events.end());
+                batch_pending.names.insert(batch_pending.names.end(), batch_main.names.begin(), batch_main.names.end());
+            }
+        }
+        batch_main.clear();
+        batch_condition.notify_one();
+    }
+
+    bool TraceWriter::End()
+    {
+        if (!active)
+        {
+            return false;
+        }
+
+        {
+            lock_guard<mutex> lock(batch_mutex);
+            writer_stop = true;
+        }
+        batch_condition.notify_one();
+        writer.join();
+        active = false;
+
+        // thread and queue names, the viewers apply these wherever they appear in the event list
+        append_metadata("process_name", pid_cpu, 0, "CPU");
+        append_metadata("process_name", pid_gpu, 0, "GPU");
+        for (uint32_t lane = 0; lane < Profiler::GetThreadLaneCount(); lane++)
+        {
+            append_metadata("thread_name", pid_cpu, lane, Profiler::GetThreadLaneName(lane));
+        }
+        append_metadata("thread_name", pid_gpu, static_cast<uint32_t>(RHI_Queue_Type::Graphics), "Graphics");
+        append_metadata("thread_name", pid_gpu, static_cast<uint32_t>(RHI_Queue_Type::Compute),  "Compute");
+        append_metadata("thread_name", pid_gpu, static_cast<uint32_t>(RHI_Queue_Type::Copy),     "Copy");
+        text += "\n]}\n";
+        write_text();
+
+        stream.flush();
+        stream.close();
+
+        return !write_failed.load(memory_order_relaxed);
+    }
+
+    bool TraceWriter::IsActive()
+    {
+        return active;
+    }
+}
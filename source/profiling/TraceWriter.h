@@ -0,0 +1,42 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =========
+#include <string>
+#include <vector>
+#include "TimeBlock.h"
+//====================
+
+namespace spartan
+{
+    // streams profiler blocks into a chrome trace event json file, chrome://tracing and ui.perfetto.dev open it as is
+    // the main thread only copies the blocks of a frame into a batch, formatting and file io happen on a background thread
+    class TraceWriter
+    {
+    public:
+        static bool Begin(const std::string& file_path);
+        static void AppendFrame(uint64_t frame, double frame_start_us, float frame_duration_ms, const std::vector<TimeBlock>& blocks);
+        static bool End();
+        static bool IsActive();
+    };
+}
@@ -23,9 +23,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "pch.h"
 #include "GeometryBuffer.h"
 #include "../rhi/RHI_Buffer.h"
+#include "../rhi/RHI_CommandList.h"
 #include "../rhi/RHI_Device.h"
 #include <algorithm>
 #include <mutex>
+#include <unordered_map>
 //===============================
 
 //= NAMESPACES =====
@@ -36,17 +38,8 @@ namespace spartan
 {
     namespace
     {
-        // cpu-side accumulators
-        // meshlet_micro_indices stays one corner per element here, the gpu copy packs four corners per uint
-        vector<RHI_Vertex_PosTexNorTan> vertices;
-        vector<uint32_t> indices;
-        vector<Sb_MeshletBounds> meshlet_bounds;
-        vector<uint32_t> meshlet_vertices;
-        vector<uint32_t> meshlet_micro_indices;
-        vector<Instance> instances;
-
         // micro index packing, a corner is a meshlet local vertex id below MESHLET_MAX_VERTICES so a byte is enough
-        // every append pads to a multiple of this so a mesh block never straddles a uint and sub-region uploads stay aligned
+        // every block is padded to a multiple of this so it never straddles a uint and sub-region uploads stay aligned
         constexpr uint32_t micro_indices_per_uint = 4;
 
         uint32_t packed_micro_count(const uint32_t corner_count)
@@ -66,593 +59,565 @@ namespace spartan
             }
         }
 
-        // gpu buffers
-        unique_ptr<RHI_Buffer> vertex_buffer;
-        unique_ptr<RHI_Buffer> index_buffer;
-        unique_ptr<RHI_Buffer> meshlet_bounds_buffer;
-        unique_ptr<RHI_Buffer> meshlet_vertex_buffer;
-        unique_ptr<RHI_Buffer> meshlet_micro_index_buffer;
-        unique_ptr<RHI_Buffer> instance_buffer;
-
-        // element counts already uploaded to the gpu
-        uint32_t vertex_count_committed              = 0;
-        uint32_t index_count_committed               = 0;
-        uint32_t meshlet_bounds_count_committed      = 0;
-        uint32_t meshlet_vertex_count_committed      = 0;
-        uint32_t meshlet_micro_count_committed       = 0;
-        uint32_t instance_count_committed            = 0;
-
-        // actual gpu buffer element counts, only written after a successful alloc
-        uint32_t vertex_capacity         = 0;
-        uint32_t index_capacity          = 0;
-        uint32_t meshlet_bounds_capacity = 0;
-        uint32_t meshlet_vertex_capacity = 0;
-        uint32_t meshlet_micro_capacity  = 0;
-        uint32_t instance_capacity       = 0;
-
-        // requested floors from Reserve, must not overwrite the gpu sizes above
-        uint32_t vertex_reserve         = 0;
-        uint32_t index_reserve          = 0;
-        uint32_t meshlet_bounds_reserve = 0;
-        uint32_t meshlet_vertex_reserve = 0;
-        uint32_t meshlet_micro_reserve  = 0;
-        uint32_t instance_reserve       = 0;
-
-        bool dirty       = false;
-        bool was_rebuilt = false;
-        mutex buffer_mutex;
-
-        // hard-cap learned from previous oom failures, prevents retrying ever-larger allocations every frame
-        // once set, AppendInstances drops new instances and BuildIfDirty stops attempting to grow past it
-        uint32_t instance_capacity_failed_at = 0;
+        // one allocation of a pool, keyed by its offset
+        struct Block
+        {
+            RangeAllocation allocation;
+            uint32_t references = 1;
+            uint32_t declines   = 0;
+            GeometryRelocation relocate; // empty for pinned blocks
+        };
+
+        // a staged write waiting for the next BuildIfDirty
+        struct PendingUpload
+        {
+            uint64_t byte_offset    = 0; // into the gpu buffer
+            uint64_t staging_offset = 0;
+            uint64_t byte_size      = 0;
+        };
+
+        struct Pool
+        {
+            const char* name     = nullptr;
+            RHI_Buffer_Type type = RHI_Buffer_Type::Max;
+            uint32_t stride      = 0;
+
+            unique_ptr<RHI_Buffer> buffer;
+            RangeAllocator allocator;              // in buffer elements, runs ahead of the buffer so appends never wait for it
+            unordered_map<uint32_t, Block> blocks; // keyed by element offset
+            vector<uint8_t> staging;               // bytes written since the last flush, the only cpu copy the pool keeps
+            vector<PendingUpload> uploads;
+            uint32_t reserve            = 0;
+            uint32_t capacity_failed_at = 0;       // learned from an oom, growing to or past it is not retried
+        };
+
+        array<Pool, static_cast<size_t>(GeometryPool::Max)> pools =
+        {{
+            { "geometry_buffer_vertex",                RHI_Buffer_Type::Vertex,   sizeof(RHI_Vertex_PosTexNorTan) },
+            { "geometry_buffer_index",                 RHI_Buffer_Type::Index,    sizeof(uint32_t)                },
+            { "geometry_buffer_meshlet_bounds",        RHI_Buffer_Type::Storage,  sizeof(Sb_MeshletBounds)        },
+            { "geometry_buffer_meshlet_vertices",      RHI_Buffer_Type::Storage,  sizeof(uint32_t)                },
+            { "geometry_buffer_meshlet_micro_indices", RHI_Buffer_Type::Storage,  sizeof(uint32_t)                },
+            { "geometry_buffer_instances",             RHI_Buffer_Type::Instance, sizeof(Instance)                }
+        }};
+
+        Pool& get_pool(const GeometryPool pool)
+        {
+            return pools[static_cast<size_t>(pool)];
+        }
+
+        // the micro index pool allocates packed uints but hands out offsets in corners
+        uint32_t units_per_element(const GeometryPool pool)
+        {
+            return pool == GeometryPool::MeshletMicro ? micro_indices_per_uint : 1;
+        }
+
+        // frames in flight may still read a freed block, its range goes back to the allocator this many builds later
+        struct PendingFree
+        {
+            GeometryPool pool;
+            RangeAllocation allocation;
+            uint64_t build_index;
+        };
+        vector<PendingFree> pending_frees;
+        uint64_t build_index          = 0;
+        constexpr uint64_t free_delay = 4;
+
+        bool was_rebuilt   = false;
+        bool was_relocated = false;
+
+        // recursive because relocation callbacks run under it and write through the Update* functions
+        recursive_mutex buffer_mutex;
 
         // logs the oom error exactly once per session so async grass tile arrivals don't spam the same message
         bool oom_logged = false;
 
-        // growth factor applied when allocating gpu buffers
-        constexpr float growth_factor = 1.25f;
+        // growth factor applied when extending a pool
+        // a flat 25% headroom on a multi-gb instance buffer wastes hundreds of mb, so the slack is clamped
+        constexpr float growth_factor      = 1.25f;
+        constexpr uint64_t max_slack_bytes = 64ull * 1024ull * 1024ull;
 
-        // deferred vertex uploads
-        //
-        // UploadSubRegion on a device local buffer stages and submits an immediate copy, which
-        // costs a queue submit and a wait. one skinned character per frame is fine, a crowd is not,
-        // so writes only touch the cpu mirror and record a range. the frame flush coalesces them
-        // into a handful of copies
-        struct DirtyRange
+        uint32_t add_headroom(const uint64_t count, const uint64_t stride)
         {
-            uint32_t offset = 0;
-            uint32_t count  = 0;
-        };
-        vector<DirtyRange> vertex_dirty_ranges;
+            uint64_t grown_count = static_cast<uint64_t>(static_cast<double>(count) * static_cast<double>(growth_factor));
+            if ((grown_count - count) * stride > max_slack_bytes)
+            {
+                grown_count = count + max_slack_bytes / max<uint64_t>(stride, 1);
+            }
 
-        // two ranges closer than this merge into one, re-uploading the untouched gap is far cheaper
-        // than a second submit
-        constexpr uint32_t dirty_merge_slack = 4096;
+            return static_cast<uint32_t>(min<uint64_t>(grown_count, UINT32_MAX - 1));
+        }
 
-        void flush_vertex_updates()
+        // moving a block costs a re-upload from its owner, this caps the bytes moved per build
+        uint64_t defrag_budget_bytes = 4ull * 1024ull * 1024ull;
+        // a pool with fewer holes than this share of its used span is left alone
+        constexpr uint32_t defrag_hole_divisor = 8;
+        // pinned blocks are stepped over, this bounds the walk when the top of a pool is all pinned
+        constexpr uint32_t defrag_max_visits = 64;
+        // an owner that keeps declining is pinned, so it doesn't stall the blocks below it forever
+        constexpr uint32_t defrag_max_declines = 16;
+
+        // small flushes are recorded on the frame command list, anything larger goes through staged copies
+        constexpr uint64_t inline_upload_max_bytes = 1024ull * 1024ull;
+        // staging keeps its memory for the per-frame deformable traffic, a load's worth is released after the flush
+        constexpr size_t staging_keep_bytes = 4 * 1024 * 1024;
+
+        void stage(Pool& pool, const uint64_t byte_offset, const void* data, const uint64_t byte_size)
         {
-            if (vertex_dirty_ranges.empty())
+            if (byte_size == 0)
             {
                 return;
             }
 
-            if (!vertex_buffer)
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            pool.uploads.push_back({ byte_offset, pool.staging.size(), byte_size });
+            pool.staging.insert(pool.staging.end(), bytes, bytes + byte_size);
+        }
+
+        uint32_t allocate(Pool& pool, const uint32_t count, GeometryRelocation&& relocate)
+        {
+            RangeAllocation allocation = pool.allocator.Allocate(count);
+            if (!allocation.IsValid())
             {
-                vertex_dirty_ranges.clear();
-                return;
+                // extend the range with headroom, the gpu buffer catches up in the next BuildIfDirty
+                // tlsf rounds a request up to the next bin, which adds at most an eighth
+                const uint64_t needed = max<uint64_t>(
+                    static_cast<uint64_t>(pool.allocator.GetHighWater()) + count + count / 8 + 1,
+                    pool.reserve
+                );
+                pool.allocator.Grow(add_headroom(needed, pool.stride));
+                allocation = pool.allocator.Allocate(count);
+            }
+            SP_ASSERT(allocation.IsValid());
+
+            pool.blocks[allocation.offset] = { allocation, 1, 0, move(relocate) };
+            return allocation.offset;
+        }
+
+        uint32_t append(const GeometryPool pool_id, const void* data, const uint32_t count, GeometryRelocation&& relocate)
+        {
+            if (count == 0)
+            {
+                return 0;
             }
 
-            sort(
-                vertex_dirty_ranges.begin(),
-                vertex_dirty_ranges.end(),
-                [](const DirtyRange& a, const DirtyRange& b)
+            Pool& pool            = get_pool(pool_id);
+            const uint32_t offset = allocate(pool, count, move(relocate));
+            stage(pool, static_cast<uint64_t>(offset) * pool.stride, data, static_cast<uint64_t>(count) * pool.stride);
+
+            return offset;
+        }
+
+        void update(const GeometryPool pool_id, const void* data, const uint32_t offset, const uint32_t count)
+        {
+            Pool& pool = get_pool(pool_id);
+            SP_ASSERT(static_cast<uint64_t>(offset) + count <= pool.allocator.GetCapacity());
+            stage(pool, static_cast<uint64_t>(offset) * pool.stride, data, static_cast<uint64_t>(count) * pool.stride);
+        }
+
+        // seed slot 0 with an identity instance so non-instanced draws can read identity at offset 0, it is never freed
+        void ensure_identity_instance()
+        {
+            if (get_pool(GeometryPool::Instance).blocks.empty())
+            {
+                const Instance identity = Instance::GetIdentity();
+                append(GeometryPool::Instance, &identity, 1, nullptr);
+            }
+        }
+
+        void release_pending_frees()
+        {
+            size_t kept = 0;
+            for (const PendingFree& pending : pending_frees)
+            {
+                if (build_index - pending.build_index >= free_delay)
                 {
-                    return a.offset < b.offset;
+                    get_pool(pending.pool).allocator.Free(pending.allocation);
                 }
-            );
+                else
+                {
+                    pending_frees[kept++] = pending;
+                }
+            }
+            pending_frees.resize(kept);
+        }
 
-            uint32_t begin = vertex_dirty_ranges[0].offset;
-            uint32_t end   = begin + vertex_dirty_ranges[0].count;
+        bool grow_buffer(Pool& pool, bool& queues_idle)
+        {
+            const uint32_t capacity = max({ pool.allocator.GetCapacity(), pool.reserve, 1u });
+            if (pool.buffer && pool.buffer->GetElementCount() >= capacity)
+            {
+                return false;
+            }
+
+            if (pool.capacity_failed_at != 0 && capacity >= pool.capacity_failed_at)
+            {
+                return false;
+            }
 
-            auto upload = [](const uint32_t first, const uint32_t last)
+            auto buffer = make_unique<RHI_Buffer>(pool.type, pool.stride, capacity, nullptr, false, pool.name);
+            if (!buffer->GetRhiResource())
             {
-                if (last <= first || last > vertex_count_committed)
+                // log once per session, Shutdown() resets the flag so the next world-load gets its own fresh log
+                if (!oom_logged)
                 {
-                    return;
+                    SP_LOG_ERROR("Failed to allocate %s with %u elements (%.2f MB), the world is too large for the available device memory, writes past the current capacity are dropped",
+                        pool.name, capacity, (static_cast<uint64_t>(capacity) * pool.stride) / (1024.0f * 1024.0f));
+                    oom_logged = true;
                 }
 
-                const uint64_t byte_offset = static_cast<uint64_t>(first) * sizeof(RHI_Vertex_PosTexNorTan);
-                const uint64_t byte_size   = static_cast<uint64_t>(last - first) * sizeof(RHI_Vertex_PosTexNorTan);
-                vertex_buffer->UploadSubRegion(vertices.data() + first, byte_offset, byte_size);
-            };
+                pool.capacity_failed_at = capacity;
+                return false;
+            }
 
-            for (size_t i = 1; i < vertex_dirty_ranges.size(); ++i)
+            // carry resident blocks over with a gpu copy, the old buffer goes through the deletion queue
+            if (pool.buffer)
             {
-                const DirtyRange& range = vertex_dirty_ranges[i];
-                if (range.offset <= end + dirty_merge_slack)
+                const uint64_t copy_size = static_cast<uint64_t>(min(pool.allocator.GetHighWater(), pool.buffer->GetElementCount())) * pool.stride;
+                if (copy_size > 0)
                 {
-                    end = max(end, range.offset + range.count);
-                    continue;
+                    // earlier frames may still be reading or writing the old buffer
+                    if (!queues_idle)
+                    {
+                        RHI_Device::QueueWaitAll();
+                        queues_idle = true;
+                    }
+
+                    if (RHI_CommandList* cmd_list = RHI_CommandList::ImmediateExecutionBegin(RHI_Queue_Type::Graphics))
+                    {
+                        RHI_CommandList::CopyBufferToBuffer(cmd_list, pool.buffer.get(), buffer.get(), copy_size);
+                        RHI_CommandList::ImmediateExecutionEnd(cmd_list);
+                    }
                 }
-
-                upload(begin, end);
-                begin = range.offset;
-                end   = range.offset + range.count;
             }
 
-            upload(begin, end);
-            vertex_dirty_ranges.clear();
+            pool.buffer = move(buffer);
+            return true;
         }
-    }
 
-    uint32_t GeometryBuffer::AppendVertices(const RHI_Vertex_PosTexNorTan* data, uint32_t count)
-    {
-        lock_guard<mutex> lock(buffer_mutex);
+        // moves relocatable blocks from the top of a pool into lower holes, so freed space consolidates at the end
+        // the owner re-uploads its block at the new offset and the old range is recycled once frames in flight are done
+        void defragment(const GeometryPool pool_id, uint64_t& budget_bytes)
+        {
+            Pool& pool                = get_pool(pool_id);
+            RangeAllocator& allocator = pool.allocator;
+            const uint32_t high_water = allocator.GetHighWater();
+            if (!pool.buffer || high_water - allocator.GetUsed() <= high_water / defrag_hole_divisor)
+            {
+                return;
+            }
 
-        uint32_t base_offset = static_cast<uint32_t>(vertices.size());
-        vertices.insert(vertices.end(), data, data + count);
-        dirty = true;
+            uint32_t node = allocator.GetLastNode();
+            for (uint32_t visits = 0; node != RangeAllocator::invalid && visits < defrag_max_visits; visits++)
+            {
+                uint32_t node_previous = allocator.GetPreviousNode(node);
 
-        return base_offset;
-    }
+                // free space, a pinned or shared block, or a range that is waiting to be recycled
+                auto it = allocator.IsNodeUsed(node) ? pool.blocks.find(allocator.GetNodeOffset(node)) : pool.blocks.end();
+                if (it == pool.blocks.end() || !it->second.relocate || it->second.references > 1)
+                {
+                    node = node_previous;
+                    continue;
+                }
 
-    uint32_t GeometryBuffer::AppendIndices(const uint32_t* data, uint32_t count)
-    {
-        lock_guard<mutex> lock(buffer_mutex);
+                const uint32_t count      = allocator.GetNodeSize(node);
+                const uint64_t byte_size  = static_cast<uint64_t>(count) * pool.stride;
+                if (byte_size > budget_bytes)
+                {
+                    return;
+                }
 
-        uint32_t base_offset = static_cast<uint32_t>(indices.size());
-        indices.insert(indices.end(), data, data + count);
-        dirty = true;
+                // nothing below fits, the top of the pool is as compact as it gets for now
+                RangeAllocation target = allocator.Allocate(count);
+                if (!target.IsValid() || target.offset > it->second.allocation.offset)
+                {
+                    allocator.Free(target);
+                    return;
+                }
 
-        return base_offset;
-    }
+                // a busy owner declines, it's asked again next frame
+                if (!it->second.relocate(target.offset * units_per_element(pool_id)))
+                {
+                    if (++it->second.declines >= defrag_max_declines)
+                    {
+                        it->second.relocate = nullptr;
+                    }
 
-    uint32_t GeometryBuffer::AppendMeshletBounds(const Sb_MeshletBounds* data, uint32_t count)
-    {
-        lock_guard<mutex> lock(buffer_mutex);
+                    allocator.Free(target);
+                    return;
+                }
 
-        uint32_t base_offset = static_cast<uint32_t>(meshlet_bounds.size());
-        if (count > 0)
-        {
-            meshlet_bounds.insert(meshlet_bounds.end(), data, data + count);
-            dirty = true;
-        }
+                pending_frees.push_back({ pool_id, it->second.allocation, build_index });
+                Block block      = move(it->second);
+                block.allocation = target;
+                pool.blocks.erase(it);
+                pool.blocks.emplace(target.offset, move(block));
 
-        return base_offset;
-    }
+                budget_bytes  -= byte_size;
+                was_relocated  = true;
 
-    uint32_t GeometryBuffer::AppendMeshletVertices(const uint32_t* data, uint32_t count)
-    {
-        lock_guard<mutex> lock(buffer_mutex);
+                // the target may have been carved from the free range right below, don't visit it again
+                node = node_previous == target.node ? allocator.GetPreviousNode(node_previous) : node_previous;
+            }
+        }
 
-        uint32_t base_offset = static_cast<uint32_t>(meshlet_vertices.size());
-        if (count > 0)
+        void flush_uploads(Pool& pool, const bool record)
         {
-            meshlet_vertices.insert(meshlet_vertices.end(), data, data + count);
-            dirty = true;
-        }
+            if (pool.uploads.empty())
+            {
+                return;
+            }
 
-        return base_offset;
-    }
+            if (pool.buffer)
+            {
+                // destination order lets neighbours merge into one copy, overlapping writes keep submission order so the last one wins
+                vector<PendingUpload> sorted = pool.uploads;
+                stable_sort(sorted.begin(), sorted.end(), [](const PendingUpload& a, const PendingUpload& b)
+                {
+                    return a.byte_offset < b.byte_offset;
+                });
 
-    uint32_t GeometryBuffer::AppendMeshletMicroIndices(const uint32_t* data, uint32_t count)
-    {
-        lock_guard<mutex> lock(buffer_mutex);
+                bool overlap = false;
+                for (size_t i = 1; i < sorted.size() && !overlap; i++)
+                {
+                    overlap = sorted[i].byte_offset < sorted[i - 1].byte_offset + sorted[i - 1].byte_size;
+                }
+                const vector<PendingUpload>& uploads = overlap ? pool.uploads : sorted;
 
-        uint32_t base_offset = static_cast<uint32_t>(meshlet_micro_indices.size());
-        if (count > 0)
-        {
-            meshlet_micro_indices.insert(meshlet_micro_indices.end(), data, data + count);
+                const uint64_t buffer_size = static_cast<uint64_t>(pool.buffer->GetElementCount()) * pool.stride;
+                for (size_t i = 0; i < uploads.size();)
+                {
+                    // writes that continue each other both in the buffer and in staging go out as one
+                    const uint64_t byte_offset    = uploads[i].byte_offset;
+                    const uint64_t staging_offset = uploads[i].staging_offset;
+                    uint64_t byte_size            = uploads[i].byte_size;
+                    for (i++; i < uploads.size(); i++)
+                    {
+                        if (uploads[i].byte_offset != byte_offset + byte_size || uploads[i].staging_offset != staging_offset + byte_size)
+                        {
+                            break;
+                        }
+                        byte_size += uploads[i].byte_size;
+                    }
+
+                    // past the capacity of a growth that failed
+                    if (byte_offset + byte_size > buffer_size)
+                    {
+                        continue;
+                    }
+
+                    const uint8_t* data = pool.staging.data() + staging_offset;
+                    if (record)
+                    {
+                        RHI_CommandList::UpdateBuffer(pool.buffer.get(), byte_offset, byte_size, data);
+                    }
+                    else
+                    {
+                        pool.buffer->UploadSubRegion(data, byte_offset, byte_size);
+                    }
+                }
+            }
 
-            // pad so the next block starts on a uint boundary, the padding corners are never indexed by a meshlet
-            const size_t remainder = meshlet_micro_indices.size() % micro_indices_per_uint;
-            if (remainder != 0)
+            pool.uploads.clear();
+            pool.staging.clear();
+            if (pool.staging.capacity() > staging_keep_bytes)
             {
-                meshlet_micro_indices.resize(meshlet_micro_indices.size() + (micro_indices_per_uint - remainder), 0u);
+                pool.staging.shrink_to_fit();
             }
-
-            dirty = true;
         }
-
-        return base_offset;
     }
 
-    uint32_t GeometryBuffer::AppendInstances(const Instance* data, uint32_t count)
+    uint32_t GeometryBuffer::AppendVertices(const RHI_Vertex_PosTexNorTan* data, uint32_t count, GeometryRelocation on_relocate)
     {
-        lock_guard<mutex> lock(buffer_mutex);
+        lock_guard<recursive_mutex> lock(buffer_mutex);
+        return append(GeometryPool::Vertex, data, count, move(on_relocate));
+    }
 
-        // seed slot 0 with an identity instance so non-instanced draws can read identity at offset 0
-        if (instances.empty())
-        {
-            instances.push_back(Instance::GetIdentity());
-            dirty = true;
-        }
+    uint32_t GeometryBuffer::AppendIndices(const uint32_t* data, uint32_t count, GeometryRelocation on_relocate)
+    {
+        lock_guard<recursive_mutex> lock(buffer_mutex);
+        return append(GeometryPool::Index, data, count, move(on_relocate));
+    }
 
-        uint32_t base_offset = static_cast<uint32_t>(instances.size());
+    uint32_t GeometryBuffer::AppendMeshletBounds(const Sb_MeshletBounds* data, uint32_t count, GeometryRelocation on_relocate)
+    {
+        lock_guard<recursive_mutex> lock(buffer_mutex);
+        return append(GeometryPool::MeshletBounds, data, count, move(on_relocate));
+    }
 
-        // once an instance oom has been seen, refuse all further appends so the cpu vector never grows past the last gpu-resident size
-        // also avoids the per-frame rebuild + log spam pattern (every async grass tile arrival would otherwise retry an alloc that already failed)
-        if (instance_capacity_failed_at != 0)
-        {
-            return base_offset;
-        }
+    uint32_t GeometryBuffer::AppendMeshletVertices(const uint32_t* data, uint32_t count, GeometryRelocation on_relocate)
+    {
+        lock_guard<recursive_mutex> lock(buffer_mutex);
+        return append(GeometryPool::MeshletVertex, data, count, move(on_relocate));
+    }
 
-        if (count > 0)
-        {
-            instances.insert(instances.end(), data, data + count);
-            dirty = true;
-        }
+    uint32_t GeometryBuffer::AppendMeshletMicroIndices(const uint32_t* data, uint32_t count, GeometryRelocation on_relocate)
+    {
+        // the tail uint is padded, the padding corners are never indexed by a meshlet
+        vector<uint32_t> packed;
+        pack_micro_indices(data, count, packed);
 
-        return base_offset;
+        lock_guard<recursive_mutex> lock(buffer_mutex);
+        const uint32_t offset = append(GeometryPool::MeshletMicro, packed.data(), static_cast<uint32_t>(packed.size()), move(on_relocate));
+        return offset * micro_indices_per_uint;
     }
 
-    void GeometryBuffer::UpdateVertices(const RHI_Vertex_PosTexNorTan* data, uint32_t offset, uint32_t count)
+    uint32_t GeometryBuffer::AppendInstances(const Instance* data, uint32_t count, GeometryRelocation on_relocate)
     {
-        lock_guard<mutex> lock(buffer_mutex);
+        lock_guard<recursive_mutex> lock(buffer_mutex);
 
-        SP_ASSERT(offset + count <= static_cast<uint32_t>(vertices.size()));
-        memcpy(vertices.data() + offset, data, count * sizeof(RHI_Vertex_PosTexNorTan));
+        ensure_identity_instance();
 
-        // queued, the frame flush coalesces every deformable mesh into a few copies
-        if (count > 0 && vertex_buffer && offset + count <= vertex_count_committed)
+        // once growing the instance buffer has failed, new instances read the identity instead of past the end
+        // also avoids the per-frame grow + log spam pattern, every async grass tile arrival would otherwise retry it
+        if (get_pool(GeometryPool::Instance).capacity_failed_at != 0)
         {
-            vertex_dirty_ranges.push_back({ offset, count });
+            return 0;
         }
+
+        return append(GeometryPool::Instance, data, count, move(on_relocate));
+    }
+
+    void GeometryBuffer::UpdateVertices(const RHI_Vertex_PosTexNorTan* data, uint32_t offset, uint32_t count)
+    {
+        lock_guard<recursive_mutex> lock(buffer_mutex);
+        update(GeometryPool::Vertex, data, offset, count);
     }
 
     void GeometryBuffer::UpdateIndices(const uint32_t* data, const uint32_t offset, const uint32_t count)
     {
-        lock_guard<mutex> lock(buffer_mutex);
+        lock_guard<recursive_mutex> lock(buffer_mutex);
+        update(GeometryPool::Index, data, offset, count);
+    }
 
-        SP_ASSERT(offset + count <= static_cast<uint32_t>(indices.size()));
-        memcpy(indices.data() + offset, data, count * sizeof(uint32_t));
+    void GeometryBuffer::UpdateMeshletBounds(const Sb_MeshletBounds* data, const uint32_t offset, const uint32_t count)
+    {
+        lock_guard<recursive_mutex> lock(buffer_mutex);
+        update(GeometryPool::MeshletBounds, data, offset, count);
+    }
 
-        if (index_buffer && offset + count <= index_count_committed)
-        {
-            const uint64_t byte_offset = static_cast<uint64_t>(offset) * sizeof(uint32_t);
-            const uint64_t byte_size   = static_cast<uint64_t>(count) * sizeof(uint32_t);
-            index_buffer->UploadSubRegion(data, byte_offset, byte_size);
-        }
+    void GeometryBuffer::UpdateMeshletVertices(const uint32_t* data, const uint32_t offset, const uint32_t count)
+    {
+        lock_guard<recursive_mutex> lock(buffer_mutex);
+        update(GeometryPool::MeshletVertex, data, offset, count);
     }
 
-    void GeometryBuffer::UpdateMeshletBounds(const Sb_MeshletBounds* data, const uint32_t offset, const uint32_t count)
+    void GeometryBuffer::UpdateMeshletMicroIndices(const uint32_t* data, const uint32_t offset, const uint32_t count)
     {
-        lock_guard<mutex> lock(buffer_mutex);
+        // there is no cpu copy to repack a shared uint from, so writes start on a block boundary
+        SP_ASSERT(offset % micro_indices_per_uint == 0);
 
-        SP_ASSERT(offset + count <= static_cast<uint32_t>(meshlet_bounds.size()));
-        memcpy(meshlet_bounds.data() + offset, data, count * sizeof(Sb_MeshletBounds));
+        vector<uint32_t> packed;
+        pack_micro_indices(data, count, packed);
 
-        if (meshlet_bounds_buffer && offset + count <= meshlet_bounds_count_committed)
-        {
-            const uint64_t byte_offset = static_cast<uint64_t>(offset) * sizeof(Sb_MeshletBounds);
-            const uint64_t byte_size   = static_cast<uint64_t>(count) * sizeof(Sb_MeshletBounds);
-            meshlet_bounds_buffer->UploadSubRegion(data, byte_offset, byte_size);
-        }
+        lock_guard<recursive_mutex> lock(buffer_mutex);
+        update(GeometryPool::MeshletMicro, packed.data(), offset / micro_indices_per_uint, static_cast<uint32_t>(packed.size()));
     }
 
-    void GeometryBuffer::UpdateMeshletVertices(const uint32_t* data, const uint32_t offset, const uint32_t count)
+    void GeometryBuffer::UpdateInstances(const Instance* data, const uint32_t offset, const uint32_t count)
+    {
+        lock_guard<recursive_mutex> lock(buffer_mutex);
+        update(GeometryPool::Instance, data, offset, count);
+    }
+
+    void GeometryBuffer::Free(const GeometryPool pool_id, const uint32_t offset)
     {
-        lock_guard<mutex> lock(buffer_mutex);
+        lock_guard<recursive_mutex> lock(buffer_mutex);
 
-        SP_ASSERT(offset + count <= static_cast<uint32_t>(meshlet_vertices.size()));
-        memcpy(meshlet_vertices.data() + offset, data, count * sizeof(uint32_t));
+        // the identity instance is shared by every non-instanced draw
+        if (pool_id == GeometryPool::Instance && offset == 0)
+        {
+            return;
+        }
 
-        if (meshlet_vertex_buffer && offset + count <= meshlet_vertex_count_committed)
+        // unknown offsets belong to blocks that Shutdown() already released
+        Pool& pool = get_pool(pool_id);
+        auto it    = pool.blocks.find(offset / units_per_element(pool_id));
+        if (it == pool.blocks.end() || --it->second.references > 0)
         {
-            const uint64_t byte_offset = static_cast<uint64_t>(offset) * sizeof(uint32_t);
-            const uint64_t byte_size   = static_cast<uint64_t>(count) * sizeof(uint32_t);
-            meshlet_vertex_buffer->UploadSubRegion(data, byte_offset, byte_size);
+            return;
         }
+
+        pending_frees.push_back({ pool_id, it->second.allocation, build_index });
+        pool.blocks.erase(it);
     }
 
-    void GeometryBuffer::UpdateMeshletMicroIndices(const uint32_t* data, const uint32_t offset, const uint32_t count)
+    void GeometryBuffer::AddReference(const GeometryPool pool_id, const uint32_t offset)
     {
-        lock_guard<mutex> lock(buffer_mutex);
+        lock_guard<recursive_mutex> lock(buffer_mutex);
 
-        SP_ASSERT(offset + count <= static_cast<uint32_t>(meshlet_micro_indices.size()));
-        memcpy(meshlet_micro_indices.data() + offset, data, count * sizeof(uint32_t));
-
-        if (count > 0 && meshlet_micro_index_buffer && offset + count <= meshlet_micro_count_committed)
+        Pool& pool = get_pool(pool_id);
+        auto it    = pool.blocks.find(offset / units_per_element(pool_id));
+        if (it != pool.blocks.end())
         {
-            // repack from the cpu array rather than from data, so the tail uint keeps the block padding that lives past count
-            const uint32_t aligned_offset = (offset / micro_indices_per_uint) * micro_indices_per_uint;
-            const uint32_t aligned_count  = packed_micro_count(offset + count - aligned_offset) * micro_indices_per_uint;
-            const uint32_t clamped_count  = min(aligned_count, static_cast<uint32_t>(meshlet_micro_indices.size()) - aligned_offset);
-
-            vector<uint32_t> packed;
-            pack_micro_indices(meshlet_micro_indices.data() + aligned_offset, clamped_count, packed);
-
-            const uint64_t byte_offset = static_cast<uint64_t>(packed_micro_count(aligned_offset)) * sizeof(uint32_t);
-            const uint64_t byte_size   = static_cast<uint64_t>(packed.size()) * sizeof(uint32_t);
-            meshlet_micro_index_buffer->UploadSubRegion(packed.data(), byte_offset, byte_size);
+            it->second.references++;
         }
     }
 
     void GeometryBuffer::BuildIfDirty()
     {
-        lock_guard<mutex> lock(buffer_mutex);
+        lock_guard<recursive_mutex> lock(buffer_mutex);
 
-        // once per frame sync point for skinning and other deformables, must run before the dirty
-        // early out because deformable writes do not mark the buffer dirty
-        flush_vertex_updates();
+        build_index++;
+        release_pending_frees();
 
-        if (!dirty || vertices.empty() || indices.empty())
+        if (get_pool(GeometryPool::Vertex).blocks.empty() || get_pool(GeometryPool::Index).blocks.empty())
         {
             return;
         }
 
-        uint32_t vertex_count         = static_cast<uint32_t>(vertices.size());
-        uint32_t index_count          = static_cast<uint32_t>(indices.size());
-        uint32_t meshlet_bounds_count = static_cast<uint32_t>(meshlet_bounds.size());
-        uint32_t meshlet_vertex_count = static_cast<uint32_t>(meshlet_vertices.size());
-        uint32_t meshlet_micro_count  = static_cast<uint32_t>(meshlet_micro_indices.size());
-        uint32_t instance_count       = static_cast<uint32_t>(instances.size());
+        ensure_identity_instance();
 
-        // ensure slot 0 always has an identity entry so non-instanced indirect draws read identity
-        if (instance_count == 0)
+        // grow every pool whose allocator ran ahead of its buffer
+        bool queues_idle = false;
+        bool grew        = false;
+        for (Pool& pool : pools)
         {
-            instances.push_back(Instance::GetIdentity());
-            instance_count = 1;
-            dirty          = true;
+            grew |= grow_buffer(pool, queues_idle);
         }
 
-        was_rebuilt             = false;
-        bool needs_full_rebuild = !vertex_buffer || !index_buffer || !meshlet_bounds_buffer ||
-                                  !meshlet_vertex_buffer || !meshlet_micro_index_buffer || !instance_buffer ||
-                                  vertex_count > vertex_capacity ||
-                                  index_count > index_capacity ||
-                                  meshlet_bounds_count > meshlet_bounds_capacity ||
-                                  meshlet_vertex_count > meshlet_vertex_capacity ||
-                                  meshlet_micro_count > meshlet_micro_capacity ||
-                                  instance_count > instance_capacity ||
-                                  vertex_reserve > vertex_capacity ||
-                                  index_reserve > index_capacity ||
-                                  meshlet_bounds_reserve > meshlet_bounds_capacity ||
-                                  meshlet_vertex_reserve > meshlet_vertex_capacity ||
-                                  meshlet_micro_reserve > meshlet_micro_capacity ||
-                                  instance_reserve > instance_capacity;
-
-        if (needs_full_rebuild)
+        if (grew)
         {
-            // allocate with headroom so late-arriving meshes don't trigger another rebuild
-            // a flat 25% headroom on a multi-gb instance buffer wastes hundreds of mb, clamp to 64mb of slack
-            auto add_headroom = [](uint64_t count, uint64_t stride, uint64_t max_slack_bytes) -> uint32_t
-            {
-                uint64_t default_grown_count = static_cast<uint64_t>(static_cast<double>(count) * static_cast<double>(growth_factor));
-                uint64_t default_slack_bytes = (default_grown_count - count) * stride;
-                if (default_slack_bytes > max_slack_bytes)
-                {
-                    uint64_t capped_extra = max_slack_bytes / max<uint64_t>(stride, 1);
-                    return static_cast<uint32_t>(count + capped_extra);
-                }
-                return static_cast<uint32_t>(default_grown_count);
-            };
-
-            constexpr uint64_t max_slack_bytes = 64ull * 1024ull * 1024ull;
-            uint32_t new_vertex_capacity         = max(add_headroom(max(vertex_count, vertex_reserve), sizeof(RHI_Vertex_PosTexNorTan), max_slack_bytes), vertex_capacity);
-            uint32_t new_index_capacity          = max(add_headroom(max(index_count, index_reserve), sizeof(uint32_t), max_slack_bytes), index_capacity);
-            uint32_t new_meshlet_bounds_capacity = max(add_headroom(max(meshlet_bounds_count, meshlet_bounds_reserve), sizeof(Sb_MeshletBounds), max_slack_bytes), max(meshlet_bounds_capacity, 1u));
-            uint32_t new_meshlet_vertex_capacity = max(add_headroom(max(max(meshlet_vertex_count, meshlet_vertex_reserve), 1u), sizeof(uint32_t), max_slack_bytes), max(meshlet_vertex_capacity, 1u));
-            uint32_t new_meshlet_micro_capacity  = max(add_headroom(max(max(meshlet_micro_count, meshlet_micro_reserve), 1u), sizeof(uint32_t), max_slack_bytes), max(meshlet_micro_capacity, 1u));
-            uint32_t new_instance_capacity       = max(add_headroom(max(instance_count, instance_reserve), sizeof(Instance), max_slack_bytes), max(instance_capacity, 1u));
-
-            // allocate into temporaries so a failure leaves the previously working buffers in place
-            auto new_vertex_buffer = make_unique<RHI_Buffer>(
-                RHI_Buffer_Type::Vertex,
-                sizeof(RHI_Vertex_PosTexNorTan),
-                new_vertex_capacity,
-                nullptr,
-                false,
-                "geometry_buffer_vertex"
-            );
-
-            auto new_index_buffer = make_unique<RHI_Buffer>(
-                RHI_Buffer_Type::Index,
-                sizeof(uint32_t),
-                new_index_capacity,
-                nullptr,
-                false,
-                "geometry_buffer_index"
-            );
-
-            auto new_meshlet_bounds_buffer = make_unique<RHI_Buffer>(
-                RHI_Buffer_Type::Storage,
-                sizeof(Sb_MeshletBounds),
-                new_meshlet_bounds_capacity,
-                nullptr,
-                false,
-                "geometry_buffer_meshlet_bounds"
-            );
-
-            auto new_meshlet_vertex_buffer = make_unique<RHI_Buffer>(
-                RHI_Buffer_Type::Storage,
-                sizeof(uint32_t),
-                new_meshlet_vertex_capacity,
-                nullptr,
-                false,
-                "geometry_buffer_meshlet_vertices"
-            );
-
-            auto new_meshlet_micro_index_buffer = make_unique<RHI_Buffer>(
-                RHI_Buffer_Type::Storage,
-                sizeof(uint32_t),
-                packed_micro_count(new_meshlet_micro_capacity),
-                nullptr,
-                false,
-                "geometry_buffer_meshlet_micro_indices"
-            );
-
-            auto new_instance_buffer = make_unique<RHI_Buffer>(
-                RHI_Buffer_Type::Instance,
-                sizeof(Instance),
-                new_instance_capacity,
-                nullptr,
-                false,
-                "geometry_buffer_instances"
-            );
-
-            bool allocation_failed = !new_vertex_buffer->GetRhiResource()              ||
-                                     !new_index_buffer->GetRhiResource()               ||
-                                     !new_meshlet_bounds_buffer->GetRhiResource()      ||
-                                     !new_meshlet_vertex_buffer->GetRhiResource()      ||
-                                     !new_meshlet_micro_index_buffer->GetRhiResource() ||
-                                     !new_instance_buffer->GetRhiResource();
-            if (allocation_failed)
-            {
-                // log once per session, the same world will hit this every time AppendInstances marks the buffer dirty during async loading and we don't need a wall of identical errors
-                // Shutdown() resets the flag so the next world-load gets its own fresh log
-                if (!oom_logged)
-                {
-                    SP_LOG_ERROR("Failed to allocate global geometry buffer (vertex_capacity=%u, index_capacity=%u, meshlet_capacity=%u, meshlet_vertex_capacity=%u, meshlet_micro_capacity=%u, instance_capacity=%u), the world is too large for the available device memory, dropping further appends",
-                        new_vertex_capacity, new_index_capacity, new_meshlet_bounds_capacity, new_meshlet_vertex_capacity, new_meshlet_micro_capacity, new_instance_capacity);
-                    oom_logged = true;
-                }
-
-                // record the failed instance count, future AppendInstances calls bail out so instances never grows past this point again
-                instance_capacity_failed_at = instance_count;
-
-                // truncate cpu-side instance vector back to whatever the last successful gpu commit can hold (zero on a first-build failure, identity slot 0 is reseeded on the next append)
-                // without this, instances would stay at the failed size and the next rebuild would re-attempt the same too-big alloc
-                if (instances.size() > instance_count_committed)
-                {
-                    instances.resize(instance_count_committed);
-                }
-
-                dirty       = false;
-                was_rebuilt = false;
-                return;
-            }
-
-            // upload committed data into the newly allocated buffers before swapping
-            new_vertex_buffer->UploadSubRegion(vertices.data(), 0, vertex_count * sizeof(RHI_Vertex_PosTexNorTan));
-            new_index_buffer->UploadSubRegion(indices.data(), 0, index_count * sizeof(uint32_t));
-            if (meshlet_bounds_count > 0)
-            {
-                new_meshlet_bounds_buffer->UploadSubRegion(meshlet_bounds.data(), 0, meshlet_bounds_count * sizeof(Sb_MeshletBounds));
-            }
-            if (meshlet_vertex_count > 0)
-            {
-                new_meshlet_vertex_buffer->UploadSubRegion(meshlet_vertices.data(), 0, meshlet_vertex_count * sizeof(uint32_t));
-            }
-            if (meshlet_micro_count > 0)
-            {
-                vector<uint32_t> packed;
-                pack_micro_indices(meshlet_micro_indices.data(), meshlet_micro_count, packed);
-                new_meshlet_micro_index_buffer->UploadSubRegion(packed.data(), 0, packed.size() * sizeof(uint32_t));
-            }
-            new_instance_buffer->UploadSubRegion(instances.data(), 0, instance_count * sizeof(Instance));
-
-            // commit, the old buffers go through the deletion queue here so frames in flight finish using them
-            vertex_buffer              = std::move(new_vertex_buffer);
-            index_buffer               = std::move(new_index_buffer);
-            meshlet_bounds_buffer      = std::move(new_meshlet_bounds_buffer);
-            meshlet_vertex_buffer      = std::move(new_meshlet_vertex_buffer);
-            meshlet_micro_index_buffer = std::move(new_meshlet_micro_index_buffer);
-            instance_buffer            = std::move(new_instance_buffer);
-
-            vertex_capacity         = new_vertex_capacity;
-            index_capacity          = new_index_capacity;
-            meshlet_bounds_capacity = new_meshlet_bounds_capacity;
-            meshlet_vertex_capacity = new_meshlet_vertex_capacity;
-            meshlet_micro_capacity  = new_meshlet_micro_capacity;
-            instance_capacity       = new_instance_capacity;
-
-            vertex_count_committed         = vertex_count;
-            index_count_committed          = index_count;
-            meshlet_bounds_count_committed = meshlet_bounds_count;
-            meshlet_vertex_count_committed = meshlet_vertex_count;
-            meshlet_micro_count_committed  = meshlet_micro_count;
-            instance_count_committed       = instance_count;
-
             was_rebuilt = true;
 
-            SP_LOG_INFO("Global geometry buffer built: %u vertices (%.2f MB), %u indices (%.2f MB), %u meshlets (%.2f MB), %u meshlet verts, %u micro indices, %u instances, capacity: %u/%u/%u/%u/%u/%u",
-                vertex_count,
-                (vertex_count * sizeof(RHI_Vertex_PosTexNorTan)) / (1024.0f * 1024.0f),
-                index_count,
-                (index_count * sizeof(uint32_t)) / (1024.0f * 1024.0f),
-                meshlet_bounds_count,
-                (meshlet_bounds_count * sizeof(Sb_MeshletBounds)) / (1024.0f * 1024.0f),
-                meshlet_vertex_count,
-                meshlet_micro_count,
-                instance_count,
-                vertex_capacity,
-                index_capacity,
-                meshlet_bounds_capacity,
-                meshlet_vertex_capacity,
-                meshlet_micro_capacity,
-                instance_capacity
+            const Pool& vertex_pool  = get_pool(GeometryPool::Vertex);
+            const Pool& index_pool   = get_pool(GeometryPool::Index);
+            const Pool& meshlet_pool = get_pool(GeometryPool::MeshletBounds);
+            SP_LOG_INFO("Global geometry buffer grown: %u/%u vertices (%.2f MB), %u/%u indices (%.2f MB), %u/%u meshlets, %u instances",
+                vertex_pool.allocator.GetUsed(),
+                vertex_pool.allocator.GetCapacity(),
+                (static_cast<uint64_t>(vertex_pool.allocator.GetCapacity()) * vertex_pool.stride) / (1024.0f * 1024.0f),
+                index_pool.allocator.GetUsed(),
+                index_pool.allocator.GetCapacity(),
+                (static_cast<uint64_t>(index_pool.allocator.GetCapacity()) * index_pool.stride) / (1024.0f * 1024.0f),
+                meshlet_pool.allocator.GetUsed(),
+                meshlet_pool.allocator.GetCapacity(),
+                get_pool(GeometryPool::Instance).allocator.GetUsed()
             );
         }
-        else
-        {
-            // the new data fits within the pre-allocated capacity, upload only the new portion
-            uint32_t new_vertices        = vertex_count - vertex_count_committed;
-            uint32_t new_indices         = index_count - index_count_committed;
-            uint32_t new_meshlets        = meshlet_bounds_count - meshlet_bounds_count_committed;
-            uint32_t new_meshlet_verts   = meshlet_vertex_count - meshlet_vertex_count_committed;
-            uint32_t new_meshlet_micros  = meshlet_micro_count - meshlet_micro_count_committed;
-            uint32_t new_instances       = instance_count - instance_count_committed;
-
-            if (new_vertices > 0)
-            {
-                uint64_t offset = static_cast<uint64_t>(vertex_count_committed) * sizeof(RHI_Vertex_PosTexNorTan);
-                uint64_t size   = static_cast<uint64_t>(new_vertices) * sizeof(RHI_Vertex_PosTexNorTan);
-                vertex_buffer->UploadSubRegion(vertices.data() + vertex_count_committed, offset, size);
-            }
-
-            if (new_indices > 0)
-            {
-                uint64_t offset = static_cast<uint64_t>(index_count_committed) * sizeof(uint32_t);
-                uint64_t size   = static_cast<uint64_t>(new_indices) * sizeof(uint32_t);
-                index_buffer->UploadSubRegion(indices.data() + index_count_committed, offset, size);
-            }
-
-            if (new_meshlets > 0)
-            {
-                uint64_t offset = static_cast<uint64_t>(meshlet_bounds_count_committed) * sizeof(Sb_MeshletBounds);
-                uint64_t size   = static_cast<uint64_t>(new_meshlets) * sizeof(Sb_MeshletBounds);
-                meshlet_bounds_buffer->UploadSubRegion(meshlet_bounds.data() + meshlet_bounds_count_committed, offset, size);
-            }
-
-            if (new_meshlet_verts > 0)
-            {
-                uint64_t offset = static_cast<uint64_t>(meshlet_vertex_count_committed) * sizeof(uint32_t);
-                uint64_t size   = static_cast<uint64_t>(new_meshlet_verts) * sizeof(uint32_t);
-                meshlet_vertex_buffer->UploadSubRegion(meshlet_vertices.data() + meshlet_vertex_count_committed, offset, size);
-            }
-
-            if (new_meshlet_micros > 0)
-            {
-                // the committed count is always a multiple of the pack width, appends pad to keep it there
-                vector<uint32_t> packed;
-                pack_micro_indices(meshlet_micro_indices.data() + meshlet_micro_count_committed, new_meshlet_micros, packed);
 
-                uint64_t offset = static_cast<uint64_t>(packed_micro_count(meshlet_micro_count_committed)) * sizeof(uint32_t);
-                uint64_t size   = static_cast<uint64_t>(packed.size()) * sizeof(uint32_t);
-                meshlet_micro_index_buffer->UploadSubRegion(packed.data(), offset, size);
-            }
-
-            if (new_instances > 0)
+        // relocations only stage data, so they go out with the flush below
+        if (defrag_budget_bytes > 0)
+        {
+            uint64_t budget_bytes = defrag_budget_bytes;
+            for (uint32_t i = 0; i < static_cast<uint32_t>(GeometryPool::Max); i++)
             {
-                uint64_t offset = static_cast<uint64_t>(instance_count_committed) * sizeof(Instance);
-                uint64_t size   = static_cast<uint64_t>(new_instances) * sizeof(Instance);
-                instance_buffer->UploadSubRegion(instances.data() + instance_count_committed, offset, size);
+                defragment(static_cast<GeometryPool>(i), budget_bytes);
             }
+        }
 
-            vertex_count_committed         = vertex_count;
-            index_count_committed          = index_count;
-            meshlet_bounds_count_committed = meshlet_bounds_count;
-            meshlet_vertex_count_committed = meshlet_vertex_count;
-            meshlet_micro_count_committed  = meshlet_micro_count;
-            instance_count_committed       = instance_count;
-
-            SP_LOG_INFO("Global geometry buffer updated: +%u vertices, +%u indices, +%u meshlets, +%u meshlet verts, +%u micro indices, +%u instances (sub-region upload, no rebuild)",
-                new_vertices, new_indices, new_meshlets, new_meshlet_verts, new_meshlet_micros, new_instances
-            );
+        // per-frame deformable traffic is recorded on the frame command list, a load's worth goes through staged copies
+        uint64_t staged_bytes = 0;
+        for (const Pool& pool : pools)
+        {
+            staged_bytes += pool.staging.size();
         }
 
-        dirty = false;
+        const bool record = RHI_Device::IsRecording() && staged_bytes <= inline_upload_max_bytes;
+        for (Pool& pool : pools)
+        {
+            flush_uploads(pool, record);
+        }
     }
 
     bool GeometryBuffer::WasRebuilt()
@@ -662,6 +627,13 @@ namespace spartan
         return result;
     }
 
+    bool GeometryBuffer::WasRelocated()
+    {
+        bool result   = was_relocated;
+        was_relocated = false;
+        return result;
+    }
+
     void GeometryBuffer::Reserve(
         uint32_t vertex_count,
         uint32_t index_count,
@@ -671,89 +643,90 @@ namespace spartan
         uint32_t instance_count
     )
     {
-        lock_guard<mutex> lock(buffer_mutex);
-
-        vertex_reserve         = max(vertex_reserve,         vertex_count);
-        index_reserve          = max(index_reserve,          index_count);
-        meshlet_bounds_reserve = max(meshlet_bounds_reserve, meshlet_bounds_count);
-        meshlet_vertex_reserve = max(meshlet_vertex_reserve, meshlet_vertex_count);
-        meshlet_micro_reserve  = max(meshlet_micro_reserve,  meshlet_micro_count);
-        instance_reserve       = max(instance_reserve,       instance_count);
+        lock_guard<recursive_mutex> lock(buffer_mutex);
+
+        const uint32_t counts[] =
+        {
+            vertex_count,
+            index_count,
+            meshlet_bounds_count,
+            meshlet_vertex_count,
+            packed_micro_count(meshlet_micro_count),
+            instance_count
+        };
+
+        // the allocators take the floor right away so appends fill it before growing again
+        for (uint32_t i = 0; i < static_cast<uint32_t>(GeometryPool::Max); i++)
+        {
+            pools[i].reserve = max(pools[i].reserve, counts[i]);
+            pools[i].allocator.Grow(pools[i].reserve);
+        }
+    }
+
+    void GeometryBuffer::SetDefragmentationBudget(const uint64_t bytes)
+    {
+        lock_guard<recursive_mutex> lock(buffer_mutex);
+        defrag_budget_bytes = bytes;
+    }
+
+    RangeAllocatorStats GeometryBuffer::GetStats(const GeometryPool pool)
+    {
+        lock_guard<recursive_mutex> lock(buffer_mutex);
+        return get_pool(pool).allocator.GetStats();
     }
 
     void GeometryBuffer::Shutdown()
     {
-        vertex_buffer              = nullptr;
-        index_buffer               = nullptr;
-        meshlet_bounds_buffer      = nullptr;
-        meshlet_vertex_buffer      = nullptr;
-        meshlet_micro_index_buffer = nullptr;
-        instance_buffer            = nullptr;
-        vertices.clear();
-        vertices.shrink_to_fit();
-        indices.clear();
-        indices.shrink_to_fit();
-        meshlet_bounds.clear();
-        meshlet_bounds.shrink_to_fit();
-        meshlet_vertices.clear();
-        meshlet_vertices.shrink_to_fit();
-        meshlet_micro_indices.clear();
-        meshlet_micro_indices.shrink_to_fit();
-        instances.clear();
-        instances.shrink_to_fit();
-        vertex_dirty_ranges.clear();
-        vertex_dirty_ranges.shrink_to_fit();
-        vertex_count_committed         = 0;
-        index_count_committed          = 0;
-        meshlet_bounds_count_committed = 0;
-        meshlet_vertex_count_committed = 0;
-        meshlet_micro_count_committed  = 0;
-        instance_count_committed       = 0;
-        vertex_capacity                = 0;
-        index_capacity                 = 0;
-        meshlet_bounds_capacity        = 0;
-        meshlet_vertex_capacity        = 0;
-        meshlet_micro_capacity         = 0;
-        instance_capacity              = 0;
-        vertex_reserve                 = 0;
-        index_reserve                  = 0;
-        meshlet_bounds_reserve         = 0;
-        meshlet_vertex_reserve         = 0;
-        meshlet_micro_reserve          = 0;
-        instance_reserve               = 0;
-        instance_capacity_failed_at    = 0;
-        dirty                          = false;
-        was_rebuilt                    = false;
-        oom_logged                     = false;
+        lock_guard<recursive_mutex> lock(buffer_mutex);
+
+        for (Pool& pool : pools)
+        {
+            pool.buffer = nullptr;
+            pool.allocator.Clear();
+            pool.blocks.clear();
+            pool.staging.clear();
+            pool.staging.shrink_to_fit();
+            pool.uploads.clear();
+            pool.uploads.shrink_to_fit();
+            pool.reserve            = 0;
+            pool.capacity_failed_at = 0;
+        }
+
+        pending_frees.clear();
+        pending_frees.shrink_to_fit();
+        build_index   = 0;
+        was_rebuilt   = false;
+        was_relocated = false;
+        oom_logged    = false;
     }
 
     RHI_Buffer* GeometryBuffer::GetVertexBuffer()
     {
-        return vertex_buffer.get();
+        return get_pool(GeometryPool::Vertex).buffer.get();
     }
 
     RHI_Buffer* GeometryBuffer::GetIndexBuffer()
     {
-        return index_buffer.get();
+        return get_pool(GeometryPool::Index).buffer.get();
     }
 
     RHI_Buffer* GeometryBuffer::GetMeshletBoundsBuffer()
     {
-        return meshlet_bounds_buffer.get();
+        return get_pool(GeometryPool::MeshletBounds).buffer.get();
     }
 
     RHI_Buffer* GeometryBuffer::GetMeshletVertexBuffer()
     {
-        return meshlet_vertex_buffer.get();
+        return get_pool(GeometryPool::MeshletVertex).buffer.get();
     }
 
     RHI_Buffer* GeometryBuffer::GetMeshletMicroIndexBuffer()
     {
-        return meshlet_micro_index_buffer.get();
+        return get_pool(GeometryPool::MeshletMicro).buffer.get();
     }
 
     RHI_Buffer* GeometryBuffer::GetInstanceBuffer()
     {
-        return instance_buffer.get();
+        return get_pool(GeometryPool::Instance).buffer.get();
     }
 }
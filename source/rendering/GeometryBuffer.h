@@ -21,48 +21,74 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES =====================
+//= INCLUDES =========================
+#include <functional>
 #include "../rhi/RHI_Vertex.h"
+#include "../memory/RangeAllocator.h"
 #include "Renderer_Buffers.h"
 #include "Instance.h"
-//================================
+//====================================
 
 namespace spartan
 {
     class RHI_Buffer;
 
-    // one global vertex and index buffer for all world geometry, meshes append during loading and receive base offsets
+    enum class GeometryPool : uint8_t
+    {
+        Vertex,
+        Index,
+        MeshletBounds,
+        MeshletVertex,
+        MeshletMicro,
+        Instance,
+        Max
+    };
+
+    // called by the defragmenter with a lower offset for a block it wants to move, the owner writes its data there
+    // through the Update* functions and adopts the offset, or returns false to stay put for now
+    // blocks appended without one are pinned, for owners that cache their offsets or rewrite them every frame
+    using GeometryRelocation = std::function<bool(uint32_t offset_new)>;
+
+    // one global vertex and index buffer for all world geometry, meshes allocate blocks from it and receive base offsets
+    // every pool is sub-allocated with a tlsf range allocator, freed blocks are recycled a few frames later and a budgeted
+    // pass moves relocatable blocks into holes, data only lives on the cpu while it waits in staging for the next BuildIfDirty
     class GeometryBuffer
     {
     public:
-        // append vertices to the global buffer, returns the base vertex offset
-        static uint32_t AppendVertices(const RHI_Vertex_PosTexNorTan* data, uint32_t count);
+        // allocate and fill vertices, returns the base vertex offset
+        static uint32_t AppendVertices(const RHI_Vertex_PosTexNorTan* data, uint32_t count, GeometryRelocation on_relocate = nullptr);
 
-        // append indices to the global buffer, returns the base index offset
-        static uint32_t AppendIndices(const uint32_t* data, uint32_t count);
+        // allocate and fill indices, returns the base index offset
+        static uint32_t AppendIndices(const uint32_t* data, uint32_t count, GeometryRelocation on_relocate = nullptr);
 
-        // append meshlet bounds to the global buffer, returns the base meshlet offset
-        static uint32_t AppendMeshletBounds(const Sb_MeshletBounds* data, uint32_t count);
+        // allocate and fill meshlet bounds, returns the base meshlet offset
+        static uint32_t AppendMeshletBounds(const Sb_MeshletBounds* data, uint32_t count, GeometryRelocation on_relocate = nullptr);
 
-        // append meshlet unique-vertex remaps, returns the base offset
-        static uint32_t AppendMeshletVertices(const uint32_t* data, uint32_t count);
+        // allocate and fill meshlet unique-vertex remaps, returns the base offset
+        static uint32_t AppendMeshletVertices(const uint32_t* data, uint32_t count, GeometryRelocation on_relocate = nullptr);
 
-        // append meshlet micro-indices, returns the base offset
-        static uint32_t AppendMeshletMicroIndices(const uint32_t* data, uint32_t count);
+        // allocate and fill meshlet micro-indices, returns the base offset in corners, always a multiple of four
+        static uint32_t AppendMeshletMicroIndices(const uint32_t* data, uint32_t count, GeometryRelocation on_relocate = nullptr);
 
-        // append instances to the global instance buffer, returns the base instance offset
+        // allocate and fill instances, returns the base instance offset
         // index 0 is reserved for the identity instance used by non-instanced draws
-        static uint32_t AppendInstances(const Instance* data, uint32_t count);
+        static uint32_t AppendInstances(const Instance* data, uint32_t count, GeometryRelocation on_relocate = nullptr);
 
-        // update existing vertices in-place, used by deformable meshes like cloth and skinning
-        // the cpu copy is immediate, the gpu copy is queued and coalesced by the next BuildIfDirty
+        // update existing elements in-place, used by deformable meshes like cloth and skinning
+        // the data is staged immediately, the gpu copy is queued and coalesced by the next BuildIfDirty
         static void UpdateVertices(const RHI_Vertex_PosTexNorTan* data, uint32_t offset, uint32_t count);
         static void UpdateIndices(const uint32_t* data, uint32_t offset, uint32_t count);
         static void UpdateMeshletBounds(const Sb_MeshletBounds* data, uint32_t offset, uint32_t count);
         static void UpdateMeshletVertices(const uint32_t* data, uint32_t offset, uint32_t count);
-        static void UpdateMeshletMicroIndices(const uint32_t* data, uint32_t offset, uint32_t count);
+        static void UpdateMeshletMicroIndices(const uint32_t* data, uint32_t offset, uint32_t count); // offset must be a block start
+        static void UpdateInstances(const Instance* data, uint32_t offset, uint32_t count);
 
-        // uploads only the new portion when it fits the existing capacity, otherwise recreates with headroom
+        // releases a block by the base offset its Append* returned, the range is reused once frames in flight are done with it
+        static void Free(GeometryPool pool, uint32_t offset);
+        // for owners that share a block, each reference needs its own Free, shared blocks are never relocated
+        static void AddReference(GeometryPool pool, uint32_t offset);
+
+        // grows the gpu buffers, moves a budgeted amount of fragmented blocks and flushes staged data
         static void BuildIfDirty();
 
         // request capacity floors, the next BuildIfDirty grows the gpu buffers if they are smaller
@@ -76,7 +102,13 @@ namespace spartan
             uint32_t instance_count
         );
 
-        // destroy gpu buffers and clear cpu data
+        // bytes the defragmenter may move per BuildIfDirty, 0 disables it
+        static void SetDefragmentationBudget(uint64_t bytes);
+
+        // occupancy and fragmentation of a pool, in gpu buffer elements (packed uints for micro indices)
+        static RangeAllocatorStats GetStats(GeometryPool pool);
+
+        // destroy gpu buffers and release every block
         static void Shutdown();
 
         static RHI_Buffer* GetVertexBuffer();
@@ -88,5 +120,8 @@ namespace spartan
 
         // true when capacity was exceeded and the buffers moved, invalidates address dependent caches, cleared on read
         static bool WasRebuilt();
+
+        // true when the defragmenter moved blocks, offsets cached outside their owners are stale, cleared on read
+        static bool WasRelocated();
     };
 }
@@ -26,6 +26,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../resource/ResourceCache.h"
 #include "../rhi/RHI_Texture.h"
 #include "../world/World.h"
+#include "../world/ChangeJournal.h"
 #include "../core/ProgressTracker.h"
 SP_WARNINGS_OFF
 #include "../io/pugixml.hpp"
@@ -1235,6 +1236,7 @@ namespace spartan
             m_resource_state = ResourceState::PreparedForGpu;
             needs_repack     = m_needs_repack;
         }
+        ChangeJournal::RecordMaterial(GetObjectId());
 
         // textures set during preparation, repack once more
         if (needs_repack)
@@ -1429,4 +1431,11 @@ namespace spartan
             m_textures[packed_base_index + slot] = nullptr;
         }
     }
+
+    void Material::bump_revision()
+    {
+        m_revision++;
+        m_global_revision++;
+        ChangeJournal::RecordMaterial(GetObjectId());
+    }
 }
@@ -214,11 +214,7 @@ namespace spartan
         void SetColorInternal(const Color& color, bool save);
         void ResetPresetProperties(bool save);
         bool IsPackableTextureType(MaterialTextureType type) const;
-        void bump_revision()
-        {
-            m_revision++;
-            m_global_revision++;
-        }
+        void bump_revision();
 
         std::array<RHI_Texture*, static_cast<uint32_t>(MaterialTextureType::Max) * slots_per_texture> m_textures;
         std::array<float, static_cast<uint32_t>(MaterialProperty::Max)> m_properties;
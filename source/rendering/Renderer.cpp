@@ -21,6 +21,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ===================================
 #include "pch.h"
+#include <bit>
 #include <mutex>
 #include <unordered_set>
 #include <future>
@@ -47,6 +48,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../rhi/RHI_VendorTechnology.h"
 #include "../rhi/RHI_AccelerationStructure.h"
 #include "../world/Entity.h"
+#include "../world/ChangeJournal.h"
 #include "../world/components/Light.h"
 #include "../world/components/Camera.h"
 #include "../world/components/Volume.h"
@@ -91,6 +93,38 @@ namespace spartan
 
         // set by TickUploadMaterials, consumed by UpdateAccelerationStructures
         bool materials_uploaded_this_frame = false;
+
+        // set when the geometry buffer defragmenter moved blocks, consumed by UpdateAccelerationStructures
+        bool geometry_relocated_this_frame = false;
+
+        // persistent material slots
+        //
+        // a material keeps its block of the bindless table (one Sb_Material plus its texture slots) for as
+        // long as something references it, so an edit rewrites that block alone and only the dirty blocks
+        // are uploaded, a pass costs the walk over referenced materials plus whatever actually changed
+        struct MaterialSlot
+        {
+            uint32_t block      = 0;
+            uint32_t revision   = 0; // Material::GetRevision() the block was written from, 0 forces a rewrite
+            uint64_t srv_hash   = 0; // async texture prep swaps srvs without bumping the material revision
+            uint64_t pass       = 0; // last UpdateMaterials() pass that referenced the material
+        };
+        unordered_map<uint64_t, MaterialSlot> material_slots;
+        vector<uint32_t> material_blocks_free;
+        vector<uint32_t> material_blocks_dirty;
+        uint32_t material_block_end = 0; // blocks below this have been handed out at least once
+        uint64_t material_pass      = 0;
+
+        // terrain layers and the surface have to sit in one contiguous run, the shader walks it from a base
+        vector<uint64_t> material_terrain_ids;
+        uint32_t material_terrain_block = 0;
+
+        // set by UpdateMaterials, read by TickUploadMaterials
+        bool material_textures_changed = false; // texture slots were written, the bindless descriptors need a refresh
+        bool material_textures_pending = false; // a referenced texture has no srv yet
+
+        // two dirty blocks closer than this merge into one upload, re-sending the gap beats another copy
+        constexpr uint32_t material_upload_merge_gap = 4;
     }
 
     // constant and push constant buffers
@@ -471,6 +505,142 @@ namespace spartan
             }
         }
 
+        // fills one draw data entry and copies it into this frame's region of the buffer when it's mapped,
+        // d3d12 bulk uploads the cpu copy later, returns the global index the shaders address it by
+        uint32_t store_draw_data(const uint32_t index, void* mapped, const math::Matrix& transform, const math::Matrix& transform_previous, uint32_t material_index, uint32_t is_transparent, const Render* render)
+        {
+            Sb_DrawData& entry       = Renderer::m_draw_data_cpu[index];
+            entry.transform          = transform;
+            entry.transform_previous = transform_previous;
+            entry.material_index     = material_index;
+            entry.is_transparent     = is_transparent;
+            entry.aabb_index         = 0;
+            entry.lod_first_index    = 0;
+            entry.flags              = 0;
+            entry.instance_offset    = 0;
+            entry.instance_index     = 0;
+            entry.lod_vertex_offset  = 0;
+
+            fill_uv_draw_fields_from_render(entry, render);
+
+            // the draw data buffer is a single large allocation partitioned into per-frame regions;
+            // each frame writes to its own region so there is no write-after-read race with the gpu
+            const uint32_t global_index = Renderer::m_frame_resource_index * renderer_max_draw_calls + index;
+            if (mapped)
+            {
+                memcpy(static_cast<char*>(mapped) + global_index * sizeof(Sb_DrawData), &entry, sizeof(Sb_DrawData));
+            }
+
+            return global_index;
+        }
+
+        // draw call sort key, most significant first: transparency, camera visible or shadow only, alpha tested
+        // pipeline, material index and the distance as float bits, which order like the float for positive values,
+        // transparent draws flip the distance so they go back to front
+        constexpr uint64_t draw_key_transparent = 1ull << 63;
+        constexpr uint64_t draw_key_offscreen   = 1ull << 62;
+        constexpr uint64_t draw_key_alpha       = 1ull << 61;
+        constexpr uint64_t draw_key_material    = (1ull << 29) - 1;
+
+        // entities per worker chunk when collecting draw calls
+        constexpr uint32_t draw_collect_chunk_size = 256;
+
+        uint64_t pack_draw_key(const bool is_transparent, const bool is_visible, const bool is_alpha_tested, const uint32_t material_index, const float distance_squared)
+        {
+            const uint32_t distance_bits = bit_cast<uint32_t>(max(distance_squared, 0.0f));
+
+            uint64_t key  = is_transparent ? draw_key_transparent : 0;
+            key          |= is_visible ? 0 : draw_key_offscreen;
+            key          |= is_alpha_tested ? draw_key_alpha : 0;
+            key          |= (static_cast<uint64_t>(material_index) & draw_key_material) << 32;
+            key          |= is_transparent ? ~distance_bits : distance_bits;
+
+            return key;
+        }
+
+        // how many of this frame's sorted draw calls have a key below the given one, the start of a key range
+        uint32_t draw_keys_below(const uint64_t key)
+        {
+            auto begin = Renderer::m_draw_calls.begin();
+            auto end   = begin + Renderer::m_draw_call_count;
+            return static_cast<uint32_t>(partition_point(begin, end, [key](const Renderer_DrawCall& draw_call) { return draw_call.sort_key < key; }) - begin);
+        }
+
+        // lsd radix sort of 64 bit keys that carry a 32 bit payload, a byte per pass, each pass histograms and
+        // scatters in parallel chunks, chunks keep their order so every pass stays stable, and passes where every
+        // key has the same byte are skipped, for draw keys that is most of the high bytes
+        void radix_sort(vector<uint64_t>& keys, vector<uint32_t>& values)
+        {
+            constexpr uint32_t radix_chunk_size = 2048;
+
+            static vector<uint64_t> keys_scratch;
+            static vector<uint32_t> values_scratch;
+            static vector<array<uint32_t, 256>> histograms;
+
+            const uint32_t count       = static_cast<uint32_t>(keys.size());
+            const uint32_t chunk_count = max((count + radix_chunk_size - 1) / radix_chunk_size, 1u);
+            keys_scratch.resize(count);
+            values_scratch.resize(count);
+            histograms.resize(chunk_count);
+
+            for (uint32_t shift = 0; shift < 64; shift += 8)
+            {
+                ThreadPool::ParallelFor(chunk_count, [&](uint32_t chunk_start, uint32_t chunk_end)
+                {
+                    for (uint32_t chunk = chunk_start; chunk < chunk_end; chunk++)
+                    {
+                        array<uint32_t, 256>& histogram = histograms[chunk];
+                        histogram.fill(0);
+
+                        const uint32_t last = min((chunk + 1) * radix_chunk_size, count);
+                        for (uint32_t i = chunk * radix_chunk_size; i < last; i++)
+                        {
+                            histogram[(keys[i] >> shift) & 0xFF]++;
+                        }
+                    }
+                });
+
+                // turn the counts into each chunk's first write position per digit, digit major so the sort stays stable
+                uint32_t offset = 0;
+                bool is_uniform = false;
+                for (uint32_t digit = 0; digit < 256; digit++)
+                {
+                    uint32_t digit_count = 0;
+                    for (uint32_t chunk = 0; chunk < chunk_count; chunk++)
+                    {
+                        const uint32_t chunk_digit_count = histograms[chunk][digit];
+                        histograms[chunk][digit]         = offset + digit_count;
+                        digit_count                     += chunk_digit_count;
+                    }
+                    is_uniform |= digit_count == count;
+                    offset     += digit_count;
+                }
+                if (is_uniform)
+                {
+                    continue;
+                }
+
+                ThreadPool::ParallelFor(chunk_count, [&](uint32_t chunk_start, uint32_t chunk_end)
+                {
+                    for (uint32_t chunk = chunk_start; chunk < chunk_end; chunk++)
+                    {
+                        array<uint32_t, 256>& positions = histograms[chunk];
+
+                        const uint32_t last = min((chunk + 1) * radix_chunk_size, count);
+                        for (uint32_t i = chunk * radix_chunk_size; i < last; i++)
+                        {
+                            const uint32_t position  = positions[(keys[i] >> shift) & 0xFF]++;
+                            keys_scratch[position]   = keys[i];
+                            values_scratch[position] = values[i];
+                        }
+                    }
+                });
+
+                keys.swap(keys_scratch);
+                values.swap(values_scratch);
+            }
+        }
+
         void tick_dynamic_resolution_scale()
         {
             if (cvar_dynamic_resolution.GetValue() == 0.0f)
@@ -707,6 +877,30 @@ namespace spartan
                 DestroyAccelerationStructures();
             }
 
+            // the defragmenter moved blocks, the tlas geometry offsets and the baked scatter args still point at the old ones
+            if (GeometryBuffer::WasRelocated())
+            {
+                geometry_relocated_this_frame = true;
+
+                for (PassState::GpuScatterSlot& slot : m_pass_state.gpu_scatter)
+                {
+                    if (!slot.enabled || !slot.mesh || slot.mesh->GetSubMeshCount() == 0 || slot.mesh->GetSubMesh(0).lods.empty())
+                    {
+                        continue;
+                    }
+
+                    const SubMesh& sub = slot.mesh->GetSubMesh(0);
+                    for (uint32_t i = 0; i < renderer_max_gpu_scatter_lods; i++)
+                    {
+                        const MeshLod& lod        = sub.lods[i < sub.lods.size() ? i : 0];
+                        Sb_IndirectDrawArgs& args = slot.indirect_args_static[i];
+                        args.first_index          = slot.mesh->GetGlobalIndexOffset() + lod.index_offset;
+                        args.vertex_offset        = static_cast<int32_t>(slot.mesh->GetGlobalVertexOffset() + lod.vertex_offset);
+                    }
+                    slot.args_baked = false;
+                }
+            }
+
             const bool secondary_request_pending =
                 secondary_camera_request ||
                 secondary_render_root_request;
@@ -1144,20 +1338,23 @@ namespace spartan
         materials_uploaded_this_frame = true;
 
         UpdateMaterials();
-        RHI_CommandList::PrepareTexturesForSampling(&m_bindless_textures);
+
+        // property edits only touch the material buffer, the texture descriptors are left alone unless a
+        // block's textures were actually rewritten or released
+        const bool refresh_textures = material_textures_changed || GetFrameNumber() == 0;
+        if (refresh_textures)
+        {
+            RHI_CommandList::PrepareTexturesForSampling(&m_bindless_textures);
+        }
         RHI_Device::UpdateBindlessMaterials(
-            &m_bindless_textures,
+            refresh_textures ? &m_bindless_textures : nullptr,
             GetBuffer(Renderer_Buffer::MaterialParameters)
         );
 
         // null srvs write the 1m checkerboard, keep retrying until gpu prep finishes
-        for (RHI_Texture* texture : m_bindless_textures)
+        if (material_textures_pending)
         {
-            if (texture && !texture->GetRhiSrv())
-            {
-                m_pass_state.bindless_materials_dirty = true;
-                break;
-            }
+            m_pass_state.bindless_materials_dirty = true;
         }
     }
 
@@ -2053,13 +2250,62 @@ namespace spartan
 
     void Renderer::BuildEmissiveTriangleNeePool()
     {
+        // the pool only depends on emissive renders, their materials and their transforms, so it's rebuilt
+        // when the change journal reports one of those, not every frame
+        static unordered_set<uint64_t> emitter_ids;
+        static float emissive_tri_count     = 0.0f;
+        static size_t render_count_built    = numeric_limits<size_t>::max();
+        static Entity* secondary_root_built = nullptr;
+        static bool built                   = false;
+
         // skip when restir off, the buffer stays at whatever data it had previously, the count
         // is set to zero so the shader treats the pool as empty regardless of buffer contents
         if (!cvar_restir_pt.GetValueAs<bool>())
         {
             m_cb_frame_cpu.restir_pt_emissive_tri_count = 0.0f;
+            built = false; // changes aren't tracked while off
+            return;
+        }
+
+        bool rebuild =
+            !built ||
+            render_entities().size() != render_count_built ||
+            secondary_render_root_active != secondary_root_built ||
+            !ChangeJournal::GetMaterialChanges().empty() ||
+            ChangeJournal::HasChanged(
+                static_cast<uint32_t>(ChangeType::Active)     |
+                static_cast<uint32_t>(ChangeType::Components) |
+                static_cast<uint32_t>(ChangeType::Mesh)       |
+                static_cast<uint32_t>(ChangeType::Material)   |
+                static_cast<uint32_t>(ChangeType::Attributes)
+            );
+        if (!rebuild && !emitter_ids.empty() && ChangeJournal::HasChanged(static_cast<uint32_t>(ChangeType::Transform)))
+        {
+            for (const EntityChanges& change : ChangeJournal::GetEntityChanges())
+            {
+                if ((change.types & static_cast<uint32_t>(ChangeType::Transform)) == 0)
+                {
+                    continue;
+                }
+
+                Entity* entity = World::GetEntity(change.handle);
+                if (entity && emitter_ids.count(entity->GetObjectId()) > 0)
+                {
+                    rebuild = true;
+                    break;
+                }
+            }
+        }
+        if (!rebuild)
+        {
+            m_cb_frame_cpu.restir_pt_emissive_tri_count = emissive_tri_count;
             return;
         }
+        built                = true;
+        render_count_built   = render_entities().size();
+        secondary_root_built = secondary_render_root_active;
+        emitter_ids.clear();
+        emissive_tri_count   = 0.0f;
 
         // statics avoid per frame heap thrash, the vectors are reused across frames and the
         // capacity ratchets up to the largest emissive render seen so far
@@ -2125,6 +2371,7 @@ namespace spartan
             }
 
             const Matrix& transform = entity->GetMatrix();
+            emitter_ids.insert(entity->GetObjectId());
 
             uint32_t tri_count = static_cast<uint32_t>(indices.size() / 3u);
             for (uint32_t i = 0; i < tri_count; i++)
@@ -2211,12 +2458,9 @@ namespace spartan
                 tris.data(),
                 static_cast<uint32_t>(tris.size() * sizeof(Sb_EmissiveTriangle))
             );
-            m_cb_frame_cpu.restir_pt_emissive_tri_count = static_cast<float>(tris.size());
-        }
-        else
-        {
-            m_cb_frame_cpu.restir_pt_emissive_tri_count = 0.0f;
+            emissive_tri_count = static_cast<float>(tris.size());
         }
+        m_cb_frame_cpu.restir_pt_emissive_tri_count = emissive_tri_count;
     }
 
     const Vector3& Renderer::GetWind()
@@ -2560,39 +2804,17 @@ namespace spartan
             return numeric_limits<uint32_t>::max();
         }
 
-        uint32_t index = m_draw_data_count++;
-
-        Sb_DrawData& entry       = m_draw_data_cpu[index];
-        entry.transform          = transform;
-        entry.transform_previous = transform_previous;
-        entry.material_index     = material_index;
-        entry.is_transparent     = is_transparent;
-        entry.aabb_index         = 0;
-        entry.lod_first_index    = 0;
-        entry.flags              = 0;
-        entry.instance_offset    = 0;
-        entry.instance_index     = 0;
-        entry.lod_vertex_offset  = 0;
-
-        fill_uv_draw_fields_from_render(entry, render);
+        const uint32_t index        = m_draw_data_count++;
+        RHI_Buffer* buffer          = GetBuffer(Renderer_Buffer::DrawData);
+        const uint32_t global_index = store_draw_data(index, buffer->GetMappedData(), transform, transform_previous, material_index, is_transparent, render);
 
-        // the draw data buffer is a single large allocation partitioned into per-frame regions;
-        // each frame writes to its own region so there is no write-after-read race with the gpu
-        uint32_t global_index = m_frame_resource_index * renderer_max_draw_calls + index;
-
-        RHI_Buffer* buffer = GetBuffer(Renderer_Buffer::DrawData);
-        if (void* mapped = buffer->GetMappedData())
-        {
-            void* dst = static_cast<char*>(mapped) + global_index * sizeof(Sb_DrawData);
-            memcpy(dst, &entry, sizeof(Sb_DrawData));
-        }
-        else if (m_draw_data_gpu_synced)
+        if (!buffer->GetMappedData() && m_draw_data_gpu_synced)
         {
             // d3d12 storage buffers are not persistently mapped, scene draws are bulk-uploaded in
             // TickUploadBindlessDependencies, imgui and editor overlays written after that must stage here
             if (RHI_Device::IsRecording())
             {
-                RHI_CommandList::UpdateBuffer(buffer, global_index * sizeof(Sb_DrawData), sizeof(Sb_DrawData), &entry);
+                RHI_CommandList::UpdateBuffer(buffer, global_index * sizeof(Sb_DrawData), sizeof(Sb_DrawData), &m_draw_data_cpu[index]);
             }
         }
 
@@ -2601,11 +2823,15 @@ namespace spartan
 
     void Renderer::UpdateMaterials()
     {
-        static array<Sb_Material, rhi_max_array_size> properties;
-        static unordered_set<uint64_t> unique_material_ids;
+        static array<Sb_Material, rhi_max_array_size> properties; // cpu mirror of the material buffer
         static bool capacity_warning_logged = false;
-        uint32_t count = 0;
-        const uint32_t material_slot_count = static_cast<uint32_t>(MaterialTextureType::Max) * Material::slots_per_texture;
+        const uint32_t material_slot_count  = static_cast<uint32_t>(MaterialTextureType::Max) * Material::slots_per_texture;
+        const uint32_t block_capacity       = rhi_max_array_size / material_slot_count;
+        const uint32_t block_invalid        = numeric_limits<uint32_t>::max();
+
+        material_pass++;
+        material_textures_changed = false;
+        material_textures_pending = false;
 
         auto should_decode_as_srgb = [](RHI_Texture* texture)
         {
@@ -2631,199 +2857,343 @@ namespace spartan
                    format == RHI_Format::BC3_Unorm ||
                    format == RHI_Format::BC7_Unorm;
         };
-    
-        auto update_material = [&count, &should_decode_as_srgb, material_slot_count](Material* material)
+
+        // the srv pointers a block was written with, a texture finishing its gpu prep changes this without
+        // the material noticing, and a null srv means the block has to be revisited once it exists
+        auto compute_srv_hash = [](Material* material)
         {
-            if (unique_material_ids.find(material->GetObjectId()) != unique_material_ids.end())
+            uint64_t hash = 17;
+            for (RHI_Texture* texture : material->GetTextures())
             {
-                return;
+                if (!texture)
+                {
+                    continue;
+                }
+
+                void* srv = texture->GetRhiSrv();
+                if (!srv)
+                {
+                    material_textures_pending = true;
+                }
+                hash = (hash * 31) ^ reinterpret_cast<uint64_t>(srv);
+            }
+            return hash;
+        };
+
+        auto allocate_block = [block_capacity, block_invalid]()
+        {
+            if (!material_blocks_free.empty())
+            {
+                const uint32_t block = material_blocks_free.back();
+                material_blocks_free.pop_back();
+                return block;
             }
 
-            if (count + material_slot_count > rhi_max_array_size)
+            return material_block_end < block_capacity ? material_block_end++ : block_invalid;
+        };
+
+        // a contiguous run for the terrain, taken from the free list when a long enough gap exists
+        auto allocate_run = [block_capacity, block_invalid](const uint32_t block_count)
+        {
+            sort(material_blocks_free.begin(), material_blocks_free.end());
+            for (size_t i = 0; i + block_count <= material_blocks_free.size(); i++)
             {
-                material->SetIndex(0);
-                if (!capacity_warning_logged)
+                if (material_blocks_free[i + block_count - 1] - material_blocks_free[i] == block_count - 1)
                 {
-                    SP_LOG_ERROR("material bindless capacity exceeded, overflowing materials will use index 0");
-                    capacity_warning_logged = true;
+                    const uint32_t first = material_blocks_free[i];
+                    material_blocks_free.erase(material_blocks_free.begin() + i, material_blocks_free.begin() + i + block_count);
+                    return first;
                 }
-                return;
             }
 
-            unique_material_ids.insert(material->GetObjectId());
+            if (material_block_end + block_count > block_capacity)
+            {
+                return block_invalid;
+            }
+
+            const uint32_t first  = material_block_end;
+            material_block_end   += block_count;
+            return first;
+        };
+
+        // the entry is left as is, nothing points at it anymore, but the textures are dropped so a
+        // released texture never reaches the descriptor update
+        auto release_block = [material_slot_count](const uint32_t block)
+        {
+            const uint32_t base = block * material_slot_count;
+            fill(m_bindless_textures.begin() + base, m_bindless_textures.begin() + base + material_slot_count, nullptr);
+            material_blocks_free.push_back(block);
+            material_textures_changed = true;
+        };
+
+        auto write_material = [&should_decode_as_srgb, material_slot_count](Material* material, const uint32_t block)
+        {
+            const uint32_t index = block * material_slot_count;
+            Sb_Material& entry   = properties[index];
+            entry                = Sb_Material{};
+
             {
                 // uv state (tiling, offset, invert, rotation, world_space_uv) intentionally not uploaded here,
                 // it is per-render and lives on Sb_DrawData (see WriteDrawData) and Sb_GeometryInfo for rt
-                properties[count].local_width           = material->GetProperty(MaterialProperty::WorldWidth);
-                properties[count].local_height          = material->GetProperty(MaterialProperty::WorldHeight);
-                properties[count].emissive_strength     = material->GetProperty(MaterialProperty::EmissiveFromAlbedo);
-                properties[count].color.x               = material->GetProperty(MaterialProperty::ColorR);
-                properties[count].color.y               = material->GetProperty(MaterialProperty::ColorG);
-                properties[count].color.z               = material->GetProperty(MaterialProperty::ColorB);
-                properties[count].color.w               = material->GetProperty(MaterialProperty::ColorA);
-                properties[count].roughness             = material->GetProperty(MaterialProperty::Roughness);
-                properties[count].metalness             = material->GetProperty(MaterialProperty::Metalness);
-                properties[count].normal                = material->GetProperty(MaterialProperty::Normal);
-                properties[count].height                = material->GetProperty(MaterialProperty::Height);
-                properties[count].anisotropic           = material->GetProperty(MaterialProperty::Anisotropic);
-                properties[count].anisotropic_rotation  = material->GetProperty(MaterialProperty::AnisotropicRotation);
-                properties[count].clearcoat             = material->GetProperty(MaterialProperty::Clearcoat);
-                properties[count].clearcoat_roughness   = material->GetProperty(MaterialProperty::Clearcoat_Roughness);
-                properties[count].flake_strength        = material->GetProperty(MaterialProperty::FlakeStrength);
-                properties[count].flake_scale           = material->GetProperty(MaterialProperty::FlakeScale);
-                properties[count].pearl_strength        = material->GetProperty(MaterialProperty::PearlStrength);
-                properties[count].pearl_color.x         = material->GetProperty(MaterialProperty::PearlColorR);
-                properties[count].pearl_color.y         = material->GetProperty(MaterialProperty::PearlColorG);
-                properties[count].pearl_color.z         = material->GetProperty(MaterialProperty::PearlColorB);
-                properties[count].pearl_color.w         = 1.0f;
-                properties[count].coat_tint.x           = material->GetProperty(MaterialProperty::CoatTintR);
-                properties[count].coat_tint.y           = material->GetProperty(MaterialProperty::CoatTintG);
-                properties[count].coat_tint.z           = material->GetProperty(MaterialProperty::CoatTintB);
-                properties[count].coat_tint.w           = material->GetProperty(MaterialProperty::CoatTintStrength);
-                properties[count].ior                   = material->GetProperty(MaterialProperty::Ior);
-                properties[count].absorption            = material->GetProperty(MaterialProperty::Absorption);
-                properties[count].thickness             = material->GetProperty(MaterialProperty::Thickness);
-                properties[count].sheen                 = material->GetProperty(MaterialProperty::Sheen);
-                properties[count].subsurface_scattering = material->GetProperty(MaterialProperty::SubsurfaceScattering);
-                properties[count].terrain_blend         = material->GetProperty(MaterialProperty::TerrainBlend);
-                properties[count].terrain_blend_sharpness =
-                    material->GetProperty(MaterialProperty::TerrainBlendSharpness);
+                const array<float, static_cast<uint32_t>(MaterialProperty::Max)>& p = material->GetProperties();
+                auto get = [&p](const MaterialProperty property) { return p[static_cast<uint32_t>(property)]; };
+
+                entry.local_width             = get(MaterialProperty::WorldWidth);
+                entry.local_height            = get(MaterialProperty::WorldHeight);
+                entry.emissive_strength       = get(MaterialProperty::EmissiveFromAlbedo);
+                entry.color.x                 = get(MaterialProperty::ColorR);
+                entry.color.y                 = get(MaterialProperty::ColorG);
+                entry.color.z                 = get(MaterialProperty::ColorB);
+                entry.color.w                 = get(MaterialProperty::ColorA);
+                entry.roughness               = get(MaterialProperty::Roughness);
+                entry.metalness               = get(MaterialProperty::Metalness);
+                entry.normal                  = get(MaterialProperty::Normal);
+                entry.height                  = get(MaterialProperty::Height);
+                entry.anisotropic             = get(MaterialProperty::Anisotropic);
+                entry.anisotropic_rotation    = get(MaterialProperty::AnisotropicRotation);
+                entry.clearcoat               = get(MaterialProperty::Clearcoat);
+                entry.clearcoat_roughness     = get(MaterialProperty::Clearcoat_Roughness);
+                entry.flake_strength          = get(MaterialProperty::FlakeStrength);
+                entry.flake_scale             = get(MaterialProperty::FlakeScale);
+                entry.pearl_strength          = get(MaterialProperty::PearlStrength);
+                entry.pearl_color.x           = get(MaterialProperty::PearlColorR);
+                entry.pearl_color.y           = get(MaterialProperty::PearlColorG);
+                entry.pearl_color.z           = get(MaterialProperty::PearlColorB);
+                entry.pearl_color.w           = 1.0f;
+                entry.coat_tint.x             = get(MaterialProperty::CoatTintR);
+                entry.coat_tint.y             = get(MaterialProperty::CoatTintG);
+                entry.coat_tint.z             = get(MaterialProperty::CoatTintB);
+                entry.coat_tint.w             = get(MaterialProperty::CoatTintStrength);
+                entry.ior                     = get(MaterialProperty::Ior);
+                entry.absorption              = get(MaterialProperty::Absorption);
+                entry.thickness               = get(MaterialProperty::Thickness);
+                entry.sheen                   = get(MaterialProperty::Sheen);
+                entry.subsurface_scattering   = get(MaterialProperty::SubsurfaceScattering);
+                entry.terrain_blend           = get(MaterialProperty::TerrainBlend);
+                entry.terrain_blend_sharpness = get(MaterialProperty::TerrainBlendSharpness);
 
                 // flags
-                properties[count].flags  = material->HasTextureOfType(MaterialTextureType::Height)             ? (1U << 0)  : 0;
-                properties[count].flags |= material->HasTextureOfType(MaterialTextureType::Normal)             ? (1U << 1)  : 0;
-                properties[count].flags |= material->HasTextureOfType(MaterialTextureType::Color)              ? (1U << 2)  : 0;
-                properties[count].flags |= material->HasTextureOfType(MaterialTextureType::Roughness)          ? (1U << 3)  : 0;
-                properties[count].flags |= material->HasTextureOfType(MaterialTextureType::Metalness)          ? (1U << 4)  : 0;
-                properties[count].flags |= material->HasTextureOfType(MaterialTextureType::AlphaMask)          ? (1U << 5)  : 0;
-                properties[count].flags |= material->HasTextureOfType(MaterialTextureType::Emission)           ? (1U << 6)  : 0;
-                properties[count].flags |= material->HasTextureOfType(MaterialTextureType::Occlusion)          ? (1U << 7)  : 0;
-                properties[count].flags |= material->GetProperty(MaterialProperty::IsTerrain)                  ? (1U << 8)  : 0;
-                properties[count].flags |= material->GetProperty(MaterialProperty::WindAnimation)              ? (1U << 9)  : 0;
-                properties[count].flags |= material->GetProperty(MaterialProperty::ColorVariationFromInstance) ? (1U << 10) : 0;
-                properties[count].flags |= material->GetProperty(MaterialProperty::IsGrassBlade)               ? (1U << 11) : 0;
-                properties[count].flags |= material->GetProperty(MaterialProperty::IsFlower)                   ? (1U << 12) : 0;
-                properties[count].flags |= material->GetProperty(MaterialProperty::IsWater)                    ? (1U << 13) : 0;
-                properties[count].flags |= material->GetProperty(MaterialProperty::Tessellation)               ? (1U << 14) : 0;
-                properties[count].flags |= material->GetProperty(MaterialProperty::EmissiveFromAlbedo)         ? (1U << 15) : 0;
-                properties[count].flags |= material->IsAlphaTested()                                          ? (1U << 16) : 0;
-                properties[count].flags |= should_decode_as_srgb(material->GetTexture(MaterialTextureType::Color))    ? (1U << 17) : 0;
-                properties[count].flags |= should_decode_as_srgb(material->GetTexture(MaterialTextureType::Emission)) ? (1U << 18) : 0;
-                properties[count].flags |= material->GetProperty(MaterialProperty::MotionBlurRadial)          ? (1U << 19) : 0;
+                entry.flags  = material->HasTextureOfType(MaterialTextureType::Height)    ? (1U << 0)  : 0;
+                entry.flags |= material->HasTextureOfType(MaterialTextureType::Normal)    ? (1U << 1)  : 0;
+                entry.flags |= material->HasTextureOfType(MaterialTextureType::Color)     ? (1U << 2)  : 0;
+                entry.flags |= material->HasTextureOfType(MaterialTextureType::Roughness) ? (1U << 3)  : 0;
+                entry.flags |= material->HasTextureOfType(MaterialTextureType::Metalness) ? (1U << 4)  : 0;
+                entry.flags |= material->HasTextureOfType(MaterialTextureType::AlphaMask) ? (1U << 5)  : 0;
+                entry.flags |= material->HasTextureOfType(MaterialTextureType::Emission)  ? (1U << 6)  : 0;
+                entry.flags |= material->HasTextureOfType(MaterialTextureType::Occlusion) ? (1U << 7)  : 0;
+                entry.flags |= get(MaterialProperty::IsTerrain)                           ? (1U << 8)  : 0;
+                entry.flags |= get(MaterialProperty::WindAnimation)                       ? (1U << 9)  : 0;
+                entry.flags |= get(MaterialProperty::ColorVariationFromInstance)          ? (1U << 10) : 0;
+                entry.flags |= get(MaterialProperty::IsGrassBlade)                        ? (1U << 11) : 0;
+                entry.flags |= get(MaterialProperty::IsFlower)                            ? (1U << 12) : 0;
+                entry.flags |= get(MaterialProperty::IsWater)                             ? (1U << 13) : 0;
+                entry.flags |= get(MaterialProperty::Tessellation)                        ? (1U << 14) : 0;
+                entry.flags |= get(MaterialProperty::EmissiveFromAlbedo)                  ? (1U << 15) : 0;
+                entry.flags |= material->IsAlphaTested()                                  ? (1U << 16) : 0;
+                entry.flags |= should_decode_as_srgb(material->GetTexture(MaterialTextureType::Color))    ? (1U << 17) : 0;
+                entry.flags |= should_decode_as_srgb(material->GetTexture(MaterialTextureType::Emission)) ? (1U << 18) : 0;
+                entry.flags |= get(MaterialProperty::MotionBlurRadial)                    ? (1U << 19) : 0;
                 // keep in sync with Surface struct in common_structs.hlsl
             }
-    
-            // textures
+
+            // textures, laid out type major in the same order as Material::GetTextures()
+            const auto& textures = material->GetTextures();
+            if (!equal(textures.begin(), textures.end(), m_bindless_textures.begin() + index))
             {
-                for (uint32_t type = 0; type < static_cast<uint32_t>(MaterialTextureType::Max); type++)
-                {
-                    for (uint32_t slot = 0; slot < Material::slots_per_texture; slot++)
-                    {
-                        uint32_t bindless_index = count + (type * Material::slots_per_texture) + slot;
-                        m_bindless_textures[bindless_index] = material->GetTexture(static_cast<MaterialTextureType>(type), slot);
-                    }
-                }
+                copy(textures.begin(), textures.end(), m_bindless_textures.begin() + index);
+                material_textures_changed = true;
             }
-    
-            material->SetIndex(count);
 
-            count += material_slot_count;
+            material->SetIndex(index);
+            material_blocks_dirty.push_back(block);
         };
-    
-        auto update_entities = [update_material]()
+
+        auto update_material = [&](Material* material)
         {
-            for (Entity* entity : render_entities())
+            auto it = material_slots.find(material->GetObjectId());
+            if (it == material_slots.end())
             {
-                Render* render = entity->GetComponent<Render>();
-                if (!render)
+                const uint32_t block = allocate_block();
+                if (block == block_invalid)
                 {
-                    continue;
+                    material->SetIndex(0);
+                    if (!capacity_warning_logged)
+                    {
+                        SP_LOG_ERROR("material bindless capacity exceeded, overflowing materials will use index 0");
+                        capacity_warning_logged = true;
+                    }
+                    return;
                 }
 
-                if (Material* material = render->GetMaterial())
-                {
-                    update_material(material);
-                }
+                it = material_slots.emplace(material->GetObjectId(), MaterialSlot{ block }).first;
+            }
+
+            MaterialSlot& slot = it->second;
+            if (slot.pass == material_pass)
+            {
+                return;
+            }
+            slot.pass = material_pass;
+
+            const uint64_t srv_hash = compute_srv_hash(material);
+            if (slot.revision != material->GetRevision() || slot.srv_hash != srv_hash)
+            {
+                write_material(material, slot.block);
+                material_textures_changed |= slot.srv_hash != srv_hash;
+                slot.revision = material->GetRevision();
+                slot.srv_hash = srv_hash;
             }
         };
-    
-        properties.fill(Sb_Material{});
-        m_bindless_textures.fill(nullptr);
-        unique_material_ids.clear();
 
-        // terrain goes first so the enabled layers land as one contiguous block, the surface
+        // terrain goes first so the enabled layers land as one contiguous run, the surface
         // material then only has to carry the base index and the shader can walk the rest
         // a layer whose folder was missing has a null material and is simply skipped, its weight
         // redistributes across the layers that do exist
-        if (m_pass_state.terrain_enabled && m_pass_state.terrain.surface)
         {
             const TerrainParams& terrain = m_pass_state.terrain;
+            const bool has_terrain       = m_pass_state.terrain_enabled && terrain.surface;
 
-            uint32_t layer_base  = count;
-            uint32_t layer_count = 0;
-            for (uint32_t i = 0; i < terrain_layer_max; i++)
+            array<Material*, terrain_layer_max + 1> run_materials = {};
+            array<uint32_t, terrain_layer_max> run_rules          = {};
+            uint32_t layer_count                                  = 0;
+            uint32_t run_count                                    = 0;
+            if (has_terrain)
             {
-                Material* layer = terrain.layer_materials[i];
-                if (!layer || terrain.layer_rules[i].weight_bias <= 0.0f)
+                for (uint32_t i = 0; i < terrain_layer_max; i++)
                 {
-                    continue;
+                    Material* layer = terrain.layer_materials[i];
+                    if (!layer || terrain.layer_rules[i].weight_bias <= 0.0f)
+                    {
+                        continue;
+                    }
+
+                    // a material listed twice keeps its first position
+                    if (find(run_materials.begin(), run_materials.begin() + run_count, layer) != run_materials.begin() + run_count)
+                    {
+                        continue;
+                    }
+
+                    run_rules[run_count]       = i;
+                    run_materials[run_count++] = layer;
                 }
+                layer_count = run_count;
 
-                const uint32_t index_before = count;
-                update_material(layer);
-                if (count == index_before)
+                if (find(run_materials.begin(), run_materials.begin() + run_count, terrain.surface) == run_materials.begin() + run_count)
                 {
-                    // already registered through an entity, which would break contiguity
-                    continue;
+                    run_materials[run_count++] = terrain.surface;
                 }
+            }
 
-                const TerrainLayerRule& rule = terrain.layer_rules[i];
-                Sb_Material& entry           = properties[index_before];
+            // a different set of materials needs a different run, the old one goes back to the free list
+            bool run_changed = run_count != material_terrain_ids.size();
+            for (uint32_t i = 0; i < run_count && !run_changed; i++)
+            {
+                run_changed = run_materials[i]->GetObjectId() != material_terrain_ids[i];
+            }
 
-                entry.terrain_slope_range         = Vector2(rule.slope_min * math::deg_to_rad, rule.slope_max * math::deg_to_rad);
-                entry.terrain_height_range        = Vector2(rule.height_min, rule.height_max);
-                entry.terrain_curvature_influence = rule.curvature_influence;
-                entry.terrain_flow_influence      = rule.flow_influence;
-                entry.terrain_occlusion_influence = rule.occlusion_influence;
-                entry.terrain_insolation_influence= rule.insolation_influence;
-                entry.terrain_wear_influence      = rule.wear_influence;
-                entry.terrain_deposition_influence= rule.deposition_influence;
-                entry.terrain_talus_influence     = rule.talus_influence;
-                entry.terrain_weight_bias         = rule.weight_bias;
-                entry.terrain_tiling_scale        = rule.tiling_scale;
-                entry.terrain_blend_contrast      = rule.blend_contrast;
-                entry.terrain_porosity            = rule.porosity;
-                entry.terrain_macro_strength      = rule.macro_strength;
-                entry.terrain_flags               = rule.flags;
+            if (run_changed)
+            {
+                for (uint64_t id : material_terrain_ids)
+                {
+                    if (auto it = material_slots.find(id); it != material_slots.end())
+                    {
+                        release_block(it->second.block);
+                        material_slots.erase(it);
+                    }
+                }
+                material_terrain_ids.clear();
 
-                layer_count++;
+                const uint32_t first = run_count ? allocate_run(run_count) : block_invalid;
+                if (first != block_invalid)
+                {
+                    material_terrain_block = first;
+                    for (uint32_t i = 0; i < run_count; i++)
+                    {
+                        // a material that already owned a block moves into the run
+                        const uint64_t id = run_materials[i]->GetObjectId();
+                        if (auto it = material_slots.find(id); it != material_slots.end())
+                        {
+                            release_block(it->second.block);
+                        }
+                        material_slots[id] = MaterialSlot{ first + i };
+                        material_terrain_ids.push_back(id);
+                    }
+                }
+                else if (run_count)
+                {
+                    SP_LOG_ERROR("material bindless capacity exceeded, no contiguous run left for %u terrain materials", run_count);
+                    run_count = 0;
+                }
             }
 
-            // the surface material follows the block, its own entry points back at the base
-            const uint32_t surface_index = count;
-            update_material(terrain.surface);
-            if (count != surface_index)
+            // the rules and terrain parameters don't live on a Material, so the run is rewritten on every pass,
+            // it's at most terrain_layer_max + 1 entries
+            for (uint32_t i = 0; i < run_count; i++)
             {
-                Sb_Material& entry = properties[surface_index];
+                Material* material      = run_materials[i];
+                MaterialSlot& slot      = material_slots[material->GetObjectId()];
+                const uint64_t srv_hash = compute_srv_hash(material);
+                write_material(material, slot.block);
+                material_textures_changed |= slot.srv_hash != srv_hash;
+                slot.pass     = material_pass;
+                slot.revision = material->GetRevision();
+                slot.srv_hash = srv_hash;
 
-                entry.terrain_world_mapping = terrain.world_mapping;
-                entry.terrain_sea_level     = terrain.sea_level;
-                entry.terrain_snow_level    = terrain.snow_level;
-                entry.terrain_layer_base    = layer_base;
-                entry.terrain_layer_count   = layer_count;
-                entry.terrain_layer_stride  = material_slot_count;
-                entry.terrain_snow_amount   = terrain.snow_amount;
-                entry.terrain_wetness       = terrain.wetness;
-                entry.terrain_flags         = (terrain.map_a && terrain.map_b) ? TerrainLayerFlags_HasMaps : 0u;
-
-                // quality rides in the bits above the flag range, 1 to 4 layers per pixel, and the
-                // debug view sits above that, see terrain_layer_quality in shared_buffers.h
-                entry.terrain_flags |= (min(max(terrain.quality, 1u), 4u) << 8);
-                entry.terrain_flags |= (min(terrain.debug_view, 15u) << 12);
+                Sb_Material& entry = properties[slot.block * material_slot_count];
+                if (i < layer_count)
+                {
+                    const TerrainLayerRule& rule = terrain.layer_rules[run_rules[i]];
+
+                    entry.terrain_slope_range         = Vector2(rule.slope_min * math::deg_to_rad, rule.slope_max * math::deg_to_rad);
+                    entry.terrain_height_range        = Vector2(rule.height_min, rule.height_max);
+                    entry.terrain_curvature_influence = rule.curvature_influence;
+                    entry.terrain_flow_influence      = rule.flow_influence;
+                    entry.terrain_occlusion_influence = rule.occlusion_influence;
+                    entry.terrain_insolation_influence= rule.insolation_influence;
+                    entry.terrain_wear_influence      = rule.wear_influence;
+                    entry.terrain_deposition_influence= rule.deposition_influence;
+                    entry.terrain_talus_influence     = rule.talus_influence;
+                    entry.terrain_weight_bias         = rule.weight_bias;
+                    entry.terrain_tiling_scale        = rule.tiling_scale;
+                    entry.terrain_blend_contrast      = rule.blend_contrast;
+                    entry.terrain_porosity            = rule.porosity;
+                    entry.terrain_macro_strength      = rule.macro_strength;
+                    entry.terrain_flags               = rule.flags;
+                }
+                else
+                {
+                    // the surface material follows the layers, its own entry points back at the base
+                    entry.terrain_world_mapping = terrain.world_mapping;
+                    entry.terrain_sea_level     = terrain.sea_level;
+                    entry.terrain_snow_level    = terrain.snow_level;
+                    entry.terrain_layer_base    = material_terrain_block * material_slot_count;
+                    entry.terrain_layer_count   = layer_count;
+                    entry.terrain_layer_stride  = material_slot_count;
+                    entry.terrain_snow_amount   = terrain.snow_amount;
+                    entry.terrain_wetness       = terrain.wetness;
+                    entry.terrain_flags         = (terrain.map_a && terrain.map_b) ? TerrainLayerFlags_HasMaps : 0u;
+
+                    // quality rides in the bits above the flag range, 1 to 4 layers per pixel, and the
+                    // debug view sits above that, see terrain_layer_quality in shared_buffers.h
+                    entry.terrain_flags |= (min(max(terrain.quality, 1u), 4u) << 8);
+                    entry.terrain_flags |= (min(terrain.debug_view, 15u) << 12);
+                }
             }
         }
 
-        update_entities();
+        for (Entity* entity : render_entities())
+        {
+            Render* render = entity->GetComponent<Render>();
+            if (!render)
+            {
+                continue;
+            }
+
+            if (Material* material = render->GetMaterial())
+            {
+                update_material(material);
+            }
+        }
 
         // a gpu scatter material is not attached to any entity, register it here so it lands in the
         // bindless table and material_index can be pushed into the scatter raster passes via the push constant
@@ -2835,9 +3205,62 @@ namespace spartan
             }
         }
 
-        RHI_Buffer* buffer = Renderer::GetBuffer(Renderer_Buffer::MaterialParameters);
-        buffer->ResetOffset();
-        buffer->Update(&properties[0], buffer->GetStride() * count);
+        // materials nothing referenced this pass give their block back, deleted ones included
+        for (auto it = material_slots.begin(); it != material_slots.end();)
+        {
+            if (it->second.pass != material_pass)
+            {
+                release_block(it->second.block);
+                it = material_slots.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        // upload the dirty blocks, neighbours within material_upload_merge_gap coalesce into one copy
+        if (!material_blocks_dirty.empty())
+        {
+            sort(material_blocks_dirty.begin(), material_blocks_dirty.end());
+            material_blocks_dirty.erase(unique(material_blocks_dirty.begin(), material_blocks_dirty.end()), material_blocks_dirty.end());
+
+            RHI_Buffer* buffer    = Renderer::GetBuffer(Renderer_Buffer::MaterialParameters);
+            const uint64_t stride = buffer->GetStride();
+            auto upload = [buffer, stride, material_slot_count](const uint32_t block_first, const uint32_t block_last)
+            {
+                // blocks are material_slot_count entries apart, only the first entry of the last block is live
+                const uint32_t index_first = block_first * material_slot_count;
+                const uint32_t index_last  = block_last * material_slot_count;
+                const uint64_t offset      = index_first * stride;
+                const uint64_t size        = (index_last - index_first + 1) * stride;
+
+                if (RHI_Device::IsRecording())
+                {
+                    RHI_CommandList::UpdateBuffer(buffer, offset, size, &properties[index_first]);
+                }
+                else
+                {
+                    buffer->UploadSubRegion(&properties[index_first], offset, size);
+                }
+            };
+
+            uint32_t run_first = material_blocks_dirty[0];
+            uint32_t run_last  = run_first;
+            for (size_t i = 1; i < material_blocks_dirty.size(); i++)
+            {
+                const uint32_t block = material_blocks_dirty[i];
+                if (block - run_last > material_upload_merge_gap)
+                {
+                    upload(run_first, run_last);
+                    run_first = block;
+                }
+                run_last = block;
+            }
+            upload(run_first, run_last);
+
+            material_blocks_dirty.clear();
+        }
     }
 
     void Renderer::UpdateLights()
@@ -3156,6 +3579,7 @@ namespace spartan
     {
         m_draw_call_count           = 0;
         m_draw_calls_prepass_count  = 0;
+        m_draw_calls_opaque_count   = 0;
         m_draw_data_count           = 0;
         m_draw_data_gpu_synced      = false;
         m_indirect_draw_count       = 0;
@@ -3177,128 +3601,184 @@ namespace spartan
                 tlas_available
             );
 
-        for (Entity* entity : render_entities())
+        // visibility only refreshes the distance of visible renders, off-screen casters measure their own
+        Camera* camera                = World::GetCamera();
+        const Vector3 camera_position = camera ? camera->GetEntity()->GetPosition() : Vector3::Zero;
+
+        // workers filter a chunk of entities each, a prefix sum over the chunk counts then hands every chunk
+        // its own slice of the draw call and draw data arrays, so the result matches the serial entity order
+        const vector<Entity*>& entities = render_entities();
+        const uint32_t entity_count     = static_cast<uint32_t>(entities.size());
+        const uint32_t chunk_count      = (entity_count + draw_collect_chunk_size - 1) / draw_collect_chunk_size;
+
+        // a worker may still be assigning the Render component or the material, so the second pass
+        // uses the pointers the first one validated instead of fetching them again
+        struct collected_draw
         {
-            if (!entity || !entity->GetActive())
-            {
-                continue;
-            }
-            if (
-                secondary_render_root_active &&
-                entity != secondary_render_root_active &&
-                !entity->IsDescendantOf(
-                    secondary_render_root_active
-                )
-            )
-            {
-                continue;
-            }
+            Entity* entity     = nullptr;
+            Render* render     = nullptr;
+            Material* material = nullptr;
+        };
 
-            // a worker may still be assigning the Render component, the mesh or the material, so guard every step
-            Render* render = entity->GetComponent<Render>();
-            if (!render || !render->GetMesh())
-            {
-                continue;
-            }
+        static vector<vector<collected_draw>> chunk_draws;
+        static vector<uint32_t> chunk_offsets;
+        static vector<uint8_t> chunk_transparents;
+        chunk_draws.resize(max(chunk_count, static_cast<uint32_t>(chunk_draws.size())));
+        chunk_offsets.assign(chunk_count, 0);
+        chunk_transparents.assign(chunk_count, 0);
 
-            Material* material = render->GetMaterial();
-            if (!material)
+        ThreadPool::ParallelFor(chunk_count, [&](uint32_t chunk_start, uint32_t chunk_end)
+        {
+            for (uint32_t chunk = chunk_start; chunk < chunk_end; chunk++)
             {
-                continue;
-            }
+                vector<collected_draw>& kept = chunk_draws[chunk];
+                kept.clear();
 
-            // off-screen geometry is only kept when classic shadow maps need the caster
-            if (!render->IsVisible())
-            {
-                if (material->IsTransparent())
+                const uint32_t first = chunk * draw_collect_chunk_size;
+                const uint32_t last  = min(first + draw_collect_chunk_size, entity_count);
+                for (uint32_t i = first; i < last; i++)
                 {
-                    m_transparents_present = true;
-                }
+                    Entity* entity = entities[i];
+                    if (!entity || !entity->GetActive())
+                    {
+                        continue;
+                    }
+                    if (
+                        secondary_render_root_active &&
+                        entity != secondary_render_root_active &&
+                        !entity->IsDescendantOf(
+                            secondary_render_root_active
+                        )
+                    )
+                    {
+                        continue;
+                    }
 
-                if (
-                    !shadow_maps_required ||
-                    !render->HasFlag(RenderFlags::CastsShadows)
-                )
-                {
-                    continue;
-                }
-            }
+                    // a worker may still be assigning the Render component, the mesh or the material, so guard every step
+                    Render* render = entity->GetComponent<Render>();
+                    if (!render || !render->GetMesh())
+                    {
+                        continue;
+                    }
 
-            if (material->IsTransparent())
-            {
-                m_transparents_present = true;
-            }
+                    Material* material = render->GetMaterial();
+                    if (!material)
+                    {
+                        continue;
+                    }
 
-            if (m_draw_call_count >= renderer_max_draw_calls)
-            {
-                break;
-            }
+                    if (material->IsTransparent())
+                    {
+                        chunk_transparents[chunk] = 1;
+                    }
 
-            uint32_t draw_data_index = WriteDrawData(
-                entity->GetMatrix(),
-                matrix_previous_for_velocity(entity),
-                material->GetIndex(),
-                material->IsTransparent() ? 1 : 0,
-                render
-            );
-            if (draw_data_index == numeric_limits<uint32_t>::max())
-            {
-                break;
+                    // off-screen geometry is only kept when classic shadow maps need the caster
+                    if (!render->IsVisible() && (!shadow_maps_required || !render->HasFlag(RenderFlags::CastsShadows)))
+                    {
+                        continue;
+                    }
+
+                    kept.push_back({ entity, render, material });
+                }
             }
+        });
 
-            Renderer_DrawCall& draw_call = m_draw_calls[m_draw_call_count++];
-            draw_call.render             = render;
-            draw_call.distance_squared   = render->GetDistanceSquared();
-            draw_call.lod_index          = render->GetLodIndex();
-            draw_call.is_occluder        = false;
-            draw_call.camera_visible     = render->IsVisible();
-            draw_call.instance_index     = 0;
-            draw_call.instance_count     = render->GetInstanceCount();
-            draw_call.draw_data_index    = draw_data_index;
+        // both the draw calls and the draw data, which imgui shares, have a ceiling, whatever is past it is dropped
+        const uint32_t budget = min(renderer_max_draw_calls - m_draw_call_count, renderer_max_draw_calls - m_draw_data_count);
+        uint32_t total        = 0;
+        for (uint32_t chunk = 0; chunk < chunk_count; chunk++)
+        {
+            chunk_offsets[chunk]    = total;
+            total                  += static_cast<uint32_t>(chunk_draws[chunk].size());
+            m_transparents_present |= chunk_transparents[chunk] != 0;
         }
-
-        // opaque before transparent, then by material id, then by distance
-        sort(m_draw_calls.begin(), m_draw_calls.begin() + m_draw_call_count, [](const Renderer_DrawCall& a, const Renderer_DrawCall& b)
+        if (total > budget)
         {
-            const bool a_transparent = a.render->GetMaterial()->IsTransparent();
-            const bool b_transparent = b.render->GetMaterial()->IsTransparent();
-            if (a_transparent != b_transparent)
+            static bool logged = false;
+            if (!logged)
             {
-                return !a_transparent;
+                SP_LOG_WARNING("draw call budget exhausted (%u), dropping further draws this frame", renderer_max_draw_calls);
+                logged = true;
             }
+            total = budget;
+        }
 
-            const uint64_t a_material_id = a.render->GetMaterial()->GetObjectId();
-            const uint64_t b_material_id = b.render->GetMaterial()->GetObjectId();
-            if (a_material_id != b_material_id)
-            {
-                return a_material_id < b_material_id;
-            }
+        const uint32_t draw_call_base = m_draw_call_count;
+        const uint32_t draw_data_base = m_draw_data_count;
+        m_draw_call_count            += total;
+        m_draw_data_count            += total;
 
-            return a_transparent ? a.distance_squared > b.distance_squared : a.distance_squared < b.distance_squared;
-        });
-    }
+        static vector<uint64_t> keys;
+        static vector<uint32_t> order;
+        keys.resize(total);
+        order.resize(total);
 
-    void Renderer::UpdateDrawCalls_BuildPrepass()
-    {
-        for (uint32_t i = 0; i < m_draw_call_count; ++i)
+        void* draw_data_mapped = GetBuffer(Renderer_Buffer::DrawData)->GetMappedData();
+        ThreadPool::ParallelFor(chunk_count, [&](uint32_t chunk_start, uint32_t chunk_end)
         {
-            const Renderer_DrawCall& dc = m_draw_calls[i];
-            if (!dc.render->GetMaterial()->IsTransparent() && dc.camera_visible)
+            for (uint32_t chunk = chunk_start; chunk < chunk_end; chunk++)
             {
-                m_draw_calls_prepass[m_draw_calls_prepass_count++] = dc;
+                const vector<collected_draw>& kept = chunk_draws[chunk];
+                const uint32_t offset              = chunk_offsets[chunk];
+                const uint32_t count               = offset < total ? min(static_cast<uint32_t>(kept.size()), total - offset) : 0;
+                for (uint32_t j = 0; j < count; j++)
+                {
+                    Entity* entity     = kept[j].entity;
+                    Render* render     = kept[j].render;
+                    Material* material = kept[j].material;
+                    const uint32_t i   = offset + j;
+
+                    const bool is_visible     = render->IsVisible();
+                    const bool is_transparent = material->IsTransparent();
+
+                    Renderer_DrawCall& draw_call = m_draw_calls[draw_call_base + i];
+                    draw_call.render             = render;
+                    draw_call.distance_squared   = is_visible ? render->GetDistanceSquared() : Vector3::DistanceSquared(camera_position, render->GetBoundingBox().GetClosestPoint(camera_position));
+                    draw_call.lod_index          = render->GetLodIndex();
+                    draw_call.is_occluder        = false;
+                    draw_call.camera_visible     = is_visible;
+                    draw_call.instance_index     = 0;
+                    draw_call.instance_count     = render->GetInstanceCount();
+                    draw_call.draw_data_index    = store_draw_data(
+                        draw_data_base + i,
+                        draw_data_mapped,
+                        entity->GetMatrix(),
+                        matrix_previous_for_velocity(entity),
+                        material->GetIndex(),
+                        is_transparent ? 1 : 0,
+                        render
+                    );
+                    draw_call.sort_key = pack_draw_key(is_transparent, is_visible, material->IsAlphaTested(), material->GetIndex(), draw_call.distance_squared);
+
+                    keys[i]  = draw_call.sort_key;
+                    order[i] = draw_call_base + i;
+                }
             }
-        }
+        });
+
+        // opaque before transparent, visible before shadow only casters, then by pipeline, material and distance
+        radix_sort(keys, order);
 
-        sort(m_draw_calls_prepass.begin(), m_draw_calls_prepass.begin() + m_draw_calls_prepass_count, [](const Renderer_DrawCall& a, const Renderer_DrawCall& b)
+        static vector<Renderer_DrawCall> sorted;
+        sorted.resize(total);
+        ThreadPool::ParallelFor(total, [&](uint32_t start, uint32_t end)
         {
-            const bool a_alpha = a.render->GetMaterial()->IsAlphaTested();
-            const bool b_alpha = b.render->GetMaterial()->IsAlphaTested();
-            if (a_alpha != b_alpha)
+            for (uint32_t i = start; i < end; i++)
             {
-                return !a_alpha;
+                sorted[i] = m_draw_calls[order[i]];
             }
-            return a.distance_squared < b.distance_squared;
-        });
+        }, 1024);
+        copy(sorted.begin(), sorted.end(), m_draw_calls.begin() + draw_call_base);
+
+        // the opaque draws are a prefix of the sorted list, shadow casters come from there
+        m_draw_calls_opaque_count = draw_keys_below(draw_key_transparent);
+    }
+
+    void Renderer::UpdateDrawCalls_BuildPrepass()
+    {
+        // opaque camera visible draws sort first, alpha tested ones after the rest, so the prepass is a prefix of the sorted list
+        m_draw_calls_prepass_count = draw_keys_below(draw_key_offscreen);
+        copy(m_draw_calls.begin(), m_draw_calls.begin() + m_draw_calls_prepass_count, m_draw_calls_prepass.begin());
     }
 
     void Renderer::UpdateDrawCalls_BuildIndirectAndCullTasks()
@@ -3317,21 +3797,14 @@ namespace spartan
         uint64_t expected_survivors_worst_case = 0;
         uint32_t cull_task_overflow_renders = 0;
 
-        for (uint32_t i = 0; i < m_draw_call_count; i++)
+        // the opaque camera visible key range, the same draws the prepass takes
+        for (uint32_t i = 0; i < m_draw_calls_prepass_count; i++)
         {
             const Renderer_DrawCall& dc = m_draw_calls[i];
             Render* render              = dc.render;
             Material* material          = render->GetMaterial();
 
-            if (!material || material->IsTransparent())
-            {
-                continue;
-            }
-            if (!dc.camera_visible)
-            {
-                continue;
-            }
-            if (material->GetProperty(MaterialProperty::Tessellation) > 0.0f)
+            if (!material || material->GetProperty(MaterialProperty::Tessellation) > 0.0f)
             {
                 continue;
             }
@@ -3723,9 +4196,11 @@ namespace spartan
             bool needs_tlas_rebuild =
                 !m_tlas ||
                 materials_uploaded_this_frame ||
+                geometry_relocated_this_frame ||
                 blas_refit_done ||
                 blas_built_this_frame;
             materials_uploaded_this_frame = false;
+            geometry_relocated_this_frame = false;
 
             if (!needs_tlas_rebuild)
             {
@@ -717,6 +717,7 @@ namespace spartan
         uint32_t lod_index       = 0;
         uint32_t draw_data_index = 0; // index into the bindless draw data buffer
         float distance_squared   = 0.0f;
+        uint64_t sort_key        = 0;     // draws sort by this, the prepass and shadow casters are key ranges of it
         bool is_occluder         = false;
         bool camera_visible      = false;
     };
@@ -178,6 +178,7 @@ namespace spartan
             uint32_t m_draw_call_count;
             std::array<Renderer_DrawCall, renderer_max_draw_calls> m_draw_calls_prepass;
             uint32_t m_draw_calls_prepass_count;
+            uint32_t m_draw_calls_opaque_count; // opaque draws are a prefix of the sorted draw calls
             std::array<Sb_DrawData, renderer_max_indirect_draws> m_indirect_draw_data;
             std::array<Render*, renderer_max_indirect_draws>     m_indirect_renders;
             uint32_t m_indirect_draw_count;
@@ -228,6 +229,7 @@ namespace spartan
         inline auto& m_draw_call_count = state().m_draw_call_count;
         inline auto& m_draw_calls_prepass = state().m_draw_calls_prepass;
         inline auto& m_draw_calls_prepass_count = state().m_draw_calls_prepass_count;
+        inline auto& m_draw_calls_opaque_count = state().m_draw_calls_opaque_count;
         inline auto& m_indirect_draw_data = state().m_indirect_draw_data;
         inline auto& m_indirect_renders = state().m_indirect_renders;
         inline auto& m_indirect_draw_count = state().m_indirect_draw_count;
@@ -29,6 +29,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../world/World.h"
 #include "../resource/IResource.h"
 #include "../rhi/RHI_CommandList.h"
+#include "../memory/Allocator.h"
 #include "../rhi/RHI_Buffer.h"
 #include "../rhi/RHI_AccelerationStructure.h"
 #include "../rhi/RHI_RasterizerState.h"
@@ -120,7 +121,7 @@ namespace spartan
         }
 
         // same formula as Terrain::SampleHeight, world_y = local_y + matrix translation
-        // GetPosition is 0 until UpdateTransform, which is also when the tiles drop, so the
+        // GetPosition is 0 until the first transform is set, which is also when the tiles drop, so the
         // offset cannot fire on its own and put grass under the mesh
         void get_grass_terrain_frame_state(Vector3& offset_out, Vector4& mapping_out)
         {
@@ -240,6 +241,32 @@ namespace spartan
             vector<const Renderer_DrawCall*> direct_draws;
         };
 
+        // the light independent filters run once over the opaque key range, every slice then culls the surviving casters in one batch
+        static vector<uint32_t> casters;
+        static FrustumBatch caster_boxes;
+        static vector<uint64_t> caster_visibility;
+        casters.clear();
+        caster_boxes.Clear();
+        for (uint32_t i = 0; i < m_draw_calls_opaque_count; i++)
+        {
+            const Renderer_DrawCall& draw_call = m_draw_calls[i];
+            Render* render                     = draw_call.render;
+            if (!render->HasFlag(RenderFlags::CastsShadows))
+            {
+                continue;
+            }
+
+            const float shadow_distance = render->GetMaxShadowDistance();
+            if (draw_call.distance_squared > shadow_distance * shadow_distance)
+            {
+                continue;
+            }
+
+            const BoundingBox& bounding_box = render->GetBoundingBox();
+            casters.push_back(i);
+            caster_boxes.Add(bounding_box.GetCenter(), bounding_box.GetExtents());
+        }
+
         vector<ShadowSlice> slices;
         uint32_t argument_count = 0;
         bool has_alpha_draws = false;
@@ -264,31 +291,19 @@ namespace spartan
                 slice.array_index = array_index;
                 slice.rect        = rect;
 
-                for (uint32_t i = 0; i < m_draw_call_count; i++)
-                {
-                    const Renderer_DrawCall& draw_call = m_draw_calls[i];
-                    Render* render                     = draw_call.render;
-                    if (!render->HasFlag(RenderFlags::CastsShadows))
-                    {
-                        continue;
-                    }
-
-                    const float shadow_distance = render->GetMaxShadowDistance();
-                    if (draw_call.distance_squared > shadow_distance * shadow_distance)
-                    {
-                        continue;
-                    }
+                const bool ignore_depth = light->GetLightType() == LightType::Directional; // orthographic
+                light->GetFrustum(array_index).CullBatch(caster_boxes, caster_visibility, ignore_depth);
 
-                    Material* material = render->GetMaterial();
-                    if (!material || material->IsTransparent())
+                for (uint32_t caster = 0; caster < static_cast<uint32_t>(casters.size()); caster++)
+                {
+                    if (!((caster_visibility[caster >> 6] >> (caster & 63)) & 1))
                     {
                         continue;
                     }
 
-                    if (!light->IsInViewFrustum(render, array_index))
-                    {
-                        continue;
-                    }
+                    const Renderer_DrawCall& draw_call = m_draw_calls[casters[caster]];
+                    Render* render                     = draw_call.render;
+                    Material* material                 = render->GetMaterial();
 
                     slice.visible_draws.push_back(&draw_call);
                     RHI_Buffer* vertex_buffer = render->GetVertexBuffer();
@@ -315,7 +330,7 @@ namespace spartan
                     }
                     ShadowBatch& batch = slice.batches[it->second];
 
-                    const bool close_to_shadow      = render->GetDistanceSquared() < 100.0f * 100.0f;
+                    const bool close_to_shadow      = draw_call.distance_squared < 100.0f * 100.0f;
                     const uint32_t lod_index_bias   = light->GetLightType() == LightType::Directional ? 1 : 0;
                     const uint32_t lod_index_shadow = clamp(render->GetLodIndex() + lod_index_bias, 0u, render->GetLodCount() - 1);
                     const uint32_t lod_index        = close_to_shadow ? draw_call.lod_index : lod_index_shadow;
@@ -432,7 +447,7 @@ namespace spartan
                     RHI_CommandList::SetBufferVertex(render->GetVertexBuffer(), instance_buffer);
                     RHI_CommandList::SetBufferIndex(render->GetIndexBuffer());
 
-                    const bool close_to_shadow      = render->GetDistanceSquared() < 100.0f * 100.0f;
+                    const bool close_to_shadow      = draw_call.distance_squared < 100.0f * 100.0f;
                     const uint32_t lod_index_bias   = light->GetLightType() == LightType::Directional ? 1 : 0;
                     const uint32_t lod_index_shadow = clamp(render->GetLodIndex() + lod_index_bias, 0u, render->GetLodCount() - 1);
                     const uint32_t lod_index        = close_to_shadow ? draw_call.lod_index : lod_index_shadow;
@@ -471,8 +486,8 @@ namespace spartan
 
         vector<HiZBatch> batches;
         unordered_map<IndexedBatchKey, uint32_t, IndexedBatchKeyHash> batch_lookup;
-        vector<const Renderer_DrawCall*> visible_draws;
-        vector<const Renderer_DrawCall*> direct_draws;
+        FrameVector<const Renderer_DrawCall*, MemoryTag::Rendering> visible_draws;
+        FrameVector<const Renderer_DrawCall*, MemoryTag::Rendering> direct_draws;
         uint32_t argument_count = 0;
         if (render_occluders)
         {
@@ -579,7 +594,7 @@ namespace spartan
                     RHI_CommandList::DrawIndexed(render->GetIndexCount(draw_call.lod_index), render->GetIndexOffset(draw_call.lod_index), render->GetVertexOffset(draw_call.lod_index));
                 };
 
-                const vector<const Renderer_DrawCall*>& draws = use_batches ? direct_draws : visible_draws;
+                const FrameVector<const Renderer_DrawCall*, MemoryTag::Rendering>& draws = use_batches ? direct_draws : visible_draws;
                 for (const Renderer_DrawCall* draw_call : draws)
                 {
                     draw_direct(*draw_call);
@@ -34,6 +34,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../rhi/RHI_Shader.h"
 #include "../rhi/RHI_VendorTechnology.h"
 #include "../xr/Xr.h"
+#include "../memory/Allocator.h"
 //=============================================
 
 //= NAMESPACES ===============
@@ -734,7 +735,7 @@ namespace spartan
     void Renderer::Pass_Particles()
     {
         // gather every active emitter, cached at world resolve
-        vector<ParticleSystem*> emitters;
+        FrameVector<ParticleSystem*, MemoryTag::Rendering> emitters;
         emitters.reserve(World::GetEntitiesWithParticles().size());
         for (Entity* entity : World::GetEntitiesWithParticles())
         {
@@ -794,9 +795,9 @@ namespace spartan
         // each emitter gets a stable slice of the shared buffer, avoiding cross emitter stomping
         uint32_t buffer_capacity = static_cast<uint32_t>(buf_a->GetObjectSize() / sizeof(Sb_Particle));
         uint32_t total_particles = 0;
-        vector<uint32_t> range_starts(emitter_count, 0);
-        vector<uint32_t> range_counts(emitter_count, 0);
-        vector<uint32_t> emit_counts(emitter_count, 0);
+        FrameVector<uint32_t, MemoryTag::Rendering> range_starts(emitter_count, 0);
+        FrameVector<uint32_t, MemoryTag::Rendering> range_counts(emitter_count, 0);
+        FrameVector<uint32_t, MemoryTag::Rendering> emit_counts(emitter_count, 0);
         bool volume_present = false;
         for (uint32_t i = 0; i < emitter_count; i++)
         {
@@ -833,8 +834,8 @@ namespace spartan
         const float delta_time = std::clamp(m_cb_frame_cpu.delta_time, 0.0f, 0.1f);
 
         // one params entry per emitter, the ring size and frame data are shared so every entry carries the same copy
-        vector<Sb_EmitterParams> emitter_params(emitter_count);
-        vector<float> emitter_distance(emitter_count, 0.0f);
+        FrameVector<Sb_EmitterParams, MemoryTag::Rendering> emitter_params(emitter_count);
+        FrameVector<float, MemoryTag::Rendering> emitter_distance(emitter_count, 0.0f);
         math::Vector3 camera_position = math::Vector3::Zero;
         if (Camera* camera = World::GetCamera())
         {
@@ -897,7 +898,7 @@ namespace spartan
             const float volume_max_distance    = 96.0f; // must match volume_max_distance in particles_volumetric.hlsl
             const uint32_t volumetric_budget   = 8;
 
-            vector<uint32_t> candidates;
+            FrameVector<uint32_t, MemoryTag::Rendering> candidates;
             candidates.reserve(emitter_count);
             for (uint32_t i = 0; i < emitter_count; i++)
             {
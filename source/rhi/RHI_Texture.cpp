@@ -34,6 +34,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../resource/import/ImageImporter.h"
 #include "../core/ProgressTracker.h"
 #include "../profiling/Breadcrumbs.h"
+#include "../world/ChangeJournal.h"
 //===========================================
 
 //= NAMESPACES =====
@@ -996,6 +997,9 @@ namespace spartan
             m_resource_state = ResourceState::Max;
         }
 
+        // materials sampling this texture pick up the new state from the journal instead of polling it
+        ChangeJournal::RecordTexture(GetObjectId());
+
         Breadcrumbs::EndMarker(); // prepare_gpu
     }
 
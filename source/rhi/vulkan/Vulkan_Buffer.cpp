@@ -64,6 +64,7 @@ namespace spartan
         // VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT       -> mappable
         // VK_MEMORY_PROPERTY_HOST_COHERENT_BIT      -> persistently mapped (flushless)
         // VK_BUFFER_USAGE_TRANSFER_DST_BIT          -> vkCmdUpdateBuffer()
+        // VK_BUFFER_USAGE_TRANSFER_SRC_BIT          -> gpu side copy into a larger buffer on growth
         // VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT -> RHI_Device::GetBufferDeviceAddress(void* buffer)
 
         if (m_type == RHI_Buffer_Type::Vertex || m_type == RHI_Buffer_Type::Index || m_type == RHI_Buffer_Type::Instance)
@@ -91,7 +92,7 @@ namespace spartan
             else
             {
                 // create destination buffer (device-local, fastest for gpu access)
-                RHI_Device::MemoryBufferCreate(m_rhi_resource, m_object_size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | flags_usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, nullptr, m_object_name.c_str());
+                RHI_Device::MemoryBufferCreate(m_rhi_resource, m_object_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | flags_usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, nullptr, m_object_name.c_str());
 
                 // if initial data is provided, upload it via a staging buffer
                 if (data && m_rhi_resource)
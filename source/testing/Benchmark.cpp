@@ -0,0 +1,198 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==================
+#include "pch.h"
+#include "Benchmark.h"
+#include "../core/ThreadPool.h"
+#include "../memory/Allocator.h"
+//===============================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace spartan
+{
+    namespace
+    {
+        vector<string> arguments;
+
+        struct suite
+        {
+            const char* name;
+            void (*run)();
+        };
+
+        // allocations and peak rss growth are only known for measured workloads, negative means not measured
+        struct result
+        {
+            string suite;
+            string name;
+            string unit;
+            double value             = 0.0;
+            int64_t allocations      = -1;
+            double peak_rss_delta_mb = -1.0;
+        };
+        vector<result> results;
+
+        bool write_results(const string& file_path)
+        {
+            FILE* file = fopen(file_path.c_str(), "w");
+            if (!file)
+            {
+                return false;
+            }
+
+            fprintf(file, "{\n  \"results\": [");
+            for (size_t i = 0; i < results.size(); i++)
+            {
+                const result& r = results[i];
+                fprintf(file, "%s\n    { \"suite\": \"%s\", \"name\": \"%s\", \"value\": %.6f, \"unit\": \"%s\"", i == 0 ? "" : ",", r.suite.c_str(), r.name.c_str(), r.value, r.unit.c_str());
+                if (r.allocations >= 0)
+                {
+                    fprintf(file, ", \"allocations\": %lld, \"peak_rss_delta_mb\": %.1f", static_cast<long long>(r.allocations), r.peak_rss_delta_mb);
+                }
+                fprintf(file, " }");
+            }
+            fprintf(file, "\n  ]\n}\n");
+
+            return fclose(file) == 0;
+        }
+    }
+
+    int Benchmark::Run(const vector<string>& args)
+    {
+        const suite suites[] =
+        {
+            { "threadpool", &Benchmark::Suite_ThreadPool },
+            { "allocator",  &Benchmark::Suite_Allocator  },
+            { "world",      &Benchmark::Suite_World      },
+            { "terrain",    &Benchmark::Suite_Terrain    },
+            { "animation",  &Benchmark::Suite_Animation  },
+            { "physics",    &Benchmark::Suite_Physics    },
+            { "mcp",        &Benchmark::Suite_Mcp        },
+            { "culling",    &Benchmark::Suite_Culling    }
+        };
+
+        arguments           = args;
+        const string filter = GetArgumentValue("-benchmark_filter");
+        results.clear();
+
+        // the workload suites run on the job system like they do in the engine
+        ThreadPool::Initialize();
+
+        uint32_t ran = 0;
+        for (const suite& s : suites)
+        {
+            if (!filter.empty() && filter != s.name)
+            {
+                continue;
+            }
+
+            SP_LOG_INFO("running benchmark suite \"%s\"", s.name);
+            Stopwatch timer;
+            s.run();
+            SP_LOG_INFO("benchmark suite \"%s\" finished in %.1f ms", s.name, timer.GetElapsedTimeMs());
+            ran++;
+        }
+
+        ThreadPool::Shutdown();
+
+        if (ran == 0)
+        {
+            SP_LOG_ERROR("no benchmark suite matches \"%s\"", filter.c_str());
+            return 1;
+        }
+
+        string json_path = GetArgumentValue("-benchmark_json");
+        if (json_path.empty())
+        {
+            json_path = "benchmark.json";
+        }
+
+        if (!write_results(json_path))
+        {
+            SP_LOG_ERROR("failed to write benchmark results to \"%s\"", json_path.c_str());
+            return 1;
+        }
+        SP_LOG_INFO("benchmark results written to \"%s\"", json_path.c_str());
+
+        return 0;
+    }
+
+    void Benchmark::Report(const char* suite, const char* name, double value, const char* unit)
+    {
+        printf("%s.%s: %.3f %s\n", suite, name, value, unit);
+        SP_LOG_INFO("%s.%s: %.3f %s", suite, name, value, unit);
+
+        result r;
+        r.suite = suite;
+        r.name  = name;
+        r.unit  = unit;
+        r.value = value;
+        results.push_back(std::move(r));
+    }
+
+    void Benchmark::Measure(const char* suite, const char* name, const uint32_t repetitions, const function<void()>& workload)
+    {
+        double best_ms       = numeric_limits<double>::max();
+        uint64_t allocations = numeric_limits<uint64_t>::max();
+
+        // the os peak is a process lifetime high-water mark that can't be reset portably,
+        // so report how much this case raised it, zero means it stayed under earlier cases
+        const double peak_rss_start_mb = static_cast<double>(Allocator::GetMemoryProcessPeakMb());
+        for (uint32_t i = 0; i < max(repetitions, 1u); i++)
+        {
+            const uint64_t allocations_start = Allocator::GetAllocationCount();
+            const Stopwatch timer;
+            workload();
+            best_ms     = min(best_ms, static_cast<double>(timer.GetElapsedTimeMs()));
+            allocations = min(allocations, Allocator::GetAllocationCount() - allocations_start);
+        }
+        const double peak_rss_delta_mb = max(static_cast<double>(Allocator::GetMemoryProcessPeakMb()) - peak_rss_start_mb, 0.0);
+
+        printf("%s.%s: %.3f ms, %llu allocations, %.1f MB peak rss growth\n", suite, name, best_ms, static_cast<unsigned long long>(allocations), peak_rss_delta_mb);
+        SP_LOG_INFO("%s.%s: %.3f ms, %llu allocations, %.1f MB peak rss growth", suite, name, best_ms, static_cast<unsigned long long>(allocations), peak_rss_delta_mb);
+
+        result r;
+        r.suite       = suite;
+        r.name        = name;
+        r.unit        = "ms";
+        r.value       = best_ms;
+        r.allocations = static_cast<int64_t>(allocations);
+        r.peak_rss_delta_mb = peak_rss_delta_mb;
+        results.push_back(std::move(r));
+    }
+
+    string Benchmark::GetArgumentValue(const char* argument)
+    {
+        for (size_t i = 0; i + 1 < arguments.size(); i++)
+        {
+            if (arguments[i] == argument)
+            {
+                return arguments[i + 1];
+            }
+        }
+
+        return "";
+    }
+}
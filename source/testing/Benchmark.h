@@ -0,0 +1,60 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =====
+#include <string>
+#include <vector>
+#include <functional>
+//================
+
+namespace spartan
+{
+    // headless cpu benchmarks, run by the spartan_benchmark console executable, which never creates a window or gpu device
+    // -benchmark_filter <suite> runs a single suite, -benchmark_json <file> is where results go (benchmark.json)
+    class Benchmark
+    {
+    public:
+        // returns a process exit code
+        static int Run(const std::vector<std::string>& args);
+
+        // prints one measurement, suites report through this
+        static void Report(const char* suite, const char* name, double value, const char* unit);
+
+        // runs a workload the given number of times and reports the fastest run's wall time and
+        // allocations, along with how much it raised the process peak rss
+        static void Measure(const char* suite, const char* name, uint32_t repetitions, const std::function<void()>& workload);
+
+        // value following an argument on the command line, empty if absent
+        static std::string GetArgumentValue(const char* argument);
+
+    private:
+        static void Suite_ThreadPool();
+        static void Suite_Allocator();
+        static void Suite_World();
+        static void Suite_Terrain();
+        static void Suite_Animation();
+        static void Suite_Physics();
+        static void Suite_Mcp();
+        static void Suite_Culling();
+    };
+}
@@ -0,0 +1,44 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// entry point of the headless benchmark executable (spartan_benchmark in tools/premake.lua)
+// it never creates a window, a gpu device or a swapchain, so it runs on machines without a gpu
+
+#include "pch.h"
+#include "Benchmark.h"
+#include <vector>
+#include <string>
+#include <filesystem>
+#include <system_error>
+
+int main(int argc, char** argv)
+{
+    // resolve data and worlds relative to the executable, like the editor does
+    const std::string exe_dir = spartan::FileSystem::GetExecutableDirectory();
+    if (!exe_dir.empty())
+    {
+        std::error_code ec;
+        std::filesystem::current_path(exe_dir, ec);
+    }
+
+    std::vector<std::string> args(argv, argv + argc);
+    return spartan::Benchmark::Run(args);
+}
@@ -0,0 +1,345 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===================
+#include "pch.h"
+#include "Benchmark.h"
+#include "../memory/Allocator.h"
+#include "../memory/RangeAllocator.h"
+#include <thread>
+#include <random>
+//==============================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace spartan
+{
+    namespace
+    {
+        constexpr uint32_t repetitions = 3;
+
+        // a trace event with the address resolved to a dense slot, so replaying needs no lookups
+        struct replay_op
+        {
+            uint32_t slot;
+            uint32_t size;
+            uint16_t alignment;
+            bool is_free;
+        };
+
+        struct replay_trace
+        {
+            vector<replay_op> ops;
+            uint32_t slot_count = 0;
+        };
+
+        // frees of allocations made before recording started are dropped
+        replay_trace build_replay(const vector<AllocationTraceEvent>& events)
+        {
+            replay_trace trace;
+            trace.ops.reserve(events.size());
+
+            unordered_map<uint64_t, uint32_t> live;
+            for (const AllocationTraceEvent& event : events)
+            {
+                if (event.is_free)
+                {
+                    auto it = live.find(event.address);
+                    if (it != live.end())
+                    {
+                        trace.ops.push_back({ it->second, 0, 0, true });
+                        live.erase(it);
+                    }
+                }
+                else
+                {
+                    live[event.address] = trace.slot_count;
+                    trace.ops.push_back({ trace.slot_count++, event.size, max<uint16_t>(event.alignment, 1), false });
+                }
+            }
+
+            return trace;
+        }
+
+        // stand-in for a recorded trace, shaped like a world load: mostly small short-lived strings
+        // and containers, a long-lived tail of components, and the occasional large buffer
+        vector<AllocationTraceEvent> synthesize_world_load_trace()
+        {
+            constexpr uint32_t allocation_count = 300000;
+
+            vector<AllocationTraceEvent> events;
+            events.reserve(allocation_count * 2);
+
+            mt19937 rng(1337);
+            vector<uint64_t> short_lived;
+            vector<uint64_t> long_lived;
+            for (uint64_t address = 1; address <= allocation_count; address++)
+            {
+                const uint32_t roll = rng() % 100;
+                uint32_t size       = 0;
+                if (roll < 60)      size = 8 + rng() % 57;      // strings, shared_ptr control blocks, small nodes
+                else if (roll < 85) size = 64 + rng() % 449;    // components, vector growth
+                else if (roll < 97) size = 512 + rng() % 3585;  // larger containers
+                else                size = 4096 + rng() % (256 * 1024); // vertex and index data
+
+                events.push_back({ address, size, static_cast<uint16_t>(alignof(max_align_t)), 0, 0 });
+                (rng() % 10 < 7 ? short_lived : long_lived).push_back(address);
+
+                // short-lived allocations die within a few dozen operations, in no particular order
+                if (short_lived.size() > 32)
+                {
+                    const size_t index = rng() % short_lived.size();
+                    events.push_back({ short_lived[index], 0, 0, 1, 0 });
+                    short_lived[index] = short_lived.back();
+                    short_lived.pop_back();
+                }
+            }
+
+            // the world is unloaded
+            for (uint64_t address : short_lived)
+            {
+                events.push_back({ address, 0, 0, 1, 0 });
+            }
+            for (uint64_t address : long_lived)
+            {
+                events.push_back({ address, 0, 0, 1, 0 });
+            }
+
+            return events;
+        }
+
+        void* crt_allocate(size_t size, size_t alignment)
+        {
+#if defined(_MSC_VER)
+            return _aligned_malloc(size, alignment);
+#else
+            if (alignment <= alignof(max_align_t))
+            {
+                return malloc(size);
+            }
+            return aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+#endif
+        }
+
+        void crt_free(void* ptr)
+        {
+#if defined(_MSC_VER)
+            _aligned_free(ptr);
+#else
+            free(ptr);
+#endif
+        }
+
+        void* engine_allocate(size_t size, size_t alignment)
+        {
+            return Allocator::Allocate(size, alignment);
+        }
+
+        void engine_free(void* ptr)
+        {
+            Allocator::Free(ptr);
+        }
+
+        using allocate_fn = void* (*)(size_t, size_t);
+        using free_fn     = void (*)(void*);
+
+        // returns the replay time in ms, anything the trace leaves alive is freed untimed
+        double replay(const replay_trace& trace, allocate_fn allocate, free_fn release)
+        {
+            vector<void*> slots(trace.slot_count, nullptr);
+
+            Stopwatch timer;
+            for (const replay_op& op : trace.ops)
+            {
+                if (op.is_free)
+                {
+                    release(slots[op.slot]);
+                    slots[op.slot] = nullptr;
+                }
+                else
+                {
+                    slots[op.slot] = allocate(op.size, op.alignment);
+                }
+            }
+            const double elapsed_ms = timer.GetElapsedTimeMs();
+
+            for (void* ptr : slots)
+            {
+                if (ptr)
+                {
+                    release(ptr);
+                }
+            }
+
+            return elapsed_ms;
+        }
+
+        // every thread replays the whole trace at once, returns the best wall time in ms
+        double replay_concurrent(const replay_trace& trace, allocate_fn allocate, free_fn release, uint32_t thread_count)
+        {
+            double best_ms = numeric_limits<double>::max();
+            for (uint32_t r = 0; r < repetitions; r++)
+            {
+                Stopwatch timer;
+                vector<thread> threads;
+                for (uint32_t i = 0; i < thread_count; i++)
+                {
+                    threads.emplace_back([&]() { replay(trace, allocate, release); });
+                }
+                for (thread& t : threads)
+                {
+                    t.join();
+                }
+                best_ms = min(best_ms, static_cast<double>(timer.GetElapsedTimeMs()));
+            }
+            return best_ms;
+        }
+
+        // one thread allocates the trace's small blocks, another frees them, returns ns per free
+        double free_remote(const replay_trace& trace, allocate_fn allocate, free_fn release)
+        {
+            vector<void*> blocks;
+            for (const replay_op& op : trace.ops)
+            {
+                if (!op.is_free && op.size <= 4096)
+                {
+                    blocks.push_back(allocate(op.size, op.alignment));
+                }
+            }
+
+            double elapsed_ms = 0.0;
+            thread([&]()
+            {
+                Stopwatch timer;
+                for (void* ptr : blocks)
+                {
+                    release(ptr);
+                }
+                elapsed_ms = timer.GetElapsedTimeMs();
+            }).join();
+
+            return elapsed_ms * 1e6 / max<size_t>(blocks.size(), 1);
+        }
+
+        // the trace through the range allocator the geometry buffer sub-allocates with, sizes read as elements
+        // returns ns per op, fragmentation is sampled after the last allocation, before the world unloads
+        double replay_range(const replay_trace& trace, float& fragmentation_out)
+        {
+            size_t last_allocation = 0;
+            for (size_t i = 0; i < trace.ops.size(); i++)
+            {
+                last_allocation = trace.ops[i].is_free ? last_allocation : i;
+            }
+
+            RangeAllocator allocator;
+            allocator.Initialize(64u * 1024u * 1024u);
+            vector<RangeAllocation> slots(trace.slot_count);
+
+            double elapsed_ms = 0.0;
+            Stopwatch timer;
+            for (size_t i = 0; i < trace.ops.size(); i++)
+            {
+                const replay_op& op = trace.ops[i];
+                if (op.is_free)
+                {
+                    allocator.Free(slots[op.slot]);
+                    slots[op.slot] = {};
+                }
+                else
+                {
+                    slots[op.slot] = allocator.Allocate(op.size);
+                    if (!slots[op.slot].IsValid())
+                    {
+                        allocator.Grow(allocator.GetCapacity() * 2);
+                        slots[op.slot] = allocator.Allocate(op.size);
+                    }
+                }
+
+                if (i == last_allocation)
+                {
+                    elapsed_ms       += timer.GetElapsedTimeMs();
+                    fragmentation_out = allocator.GetStats().GetFragmentation();
+                    timer.Start();
+                }
+            }
+            elapsed_ms += timer.GetElapsedTimeMs();
+
+            return elapsed_ms * 1e6 / max<size_t>(trace.ops.size(), 1);
+        }
+    }
+
+    void Benchmark::Suite_Allocator()
+    {
+        // -allocation_trace_file points at a trace written by running the engine with -allocation_trace
+        string file_path = GetArgumentValue("-allocation_trace_file");
+        if (file_path.empty())
+        {
+            file_path = "allocation_trace.bin";
+        }
+
+        vector<AllocationTraceEvent> events;
+        if (!Allocator::TraceLoad(file_path.c_str(), events))
+        {
+            SP_LOG_INFO("no allocation trace at \"%s\", replaying a synthetic world load", file_path.c_str());
+            events = synthesize_world_load_trace();
+        }
+
+        const replay_trace trace = build_replay(events);
+        const double op_count    = static_cast<double>(trace.ops.size());
+        Benchmark::Report("allocator", "trace_ops", op_count, "ops");
+
+        double crt_ms    = numeric_limits<double>::max();
+        double engine_ms = numeric_limits<double>::max();
+        for (uint32_t r = 0; r < repetitions; r++)
+        {
+            crt_ms    = min(crt_ms, replay(trace, &crt_allocate, &crt_free));
+            engine_ms = min(engine_ms, replay(trace, &engine_allocate, &engine_free));
+        }
+        Benchmark::Report("allocator", "replay_crt", crt_ms * 1e6 / op_count, "ns/op");
+        Benchmark::Report("allocator", "replay_engine", engine_ms * 1e6 / op_count, "ns/op");
+
+        uint32_t hw_threads = thread::hardware_concurrency();
+        hw_threads          = hw_threads == 0 ? 4 : hw_threads;
+        if (hw_threads > 1)
+        {
+            char name[64];
+            const double total_ops = op_count * hw_threads;
+            snprintf(name, sizeof(name), "replay_crt_%ut", hw_threads);
+            Benchmark::Report("allocator", name, total_ops / (replay_concurrent(trace, &crt_allocate, &crt_free, hw_threads) * 1e3), "Mops/s");
+            snprintf(name, sizeof(name), "replay_engine_%ut", hw_threads);
+            Benchmark::Report("allocator", name, total_ops / (replay_concurrent(trace, &engine_allocate, &engine_free, hw_threads) * 1e3), "Mops/s");
+        }
+
+        Benchmark::Report("allocator", "free_remote_crt", free_remote(trace, &crt_allocate, &crt_free), "ns/op");
+        Benchmark::Report("allocator", "free_remote_engine", free_remote(trace, &engine_allocate, &engine_free), "ns/op");
+
+        float fragmentation = 0.0f;
+        double range_ns     = numeric_limits<double>::max();
+        for (uint32_t r = 0; r < repetitions; r++)
+        {
+            range_ns = min(range_ns, replay_range(trace, fragmentation));
+        }
+        Benchmark::Report("allocator", "replay_range_tlsf", range_ns, "ns/op");
+        Benchmark::Report("allocator", "range_fragmentation", fragmentation * 100.0f, "%");
+    }
+}
@@ -0,0 +1,133 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==========================
+#include "pch.h"
+#include "Benchmark.h"
+#include "../animation/AnimationClip.h"
+#include "../animation/AnimationEvaluate.h"
+#include "../animation/Skeleton.h"
+//=====================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan::math;
+//============================
+
+namespace spartan
+{
+    namespace
+    {
+        constexpr uint32_t chain_count     = 4;   // spine and limbs hanging off the root
+        constexpr uint32_t chain_length    = 16;
+        constexpr uint32_t joint_count     = 1 + chain_count * chain_length;
+        constexpr uint32_t character_count = 256; // a busy street worth of pedestrians
+        constexpr uint32_t frame_count     = 120;
+        constexpr float clip_duration      = 2.0f;
+        constexpr float clip_sample_rate   = 30.0f;
+        constexpr uint32_t repetitions     = 3;
+
+        // a humanoid sized skeleton, every joint sits one unit down its chain
+        void build_skeleton(Skeleton& skeleton)
+        {
+            skeleton.Allocate(static_cast<uint16_t>(joint_count));
+            skeleton.m_mutable_parents[0] = -1;
+            for (uint32_t chain = 0; chain < chain_count; chain++)
+            {
+                for (uint32_t link = 0; link < chain_length; link++)
+                {
+                    const uint32_t joint = 1 + chain * chain_length + link;
+                    skeleton.m_mutable_parents[joint]  = static_cast<int16_t>(link == 0 ? 0 : joint - 1);
+                    skeleton.bind_local_matrices[joint] = Matrix::CreateTranslation(Vector3(0.0f, 0.1f, 0.0f));
+                }
+            }
+            skeleton.FinalizeBindPose();
+        }
+
+        // every joint swings around its own axis at its own rate, the root also translates
+        void build_clip(AnimationClip& clip)
+        {
+            const uint32_t sample_count = static_cast<uint32_t>(clip_duration * clip_sample_rate) + 1;
+
+            clip.name             = "benchmark_walk";
+            clip.duration_seconds = clip_duration;
+            clip.sample_rate      = clip_sample_rate;
+            clip.joint_count      = joint_count;
+            clip.base_local_positions.assign(joint_count, Vector3::Zero);
+            clip.base_local_rotations.assign(joint_count, Quaternion::Identity);
+            clip.base_local_scales.assign(joint_count, Vector3::One);
+
+            for (uint32_t joint = 0; joint < joint_count; joint++)
+            {
+                clip.sampled_bones.push_back(joint);
+
+                AnimChannel channel;
+                channel.bone_index   = joint;
+                channel.first_sample = static_cast<uint32_t>(clip.rotation_stream.values.size());
+                channel.sample_count = sample_count;
+                clip.rotation_stream.channels.push_back(channel);
+
+                const Vector3 axis = Vector3(1.0f, static_cast<float>(joint % 3), static_cast<float>(joint % 5)).Normalized();
+                for (uint32_t sample = 0; sample < sample_count; sample++)
+                {
+                    const float phase = static_cast<float>(sample) / static_cast<float>(sample_count - 1) * 6.2831853f;
+                    clip.rotation_stream.values.push_back(Quaternion::FromAxisAngle(axis, 0.5f * sinf(phase + joint * 0.3f)));
+                }
+            }
+
+            AnimChannel root;
+            root.bone_index   = 0;
+            root.first_sample = 0;
+            root.sample_count = sample_count;
+            clip.position_stream.channels.push_back(root);
+            for (uint32_t sample = 0; sample < sample_count; sample++)
+            {
+                clip.position_stream.values.push_back(Vector3(0.0f, 0.0f, sample * 0.05f));
+            }
+        }
+    }
+
+    void Benchmark::Suite_Animation()
+    {
+        Skeleton skeleton;
+        AnimationClip clip;
+        build_skeleton(skeleton);
+        build_clip(clip);
+        animation_evaluate::EnsureSampleIndex(clip);
+
+        // buffers are reused across characters like the animator does, steady state sampling should not allocate
+        vector<Matrix> locals;
+        vector<Matrix> globals(joint_count);
+        Measure("animation", "sample_256_characters_120_frames", repetitions, [&]()
+        {
+            for (uint32_t frame = 0; frame < frame_count; frame++)
+            {
+                for (uint32_t character = 0; character < character_count; character++)
+                {
+                    // offset every character so they don't all hit the same keys
+                    const float time = frame / 60.0f + character * 0.013f;
+                    animation_evaluate::SampleLocals(clip, skeleton, time, locals);
+                    skeleton.ComputeGlobalPose(locals, globals);
+                }
+            }
+        });
+    }
+}
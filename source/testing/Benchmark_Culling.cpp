@@ -0,0 +1,156 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =================
+#include "pch.h"
+#include "Benchmark.h"
+#include "../math/AabbTree.h"
+#include <random>
+//============================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan::math;
+//============================
+
+namespace spartan
+{
+    namespace
+    {
+        constexpr uint32_t box_count   = 100000;
+        constexpr uint32_t cull_count  = 100; // frustums per measurement, one per frame of a camera turning in place
+        constexpr float world_extent   = 2000.0f;
+        constexpr float max_distance   = 500.0f;
+        constexpr uint32_t repetitions = 3;
+
+        // props scattered over a city sized square, a fixed seed keeps every run culling the same scene
+        void generate_boxes(vector<Vector3>& centers, vector<Vector3>& extents)
+        {
+            mt19937 generator(7);
+            uniform_real_distribution<float> position(-world_extent * 0.5f, world_extent * 0.5f);
+            uniform_real_distribution<float> height(0.0f, 30.0f);
+            uniform_real_distribution<float> size(0.25f, 8.0f);
+
+            centers.resize(box_count);
+            extents.resize(box_count);
+            for (uint32_t i = 0; i < box_count; i++)
+            {
+                centers[i] = Vector3(position(generator), height(generator), position(generator));
+                extents[i] = Vector3(size(generator), size(generator), size(generator));
+            }
+        }
+
+        Frustum camera_frustum(const uint32_t frame)
+        {
+            const float yaw      = static_cast<float>(frame) / static_cast<float>(cull_count) * 6.2831853f;
+            const Vector3 eye    = Vector3(0.0f, 2.0f, 0.0f);
+            const Vector3 target = eye + Vector3(sinf(yaw), 0.0f, cosf(yaw));
+            const Matrix view       = Matrix::CreateLookAtLH(eye, target, Vector3::Up);
+            const Matrix projection = Matrix::CreatePerspectiveFieldOfViewLH(1.0f, 16.0f / 9.0f, 0.1f, 1000.0f);
+
+            return Frustum(view, projection);
+        }
+    }
+
+    void Benchmark::Suite_Culling()
+    {
+        vector<Vector3> centers;
+        vector<Vector3> extents;
+        generate_boxes(centers, extents);
+
+        Frustum frustums[cull_count];
+        for (uint32_t frame = 0; frame < cull_count; frame++)
+        {
+            frustums[frame] = camera_frustum(frame);
+        }
+        const Vector3 origin = Vector3(0.0f, 2.0f, 0.0f);
+
+        // the per object path the batch replaced, one call and six planes at a time
+        uint32_t visible_scalar = 0;
+        Measure("culling", "scalar_100k_boxes_100_frustums", repetitions, [&]()
+        {
+            visible_scalar = 0;
+            for (const Frustum& frustum : frustums)
+            {
+                for (uint32_t i = 0; i < box_count; i++)
+                {
+                    visible_scalar += frustum.IsVisible(centers[i], extents[i]) ? 1 : 0;
+                }
+            }
+        });
+
+        FrustumBatch batch;
+        batch.Reserve(box_count);
+        for (uint32_t i = 0; i < box_count; i++)
+        {
+            batch.Add(centers[i], extents[i], max_distance);
+        }
+
+        vector<uint64_t> visibility;
+        uint32_t visible_batch = 0;
+        Measure("culling", "batch_100k_boxes_100_frustums", repetitions, [&]()
+        {
+            visible_batch = 0;
+            for (const Frustum& frustum : frustums)
+            {
+                frustum.CullBatch(batch, visibility);
+                for (const uint64_t word : visibility)
+                {
+                    visible_batch += static_cast<uint32_t>(popcount(word));
+                }
+            }
+        });
+
+        // the distance rejection rides along in the same pass
+        Measure("culling", "batch_distance_100k_boxes_100_frustums", repetitions, [&]()
+        {
+            for (const Frustum& frustum : frustums)
+            {
+                frustum.CullBatch(batch, visibility, false, &origin);
+            }
+        });
+
+        // the hierarchy visits what is visible instead of every box
+        AabbTree tree;
+        for (uint32_t i = 0; i < box_count; i++)
+        {
+            tree.Insert(BoundingBox(centers[i] - extents[i], centers[i] + extents[i]), max_distance, i);
+        }
+
+        vector<uint32_t> visible_ids;
+        visible_ids.reserve(box_count);
+        Measure("culling", "tree_distance_100k_boxes_100_frustums", repetitions, [&]()
+        {
+            for (const Frustum& frustum : frustums)
+            {
+                visible_ids.clear();
+                tree.Cull(frustum, &origin, false, visible_ids);
+            }
+        });
+
+        // both paths have to agree, a fast kernel that disagrees with the reference is a broken kernel
+        Report("culling", "visible_per_frustum", static_cast<double>(visible_batch) / cull_count, "boxes");
+        if (visible_batch != visible_scalar)
+        {
+            SP_LOG_ERROR("batch culling disagrees with the scalar path, %u vs %u visible", visible_batch, visible_scalar);
+        }
+    }
+}
@@ -0,0 +1,130 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =========================
+#include "pch.h"
+#include "Benchmark.h"
+#include "../geometry/GeometryGeneration.h"
+#include "../mcp/McpGeometryKernel.h"
+#include "../mcp/McpTextureKernel.h"
+//====================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan::math;
+//============================
+
+namespace spartan
+{
+    namespace
+    {
+        constexpr uint32_t texture_resolution = 1024;
+        constexpr uint32_t array_count        = 16;
+        constexpr uint32_t repetitions        = 3;
+
+        // weathered brick wall, the kind of stack an agent asks for
+        mcp_texture_kernel::request build_texture_request()
+        {
+            using namespace mcp_texture_kernel;
+
+            request settings;
+            settings.width  = texture_resolution;
+            settings.height = texture_resolution;
+
+            layer base;
+            base.type              = layer_type::fill;
+            base.color_a           = { 0.55f, 0.25f, 0.18f, 1.0f };
+            base.contributes_color = true;
+            settings.layers.push_back(base);
+
+            layer bricks;
+            bricks.type              = layer_type::bricks;
+            bricks.color_a           = { 0.75f, 0.72f, 0.66f, 1.0f };
+            bricks.count_x           = 8.0f;
+            bricks.count_y           = 16.0f;
+            bricks.contributes_color = true;
+            bricks.relief            = 1.0f;
+            settings.layers.push_back(bricks);
+
+            layer grime;
+            grime.type              = layer_type::noise;
+            grime.noise             = noise_kind::perlin_fbm;
+            grime.blend             = blend_mode::multiply;
+            grime.octaves           = 6;
+            grime.frequency         = 8.0f;
+            grime.contributes_color = true;
+            grime.roughness_value   = 0.9f;
+            settings.layers.push_back(grime);
+
+            layer cells;
+            cells.type      = layer_type::noise;
+            cells.noise     = noise_kind::worley;
+            cells.frequency = 12.0f;
+            cells.relief    = 0.3f;
+            settings.layers.push_back(cells);
+
+            layer scratches;
+            scratches.type    = layer_type::scratches;
+            scratches.density = 2.0f;
+            scratches.relief  = -0.2f;
+            settings.layers.push_back(scratches);
+
+            return settings;
+        }
+    }
+
+    void Benchmark::Suite_Mcp()
+    {
+        const mcp_texture_kernel::request texture_request = build_texture_request();
+        mcp_texture_kernel::result texture;
+        Measure("mcp", "texture_bricks_1024", repetitions, [&]()
+        {
+            string error;
+            if (!mcp_texture_kernel::generate(texture_request, texture, error))
+            {
+                SP_LOG_ERROR("texture kernel failed: %s", error.c_str());
+            }
+        });
+
+        // a column of rings, every operation the agent chains on a mesh, with budgets large enough for all of it
+        vector<RHI_Vertex_PosTexNorTan> sphere_vertices;
+        vector<uint32_t> sphere_indices;
+        geometry_generation::generate_sphere(&sphere_vertices, &sphere_indices, 1.0f, 64, 64);
+
+        mcp_geometry_kernel::budgets limits;
+        limits.max_vertices = 4000000;
+        limits.max_indices  = 12000000;
+
+        vector<RHI_Vertex_PosTexNorTan> vertices;
+        vector<uint32_t> indices;
+        Measure("mcp", "geometry_array_solidify_uv", repetitions, [&]()
+        {
+            vertices.clear();
+            indices.clear();
+            mcp_geometry_kernel::linear_array(sphere_vertices, sphere_indices, array_count, Vector3(0.0f, 2.5f, 0.0f), vertices, indices, limits);
+            mcp_geometry_kernel::bend(vertices, indices, mcp_geometry_kernel::axis::y, mcp_geometry_kernel::axis::x, 1.5f, Vector3::Zero, limits);
+            mcp_geometry_kernel::solidify(vertices, indices, 0.05f, limits);
+            mcp_geometry_kernel::project_uv_box_seamed(vertices, indices, Vector2::One, Vector2::Zero, limits);
+            mcp_geometry_kernel::recalculate_normals_tangents(vertices, indices, limits);
+            mcp_geometry_kernel::validate(vertices, indices, limits);
+        });
+    }
+}
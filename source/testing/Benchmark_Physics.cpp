@@ -0,0 +1,114 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =========================
+#include "pch.h"
+#include "Benchmark.h"
+#include "../physics/PhysicsWorld.h"
+SP_WARNINGS_OFF
+#ifdef DEBUG
+    #define _DEBUG 1
+    #undef NDEBUG
+#else
+    #define NDEBUG 1
+    #undef _DEBUG
+#endif
+#define PX_PHYSX_STATIC_LIB
+#include <physx/PxPhysicsAPI.h>
+SP_WARNINGS_ON
+//====================================
+
+//= NAMESPACES ====
+using namespace std;
+using namespace physx;
+//=================
+
+namespace spartan
+{
+    namespace
+    {
+        constexpr uint32_t stack_width  = 20;
+        constexpr uint32_t stack_height = 5;
+        constexpr uint32_t step_count   = 400; // two simulated seconds at the engine's 200 hz
+        constexpr uint32_t repetitions  = 3;
+
+        // a pile of boxes dropped onto a plane, they collide, topple and settle over the measured steps
+        void build_scene(PxPhysics* physics, PxScene* scene, PxMaterial* material, vector<PxRigidActor*>& actors)
+        {
+            PxRigidStatic* ground = PxCreatePlane(*physics, PxPlane(0.0f, 1.0f, 0.0f, 0.0f), *material);
+            scene->addActor(*ground);
+            actors.push_back(ground);
+
+            const PxBoxGeometry box(0.5f, 0.5f, 0.5f);
+            for (uint32_t y = 0; y < stack_height; y++)
+            {
+                for (uint32_t z = 0; z < stack_width; z++)
+                {
+                    for (uint32_t x = 0; x < stack_width; x++)
+                    {
+                        // every other layer is offset by half a box so the pile collapses instead of resting
+                        const float offset = (y % 2) * 0.5f;
+                        const PxTransform pose(PxVec3(x * 1.1f + offset, 0.6f + y * 1.2f, z * 1.1f + offset));
+                        PxRigidDynamic* body = PxCreateDynamic(*physics, pose, box, *material, 10.0f);
+                        scene->addActor(*body);
+                        actors.push_back(body);
+                    }
+                }
+            }
+        }
+    }
+
+    void Benchmark::Suite_Physics()
+    {
+        PhysicsWorld::Initialize();
+        PxPhysics* physics   = static_cast<PxPhysics*>(PhysicsWorld::GetPhysics());
+        PxScene* scene       = static_cast<PxScene*>(PhysicsWorld::GetScene());
+        PxMaterial* material = physics->createMaterial(0.6f, 0.6f, 0.1f);
+        const float step     = PhysicsWorld::GetFixedTimeStep();
+
+        vector<PxRigidActor*> actors;
+        Measure("physics", "box_pile_2000_400_steps", repetitions, [&]()
+        {
+            // a fresh pile every repetition so each one simulates the same collapse
+            for (PxRigidActor* actor : actors)
+            {
+                scene->removeActor(*actor);
+                actor->release();
+            }
+            actors.clear();
+            build_scene(physics, scene, material, actors);
+
+            for (uint32_t i = 0; i < step_count; i++)
+            {
+                scene->simulate(step);
+                scene->fetchResults(true);
+            }
+        });
+
+        for (PxRigidActor* actor : actors)
+        {
+            scene->removeActor(*actor);
+            actor->release();
+        }
+        material->release();
+        PhysicsWorld::Shutdown();
+    }
+}
@@ -0,0 +1,78 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ====================
+#include "pch.h"
+#include "Benchmark.h"
+#include "../world/TerrainSystem.h"
+//===============================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan::math;
+//============================
+
+namespace spartan
+{
+    namespace
+    {
+        constexpr uint32_t grid_size   = 512;
+        constexpr float level_sea      = 0.0f;
+        constexpr uint32_t repetitions = 3;
+
+        // a flat 1 m grid with perlin relief, the noise is seeded from the grid size so every run erodes the same terrain
+        vector<Vector3> generate_heightfield()
+        {
+            vector<Vector3> positions(grid_size * grid_size);
+            for (uint32_t z = 0; z < grid_size; z++)
+            {
+                for (uint32_t x = 0; x < grid_size; x++)
+                {
+                    positions[z * grid_size + x] = Vector3(static_cast<float>(x), 0.0f, static_cast<float>(z));
+                }
+            }
+
+            TerrainSystem::ApplyPerlinNoise(positions, grid_size, grid_size, level_sea, 60.0f, 0.005f, 6, 0.5f);
+
+            return positions;
+        }
+    }
+
+    void Benchmark::Suite_Terrain()
+    {
+        const vector<Vector3> source = generate_heightfield();
+        vector<Vector3> positions(source.size());
+        TerrainErosionMaps erosion_maps;
+        TerrainAnalysisMaps analysis_maps;
+
+        Measure("terrain", "erosion_512", repetitions, [&]()
+        {
+            positions.assign(source.begin(), source.end());
+            TerrainSystem::ApplyErosion(positions, grid_size, grid_size, level_sea, 1.0f, &erosion_maps);
+        });
+
+        // runs on the eroded terrain from the last repetition, like terrain generation does
+        Measure("terrain", "analysis_maps_512", repetitions, [&]()
+        {
+            TerrainSystem::ComputeAnalysisMaps(analysis_maps, positions, grid_size, grid_size, level_sea, &erosion_maps);
+        });
+    }
+}
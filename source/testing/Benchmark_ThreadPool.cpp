@@ -0,0 +1,255 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==================
+#include "pch.h"
+#include "Benchmark.h"
+#include "../core/ThreadPool.h"
+#include <thread>
+#include <condition_variable>
+#include <deque>
+//=============================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace spartan
+{
+    namespace
+    {
+        constexpr uint32_t task_count      = 200000;
+        constexpr uint32_t spawner_count   = 64;
+        constexpr uint32_t repetitions     = 3;
+
+        // the single-queue pool the job system replaced, kept here as the baseline
+        class legacy_pool
+        {
+        public:
+            explicit legacy_pool(uint32_t thread_count)
+            {
+                for (uint32_t i = 0; i < thread_count; i++)
+                {
+                    m_threads.emplace_back([this]() { thread_loop(); });
+                }
+            }
+
+            ~legacy_pool()
+            {
+                {
+                    lock_guard<mutex> lock(m_mutex);
+                    m_stopping = true;
+                }
+                m_cv.notify_all();
+
+                for (thread& t : m_threads)
+                {
+                    t.join();
+                }
+            }
+
+            future<void> AddTask(Task&& task)
+            {
+                auto packaged = make_shared<packaged_task<void()>>(std::move(task));
+                future<void> result = packaged->get_future();
+                {
+                    lock_guard<mutex> lock(m_mutex);
+                    m_tasks.emplace_back([packaged]() { (*packaged)(); });
+                }
+                m_cv.notify_one();
+                return result;
+            }
+
+        private:
+            void thread_loop()
+            {
+                while (true)
+                {
+                    Task task;
+                    {
+                        unique_lock<mutex> lock(m_mutex);
+                        m_cv.wait(lock, [this] { return !m_tasks.empty() || m_stopping; });
+                        if (m_stopping && m_tasks.empty())
+                        {
+                            return;
+                        }
+
+                        task = std::move(m_tasks.front());
+                        m_tasks.pop_front();
+                    }
+                    task();
+                }
+            }
+
+            vector<thread> m_threads;
+            deque<Task> m_tasks;
+            mutex m_mutex;
+            condition_variable m_cv;
+            bool m_stopping = false;
+        };
+
+        // a few dozen nanoseconds of work, small enough that scheduling cost dominates
+        atomic<uint64_t> sink = 0;
+        void tiny_work(uint32_t seed)
+        {
+            uint32_t x = seed | 1;
+            for (uint32_t i = 0; i < 32; i++)
+            {
+                x ^= x << 13;
+                x ^= x >> 17;
+                x ^= x << 5;
+            }
+            sink.fetch_add(x & 1, memory_order_relaxed);
+        }
+
+        template <typename Function>
+        double best_tasks_per_second(Function&& function, uint32_t tasks)
+        {
+            double best_ms = numeric_limits<double>::max();
+            for (uint32_t i = 0; i < repetitions; i++)
+            {
+                Stopwatch timer;
+                function();
+                best_ms = min(best_ms, static_cast<double>(timer.GetElapsedTimeMs()));
+            }
+
+            return static_cast<double>(tasks) / (best_ms / 1000.0) / 1e6;
+        }
+
+        double legacy_flat(uint32_t thread_count)
+        {
+            legacy_pool pool(thread_count);
+            return best_tasks_per_second([&pool]()
+            {
+                vector<future<void>> futures;
+                futures.reserve(task_count);
+                for (uint32_t i = 0; i < task_count; i++)
+                {
+                    futures.emplace_back(pool.AddTask([i]() { tiny_work(i); }));
+                }
+
+                for (future<void>& f : futures)
+                {
+                    f.get();
+                }
+            }, task_count);
+        }
+
+        double legacy_spawned(uint32_t thread_count)
+        {
+            legacy_pool pool(thread_count);
+            return best_tasks_per_second([&pool]()
+            {
+                // the legacy pool can't wait from inside a task, so the caller polls a counter
+                atomic<uint32_t> done = 0;
+                for (uint32_t s = 0; s < spawner_count; s++)
+                {
+                    pool.AddTask([&pool, &done, s]()
+                    {
+                        for (uint32_t i = 0; i < task_count / spawner_count; i++)
+                        {
+                            pool.AddTask([&done, s, i]() { tiny_work(s ^ i); done.fetch_add(1, memory_order_relaxed); });
+                        }
+                    });
+                }
+
+                while (done.load(memory_order_relaxed) < task_count)
+                {
+                    this_thread::yield();
+                }
+            }, task_count);
+        }
+
+        double job_system_flat()
+        {
+            return best_tasks_per_second([]()
+            {
+                JobCounter counter;
+                for (uint32_t i = 0; i < task_count; i++)
+                {
+                    ThreadPool::Schedule([i]() { tiny_work(i); }, &counter);
+                }
+                ThreadPool::Wait(counter);
+            }, task_count);
+        }
+
+        double job_system_spawned()
+        {
+            return best_tasks_per_second([]()
+            {
+                JobCounter counter;
+                for (uint32_t s = 0; s < spawner_count; s++)
+                {
+                    ThreadPool::Schedule([&counter, s]()
+                    {
+                        for (uint32_t i = 0; i < task_count / spawner_count; i++)
+                        {
+                            ThreadPool::Schedule([s, i]() { tiny_work(s ^ i); }, &counter);
+                        }
+                    }, &counter);
+                }
+                ThreadPool::Wait(counter);
+            }, task_count);
+        }
+    }
+
+    void Benchmark::Suite_ThreadPool()
+    {
+        uint32_t hw_threads = thread::hardware_concurrency();
+        hw_threads          = hw_threads == 0 ? 4 : hw_threads;
+
+        // 1, 2, 4 .. and the hardware thread count
+        vector<uint32_t> thread_counts;
+        for (uint32_t count = 1; count < hw_threads; count *= 2)
+        {
+            thread_counts.push_back(count);
+        }
+        thread_counts.push_back(hw_threads);
+
+        // the job system is a singleton, keep whatever state it was in
+        const uint32_t initial_thread_count = ThreadPool::GetThreadCount();
+        if (initial_thread_count > 0)
+        {
+            ThreadPool::Shutdown();
+        }
+
+        char name[64];
+        for (uint32_t count : thread_counts)
+        {
+            snprintf(name, sizeof(name), "legacy_flat_%ut", count);
+            Benchmark::Report("threadpool", name, legacy_flat(count), "Mtasks/s");
+            snprintf(name, sizeof(name), "legacy_spawned_%ut", count);
+            Benchmark::Report("threadpool", name, legacy_spawned(count), "Mtasks/s");
+
+            ThreadPool::Initialize(count);
+            snprintf(name, sizeof(name), "jobs_flat_%ut", count);
+            Benchmark::Report("threadpool", name, job_system_flat(), "Mtasks/s");
+            snprintf(name, sizeof(name), "jobs_spawned_%ut", count);
+            Benchmark::Report("threadpool", name, job_system_spawned(), "Mtasks/s");
+            ThreadPool::Shutdown();
+        }
+
+        if (initial_thread_count > 0)
+        {
+            ThreadPool::Initialize();
+        }
+    }
+}
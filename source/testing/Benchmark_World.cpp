@@ -0,0 +1,254 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =================
+#include "pch.h"
+#include "Benchmark.h"
+#include "../world/World.h"
+#include "../world/Entity.h"
+#include "../world/WorldFile.h"
+#include "../world/components/Render.h"
+#include "../io/pugixml.hpp"
+#include <filesystem>
+#include <sstream>
+//============================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan::math;
+//============================
+
+namespace spartan
+{
+    namespace
+    {
+        constexpr uint32_t repetitions       = 5;
+        constexpr uint32_t spawn_count       = 10000;
+        constexpr uint32_t spawn_repetitions = 3;
+
+        struct world_stats
+        {
+            uint32_t entities   = 0;
+            uint32_t components = 0;
+        };
+
+        // the cpu side of World::LoadFromFile, parse the document, flatten the entity tree and read what Entity::Load reads
+        // the components themselves need the renderer and physics to initialize, so they are only counted
+        bool load_world(const string& file_path, world_stats& stats)
+        {
+            pugi::xml_document doc;
+            if (!doc.load_file(file_path.c_str()))
+            {
+                return false;
+            }
+
+            pugi::xml_node entities_node = doc.child("World").child("Entities");
+            if (!entities_node)
+            {
+                return false;
+            }
+
+            vector<pugi::xml_node> flat_entities;
+            function<void(pugi::xml_node)> collect = [&](pugi::xml_node node)
+            {
+                flat_entities.push_back(node);
+                for (pugi::xml_node child = node.child("Entity"); child; child = child.next_sibling("Entity"))
+                {
+                    collect(child);
+                }
+            };
+            for (pugi::xml_node entity_node = entities_node.child("Entity"); entity_node; entity_node = entity_node.next_sibling("Entity"))
+            {
+                collect(entity_node);
+            }
+
+            stats = world_stats();
+            for (pugi::xml_node node : flat_entities)
+            {
+                Vector3 position;
+                Quaternion rotation;
+                Vector3 scale;
+                {
+                    stringstream ss(node.attribute("position").as_string());
+                    ss >> position.x >> position.y >> position.z;
+                }
+                {
+                    stringstream ss(node.attribute("rotation").as_string());
+                    ss >> rotation.x >> rotation.y >> rotation.z >> rotation.w;
+                }
+                {
+                    stringstream ss(node.attribute("scale").as_string());
+                    ss >> scale.x >> scale.y >> scale.z;
+                }
+
+                for (pugi::xml_node component_node = node.first_child(); component_node; component_node = component_node.next_sibling())
+                {
+                    if (strcmp(component_node.name(), "Entity") != 0)
+                    {
+                        stats.components++;
+                    }
+                }
+                stats.entities++;
+            }
+
+            return true;
+        }
+
+        // the same for a binary world, records arrive decoded so only the component nodes are walked
+        bool load_world_binary(const string& file_path, world_stats& stats)
+        {
+            WorldFileContents contents;
+            if (!WorldFile::Read(file_path, contents))
+            {
+                return false;
+            }
+
+            stats = world_stats();
+            for (const pugi::xml_node& node : contents.nodes)
+            {
+                for (pugi::xml_node component_node = node.first_child(); component_node; component_node = component_node.next_sibling())
+                {
+                    stats.components++;
+                }
+                stats.entities++;
+            }
+
+            return true;
+        }
+
+        // a prop on a grid, the transforms a traffic or world build script would hand over
+        vector<Matrix> spawn_transforms()
+        {
+            vector<Matrix> transforms;
+            transforms.reserve(spawn_count);
+            for (uint32_t i = 0; i < spawn_count; i++)
+            {
+                const Vector3 position(static_cast<float>(i % 100) * 4.0f, 0.0f, static_cast<float>(i / 100) * 4.0f);
+                transforms.emplace_back(position, Quaternion::FromAxisAngle(Vector3::Up, static_cast<float>(i)), Vector3::One);
+            }
+            return transforms;
+        }
+
+        // one clone at a time against one InstantiateBatch call, the props only carry a render
+        // component without a mesh so nothing reaches the gpu
+        void spawn_props()
+        {
+            Entity* prop = World::CreateEntity();
+            prop->SetObjectName("benchmark_prop");
+            prop->AddComponent<Render>();
+            const vector<Matrix> transforms = spawn_transforms();
+
+            vector<Entity*> spawned;
+            Benchmark::Measure("world", "spawn_props_clone", spawn_repetitions, [&]()
+            {
+                for (const Matrix& transform : transforms)
+                {
+                    Entity* clone = prop->Clone();
+                    clone->SetPositionLocal(transform.GetTranslation());
+                    clone->SetRotationLocal(transform.GetRotation());
+                    spawned.push_back(clone);
+                }
+            });
+
+            vector<Entity*> instances;
+            Benchmark::Measure("world", "spawn_props_batch", spawn_repetitions, [&]()
+            {
+                World::InstantiateBatch(prop, spawn_count, transforms, instances);
+                spawned.insert(spawned.end(), instances.begin(), instances.end());
+            });
+
+            spawned.push_back(prop);
+            for (Entity* entity : spawned)
+            {
+                World::RemoveEntityImmediate(entity);
+            }
+        }
+    }
+
+    void Benchmark::Suite_World()
+    {
+        spawn_props();
+
+        // the bundled worlds, next to the executable once staged or at the repository root
+        string directory;
+        for (const char* candidate : { "worlds", "../worlds" })
+        {
+            if (FileSystem::Exists(candidate) && FileSystem::IsDirectory(candidate))
+            {
+                directory = candidate;
+                break;
+            }
+        }
+
+        if (directory.empty())
+        {
+            SP_LOG_WARNING("no worlds directory found, skipping the world suite");
+            return;
+        }
+
+        vector<string> files = FileSystem::GetFilesInDirectory(directory);
+        sort(files.begin(), files.end()); // same order on every machine
+        for (const string& file_path : files)
+        {
+            // binary worlds are measured against the xml they are converted from below
+            if (FileSystem::GetExtensionFromFilePath(file_path) != ".world" || WorldFile::IsBinary(file_path))
+            {
+                continue;
+            }
+
+            const string name = "load_" + FileSystem::GetFileNameWithoutExtensionFromFilePath(file_path);
+            world_stats stats;
+            Measure("world", name.c_str(), repetitions, [&]()
+            {
+                if (!load_world(file_path, stats))
+                {
+                    SP_LOG_ERROR("failed to parse \"%s\"", file_path.c_str());
+                }
+            });
+            Report("world", (name + "_entities").c_str(), stats.entities, "entities");
+            Report("world", (name + "_components").c_str(), stats.components, "components");
+
+            // the same world in the binary format
+            const string binary_path = (filesystem::temp_directory_path() / (FileSystem::GetFileNameFromFilePath(file_path) + ".binary")).string();
+            if (!WorldFile::ConvertXmlToBinary(file_path, binary_path))
+            {
+                SP_LOG_ERROR("failed to convert \"%s\"", file_path.c_str());
+                continue;
+            }
+
+            world_stats stats_binary;
+            Measure("world", (name + "_binary").c_str(), repetitions, [&]()
+            {
+                if (!load_world_binary(binary_path, stats_binary))
+                {
+                    SP_LOG_ERROR("failed to read \"%s\"", binary_path.c_str());
+                }
+            });
+            if (stats_binary.entities != stats.entities || stats_binary.components != stats.components)
+            {
+                SP_LOG_ERROR("\"%s\" lost entities or components in the binary conversion", file_path.c_str());
+            }
+            Report("world", (name + "_xml_size").c_str(), static_cast<double>(filesystem::file_size(file_path)), "bytes");
+            Report("world", (name + "_binary_size").c_str(), static_cast<double>(filesystem::file_size(binary_path)), "bytes");
+            FileSystem::Delete(binary_path);
+        }
+    }
+}
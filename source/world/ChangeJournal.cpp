@@ -0,0 +1,157 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES ============
+#include "pch.h"
+#include "ChangeJournal.h"
+#include "Entity.h"
+//=======================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace spartan
+{
+    namespace
+    {
+        // recording side, written from any thread
+        mutex mutex_recording;
+        vector<EntityHandle> recorded_entities;
+        vector<uint64_t> recorded_materials;
+        vector<uint64_t> recorded_textures;
+
+        // published side, only the main thread touches it, swapped with the recording side so a warmed up frame doesn't allocate
+        vector<EntityHandle> published_handles;
+        vector<EntityChanges> published_entities;
+        vector<uint64_t> published_materials;
+        vector<uint64_t> published_textures;
+        uint32_t published_mask = 0;
+        uint64_t frame          = 0;
+    }
+
+    void ChangeJournal::Record(Entity* entity, const ChangeType type)
+    {
+        // entities the world doesn't own have nobody reading their changes
+        if (!entity || !entity->GetHandle().IsValid())
+        {
+            return;
+        }
+
+        // only the first change of the frame journals the entity, the rest just merge their bits
+        if (entity->m_changes.fetch_or(static_cast<uint32_t>(type), memory_order_acq_rel) != 0)
+        {
+            return;
+        }
+
+        lock_guard lock(mutex_recording);
+        recorded_entities.push_back(entity->GetHandle());
+    }
+
+    void ChangeJournal::RecordMaterial(const uint64_t material_id)
+    {
+        lock_guard lock(mutex_recording);
+        recorded_materials.push_back(material_id);
+    }
+
+    void ChangeJournal::RecordTexture(const uint64_t texture_id)
+    {
+        lock_guard lock(mutex_recording);
+        recorded_textures.push_back(texture_id);
+    }
+
+    void ChangeJournal::Publish()
+    {
+        published_handles.clear();
+        published_materials.clear();
+        published_textures.clear();
+        {
+            lock_guard lock(mutex_recording);
+            published_handles.swap(recorded_entities);
+            published_materials.swap(recorded_materials);
+            published_textures.swap(recorded_textures);
+        }
+
+        // claim the bits, anything recorded from here on journals the entity again for the next frame
+        published_entities.clear();
+        published_mask = 0;
+        for (const EntityHandle handle : published_handles)
+        {
+            if (Entity* entity = World::GetEntity(handle))
+            {
+                const uint32_t types = entity->m_changes.exchange(0, memory_order_acq_rel);
+                if (types != 0)
+                {
+                    published_entities.push_back({ handle, types });
+                    published_mask |= types;
+                }
+            }
+        }
+
+        // a material edited several times in a frame shows up once
+        sort(published_materials.begin(), published_materials.end());
+        published_materials.erase(unique(published_materials.begin(), published_materials.end()), published_materials.end());
+
+        frame++;
+    }
+
+    void ChangeJournal::Clear()
+    {
+        {
+            lock_guard lock(mutex_recording);
+            recorded_entities.clear();
+            recorded_materials.clear();
+            recorded_textures.clear();
+        }
+
+        published_handles.clear();
+        published_entities.clear();
+        published_materials.clear();
+        published_textures.clear();
+        published_mask = 0;
+    }
+
+    const vector<EntityChanges>& ChangeJournal::GetEntityChanges()
+    {
+        return published_entities;
+    }
+
+    const vector<uint64_t>& ChangeJournal::GetMaterialChanges()
+    {
+        return published_materials;
+    }
+
+    const vector<uint64_t>& ChangeJournal::GetTextureChanges()
+    {
+        return published_textures;
+    }
+
+    bool ChangeJournal::HasChanged(const uint32_t types)
+    {
+        return (published_mask & types) != 0;
+    }
+
+    uint64_t ChangeJournal::GetFrame()
+    {
+        return frame;
+    }
+}
@@ -0,0 +1,74 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES =====
+#include <cstdint>
+#include <vector>
+#include "World.h"
+//================
+
+namespace spartan
+{
+    class Entity;
+
+    enum class ChangeType : uint32_t
+    {
+        None       = 0,
+        Transform  = 1 << 0,
+        Active     = 1 << 1,
+        Components = 1 << 2, // a component was added or removed
+        Mesh       = 1 << 3,
+        Material   = 1 << 4, // material assignment, edits to the material itself are recorded per material
+        Light      = 1 << 5, // light parameters or light matrices
+        Attributes = 1 << 6  // set through reflected attributes (editor, tools), may have touched anything
+    };
+
+    struct EntityChanges
+    {
+        EntityHandle handle;
+        uint32_t types = 0; // ChangeType bits
+    };
+
+    // what changed in the world this frame, so per-frame systems visit the deltas instead of every entity
+    // components record when their state actually changes, from any thread, an entity is journaled once per
+    // frame no matter how often it changes, World::Tick publishes the frame and it stays readable until the next one
+    class ChangeJournal
+    {
+    public:
+        static void Record(Entity* entity, ChangeType type);
+        static void RecordMaterial(uint64_t material_id);
+        static void RecordTexture(uint64_t texture_id); // a texture finished preparing for the gpu
+
+        // main thread, once per tick
+        static void Publish();
+        static void Clear();
+
+        // the last published frame, resolve handles through World::GetEntity(), removed entities resolve to null
+        static const std::vector<EntityChanges>& GetEntityChanges();
+        static const std::vector<uint64_t>& GetMaterialChanges();
+        static const std::vector<uint64_t>& GetTextureChanges();
+        static bool HasChanged(uint32_t types); // any entity change of the given ChangeType bits
+        static uint64_t GetFrame();             // bumps with every publish
+    };
+}
@@ -23,8 +23,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "pch.h"
 #include <cstdio>
 #include <sstream>
+#include <thread>
 #include "Entity.h"
+#include "ChangeJournal.h"
 #include "Prefab.h"
+#include "WorldFile.h"
 #include "components/AudioSource.h"
 #include "components/Camera.h"
 #include "components/Light.h"
@@ -45,6 +48,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "components/Text3D.h"
 #include "components/Animator.h"
 #include "components/Ragdoll.h"
+#include "../memory/Allocator.h"
 SP_WARNINGS_OFF
 #include "../io/pugixml.hpp"
 SP_WARNINGS_ON
@@ -125,7 +129,7 @@ namespace spartan
                     Component* component_clone = clone->AddComponent(component_original->GetType());
 
                     // component's properties
-                    component_clone->SetAttributes(component_original->GetAttributes());
+                    component_clone->CopyAttributes(component_original.get());
                 }
             }
 
@@ -368,6 +372,12 @@ namespace spartan
             "SetRotation",              &Entity::SetRotation,
             "SetRotationLocal",         &Entity::SetRotationLocal,
 
+            // cheaper than the full binding for scripts that only move things, see TransformView
+            "GetTransformView", [](Entity* self) -> TransformView
+            {
+                return TransformView{ self->GetHandle() };
+            },
+
             "GetScale",                 &Entity::GetScale,
             "GetScaleLocal",            &Entity::GetScaleLocal,
             "SetScale",                 &Entity::SetScale,
@@ -673,8 +683,10 @@ namespace spartan
     {
         // self
         {
+            const uint64_t id_previous = m_object_id;
             m_is_active   = node.attribute("active").as_bool(true);
             m_object_id   = node.attribute("id").as_ullong();
+            World::OnEntityIdChanged(this, id_previous);
             m_object_name = node.attribute("name").as_string(m_object_name.c_str());
             SetTagsString(node.attribute("tags").as_string(""));
 
@@ -696,117 +708,143 @@ namespace spartan
                 ss >> m_scale_local.x >> m_scale_local.y >> m_scale_local.z;
             }
 
-            // components and prefabs
-            for (pugi::xml_node component_node = node.first_child(); component_node; component_node = component_node.next_sibling())
+            LoadComponents(node);
+        }
+
+        // children, skipped when the world loader flattens the hierarchy for parallel load
+        if (load_children)
+        {
+            for (pugi::xml_node child_node = node.child("Entity"); child_node; child_node = child_node.next_sibling("Entity"))
             {
-                string type_name = component_node.name();
-                if (type_name == "Entity")
-                {
-                    continue;
-                } // skip children, handled below
+                Entity* child = World::CreateEntity();
+                child->Load(child_node);
+                child->SetParent(this);
+            }
+        }
 
-                // check for prefab node - creates complex entity hierarchies
-                if (type_name == "prefab")
-                {
-                    // store prefab data for saving later
-                    string prefab_type = component_node.attribute("type").as_string();
-                    string prefab_file = component_node.attribute("file").as_string();
+        MarkTransformDirty();
+    }
 
-                    unordered_map<string, string> prefab_attributes;
-                    for (pugi::xml_attribute attr = component_node.first_attribute(); attr; attr = attr.next_attribute())
-                    {
-                        string attr_name = attr.name();
-                        if (attr_name == "type" || attr_name == "file")
-                        {
-                            continue;
-                        } // type and file are stored separately
-                        prefab_attributes[attr_name] = attr.value();
-                    }
-                    SetPrefabData(prefab_type, prefab_attributes);
+    void Entity::Load(const EntityRecord& record, pugi::xml_node& node)
+    {
+        const uint64_t id_previous = m_object_id;
+        m_is_active = record.active;
+        m_object_id = record.id;
+        World::OnEntityIdChanged(this, id_previous);
+        if (!record.name.empty())
+        {
+            m_object_name = record.name;
+        }
+        SetTagsString(record.tags);
 
-                    if (!prefab_file.empty())
-                    {
-                        SetPrefabFilePath(prefab_file);
-                    }
+        // already decoded, no string parsing
+        m_position_local = record.position;
+        m_rotation_local = record.rotation;
+        m_scale_local    = record.scale;
 
-                    // code prefab - use registered factory function
-                    if (!prefab_type.empty() && Prefab::IsRegistered(prefab_type))
-                    {
-                        Prefab::Create(component_node, this);
-                    }
-                    // file prefab - load entity hierarchy from .prefab file
-                    else if (!prefab_file.empty())
+        LoadComponents(node);
+        MarkTransformDirty();
+    }
+
+    void Entity::LoadComponents(pugi::xml_node& node)
+    {
+        // components and prefabs
+        for (pugi::xml_node component_node = node.first_child(); component_node; component_node = component_node.next_sibling())
+        {
+            string type_name = component_node.name();
+            if (type_name == "Entity")
+            {
+                continue;
+            } // skip children, the caller loads them
+
+            // check for prefab node - creates complex entity hierarchies
+            if (type_name == "prefab")
+            {
+                // store prefab data for saving later
+                string prefab_type = component_node.attribute("type").as_string();
+                string prefab_file = component_node.attribute("file").as_string();
+
+                unordered_map<string, string> prefab_attributes;
+                for (pugi::xml_attribute attr = component_node.first_attribute(); attr; attr = attr.next_attribute())
+                {
+                    string attr_name = attr.name();
+                    if (attr_name == "type" || attr_name == "file")
                     {
-                        Prefab::LoadFromFile(prefab_file, this);
-                    }
+                        continue;
+                    } // type and file are stored separately
+                    prefab_attributes[attr_name] = attr.value();
+                }
+                SetPrefabData(prefab_type, prefab_attributes);
 
-                    // snapshot the base so later additions are detected as overrides
-                    MarkPrefabBaseline();
+                if (!prefab_file.empty())
+                {
+                    SetPrefabFilePath(prefab_file);
+                }
+
+                // code prefab - use registered factory function
+                if (!prefab_type.empty() && Prefab::IsRegistered(prefab_type))
+                {
+                    Prefab::Create(component_node, this);
+                }
+                // file prefab - load entity hierarchy from .prefab file
+                else if (!prefab_file.empty())
+                {
+                    Prefab::LoadFromFile(prefab_file, this);
+                }
 
+                // snapshot the base so later additions are detected as overrides
+                MarkPrefabBaseline();
+
+                continue;
+            }
+
+            // apply a user override onto an existing base node, resolved by name path
+            if (type_name == "prefab_override")
+            {
+                string path     = component_node.attribute("path").as_string();
+                Entity* target  = GetDescendantByPath(path);
+                if (!target)
+                {
+                    SP_LOG_WARNING("Prefab override path no longer exists, skipping: %s", path.c_str());
                     continue;
                 }
 
-                // apply a user override onto an existing base node, resolved by name path
-                if (type_name == "prefab_override")
+                load_transform_override(target, component_node);
+
+                for (pugi::xml_node override_child = component_node.first_child(); override_child; override_child = override_child.next_sibling())
                 {
-                    string path     = component_node.attribute("path").as_string();
-                    Entity* target  = GetDescendantByPath(path);
-                    if (!target)
+                    string override_name = override_child.name();
+                    if (override_name == "Entity")
                     {
-                        SP_LOG_WARNING("Prefab override path no longer exists, skipping: %s", path.c_str());
-                        continue;
+                        Entity* child = World::CreateEntity();
+                        child->Load(override_child);
+                        child->SetParent(target);
                     }
-
-                    load_transform_override(target, component_node);
-
-                    for (pugi::xml_node override_child = component_node.first_child(); override_child; override_child = override_child.next_sibling())
+                    else
                     {
-                        string override_name = override_child.name();
-                        if (override_name == "Entity")
+                        ComponentType override_type = Component::StringToType(override_name);
+                        if (override_type != ComponentType::Max)
                         {
-                            Entity* child = World::CreateEntity();
-                            child->Load(override_child);
-                            child->SetParent(target);
-                        }
-                        else
-                        {
-                            ComponentType override_type = Component::StringToType(override_name);
-                            if (override_type != ComponentType::Max)
+                            if (Component* component = target->AddComponent(override_type))
                             {
-                                if (Component* component = target->AddComponent(override_type))
-                                {
-                                    component->Load(override_child);
-                                }
+                                component->Load(override_child);
                             }
                         }
                     }
-
-                    continue;
                 }
 
-                ComponentType type = Component::StringToType(type_name);
-                if (type != ComponentType::Max)
-                {
-                    if (Component* component = AddComponent(type))
-                    {
-                        component->Load(component_node);
-                    }
-                }
+                continue;
             }
-        }
 
-        // children, skipped when the world loader flattens the hierarchy for parallel load
-        if (load_children)
-        {
-            for (pugi::xml_node child_node = node.child("Entity"); child_node; child_node = child_node.next_sibling("Entity"))
+            ComponentType type = Component::StringToType(type_name);
+            if (type != ComponentType::Max)
             {
-                Entity* child = World::CreateEntity();
-                child->Load(child_node);
-                child->SetParent(this);
+                if (Component* component = AddComponent(type))
+                {
+                    component->Load(component_node);
+                }
             }
         }
-
-        UpdateTransform();
     }
 
     bool Entity::GetActive()
@@ -827,6 +865,7 @@ namespace spartan
         }
 
         m_is_active = active;
+        ChangeJournal::Record(this, ChangeType::Active);
     }
 
     Component* Entity::GetComponentByType(ComponentType Type) const
@@ -907,6 +946,7 @@ namespace spartan
 
         m_components[static_cast<uint32_t>(Type)] = component;
         m_component_count++;
+        ChangeJournal::Record(this, ChangeType::Components);
 
         component->SetType(Type);
         component->Initialize();
@@ -923,6 +963,7 @@ namespace spartan
             {
                 m_component_count--;
             }
+            ChangeJournal::Record(this, ChangeType::Components);
         }
     }
 
@@ -958,49 +999,32 @@ namespace spartan
                     {
                         m_component_count--;
                     }
+                    ChangeJournal::Record(this, ChangeType::Components);
                     break;
                 }
             }
         }
     }
 
-    void Entity::UpdateTransform()
+    void Entity::MarkTransformDirty()
     {
-        // compute local transform
-        m_matrix_local = Matrix(m_position_local, m_rotation_local, m_scale_local);
-
-        // compute world transform
-        if (m_parent)
-        {
-            m_matrix = m_matrix_local * m_parent->GetMatrix();
-        }
-        else
-        {
-            m_matrix = m_matrix_local;
-        }
+        // mark update
+        m_time_since_last_transform_sec = 0.0f;
 
-        // update directions directly from matrix (avoids unstable quaternion decomposition)
-        // row-major layout: row 0 = right (X), row 1 = up (Y), row 2 = forward (Z)
+        // an entity that is already dirty has already marked its subtree, repeated sets within a tick stop here
+        if (m_transform_state.exchange(TransformState::Dirty, memory_order_acq_rel) == TransformState::Dirty)
         {
-            // x
-            m_right    = Vector3::Normalize(Vector3(m_matrix.m00, m_matrix.m01, m_matrix.m02));
-            m_left     = -m_right;
-            // y
-            m_up       = Vector3::Normalize(Vector3(m_matrix.m10, m_matrix.m11, m_matrix.m12));
-            m_down     = -m_up;
-            // z
-            m_forward  = Vector3::Normalize(Vector3(m_matrix.m20, m_matrix.m21, m_matrix.m22));
-            m_backward = -m_forward;
+            return;
         }
 
-        // mark update
-        m_time_since_last_transform_sec = 0.0f;
+        TransformHierarchy::Enqueue(m_handle);
+        ChangeJournal::Record(this, ChangeType::Transform);
 
         // copy under the children lock, parallel prefab loads can AddChild while a parent updates
         Entity* stack_children[32];
         Entity** child_list = nullptr;
         uint32_t child_count = 0;
-        vector<Entity*> heap_children;
+        FrameVector<Entity*, MemoryTag::World> heap_children;
         {
             lock_guard lock(m_mutex_children);
             child_count = static_cast<uint32_t>(m_children.size());
@@ -1016,7 +1040,7 @@ namespace spartan
             }
             else
             {
-                heap_children = m_children;
+                heap_children.assign(m_children.begin(), m_children.end());
                 child_list    = heap_children.data();
             }
         }
@@ -1025,8 +1049,56 @@ namespace spartan
         {
             if (child_list[i])
             {
-                child_list[i]->UpdateTransform();
+                child_list[i]->MarkTransformDirty();
+            }
+        }
+    }
+
+    void Entity::ResolveTransform() const
+    {
+        // claim the entity, if another thread (or the batch) is resolving it, wait for that instead
+        while (true)
+        {
+            TransformState expected = TransformState::Dirty;
+            if (m_transform_state.compare_exchange_strong(expected, TransformState::Resolving, memory_order_acquire))
+            {
+                break;
             }
+
+            if (expected == TransformState::Clean)
+            {
+                return;
+            }
+
+            this_thread::yield();
+        }
+
+        // the parent resolves first through its own getter
+        Matrix matrix_local = Matrix(m_position_local, m_rotation_local, m_scale_local);
+        ApplyTransform(matrix_local, m_parent ? matrix_local * m_parent->GetMatrix() : matrix_local);
+
+        // a setter that ran in the meantime left the entity dirty, it resolves again on the next read
+        TransformState expected = TransformState::Resolving;
+        m_transform_state.compare_exchange_strong(expected, TransformState::Clean, memory_order_release);
+    }
+
+    void Entity::ApplyTransform(const Matrix& matrix_local, const Matrix& matrix) const
+    {
+        m_matrix_local = matrix_local;
+        m_matrix       = matrix;
+
+        // update directions directly from matrix (avoids unstable quaternion decomposition)
+        // row-major layout: row 0 = right (X), row 1 = up (Y), row 2 = forward (Z)
+        {
+            // x
+            m_right    = Vector3::Normalize(Vector3(m_matrix.m00, m_matrix.m01, m_matrix.m02));
+            m_left     = -m_right;
+            // y
+            m_up       = Vector3::Normalize(Vector3(m_matrix.m10, m_matrix.m11, m_matrix.m12));
+            m_down     = -m_up;
+            // z
+            m_forward  = Vector3::Normalize(Vector3(m_matrix.m20, m_matrix.m21, m_matrix.m22));
+            m_backward = -m_forward;
         }
     }
 
@@ -1056,7 +1128,7 @@ namespace spartan
         }
 
         m_position_local = position;
-        UpdateTransform();
+        MarkTransformDirty();
     }
 
     void Entity::SetRotation(const Quaternion& rotation)
@@ -1108,7 +1180,7 @@ namespace spartan
         }
 
         m_rotation_local = rotation;
-        UpdateTransform();
+        MarkTransformDirty();
     }
 
     void Entity::SetScale(const Vector3& scale)
@@ -1143,7 +1215,7 @@ namespace spartan
         m_scale_local.y = (m_scale_local.y == 0.0f) ? numeric_limits<float>::min() : m_scale_local.y;
         m_scale_local.z = (m_scale_local.z == 0.0f) ? numeric_limits<float>::min() : m_scale_local.z;
 
-        UpdateTransform();
+        MarkTransformDirty();
     }
 
     void Entity::Translate(const Vector3& delta)
@@ -1256,7 +1328,7 @@ namespace spartan
                         }
 
                         child->m_parent = m_parent; // directly setting parent
-                        child->UpdateTransform();   // update transform if needed
+                        child->MarkTransformDirty(); // update transform if needed
                     }
                 }
             }
@@ -1277,8 +1349,8 @@ namespace spartan
             m_parent = new_parent;
         }
 
-        // transform after releasing m_mutex_parent, UpdateTransform can touch children/locks
-        UpdateTransform();
+        // transform after releasing m_mutex_parent, MarkTransformDirty can touch children/locks
+        MarkTransformDirty();
     }
 
     void Entity::AddChild(Entity* child)
@@ -1363,7 +1435,7 @@ namespace spartan
         lock_guard lock(m_mutex_parent);
 
         m_parent = nullptr;
-        UpdateTransform();
+        MarkTransformDirty();
     }
 
     uint32_t Entity::GetChildrenCount() const
@@ -27,6 +27,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <mutex>
 #include <unordered_map>
 #include "World.h"
+#include "ChangeJournal.h"
+#include "TransformHierarchy.h"
 #include "components/Component.h"
 #include "../math/Quaternion.h"
 #include "../math/Matrix.h"
@@ -40,6 +42,7 @@ namespace pugi
 namespace spartan
 {
     class Render;
+    struct EntityRecord;
 
     class Entity : public SpartanObject
     {
@@ -68,6 +71,8 @@ namespace spartan
         void Save(pugi::xml_node& node);
         // load_children false skips nested Entity nodes, used by the flattened world loader
         void Load(pugi::xml_node& node, bool load_children = true);
+        // binary worlds decode identity and transform up front, node then only carries components and prefabs
+        void Load(const EntityRecord& record, pugi::xml_node& node);
 
         // active
         bool GetActive();
@@ -95,6 +100,7 @@ namespace spartan
             // save new component
             m_components[static_cast<uint32_t>(type)] = std::static_pointer_cast<Component>(component);
             m_component_count++;
+            ChangeJournal::Record(this, ChangeType::Components);
 
             // initialize component
             component->SetType(type);
@@ -126,6 +132,7 @@ namespace spartan
                 {
                     m_component_count--;
                 }
+                ChangeJournal::Record(this, ChangeType::Components);
             }
         }
 
@@ -136,21 +143,21 @@ namespace spartan
         uint32_t GetComponentCount() const;
 
         //= POSITION ======================================================================
-        math::Vector3 GetPosition()             const { return m_matrix.GetTranslation(); }
+        math::Vector3 GetPosition()             const { ResolveTransformIfDirty(); return m_matrix.GetTranslation(); }
         const math::Vector3& GetPositionLocal() const { return m_position_local; }
         void SetPosition(const math::Vector3& position);
         void SetPositionLocal(const math::Vector3& position);
         //=================================================================================
 
         //= ROTATION ======================================================================
-        math::Quaternion GetRotation()             const { return m_matrix.GetRotation(); }
+        math::Quaternion GetRotation()             const { ResolveTransformIfDirty(); return m_matrix.GetRotation(); }
         const math::Quaternion& GetRotationLocal() const { return m_rotation_local; }
         void SetRotation(const math::Quaternion& rotation);
         void SetRotationLocal(const math::Quaternion& rotation);
         //=================================================================================
 
         //= SCALE ================================================================
-        math::Vector3 GetScale()             const { return m_matrix.GetScale(); }
+        math::Vector3 GetScale()             const { ResolveTransformIfDirty(); return m_matrix.GetScale(); }
         const math::Vector3& GetScaleLocal() const { return m_scale_local; }
         void SetScale(const math::Vector3& scale);
         void SetScaleLocal(const math::Vector3& scale);
@@ -162,12 +169,12 @@ namespace spartan
         //=========================================
 
         //= DIRECTIONS ================================================
-        const math::Vector3& GetUp() const       { return m_up; }
-        const math::Vector3& GetDown() const     { return m_down; }
-        const math::Vector3& GetForward() const  { return m_forward; }
-        const math::Vector3& GetBackward() const { return m_backward; }
-        const math::Vector3& GetRight() const    { return m_right; }
-        const math::Vector3& GetLeft() const     { return m_left; }
+        const math::Vector3& GetUp() const       { ResolveTransformIfDirty(); return m_up; }
+        const math::Vector3& GetDown() const     { ResolveTransformIfDirty(); return m_down; }
+        const math::Vector3& GetForward() const  { ResolveTransformIfDirty(); return m_forward; }
+        const math::Vector3& GetBackward() const { ResolveTransformIfDirty(); return m_backward; }
+        const math::Vector3& GetRight() const    { ResolveTransformIfDirty(); return m_right; }
+        const math::Vector3& GetLeft() const     { ResolveTransformIfDirty(); return m_left; }
         //=============================================================
 
         //= HIERARCHY ===================================================================================
@@ -192,8 +199,10 @@ namespace spartan
         std::vector<Entity*> GetChildren() const;
         //===============================================================================================
 
-        const math::Matrix& GetMatrix() const              { return m_matrix; }
-        const math::Matrix& GetLocalMatrix() const         { return m_matrix_local; }
+        // setters only mark the transform dirty, TransformHierarchy::Resolve() batches the world matrices
+        // once per tick phase, reading a dirty transform in between resolves it (and its dirty ancestors) on the spot
+        const math::Matrix& GetMatrix() const              { ResolveTransformIfDirty(); return m_matrix; }
+        const math::Matrix& GetLocalMatrix() const         { ResolveTransformIfDirty(); return m_matrix_local; }
         const math::Matrix& GetMatrixPrevious() const      { return m_matrix_previous; }
         void SetMatrixPrevious(const math::Matrix& matrix) { m_matrix_previous = matrix; }
         float GetTimeSinceLastTransform() const            { return m_time_since_last_transform_sec; }
@@ -214,6 +223,10 @@ namespace spartan
         void MarkPrefabBaseline();
         bool IsPrefabOwned() const { return m_prefab_owned; }
 
+        // assigned by World::CreateEntity(), hold on to this instead of the pointer when the entity may be removed
+        EntityHandle GetHandle() const            { return m_handle; }
+        void SetHandle(const EntityHandle handle) { m_handle = handle; }
+
         // transient entities are not serialized (e.g. dynamically created entities like flashlights)
         void SetTransient(bool transient)  { m_transient = transient; }
         bool IsTransient() const           { return m_transient; }
@@ -231,11 +244,28 @@ namespace spartan
     private:
         std::atomic<bool> m_is_active = true;
         bool m_transient              = false; // transient entities are not serialized
+        EntityHandle m_handle;
         std::array<std::shared_ptr<Component>, static_cast<uint32_t>(ComponentType::Max)> m_components;
         uint32_t m_component_count = 0;
 
-        void UpdateTransform();
+        void MarkTransformDirty();
+        void ResolveTransformIfDirty() const
+        {
+            if (m_transform_state.load(std::memory_order_acquire) != TransformState::Clean)
+            {
+                ResolveTransform();
+            }
+        }
+        void ResolveTransform() const;
+        void ApplyTransform(const math::Matrix& matrix_local, const math::Matrix& matrix) const;
         math::Matrix GetParentTransformMatrix();
+        friend class TransformHierarchy;
+
+        // ChangeType bits recorded this frame, ChangeJournal claims them when it publishes
+        std::atomic<uint32_t> m_changes = 0;
+        friend class ChangeJournal;
+
+        void LoadComponents(pugi::xml_node& node);
 
         // walks a prefab base subtree and writes user additions as <prefab_override> blocks onto the instance root node
         void SaveOverrides(pugi::xml_node& root_node, const std::string& path);
@@ -246,17 +276,22 @@ namespace spartan
         math::Quaternion m_rotation_local = math::Quaternion::Identity;
         math::Vector3 m_scale_local       = math::Vector3::One;
 
-        math::Matrix m_matrix          = math::Matrix::Identity;
-        math::Matrix m_matrix_previous = math::Matrix::Identity;
-        math::Matrix m_matrix_local    = math::Matrix::Identity;
-
-        // computed during UpdateTransform() and cached for performance
-        math::Vector3 m_forward  = math::Vector3::Zero;
-        math::Vector3 m_backward = math::Vector3::Zero;
-        math::Vector3 m_up       = math::Vector3::Zero;
-        math::Vector3 m_down     = math::Vector3::Zero;
-        math::Vector3 m_right    = math::Vector3::Zero;
-        math::Vector3 m_left     = math::Vector3::Zero;
+        mutable math::Matrix m_matrix       = math::Matrix::Identity;
+        math::Matrix m_matrix_previous      = math::Matrix::Identity;
+        mutable math::Matrix m_matrix_local = math::Matrix::Identity;
+
+        // computed when the transform resolves and cached for performance
+        mutable math::Vector3 m_forward  = math::Vector3::Zero;
+        mutable math::Vector3 m_backward = math::Vector3::Zero;
+        mutable math::Vector3 m_up       = math::Vector3::Zero;
+        mutable math::Vector3 m_down     = math::Vector3::Zero;
+        mutable math::Vector3 m_right    = math::Vector3::Zero;
+        mutable math::Vector3 m_left     = math::Vector3::Zero;
+
+        // dirty until the world matrix is recomputed, the batch fields let TransformHierarchy find parents in its arrays
+        mutable std::atomic<TransformState> m_transform_state = TransformState::Clean;
+        uint32_t m_transform_batch                            = 0;
+        uint32_t m_transform_batch_index                      = 0;
 
         Entity* m_parent = nullptr;      // the parent of this entity
         std::vector<Entity*> m_children; // the children of this entity
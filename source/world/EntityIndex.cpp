@@ -0,0 +1,390 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==========
+#include "pch.h"
+#include "EntityIndex.h"
+#include "Entity.h"
+//=====================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace spartan
+{
+    namespace
+    {
+        constexpr uint64_t id_empty              = 0;
+        constexpr uint64_t id_removed            = numeric_limits<uint64_t>::max();
+        constexpr uint32_t id_table_capacity_min = 1024;
+
+        // ids come from files as well as from the random generator, so mix them before probing
+        uint32_t hash_id(uint64_t id)
+        {
+            id ^= id >> 33;
+            id *= 0xff51afd7ed558ccdull;
+            id ^= id >> 33;
+            return static_cast<uint32_t>(id);
+        }
+
+        uint32_t next_generation(uint32_t generation)
+        {
+            return generation == numeric_limits<uint32_t>::max() ? 1 : generation + 1;
+        }
+    }
+
+    EntityIndex::EntityIndex()
+    {
+        m_id_tables.push_back(make_unique<id_table>(id_table_capacity_min));
+        m_ids.store(m_id_tables.back().get(), memory_order_release);
+    }
+
+    EntityIndex::~EntityIndex()
+    {
+        for (atomic<slot*>& chunk : m_chunks)
+        {
+            delete[] chunk.load(memory_order_relaxed);
+        }
+    }
+
+    EntityHandle EntityIndex::Add(Entity* entity)
+    {
+        lock_guard<mutex> lock(m_mutex);
+        return AddLocked(entity);
+    }
+
+    void EntityIndex::Add(span<Entity* const> entities, EntityHandle* handles_out)
+    {
+        lock_guard<mutex> lock(m_mutex);
+
+        // grow the id table once for the whole batch instead of rehashing part way through
+        const uint32_t used = m_ids.load(memory_order_relaxed)->used + static_cast<uint32_t>(entities.size());
+        if (used * 2 > m_ids.load(memory_order_relaxed)->mask + 1)
+        {
+            Rehash(max(id_table_capacity_min, bit_ceil((m_count.load(memory_order_relaxed) + static_cast<uint32_t>(entities.size())) * 4)));
+        }
+
+        for (size_t i = 0; i < entities.size(); i++)
+        {
+            handles_out[i] = AddLocked(entities[i]);
+        }
+    }
+
+    EntityHandle EntityIndex::AddLocked(Entity* entity)
+    {
+        uint32_t index = 0;
+        if (!m_free.empty())
+        {
+            index = m_free.back();
+            m_free.pop_back();
+        }
+        else
+        {
+            index = m_slot_count;
+            const uint32_t chunk = index / chunk_size;
+            SP_ASSERT_MSG(chunk < chunk_count_max, "Too many entities");
+            if (!m_chunks[chunk].load(memory_order_relaxed))
+            {
+                m_chunks[chunk].store(new slot[chunk_size], memory_order_release);
+            }
+            m_slot_count++;
+        }
+
+        slot& s           = *GetSlot(index);
+        const uint64_t id = entity->GetObjectId();
+        s.id.store(id, memory_order_relaxed);
+        s.entity.store(entity, memory_order_release);
+        InsertId(id, index);
+        m_count.fetch_add(1, memory_order_relaxed);
+
+        return { index, s.generation.load(memory_order_relaxed) };
+    }
+
+    void EntityIndex::Remove(const EntityHandle handle)
+    {
+        lock_guard<mutex> lock(m_mutex);
+
+        slot* s = GetSlot(handle.index);
+        if (!s || s->generation.load(memory_order_relaxed) != handle.generation)
+        {
+            return;
+        }
+
+        // bump the generation before clearing, a reader that still sees the entity sees it as it was before removal
+        EraseId(s->id.load(memory_order_relaxed), handle.index);
+        s->generation.store(next_generation(handle.generation), memory_order_release);
+        s->entity.store(nullptr, memory_order_release);
+        s->id.store(id_empty, memory_order_relaxed);
+        m_free.push_back(handle.index);
+        m_count.fetch_sub(1, memory_order_relaxed);
+    }
+
+    void EntityIndex::UpdateId(const EntityHandle handle, const uint64_t id_previous, const uint64_t id)
+    {
+        lock_guard<mutex> lock(m_mutex);
+
+        slot* s = GetSlot(handle.index);
+        if (!s || s->generation.load(memory_order_relaxed) != handle.generation || id == id_previous)
+        {
+            return;
+        }
+
+        EraseId(id_previous, handle.index);
+        s->id.store(id, memory_order_release);
+        InsertId(id, handle.index);
+    }
+
+    void EntityIndex::Clear()
+    {
+        lock_guard<mutex> lock(m_mutex);
+
+        // slots keep their generation moving so handles from before the clear stay stale
+        m_free.clear();
+        for (uint32_t i = m_slot_count; i > 0; i--)
+        {
+            slot& s = *GetSlot(i - 1);
+            if (s.entity.load(memory_order_relaxed))
+            {
+                s.generation.store(next_generation(s.generation.load(memory_order_relaxed)), memory_order_relaxed);
+                s.entity.store(nullptr, memory_order_relaxed);
+                s.id.store(id_empty, memory_order_relaxed);
+            }
+            m_free.push_back(i - 1);
+        }
+        m_count.store(0, memory_order_relaxed);
+
+        m_id_tables.clear();
+        m_id_tables.push_back(make_unique<id_table>(id_table_capacity_min));
+        m_ids.store(m_id_tables.back().get(), memory_order_release);
+        m_id_duplicates.clear();
+    }
+
+    void EntityIndex::ReleaseRetiredTables()
+    {
+        lock_guard<mutex> lock(m_mutex);
+
+        if (m_id_tables.size() > 1)
+        {
+            m_id_tables.erase(m_id_tables.begin(), m_id_tables.end() - 1);
+        }
+    }
+
+    Entity* EntityIndex::Get(const EntityHandle handle) const
+    {
+        if (!handle.IsValid())
+        {
+            return nullptr;
+        }
+
+        const slot* s = GetSlot(handle.index);
+        if (!s)
+        {
+            return nullptr;
+        }
+
+        Entity* entity = s->entity.load(memory_order_acquire);
+        return s->generation.load(memory_order_acquire) == handle.generation ? entity : nullptr;
+    }
+
+    Entity* EntityIndex::Find(const uint64_t id) const
+    {
+        if (id == id_empty || id == id_removed)
+        {
+            return nullptr;
+        }
+
+        const id_table* table = m_ids.load(memory_order_acquire);
+        uint32_t position     = hash_id(id) & table->mask;
+        for (uint32_t probe = 0; probe <= table->mask; probe++, position = (position + 1) & table->mask)
+        {
+            const id_entry& entry = table->entries[position];
+            const uint64_t key    = entry.id.load(memory_order_acquire);
+            if (key == id_empty)
+            {
+                return nullptr;
+            }
+
+            if (key == id)
+            {
+                // the entry can be reused between the two loads, the slot's own id settles it
+                const slot* s = GetSlot(entry.slot.load(memory_order_acquire));
+                if (s && s->id.load(memory_order_acquire) == id)
+                {
+                    return s->entity.load(memory_order_acquire);
+                }
+                return nullptr;
+            }
+        }
+
+        return nullptr;
+    }
+
+    EntityIndex::slot* EntityIndex::GetSlot(const uint32_t index) const
+    {
+        const uint32_t chunk = index / chunk_size;
+        if (chunk >= chunk_count_max)
+        {
+            return nullptr;
+        }
+
+        slot* slots = m_chunks[chunk].load(memory_order_acquire);
+        return slots ? &slots[index % chunk_size] : nullptr;
+    }
+
+    void EntityIndex::InsertId(const uint64_t id, const uint32_t slot_index)
+    {
+        if (id == id_empty || id == id_removed)
+        {
+            return;
+        }
+
+        // keep at most half the table in use, removed entries included, so probes stay short
+        id_table* table = m_ids.load(memory_order_relaxed);
+        if ((table->used + 1) * 2 > table->mask + 1)
+        {
+            Rehash(max(id_table_capacity_min, bit_ceil((m_count.load(memory_order_relaxed) + 1) * 4)));
+            table = m_ids.load(memory_order_relaxed);
+        }
+
+        // removed entries are reused, but the probe runs on to the first empty entry to catch duplicates
+        id_entry* reuse   = nullptr;
+        uint32_t position = hash_id(id) & table->mask;
+        while (true)
+        {
+            id_entry& entry    = table->entries[position];
+            const uint64_t key = entry.id.load(memory_order_relaxed);
+
+            // duplicate ids resolve to the entity that registered first, like the old linear scan,
+            // the others wait on the side and take over the entry when the owner goes away
+            if (key == id)
+            {
+                m_id_duplicates.emplace(id, slot_index);
+                return;
+            }
+
+            if (key == id_removed && !reuse)
+            {
+                reuse = &entry;
+            }
+
+            if (key == id_empty)
+            {
+                if (!reuse)
+                {
+                    reuse = &entry;
+                    table->used++;
+                }
+
+                // the slot is written first, a reader that sees the id sees the slot too
+                reuse->slot.store(slot_index, memory_order_relaxed);
+                reuse->id.store(id, memory_order_release);
+                return;
+            }
+
+            position = (position + 1) & table->mask;
+        }
+    }
+
+    void EntityIndex::EraseId(const uint64_t id, const uint32_t slot_index)
+    {
+        if (id == id_empty || id == id_removed)
+        {
+            return;
+        }
+
+        id_table* table   = m_ids.load(memory_order_relaxed);
+        uint32_t position = hash_id(id) & table->mask;
+        for (uint32_t probe = 0; probe <= table->mask; probe++, position = (position + 1) & table->mask)
+        {
+            id_entry& entry    = table->entries[position];
+            const uint64_t key = entry.id.load(memory_order_relaxed);
+            if (key == id_empty)
+            {
+                return;
+            }
+
+            if (key != id)
+            {
+                continue;
+            }
+
+            // a duplicate that never owned the entry only leaves the side table
+            if (entry.slot.load(memory_order_relaxed) != slot_index)
+            {
+                auto [first, last] = m_id_duplicates.equal_range(id);
+                for (auto it = first; it != last; ++it)
+                {
+                    if (it->second == slot_index)
+                    {
+                        m_id_duplicates.erase(it);
+                        break;
+                    }
+                }
+                return;
+            }
+
+            // hand the entry to another live slot with the same id, so Find() still resolves it
+            auto heir = m_id_duplicates.find(id);
+            if (heir != m_id_duplicates.end())
+            {
+                entry.slot.store(heir->second, memory_order_release);
+                m_id_duplicates.erase(heir);
+                return;
+            }
+
+            // the entry stays occupied so probes for other ids keep walking past it
+            entry.id.store(id_removed, memory_order_release);
+            return;
+        }
+    }
+
+    void EntityIndex::Rehash(const uint32_t capacity)
+    {
+        // the new table is filled before it's published, readers in the old one still find everything,
+        // entries are copied rather than rebuilt from the slots so duplicate ids keep the same owner
+        unique_ptr<id_table> table   = make_unique<id_table>(capacity);
+        const id_table* table_source = m_ids.load(memory_order_relaxed);
+        for (uint32_t i = 0; i <= table_source->mask; i++)
+        {
+            const id_entry& source = table_source->entries[i];
+            const uint64_t id      = source.id.load(memory_order_relaxed);
+            if (id == id_empty || id == id_removed)
+            {
+                continue;
+            }
+
+            uint32_t position = hash_id(id) & table->mask;
+            while (table->entries[position].id.load(memory_order_relaxed) != id_empty)
+            {
+                position = (position + 1) & table->mask;
+            }
+
+            id_entry& entry = table->entries[position];
+            entry.slot.store(source.slot.load(memory_order_relaxed), memory_order_relaxed);
+            entry.id.store(id, memory_order_relaxed);
+            table->used++;
+        }
+
+        m_ids.store(table.get(), memory_order_release);
+        m_id_tables.push_back(move(table));
+    }
+}
@@ -0,0 +1,104 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ========
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include "World.h"
+//===================
+
+namespace spartan
+{
+    class Entity;
+
+    // generational slots for every entity the world owns, plus an id to slot hash table
+    // readers never lock, writers (entity creation, removal and id changes) serialize on a mutex
+    // slot chunks never move and replaced hash tables are kept until ReleaseRetiredTables(), so a reader never touches freed memory
+    class EntityIndex
+    {
+    public:
+        EntityIndex();
+        ~EntityIndex();
+
+        EntityHandle Add(Entity* entity);
+        // one lock and at most one rehash for the whole batch, handles_out must hold entities.size() handles
+        void Add(std::span<Entity* const> entities, EntityHandle* handles_out);
+        void Remove(EntityHandle handle);
+        void UpdateId(EntityHandle handle, uint64_t id_previous, uint64_t id);
+
+        // invalidates every handle, only call while no other thread reads
+        void Clear();
+
+        // frees the hash tables that rehashes replaced, only call while no other thread reads
+        void ReleaseRetiredTables();
+
+        Entity* Get(EntityHandle handle) const;
+        Entity* Find(uint64_t id) const;
+        uint32_t GetCount() const { return m_count.load(std::memory_order_relaxed); }
+
+    private:
+        static constexpr uint32_t chunk_size      = 4096;
+        static constexpr uint32_t chunk_count_max = 1024; // 4m entities
+
+        struct slot
+        {
+            std::atomic<Entity*> entity     = nullptr;
+            std::atomic<uint64_t> id        = 0;
+            std::atomic<uint32_t> generation = 1;
+        };
+
+        struct id_entry
+        {
+            std::atomic<uint64_t> id   = 0; // 0 is empty, uint64 max is a removed entry
+            std::atomic<uint32_t> slot = 0;
+        };
+
+        struct id_table
+        {
+            explicit id_table(uint32_t capacity) : entries(new id_entry[capacity]), mask(capacity - 1) {}
+
+            std::unique_ptr<id_entry[]> entries;
+            uint32_t mask = 0;
+            uint32_t used = 0; // live and removed entries, only the writer reads this
+        };
+
+        EntityHandle AddLocked(Entity* entity);
+        slot* GetSlot(uint32_t index) const;
+        void InsertId(uint64_t id, uint32_t slot_index);
+        void EraseId(uint64_t id, uint32_t slot_index);
+        void Rehash(uint32_t capacity);
+
+        std::atomic<slot*> m_chunks[chunk_count_max] = {};
+        std::atomic<id_table*> m_ids                  = nullptr;
+        std::vector<std::unique_ptr<id_table>> m_id_tables; // the last one is live, readers may still be in older ones
+        std::unordered_multimap<uint64_t, uint32_t> m_id_duplicates; // slots whose id another slot already owns in the table
+        std::vector<uint32_t> m_free;
+        uint32_t m_slot_count                         = 0;
+        std::atomic<uint32_t> m_count                 = 0;
+        std::mutex m_mutex;
+    };
+}
@@ -0,0 +1,229 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ========================
+#include "pch.h"
+#include "TransformHierarchy.h"
+#include "Entity.h"
+#include "../core/ThreadPool.h"
+#include "../profiling/Profiler.h"
+//===================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan::math;
+//============================
+
+namespace spartan
+{
+    namespace
+    {
+        constexpr uint32_t parent_none        = numeric_limits<uint32_t>::max();
+        constexpr uint32_t parallel_level_min = 256; // smaller levels are cheaper to resolve inline
+        constexpr uint32_t parallel_chunk_min = 64;
+
+        mutex mutex_queue;
+        vector<EntityHandle> queue;
+
+        // persistent so a warmed up tick doesn't allocate
+        struct pending_entity
+        {
+            Entity* entity = nullptr;
+            uint32_t depth = 0;
+        };
+        vector<EntityHandle> handles;
+        vector<pending_entity> pending;
+        vector<uint32_t> level_offsets; // level i spans [level_offsets[i], level_offsets[i + 1])
+        vector<uint32_t> level_cursors;
+
+        // the batch, depth sorted
+        vector<Entity*> batch_entity;
+        vector<uint32_t> batch_parent; // index into the batch, or parent_none when the parent is already clean
+        vector<Matrix> batch_world;
+
+        uint32_t batch_id       = 0;
+        uint32_t resolved_count = 0;
+    }
+
+    void TransformHierarchy::Enqueue(const EntityHandle handle)
+    {
+        // entities that aren't owned by the world resolve lazily when read
+        if (!handle.IsValid())
+        {
+            return;
+        }
+
+        lock_guard lock(mutex_queue);
+        queue.push_back(handle);
+    }
+
+    void TransformHierarchy::Resolve()
+    {
+        SP_PROFILE_CPU();
+
+        handles.clear();
+        {
+            lock_guard lock(mutex_queue);
+            handles.swap(queue);
+        }
+
+        resolved_count = 0;
+        if (handles.empty())
+        {
+            return;
+        }
+
+        if (++batch_id == 0)
+        {
+            batch_id = 1;
+        }
+
+        // claim whatever is still dirty, reads since the setter may have resolved some already
+        pending.clear();
+        uint32_t depth_max = 0;
+        for (const EntityHandle handle : handles)
+        {
+            Entity* entity = World::GetEntity(handle);
+            if (!entity)
+            {
+                continue;
+            }
+
+            TransformState expected = TransformState::Dirty;
+            if (!entity->m_transform_state.compare_exchange_strong(expected, TransformState::Resolving, memory_order_acquire))
+            {
+                continue;
+            }
+
+            uint32_t depth = 0;
+            for (Entity* parent = entity->GetParent(); parent; parent = parent->GetParent())
+            {
+                depth++;
+            }
+
+            depth_max = max(depth_max, depth);
+            pending.push_back({ entity, depth });
+        }
+
+        const uint32_t count = static_cast<uint32_t>(pending.size());
+        if (count == 0)
+        {
+            return;
+        }
+
+        // counting sort by depth
+        level_offsets.assign(depth_max + 2, 0);
+        for (const pending_entity& entry : pending)
+        {
+            level_offsets[entry.depth + 1]++;
+        }
+        for (uint32_t level = 1; level < static_cast<uint32_t>(level_offsets.size()); level++)
+        {
+            level_offsets[level] += level_offsets[level - 1];
+        }
+        level_cursors.assign(level_offsets.begin(), level_offsets.end());
+
+        batch_entity.resize(count);
+        batch_parent.resize(count);
+        batch_world.resize(count);
+        for (const pending_entity& entry : pending)
+        {
+            const uint32_t index                 = level_cursors[entry.depth]++;
+            batch_entity[index]                  = entry.entity;
+            entry.entity->m_transform_batch       = batch_id;
+            entry.entity->m_transform_batch_index = index;
+        }
+
+        // parents in the batch are read from the arrays, the rest are clean (or resolve through their getter)
+        for (uint32_t i = 0; i < count; i++)
+        {
+            Entity* parent  = batch_entity[i]->GetParent();
+            batch_parent[i] = (parent && parent->m_transform_batch == batch_id) ? parent->m_transform_batch_index : parent_none;
+        }
+
+        // each level only reads the ones above it
+        for (uint32_t level = 0; level <= depth_max; level++)
+        {
+            const uint32_t start       = level_offsets[level];
+            const uint32_t level_count = level_offsets[level + 1] - start;
+            if (level_count >= parallel_level_min)
+            {
+                ThreadPool::ParallelFor(level_count, [start](uint32_t work_start, uint32_t work_end)
+                {
+                    ResolveRange(start + work_start, start + work_end);
+                }, parallel_chunk_min);
+            }
+            else
+            {
+                ResolveRange(start, start + level_count);
+            }
+        }
+
+        resolved_count = count;
+    }
+
+    void TransformHierarchy::Clear()
+    {
+        {
+            lock_guard lock(mutex_queue);
+            queue.clear();
+        }
+
+        handles.clear();
+        pending.clear();
+        batch_entity.clear();
+        batch_parent.clear();
+        batch_world.clear();
+        resolved_count = 0;
+    }
+
+    void TransformHierarchy::ResolveRange(const uint32_t start, const uint32_t end)
+    {
+        for (uint32_t i = start; i < end; i++)
+        {
+            Entity* entity      = batch_entity[i];
+            Matrix matrix_local = Matrix(entity->GetPositionLocal(), entity->GetRotationLocal(), entity->GetScaleLocal());
+
+            if (batch_parent[i] != parent_none)
+            {
+                batch_world[i] = matrix_local * batch_world[batch_parent[i]];
+            }
+            else if (Entity* parent = entity->GetParent())
+            {
+                batch_world[i] = matrix_local * parent->GetMatrix();
+            }
+            else
+            {
+                batch_world[i] = matrix_local;
+            }
+
+            // publish per level, a thread waiting on this entity never waits on a deeper level
+            entity->ApplyTransform(matrix_local, batch_world[i]);
+            TransformState expected = TransformState::Resolving;
+            entity->m_transform_state.compare_exchange_strong(expected, TransformState::Clean, memory_order_release);
+        }
+    }
+
+    uint32_t TransformHierarchy::GetResolvedCount()
+    {
+        return resolved_count;
+    }
+}
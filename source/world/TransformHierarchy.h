@@ -0,0 +1,54 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =====
+#include <cstdint>
+#include "World.h"
+//================
+
+namespace spartan
+{
+    enum class TransformState : uint8_t
+    {
+        Clean,
+        Dirty,
+        Resolving // claimed by the batch or by a thread that read it while dirty
+    };
+
+    // entity setters only mark their subtree dirty and queue it here, Resolve() then recomputes every dirty
+    // world matrix in one batch, sorted by hierarchy depth into flat arrays and resolved level by level,
+    // each level in parallel since it only reads the levels above it
+    class TransformHierarchy
+    {
+    public:
+        static void Enqueue(EntityHandle handle);
+        static void Resolve();
+        static void Clear();
+
+        // entities resolved by the last batch
+        static uint32_t GetResolvedCount();
+
+    private:
+        static void ResolveRange(uint32_t start, uint32_t end);
+    };
+}
@@ -24,7 +24,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <unordered_set>
 #include "World.h"
 #include "Entity.h"
+#include "EntityIndex.h"
+#include "TransformHierarchy.h"
+#include "ChangeJournal.h"
 #include "Prefab.h"
+#include "WorldFile.h"
+#include "WorldPartition.h"
 #include "WorldHelpers.h"
 #include "../car/Car.h"
 #include "../profiling/Profiler.h"
@@ -78,6 +83,8 @@ namespace spartan
         sol::state lua_state;
         vector<Entity*> entities;
         vector<Entity*> entities_lights;       // entities subset that contains only lights
+        uint64_t entities_lights_revision = 0; // bumps whenever the light list is rebuilt
+        uint64_t entities_render_revision = 0; // bumps whenever the render list is rebuilt
         vector<Entity*> entities_with_render;  // entities subset that contains only active render components
         vector<Entity*> entities_with_ragdoll; // active ragdolls, late-ticked after scripts
         vector<Entity*> entities_with_pretick; // physics, script, or ragdoll, only these need Entity::PreTick
@@ -95,6 +102,8 @@ namespace spartan
         string library_resource_directory;
         vector<string> world_console_variables; // cvar names overridden by this world (preserved across save/load)
         mutex entity_access_mutex;
+        // handle and id lookups, readers don't take entity_access_mutex
+        EntityIndex entity_index;
         // entities created by workers but not yet drained into the live entities vector, the main thread drains this every tick
         // workers may still be configuring components for these, the renderer tolerates partial state via skip checks
         vector<Entity*> entities_pending;
@@ -103,8 +112,8 @@ namespace spartan
         atomic<bool> defer_script_init = false;
         mutex script_init_mutex;
         vector<pair<int, function<void()>>> script_inits_pending;
-        // keeps the world xml alive until main thread finishes deferred script init
-        shared_ptr<pugi::xml_document> deferred_load_document;
+        // keeps the world xml (or the decoded binary world) alive until main thread finishes deferred script init
+        shared_ptr<void> deferred_load_document;
         // load worker finished entity build, main thread must publish and run scripts before clearing loading
         atomic<bool> load_ready_for_main_commit = false;
         set<uint64_t> pending_remove;
@@ -205,31 +214,130 @@ namespace spartan
             erase_from(entities_pending);
         }
 
-        // snapshot for play/stop state restoration (like unity's play mode)
+        // snapshot for play/stop state restoration (like unity's play mode), a flat copy of every local transform
+        // taken in one parallel pass, entities that are gone by the time play stops resolve to null and are skipped
         struct EntitySnapshot
         {
+            EntityHandle handle; // invalid for transient entities, they own their transforms
             Vector3 position;
             Quaternion rotation;
             Vector3 scale;
         };
-        unordered_map<uint64_t, EntitySnapshot> play_mode_snapshot;
+        vector<EntitySnapshot> play_mode_snapshot;
         float play_mode_time_of_day = 0.0f;
 
         // ids of entities created while playing, they are removed when play stops so spawned objects never leak into the world
         set<uint64_t> play_mode_spawned_ids;
 
-        // play boot spreads Entity::Start over frames so thousands of entities do not freeze the first tick
+        // play boot spreads Component::Start over frames so thousands of entities do not freeze the first tick
+        // starts are grouped into levels by the component types they depend on, a level begins once every level
+        // before it finished, its thread safe starts run on the job system and the rest on the main thread under a budget
         enum class play_boot_phase : uint8_t
         {
             idle,
             starting,
             ready
         };
+        struct play_start_job
+        {
+            EntityHandle handle; // starts can remove entities, so jobs resolve late instead of holding pointers
+            ComponentType type;
+        };
+        struct play_start_level
+        {
+            vector<play_start_job> parallel;
+            vector<play_start_job> serial;
+        };
         play_boot_phase play_boot = play_boot_phase::idle;
-        vector<Entity*> play_start_queue;
-        size_t play_start_cursor = 0;
+        vector<play_start_level> play_start_levels;
+        uint32_t play_start_level_index = 0;
+        size_t play_start_cursor        = 0;
+        bool play_start_parallel_done   = false;
+        double play_boot_start_ms       = 0.0;
+        uint32_t play_boot_frames       = 0;
         constexpr double play_start_budget_ms = 4.0;
 
+        void run_play_start_job(const play_start_job& job)
+        {
+            if (Entity* entity = World::GetEntity(job.handle))
+            {
+                if (Component* component = entity->GetComponentByType(job.type))
+                {
+                    component->Start();
+                }
+            }
+        }
+
+        // a type's level is one past the deepest level among the types it depends on, cycles are reported and cut
+        void build_play_start_levels(const vector<Entity*>& entities_to_start)
+        {
+            constexpr uint32_t type_count = static_cast<uint32_t>(ComponentType::Max);
+            array<uint64_t, type_count> dependencies = {};
+            array<bool, type_count> thread_safe      = {};
+            for (Entity* entity : entities_to_start)
+            {
+                for (const shared_ptr<Component>& component : entity->GetAllComponents())
+                {
+                    if (component)
+                    {
+                        const uint32_t type = static_cast<uint32_t>(component->GetType());
+                        dependencies[type]  = component->GetStartDependencies();
+                        thread_safe[type]   = component->IsStartThreadSafe();
+                    }
+                }
+            }
+
+            array<uint32_t, type_count> type_level = {};
+            bool settled = false;
+            for (uint32_t pass = 0; pass <= type_count && !settled; pass++)
+            {
+                settled = true;
+                for (uint32_t type = 0; type < type_count; type++)
+                {
+                    for (uint32_t dependency = 0; dependency < type_count; dependency++)
+                    {
+                        if ((dependencies[type] & StartDependency(static_cast<ComponentType>(dependency))) && type_level[type] <= type_level[dependency])
+                        {
+                            type_level[type] = type_level[dependency] + 1;
+                            settled          = false;
+                        }
+                    }
+                }
+            }
+            if (!settled)
+            {
+                SP_LOG_WARNING("Component start dependencies form a cycle, start order is partial");
+            }
+
+            uint32_t level_count = 0;
+            for (uint32_t type = 0; type < type_count; type++)
+            {
+                level_count = max(level_count, min(type_level[type], type_count) + 1);
+            }
+
+            play_start_levels.clear();
+            play_start_levels.resize(level_count);
+            for (Entity* entity : entities_to_start)
+            {
+                for (const shared_ptr<Component>& component : entity->GetAllComponents())
+                {
+                    if (!component)
+                    {
+                        continue;
+                    }
+
+                    const uint32_t type      = static_cast<uint32_t>(component->GetType());
+                    play_start_level& level  = play_start_levels[min(type_level[type], type_count)];
+                    const play_start_job job = { entity->GetHandle(), component->GetType() };
+                    (thread_safe[type] ? level.parallel : level.serial).push_back(job);
+                }
+            }
+
+            play_start_level_index   = 0;
+            play_start_cursor        = 0;
+            play_start_parallel_done = false;
+        }
+
         bool entity_has_play_priority(Entity* entity)
         {
             if (!entity)
@@ -245,28 +353,32 @@ namespace spartan
                 || entity->GetComponent<Ragdoll>();
         }
 
-        // entity state tracking - things that change the nature of the entity for rendering
-        enum class EntityChange : uint8_t
+        // material change tracking - things that change the nature of the material for rendering
+        struct material_state
         {
-            None       = 0,
-            Active     = 1 << 0,
-            Components = 1 << 1,
-            CullMode   = 1 << 2,
-            LightType  = 1 << 3
+            Material* material = nullptr;
+            size_t hash        = 0;
         };
-        unordered_map<uint64_t, uint32_t> entity_states; // stores: low 8 bits for flags, next 8 for component count, next 8 for cull mode, next 8 for light type
-
-        // material change tracking - things that change the nature of the material for rendering
-        unordered_map<uint64_t, size_t> material_state_hashes;
+        unordered_map<uint64_t, material_state> material_states;               // materials the render list uses, by id
+        unordered_map<uint64_t, vector<uint64_t>> material_textures_preparing; // texture id to the materials waiting on it
 
         // light change tracking - things that change the nature of the light for rendering
         unordered_map<uint64_t, size_t> light_state_hashes;
 
-        void mark_entity_changed(uint64_t id, EntityChange change)
-        {
-            entity_states[id] |= static_cast<uint32_t>(change);
-            resolve            = true;
-        }
+        // entity changes that can alter which material a render uses, activation and component
+        // changes rebuild the render list instead, which rehashes every material
+        constexpr uint32_t material_affecting_changes =
+            static_cast<uint32_t>(ChangeType::Mesh)     |
+            static_cast<uint32_t>(ChangeType::Material) |
+            static_cast<uint32_t>(ChangeType::Attributes);
+
+        // entity changes that feed compute_light_hash()
+        constexpr uint32_t light_affecting_changes =
+            static_cast<uint32_t>(ChangeType::Transform)  |
+            static_cast<uint32_t>(ChangeType::Active)     |
+            static_cast<uint32_t>(ChangeType::Components) |
+            static_cast<uint32_t>(ChangeType::Light)      |
+            static_cast<uint32_t>(ChangeType::Attributes);
 
         size_t compute_material_hash(Material* material)
         {
@@ -286,6 +398,36 @@ namespace spartan
             return hash;
         }
 
+        // hashes a material into the given states, returns true if it's new there or its hash moved
+        bool track_material(Material* material, unordered_map<uint64_t, material_state>& states)
+        {
+            const uint64_t id = material->GetObjectId();
+
+            // textures still on their way to the gpu journal their completion, remember who to rehash then
+            for (const auto* texture : material->GetTextures())
+            {
+                if (texture && texture->GetResourceState() != ResourceState::PreparedForGpu)
+                {
+                    vector<uint64_t>& waiting = material_textures_preparing[texture->GetObjectId()];
+                    if (find(waiting.begin(), waiting.end(), id) == waiting.end())
+                    {
+                        waiting.push_back(id);
+                    }
+                }
+            }
+
+            const size_t hash   = compute_material_hash(material);
+            auto [it, inserted] = states.try_emplace(id, material_state{ material, hash });
+            if (inserted)
+            {
+                return true;
+            }
+
+            const bool changed = it->second.hash != hash;
+            it->second         = { material, hash };
+            return changed;
+        }
+
         size_t compute_light_hash(Light* light, Entity* entity)
         {
             size_t hash = 17;
@@ -513,6 +655,7 @@ namespace spartan
             Animator        ::RegisterForScripting(state_view);
             Ragdoll         ::RegisterForScripting(state_view);
             Camera          ::RegisterForScripting(state_view);
+            Script          ::RegisterForScripting(state_view);
             WorldHelpers    ::RegisterForScripting(state_view);
 
             lua_state.new_enum("ComponentType",
@@ -651,6 +794,8 @@ namespace spartan
             {
                 return World::GetEntityById(std::strtoull(id.c_str(), nullptr, 10));
             };
+            WorldTable["BuildPartition"]            = &WorldPartition::Build;
+            WorldTable["SetStreamingFocus"]         = &WorldPartition::SetFocus;
             WorldTable["Raycast"] = [](const Vector3& origin, const Vector3& direction, float max_distance) -> sol::object
             {
                 Vector3 hit_position;
@@ -1153,6 +1298,41 @@ namespace spartan
         }
     }
 
+    namespace world_batch
+    {
+        // components whose construction and attribute copy don't touch lua, physics, audio or gpu state,
+        // so batch instantiation can build them on workers, the rest are added on the calling thread
+        bool is_worker_safe(const ComponentType type)
+        {
+            return type == ComponentType::Render         ||
+                   type == ComponentType::Volume         ||
+                   type == ComponentType::SpawnPoint     ||
+                   type == ComponentType::CarReset       ||
+                   type == ComponentType::SplineFollower;
+        }
+
+        struct template_node
+        {
+            Entity* source = nullptr;
+            int32_t parent = -1; // index into the flattened template, -1 for the root
+        };
+
+        // depth first, so every node comes after its parent
+        void flatten(Entity* entity, const int32_t parent, vector<template_node>& nodes)
+        {
+            const int32_t index = static_cast<int32_t>(nodes.size());
+            nodes.push_back({ entity, parent });
+
+            for (Entity* child : entity->GetChildren())
+            {
+                if (child)
+                {
+                    flatten(child, index, nodes);
+                }
+            }
+        }
+    }
+
     void World::ProcessPendingRemovals()
     {
         lock_guard<mutex> lock(entity_access_mutex);
@@ -1202,13 +1382,9 @@ namespace spartan
                 // strip cache lists before delete, pretick still runs this frame before resolve
                 untrack_entity(*it);
 
-                // clean up change tracking
-                entity_states.erase(id);
-                if (Material* mat = (*it)->GetComponent<Render>() ? (*it)->GetComponent<Render>()->GetMaterial() : nullptr)
-                {
-                    material_state_hashes.erase(mat->GetObjectId());
-                }
+                // clean up change tracking, materials are rehashed when the render list is rebuilt
                 light_state_hashes.erase(id);
+                entity_index.Remove((*it)->GetHandle());
                 delete *it;
                 it = entities.erase(it);
             }
@@ -1349,6 +1525,10 @@ namespace spartan
             }
             entities_pending.clear();
             pending_remove.clear();
+            entity_index.Clear();
+            TransformHierarchy::Clear();
+            ChangeJournal::Clear();
+            WorldPartition::Shutdown();
         }
 
         WorldHelpers::Clear();                        // release long lived builder meshes and materials
@@ -1356,7 +1536,8 @@ namespace spartan
         play_mode_spawned_ids.clear();
         play_mode_snapshot.clear();
         play_boot = play_boot_phase::idle;
-        play_start_queue.clear();
+        play_start_levels.clear();
+        play_start_level_index = 0;
         play_start_cursor = 0;
         was_in_editor_mode = true;
         camera = nullptr;
@@ -1366,8 +1547,8 @@ namespace spartan
         world_description.clear();
 
         // clear change tracking
-        entity_states.clear();
-        material_state_hashes.clear();
+        material_states.clear();
+        material_textures_preparing.clear();
         light_state_hashes.clear();
 
         // mark for resolve
@@ -1437,7 +1618,7 @@ namespace spartan
             // renderer caches, a static world such as empty would otherwise stay on the last unlit loading frame
             resolve = true;
             // drop hashes recorded against an empty entities_with_render during the commit frame gap
-            material_state_hashes.clear();
+            material_states.clear();
             light_state_hashes.clear();
             SP_FIRE_EVENT(EventType::WorldLoaded);
         }
@@ -1447,26 +1628,38 @@ namespace spartan
         const bool stopped = !Engine::IsFlagSet(EngineMode::Playing) && !was_in_editor_mode;
         was_in_editor_mode = !Engine::IsFlagSet(EngineMode::Playing);
 
-        // start, transform snapshot and Entity::Start are both time budgeted across frames
+        // start, the transform snapshot is one parallel copy, component starts are time budgeted across frames
         if (started)
         {
-            play_mode_snapshot.clear();
-            play_mode_snapshot.reserve(entities.size());
+            play_boot_start_ms    = Timer::GetTimeMs();
+            play_boot_frames      = 0;
             play_mode_time_of_day = world_time::time_of_day;
             play_mode_spawned_ids.clear();
 
-            play_start_queue.clear();
-            play_start_queue.reserve(entities.size());
-            for (Entity* entity : entities)
+            const uint32_t entity_count = static_cast<uint32_t>(entities.size());
+            play_mode_snapshot.resize(entity_count);
+            ThreadPool::ParallelFor(entity_count, [](uint32_t start, uint32_t end)
             {
-                play_start_queue.push_back(entity);
-            }
-            // traffic pedestrians cars scripts first so their async work starts immediately
+                for (uint32_t i = start; i < end; i++)
+                {
+                    Entity* entity            = entities[i];
+                    EntitySnapshot& snapshot  = play_mode_snapshot[i];
+                    snapshot.handle           = entity->IsTransient() ? EntityHandle() : entity->GetHandle();
+                    snapshot.position         = entity->GetPositionLocal();
+                    snapshot.rotation         = entity->GetRotationLocal();
+                    snapshot.scale            = entity->GetScaleLocal();
+                }
+            }, 256);
+            WorldPartition::OnPlayStart();
+
+            // dependency levels come first, traffic and pedestrians wait for physics so they start in the level after it,
+            // the partition only keeps entities with priority components ahead of the rest inside each level
+            vector<Entity*> entities_to_start = entities;
             stable_partition(
-                play_start_queue.begin(),
-                play_start_queue.end(),
+                entities_to_start.begin(),
+                entities_to_start.end(),
                 [](Entity* entity) { return entity_has_play_priority(entity); });
-            play_start_cursor = 0;
+            build_play_start_levels(entities_to_start);
             play_boot = play_boot_phase::starting;
         }
 
@@ -1474,7 +1667,8 @@ namespace spartan
         if (stopped)
         {
             play_boot = play_boot_phase::idle;
-            play_start_queue.clear();
+            play_start_levels.clear();
+            play_start_level_index = 0;
             play_start_cursor = 0;
 
             // copy the list, Stop can queue removals and must not walk a mutating vector
@@ -1488,12 +1682,10 @@ namespace spartan
             }
 
             // restore all entity transforms from snapshot
-            for (Entity* entity : entities)
+            for (const EntitySnapshot& snapshot : play_mode_snapshot)
             {
-                auto it = play_mode_snapshot.find(entity->GetObjectId());
-                if (it != play_mode_snapshot.end())
+                if (Entity* entity = World::GetEntity(snapshot.handle))
                 {
-                    const EntitySnapshot& snapshot = it->second;
                     entity->SetPositionLocal(snapshot.position);
                     entity->SetRotationLocal(snapshot.rotation);
                     entity->SetScaleLocal(snapshot.scale);
@@ -1555,50 +1747,81 @@ namespace spartan
                 RemoveEntity(entity);
             }
             play_mode_spawned_ids.clear();
+
+            // streamed cells that were simulated go back to their pre-play state
+            WorldPartition::OnPlayStop();
         }
 
         ProcessPendingRemovals();
 
-        // drain a slice of snapshot + Entity::Start each frame until the scene is ready
+        // after removals, a cell that unloaded and comes back must not collide with its own pending ids
+        WorldPartition::Tick();
+
+        // drain a slice of component starts each frame until the scene is ready
         if (play_boot == play_boot_phase::starting)
         {
+            SP_PROFILE_CPU_START("play_boot");
+            play_boot_frames++;
+
             const double budget_start = Timer::GetTimeMs();
-            while (play_start_cursor < play_start_queue.size())
+            while (play_start_level_index < play_start_levels.size())
             {
-                Entity* entity = play_start_queue[play_start_cursor++];
-                if (entity)
+                play_start_level& level = play_start_levels[play_start_level_index];
+
+                // thread safe starts of the level go wide at once, they only touch their own component
+                if (!play_start_parallel_done)
                 {
-                    if (!entity->IsTransient())
+                    const uint32_t parallel_count = static_cast<uint32_t>(level.parallel.size());
+                    if (parallel_count > 0)
                     {
-                        EntitySnapshot snapshot;
-                        snapshot.position = entity->GetPositionLocal();
-                        snapshot.rotation = entity->GetRotationLocal();
-                        snapshot.scale    = entity->GetScaleLocal();
-                        play_mode_snapshot[entity->GetObjectId()] = snapshot;
+                        ThreadPool::ParallelFor(parallel_count, [&level](uint32_t start, uint32_t end)
+                        {
+                            for (uint32_t i = start; i < end; i++)
+                            {
+                                run_play_start_job(level.parallel[i]);
+                            }
+                        }, 64);
                     }
-                    entity->Start();
+                    play_start_parallel_done = true;
                 }
 
-                if ((Timer::GetTimeMs() - budget_start) >= play_start_budget_ms)
+                while (play_start_cursor < level.serial.size() && (Timer::GetTimeMs() - budget_start) < play_start_budget_ms)
+                {
+                    run_play_start_job(level.serial[play_start_cursor++]);
+                }
+
+                if (play_start_cursor < level.serial.size())
                 {
                     break;
                 }
+
+                play_start_level_index++;
+                play_start_cursor        = 0;
+                play_start_parallel_done = false;
             }
 
-            if (play_start_cursor >= play_start_queue.size())
+            if (play_start_level_index >= play_start_levels.size())
             {
-                play_start_queue.clear();
-                play_start_cursor = 0;
+                play_start_levels.clear();
+                play_start_level_index = 0;
                 play_boot = play_boot_phase::ready;
+
+                Profiler::m_play_boot_ms     = static_cast<float>(Timer::GetTimeMs() - play_boot_start_ms);
+                Profiler::m_play_boot_frames = play_boot_frames;
                 SP_LOG_INFO(
-                    "play boot complete, %zu entities started",
-                    entities.size());
+                    "play boot complete, %zu entities started in %.2f ms over %u frames",
+                    entities.size(), Profiler::m_play_boot_ms, play_boot_frames);
             }
+
+            SP_PROFILE_CPU_END();
         }
 
         // during boot keep rendering, but skip sim ticks and the per entity change scan
         if (play_boot != play_boot_phase::starting)
         {
+            // physics, the editor and scripts moved entities since the last tick
+            TransformHierarchy::Resolve();
+
             for (Entity* entity : entities_with_pretick)
             {
                 if (entity->GetActive())
@@ -1607,45 +1830,47 @@ namespace spartan
                 }
             }
 
-            // renderables cover most of the scene, cull/lod in parallel then finish other components
+            // bodies synced from physics, resolve before the parallel render tick reads them
+            TransformHierarchy::Resolve();
+
+            // renderables cover most of the scene, bounds need the entity transform, so they go per entity,
+            // culling and lods then walk the render culling tree without touching entities again, small
+            // scenes take the same path serially so the tree always covers every render
             const uint32_t render_count = static_cast<uint32_t>(entities_with_render.size());
             if (render_count > 0)
             {
-                if (render_count >= 64)
+                auto tick_bounds = [&](uint32_t start, uint32_t end)
                 {
-                    ThreadPool::ParallelLoop([&](uint32_t start, uint32_t end)
+                    for (uint32_t i = start; i < end; i++)
                     {
-                        for (uint32_t i = start; i < end; i++)
+                        Entity* entity = entities_with_render[i];
+                        if (!entity->GetActive())
                         {
-                            Entity* entity = entities_with_render[i];
-                            if (!entity->GetActive())
-                            {
-                                continue;
-                            }
-
-                            if (Render* render = entity->GetComponent<Render>())
-                            {
-                                render->Tick();
-                            }
+                            continue;
                         }
-                    }, render_count);
 
-                    for (Entity* entity : entities_with_render)
-                    {
-                        if (entity->GetActive())
+                        if (Render* render = entity->GetComponent<Render>())
                         {
-                            entity->TickAfterParallelRender();
+                            render->TickBounds();
                         }
                     }
+                };
+
+                if (render_count >= 64)
+                {
+                    ThreadPool::ParallelFor(render_count, tick_bounds, 16);
                 }
                 else
                 {
-                    for (Entity* entity : entities_with_render)
+                    tick_bounds(0, render_count);
+                }
+                Render::TickVisibility();
+
+                for (Entity* entity : entities_with_render)
+                {
+                    if (entity->GetActive())
                     {
-                        if (entity->GetActive())
-                        {
-                            entity->Tick();
-                        }
+                        entity->TickAfterParallelRender();
                     }
                 }
             }
@@ -1656,6 +1881,7 @@ namespace spartan
                     entity->Tick();
                 }
             }
+            Script::TickSystems();
 
             // ragdoll hit capsules after scripts/pedestrians moved the bodies
             for (Entity* entity : entities_with_ragdoll)
@@ -1668,77 +1894,37 @@ namespace spartan
                     }
                 }
             }
+        }
 
-            // only entities marked dirty need the change scan, empty most frames
-            if (!entity_states.empty())
+        // publish what changed this frame, activation and component changes reshape the cached lists
+        ChangeJournal::Publish();
+        if (ChangeJournal::HasChanged(static_cast<uint32_t>(ChangeType::Active) | static_cast<uint32_t>(ChangeType::Components)))
+        {
+            resolve = true;
+        }
+
+        // a light that became or stopped being directional changes which one the world picks as the sun
+        if (!resolve && ChangeJournal::HasChanged(static_cast<uint32_t>(ChangeType::Light)))
+        {
+            for (const EntityChanges& change : ChangeJournal::GetEntityChanges())
             {
-                for (Entity* entity : entities)
+                if ((change.types & static_cast<uint32_t>(ChangeType::Light)) == 0)
                 {
-                    if (!entity->GetActive())
-                    {
-                        continue;
-                    }
-
-                    uint64_t id = entity->GetObjectId();
-                    auto it = entity_states.find(id);
-                    if (it == entity_states.end())
-                    {
-                        continue;
-                    }
-
-                    uint32_t& state = it->second;
-                    uint32_t new_state = state;
-
-                    // active state
-                    bool was_active = (state & static_cast<uint32_t>(EntityChange::Active)) != 0;
-                    if (entity->GetActive() != was_active)
-                    {
-                        new_state |= static_cast<uint32_t>(EntityChange::Active);
-                        resolve = true;
-                    }
-
-                    // component count
-                    uint8_t prev_component_count = (state >> 8) & 0xFF;
-                    uint8_t curr_component_count = static_cast<uint8_t>(min(entity->GetComponentCount(), 255u));
-                    if (curr_component_count != prev_component_count)
-                    {
-                        new_state = (new_state & ~0xFF00) | (curr_component_count << 8);
-                        new_state |= static_cast<uint32_t>(EntityChange::Components);
-                        resolve = true;
-                    }
-
-                    // cull mode
-                    uint8_t prev_cull = (state >> 16) & 0xFF;
-                    uint8_t curr_cull = static_cast<uint8_t>(RHI_CullMode::None);
-                    if (Render* render = entity->GetComponent<Render>())
-                    {
-                        if (Material* material = render->GetMaterial())
-                        {
-                            curr_cull = static_cast<uint8_t>(material->GetProperty(MaterialProperty::CullMode));
-                        }
-                    }
-                    if (curr_cull != prev_cull)
-                    {
-                        new_state = (new_state & ~0xFF0000) | (curr_cull << 16);
-                        new_state |= static_cast<uint32_t>(EntityChange::CullMode);
-                        resolve = true;
-                    }
+                    continue;
+                }
 
-                    // light type
-                    uint8_t prev_light_type = (state >> 24) & 0xFF;
-                    uint8_t curr_light_type = static_cast<uint8_t>(LightType::Max);
-                    if (Light* light_comp = entity->GetComponent<Light>())
-                    {
-                        curr_light_type = static_cast<uint8_t>(light_comp->GetLightType());
-                    }
-                    if (curr_light_type != prev_light_type)
-                    {
-                        new_state = (new_state & ~0xFF000000) | (curr_light_type << 24);
-                        new_state |= static_cast<uint32_t>(EntityChange::LightType);
-                        resolve = true;
-                    }
+                Entity* entity    = entity_index.Get(change.handle);
+                Light* light_comp = entity ? entity->GetComponent<Light>() : nullptr;
+                if (!light_comp)
+                {
+                    continue;
+                }
 
-                    state = new_state;
+                const bool directional = light_comp->GetLightType() == LightType::Directional;
+                if ((directional && !light) || (!directional && entity == light))
+                {
+                    resolve = true;
+                    break;
                 }
             }
         }
@@ -1760,6 +1946,8 @@ namespace spartan
                 light              = nullptr;
                 audio_source_count = 0;
                 entities_lights.clear();
+                entities_lights_revision++;
+                entities_render_revision++;
                 entities_with_render.clear();
                 entities_with_ragdoll.clear();
                 entities_with_pretick.clear();
@@ -1865,7 +2053,16 @@ namespace spartan
 
             compute_bounding_box();
             resolve = false;
-            entity_states.clear();
+        }
+
+        // whatever the logic ticks moved, so the renderer reads clean transforms
+        TransformHierarchy::Resolve();
+
+        // the parallel passes above joined, so id tables replaced by rehashes this frame have no readers left,
+        // a load or save in flight can still have a worker reading, so the tables wait for the next idle tick
+        if (world_io_state.load(memory_order_acquire) == WorldIoState::Idle)
+        {
+            entity_index.ReleaseRetiredTables();
         }
 
         if (Engine::IsFlagSet(EngineMode::Playing) && !Engine::IsFlagSet(EngineMode::Paused))
@@ -1976,7 +2173,7 @@ namespace spartan
             return false;
         }
 
-        // snapshot live world state on the caller, only the xml write runs on a worker
+        // snapshot live world state on the caller, only the file write runs on a worker
         if (!SaveToFileInternal(move(file_path), true))
         {
             world_io_state.store(WorldIoState::Idle, memory_order_release);
@@ -1993,7 +2190,7 @@ namespace spartan
             WorldIoState::Saving;
     }
 
-    bool World::SaveToFileInternal(string file_path, bool defer_xml_write)
+    bool World::SaveToFileInternal(string file_path, bool defer_file_write)
     {
         if (FileSystem::GetExtensionFromFilePath(file_path) != EXTENSION_WORLD)
         {
@@ -2003,7 +2200,7 @@ namespace spartan
         // start timing
         const Stopwatch timer;
 
-        // serialize the resources before saving the world (XML), as it references them
+        // serialize the resources before saving the world, as it references them
         {
             string directory = world_file_path_to_resource_directory(file_path);
             FileSystem::CreateDirectory_(directory);
@@ -2137,6 +2334,29 @@ namespace spartan
                 }
             }
 
+            // streamed out cells still point at their resources, keep them saved and out of the prune
+            {
+                vector<string> cell_resource_paths;
+                WorldPartition::GetUnloadedResourcePaths(cell_resource_paths);
+                for (const string& path : cell_resource_paths)
+                {
+                    if (FileSystem::IsEngineMeshFile(path))
+                    {
+                        if (shared_ptr<Mesh> mesh = ResourceCache::GetByPath<Mesh>(path))
+                        {
+                            referenced_resources.insert(mesh.get());
+                        }
+                    }
+                    else if (FileSystem::IsEngineMaterialFile(path))
+                    {
+                        if (shared_ptr<Material> material = ResourceCache::GetByPath<Material>(path))
+                        {
+                            reference_material(material.get());
+                        }
+                    }
+                }
+            }
+
             // the windows file system is case insensitive so the uniqueness check has to be too
             auto to_file_key = [](const string& file_name)
             {
@@ -2406,7 +2626,8 @@ namespace spartan
             for (Entity* root : root_entities)
             {
                 // transient entities are runtime only, such as skid mark trails, they must never be serialized
-                if (root->IsTransient())
+                // streamed entities belong to their cell file
+                if (root->IsTransient() || WorldPartition::IsStreamed(root))
                 {
                     ProgressTracker::GetProgress(ProgressType::World).JobDone();
                     continue;
@@ -2421,30 +2642,37 @@ namespace spartan
             ProgressTracker::GetProgress(ProgressType::World).Complete();
         }
 
-        if (defer_xml_write)
+        // loaded cells carry edits made since they streamed in, unloaded ones are already current on disk
+        if (!WorldPartition::SaveCells(file_path))
+        {
+            SP_LOG_ERROR("Failed to save the world cells");
+        }
+
+        // the document is only the intermediate form, worlds are written in the binary format
+        // WorldFile::ConvertBinaryToXml() exports one to xml
+        if (defer_file_write)
         {
             // snapshot is complete, only the file write leaves the main thread
-            ostringstream xml_stream;
-            doc.save(xml_stream, " ", pugi::format_indent);
-            string xml_content = xml_stream.str();
+            vector<char> bytes;
+            WorldFile::Serialize(world_node, bytes);
             const float elapsed_ms = timer.GetElapsedTimeMs();
 
             ThreadPool::AddTask(
-                [file_path = move(file_path), xml_content = move(xml_content), elapsed_ms]()
+                [file_path = move(file_path), bytes = move(bytes), elapsed_ms]()
                 {
                     SaveStateReset reset;
 
                     ofstream out(file_path, ios::binary | ios::trunc);
                     if (!out)
                     {
-                        SP_LOG_ERROR("Failed to save XML file.");
+                        SP_LOG_ERROR("Failed to save world file.");
                         return;
                     }
 
-                    out.write(xml_content.data(), static_cast<streamsize>(xml_content.size()));
+                    out.write(bytes.data(), static_cast<streamsize>(bytes.size()));
                     if (!out)
                     {
-                        SP_LOG_ERROR("Failed to save XML file.");
+                        SP_LOG_ERROR("Failed to save world file.");
                         return;
                     }
 
@@ -2456,10 +2684,8 @@ namespace spartan
         }
 
         // save to file
-        bool saved = doc.save_file(file_path.c_str(), " ", pugi::format_indent);
-        if (!saved)
+        if (!WorldFile::Write(file_path, world_node))
         {
-            SP_LOG_ERROR("Failed to save XML file.");
             return false;
         }
 
@@ -2517,7 +2743,7 @@ namespace spartan
             // start timing
             const Stopwatch timer;
 
-            // deserialize the resources before loading the world (XML), as it references them
+            // deserialize the resources before loading the world, as it references them
             {
                 string directory = world_file_path_to_resource_directory(file_path);
 
@@ -2648,90 +2874,120 @@ namespace spartan
                 }
             }
 
-            // load xml document, kept alive until main thread finishes deferred script init
-            shared_ptr<pugi::xml_document> doc = make_shared<pugi::xml_document>();
-            pugi::xml_parse_result result = doc->load_file(file_path.c_str());
-            if (!result)
-            {
-                SP_LOG_ERROR("Failed to load XML file: %s", result.description());
-                finish();
-                return;
-            }
-            deferred_load_document = doc;
-
-            // get world node
-            pugi::xml_node world_node = doc->child("World");
-            if (!world_node)
+            // flatten the entity tree so every node can load in parallel
+            // parent_index is into this same vector, UINT32_MAX means root
+            // binary worlds also carry the decoded record, their node then only holds components
+            struct FlatEntity
             {
-                SP_LOG_ERROR("No 'World' node found.");
-                deferred_load_document.reset();
-                finish();
-                return;
-            }
-
-            // read metadata
-            world_description = world_node.attribute("description").as_string();
+                pugi::xml_node node;
+                uint32_t parent_index      = UINT32_MAX;
+                const EntityRecord* record = nullptr;
+            };
+            vector<FlatEntity> flat_entities;
 
-            // console variables: apply any cvars defined by the world
-            // format:
-            //   <ConsoleVariables>
-            //     <Variable name="r.restir_pt" value="1" />
-            //   </ConsoleVariables>
             world_console_variables.clear();
-            if (pugi::xml_node cvars_node = world_node.child("ConsoleVariables"))
+            if (WorldFile::IsBinary(file_path))
             {
-                for (pugi::xml_node var_node = cvars_node.child("Variable"); var_node; var_node = var_node.next_sibling("Variable"))
+                // memory mapped, entity ranges decode in parallel, kept alive like the xml document below
+                shared_ptr<WorldFileContents> contents = make_shared<WorldFileContents>();
+                if (!WorldFile::Read(file_path, *contents))
                 {
-                    const char* name  = var_node.attribute("name").as_string();
-                    const char* value = var_node.attribute("value").as_string();
+                    finish();
+                    return;
+                }
+                deferred_load_document = contents;
 
-                    if (name && name[0] != '\0')
+                world_description = contents->description;
+                for (const auto& [name, value] : contents->console_variables)
+                {
+                    if (!name.empty())
                     {
                         ConsoleRegistry::Get().SetValueFromString(name, value);
                         world_console_variables.emplace_back(name);
                     }
                 }
-            }
 
-            // entities
+                flat_entities.reserve(contents->records.size());
+                for (size_t i = 0; i < contents->records.size(); i++)
+                {
+                    flat_entities.push_back({ contents->nodes[i], contents->records[i].parent_index, &contents->records[i] });
+                }
+            }
+            else
             {
-                // get node
-                pugi::xml_node entities_node = world_node.child("Entities");
-                if (!entities_node)
+                // load xml document, kept alive until main thread finishes deferred script init
+                shared_ptr<pugi::xml_document> doc = make_shared<pugi::xml_document>();
+                pugi::xml_parse_result result = doc->load_file(file_path.c_str());
+                if (!result)
                 {
-                    SP_LOG_ERROR("No 'Entities' node found.");
-                    deferred_load_document.reset();
+                    SP_LOG_ERROR("Failed to load XML file: %s", result.description());
                     finish();
                     return;
                 }
+                deferred_load_document = doc;
 
-                // flatten the entity tree so every node can load in parallel
-                // parent_index is into this same vector, UINT32_MAX means root
-                struct FlatEntity
+                // get world node
+                pugi::xml_node world_node = doc->child("World");
+                if (!world_node)
                 {
-                    pugi::xml_node node;
-                    uint32_t parent_index = UINT32_MAX;
-                };
+                    SP_LOG_ERROR("No 'World' node found.");
+                    deferred_load_document.reset();
+                    finish();
+                    return;
+                }
+
+                // read metadata
+                world_description = world_node.attribute("description").as_string();
 
-                vector<FlatEntity> flat_entities;
+                // console variables: apply any cvars defined by the world
+                // format:
+                //   <ConsoleVariables>
+                //     <Variable name="r.restir_pt" value="1" />
+                //   </ConsoleVariables>
+                if (pugi::xml_node cvars_node = world_node.child("ConsoleVariables"))
                 {
-                    function<void(pugi::xml_node, uint32_t)> collect = [&](pugi::xml_node node, uint32_t parent_index)
+                    for (pugi::xml_node var_node = cvars_node.child("Variable"); var_node; var_node = var_node.next_sibling("Variable"))
                     {
-                        const uint32_t index = static_cast<uint32_t>(flat_entities.size());
-                        flat_entities.push_back({ node, parent_index });
+                        const char* name  = var_node.attribute("name").as_string();
+                        const char* value = var_node.attribute("value").as_string();
 
-                        for (pugi::xml_node child = node.child("Entity"); child; child = child.next_sibling("Entity"))
+                        if (name && name[0] != '\0')
                         {
-                            collect(child, index);
+                            ConsoleRegistry::Get().SetValueFromString(name, value);
+                            world_console_variables.emplace_back(name);
                         }
-                    };
+                    }
+                }
 
-                    for (pugi::xml_node entity_node = entities_node.child("Entity"); entity_node; entity_node = entity_node.next_sibling("Entity"))
+                // get node
+                pugi::xml_node entities_node = world_node.child("Entities");
+                if (!entities_node)
+                {
+                    SP_LOG_ERROR("No 'Entities' node found.");
+                    deferred_load_document.reset();
+                    finish();
+                    return;
+                }
+
+                function<void(pugi::xml_node, uint32_t)> collect = [&](pugi::xml_node node, uint32_t parent_index)
+                {
+                    const uint32_t index = static_cast<uint32_t>(flat_entities.size());
+                    flat_entities.push_back({ node, parent_index });
+
+                    for (pugi::xml_node child = node.child("Entity"); child; child = child.next_sibling("Entity"))
                     {
-                        collect(entity_node, UINT32_MAX);
+                        collect(child, index);
                     }
+                };
+
+                for (pugi::xml_node entity_node = entities_node.child("Entity"); entity_node; entity_node = entity_node.next_sibling("Entity"))
+                {
+                    collect(entity_node, UINT32_MAX);
                 }
+            }
 
+            // entities
+            {
                 // progress tracking
                 uint32_t entity_count = static_cast<uint32_t>(flat_entities.size());
                 // close the resource phase first, a missed resource JobDone would accumulate into
@@ -2755,7 +3011,14 @@ namespace spartan
                     for (uint32_t i = 0; i < entity_count; i++)
                     {
                         Entity* entity = World::CreateEntity();
-                        entity->Load(flat_entities[i].node, false);
+                        if (flat_entities[i].record)
+                        {
+                            entity->Load(*flat_entities[i].record, flat_entities[i].node);
+                        }
+                        else
+                        {
+                            entity->Load(flat_entities[i].node, false);
+                        }
                         loaded_entities[i] = entity;
                         ProgressTracker::GetProgress(ProgressType::World).JobDone();
                     }
@@ -2779,6 +3042,9 @@ namespace spartan
                 // leave entities in entities_pending, only the main thread may publish into the live vector
             }
 
+            // partitioned worlds stream the rest of their entities in from the cells around the focus
+            WorldPartition::Open(file_path);
+
             // report time
             SP_LOG_INFO("World \"%s\" has been loaded. Duration %.2f ms", file_path.c_str(), timer.GetElapsedTimeMs());
 
@@ -2799,12 +3065,13 @@ namespace spartan
         lock_guard lock(entity_access_mutex);
 
         Entity* entity = new Entity();
+        entity->SetHandle(entity_index.Add(entity));
         // entity becomes visible to the renderer on the next World::Tick which auto-drains this list, partial component state is tolerated via skip checks
         entities_pending.push_back(entity);
-        mark_entity_changed(entity->GetObjectId(), EntityChange::Components); // new entity requires resolve
 
         // entities spawned during play are tracked so they can be removed when play stops
-        if (Engine::IsFlagSet(EngineMode::Playing))
+        // streamed cells are part of the world, not spawns, they must survive a stop
+        if (Engine::IsFlagSet(EngineMode::Playing) && !WorldPartition::IsInstantiating())
         {
             play_mode_spawned_ids.insert(entity->GetObjectId());
         }
@@ -2812,6 +3079,138 @@ namespace spartan
         return entity;
     }
 
+    void World::InstantiateBatch(Entity* source, const uint32_t count, span<const Matrix> transforms, vector<Entity*>& instances_out, Entity* parent)
+    {
+        SP_PROFILE_CPU();
+        SP_ASSERT_MSG(source != nullptr, "Entity is null");
+        SP_ASSERT_MSG(transforms.empty() || transforms.size() >= count, "Fewer transforms than instances");
+
+        instances_out.clear();
+        if (count == 0)
+        {
+            return;
+        }
+
+        vector<world_batch::template_node> nodes;
+        world_batch::flatten(source, -1, nodes);
+        const uint32_t node_count = static_cast<uint32_t>(nodes.size());
+        const uint32_t total      = count * node_count;
+
+        uint32_t render_count           = 0;
+        bool has_main_thread_components = false;
+        for (const world_batch::template_node& node : nodes)
+        {
+            for (const shared_ptr<Component>& component : node.source->GetAllComponents())
+            {
+                if (component)
+                {
+                    render_count               += component->GetType() == ComponentType::Render ? 1 : 0;
+                    has_main_thread_components |= !world_batch::is_worker_safe(component->GetType());
+                }
+            }
+        }
+        Render::ReserveStates(render_count * count);
+
+        // allocate on workers, then index the whole batch under one lock, every clone needs its handle
+        // before its transform is set since dirty transforms are queued by handle
+        vector<Entity*> entities(total);
+        ThreadPool::ParallelFor(total, [&entities](uint32_t start, uint32_t end)
+        {
+            for (uint32_t i = start; i < end; i++)
+            {
+                entities[i] = new Entity();
+            }
+        }, 256);
+
+        vector<EntityHandle> handles(total);
+        entity_index.Add(entities, handles.data());
+
+        // each worker builds whole instances, so the hierarchy it wires up is never shared with another worker
+        ThreadPool::ParallelFor(count, [&](uint32_t start, uint32_t end)
+        {
+            for (uint32_t instance = start; instance < end; instance++)
+            {
+                Entity** clones = &entities[instance * node_count];
+                for (uint32_t i = 0; i < node_count; i++)
+                {
+                    Entity* original = nodes[i].source;
+                    Entity* clone    = clones[i];
+
+                    clone->SetHandle(handles[instance * node_count + i]);
+                    clone->SetObjectName(original->GetObjectName());
+                    clone->SetActive(original->IsActive());
+                    clone->SetTagsString(original->GetTagsString());
+                    clone->SetTransient(original->IsTransient());
+
+                    if (i == 0 && !transforms.empty())
+                    {
+                        const Matrix& transform = transforms[instance];
+                        clone->SetPositionLocal(transform.GetTranslation());
+                        clone->SetRotationLocal(transform.GetRotation());
+                        clone->SetScaleLocal(transform.GetScale());
+                    }
+                    else
+                    {
+                        clone->SetPositionLocal(original->GetPositionLocal());
+                        clone->SetRotationLocal(original->GetRotationLocal());
+                        clone->SetScaleLocal(original->GetScaleLocal());
+                    }
+
+                    for (const shared_ptr<Component>& component : original->GetAllComponents())
+                    {
+                        if (component && world_batch::is_worker_safe(component->GetType()))
+                        {
+                            clone->AddComponent(component->GetType())->CopyAttributes(component.get());
+                        }
+                    }
+
+                    if (nodes[i].parent >= 0)
+                    {
+                        clone->SetParent(clones[nodes[i].parent]);
+                    }
+                }
+            }
+        }, 16);
+
+        // the rest of the components initialize against systems that expect the main thread
+        if (has_main_thread_components)
+        {
+            for (uint32_t i = 0; i < total; i++)
+            {
+                for (const shared_ptr<Component>& component : nodes[i % node_count].source->GetAllComponents())
+                {
+                    if (component && !world_batch::is_worker_safe(component->GetType()))
+                    {
+                        entities[i]->AddComponent(component->GetType())->CopyAttributes(component.get());
+                    }
+                }
+            }
+        }
+
+        instances_out.reserve(count);
+        for (uint32_t instance = 0; instance < count; instance++)
+        {
+            Entity* root = entities[instance * node_count];
+            if (parent)
+            {
+                root->SetParent(parent);
+            }
+            instances_out.push_back(root);
+        }
+
+        // publish in one commit, the renderer never sees a half built instance
+        lock_guard lock(entity_access_mutex);
+        entities_pending.insert(entities_pending.end(), entities.begin(), entities.end());
+        const bool playing = Engine::IsFlagSet(EngineMode::Playing);
+        if (playing)
+        {
+            for (Entity* entity : entities)
+            {
+                play_mode_spawned_ids.insert(entity->GetObjectId());
+            }
+        }
+    }
+
     bool World::IsDeferringScriptInit()
     {
         return defer_script_init.load(memory_order_acquire);
@@ -2827,7 +3226,7 @@ namespace spartan
     {
         SP_ASSERT_MSG(entity != nullptr, "Entity is null");
 
-        return GetEntityById(entity->GetObjectId()) != nullptr;
+        return entity_index.Get(entity->GetHandle()) == entity;
     }
 
     void World::RemoveEntity(Entity* entity_to_remove)
@@ -2915,12 +3314,7 @@ namespace spartan
             auto it = find(entities.begin(), entities.end(), entity);
             if (it != entities.end())
             {
-                // clean up change tracking
-                entity_states.erase(id);
-                if (Material* mat = entity->GetComponent<Render>() ? entity->GetComponent<Render>()->GetMaterial() : nullptr)
-                {
-                    material_state_hashes.erase(mat->GetObjectId());
-                }
+                // clean up change tracking, materials are rehashed when the render list is rebuilt
                 light_state_hashes.erase(id);
                 entities.erase(it);
             }
@@ -2929,6 +3323,7 @@ namespace spartan
 
             pending_remove.erase(id);
 
+            entity_index.Remove(entity->GetHandle());
             delete entity;
         }
 
@@ -3043,27 +3438,23 @@ namespace spartan
 
     Entity* World::GetEntityById(const uint64_t id)
     {
-        lock_guard<mutex> lock(entity_access_mutex);
+        // pending entities are indexed on creation, so callers see their own freshly created entity
+        return entity_index.Find(id);
+    }
 
-        for (const auto& entity : entities)
-        {
-            if (entity && entity->GetObjectId() == id)
-            {
-                return entity;
-            }
-        }
+    Entity* World::GetEntity(const EntityHandle handle)
+    {
+        return entity_index.Get(handle);
+    }
 
-        // entities created this frame are not drained yet, a lookup that misses them
-        // makes callers think their own freshly created entity died
-        for (const auto& entity : entities_pending)
-        {
-            if (entity && entity->GetObjectId() == id)
-            {
-                return entity;
-            }
-        }
+    bool World::IsAlive(const EntityHandle handle)
+    {
+        return entity_index.Get(handle) != nullptr;
+    }
 
-        return nullptr;
+    void World::OnEntityIdChanged(Entity* entity, const uint64_t id_previous)
+    {
+        entity_index.UpdateId(entity->GetHandle(), id_previous, entity->GetObjectId());
     }
 
     const vector<Entity*>& World::GetEntities()
@@ -3148,62 +3539,84 @@ namespace spartan
     {
         lock_guard<mutex> lock(entity_access_mutex);
 
-        static uint32_t last_global_revision = 0;
-        static uint64_t resource_poll_frame = 0;
-        const uint32_t global_revision = Material::GetGlobalRevision();
-        const bool props_changed = global_revision != last_global_revision;
-        last_global_revision = global_revision;
-
-        // property/texture pointer edits are covered by the global revision, async resource
-        // states still need a periodic poll so bindless updates when gpu prep finishes
-        resource_poll_frame++;
-        const bool poll_resources = (resource_poll_frame % 8) == 0;
-        const bool hashes_empty = material_state_hashes.empty() && !entities_with_render.empty();
-        if (!props_changed && !poll_resources && !hashes_empty)
-        {
-            return false;
-        }
-
+        // a rebuilt render list is hashed in full, otherwise only the materials the change journal saw change
+        static uint64_t materials_revision_hashed = 0;
         bool changed = false;
-        unordered_set<uint64_t> seen;
-        seen.reserve(entities_with_render.size());
-
-        for (Entity* entity : entities_with_render)
+        if (materials_revision_hashed != entities_render_revision)
         {
-            if (!entity)
+            materials_revision_hashed = entities_render_revision;
+
+            unordered_map<uint64_t, material_state> previous;
+            previous.swap(material_states);
+            material_textures_preparing.clear();
+            for (Entity* entity : entities_with_render)
             {
-                continue;
+                Render* render     = entity ? entity->GetComponent<Render>() : nullptr;
+                Material* material = render ? render->GetMaterial() : nullptr;
+                if (material && material_states.find(material->GetObjectId()) == material_states.end())
+                {
+                    track_material(material, material_states);
+                }
             }
 
-            Render* render = entity->GetComponent<Render>();
-            if (!render)
+            changed = previous.size() != material_states.size();
+            for (auto it = material_states.begin(); it != material_states.end() && !changed; ++it)
             {
-                continue;
+                auto it_previous = previous.find(it->first);
+                changed          = it_previous == previous.end() || it_previous->second.hash != it->second.hash;
             }
 
-            Material* material = render->GetMaterial();
-            if (!material)
+            return changed;
+        }
+
+        // edited materials, and materials that finished preparing
+        for (const uint64_t id : ChangeJournal::GetMaterialChanges())
+        {
+            auto it = material_states.find(id);
+            if (it != material_states.end())
             {
-                continue;
+                changed |= track_material(it->second.material, material_states);
             }
+        }
 
-            const uint64_t id = material->GetObjectId();
-            if (!seen.insert(id).second)
+        // textures that finished preparing, only the materials that were waiting on them are rehashed
+        for (const uint64_t texture_id : ChangeJournal::GetTextureChanges())
+        {
+            auto waiting = material_textures_preparing.find(texture_id);
+            if (waiting == material_textures_preparing.end())
             {
                 continue;
             }
 
-            size_t current_hash = compute_material_hash(material);
-            auto it = material_state_hashes.find(id);
-            if (it == material_state_hashes.end())
+            const vector<uint64_t> material_ids = move(waiting->second);
+            material_textures_preparing.erase(waiting);
+            for (const uint64_t id : material_ids)
             {
-                material_state_hashes[id] = current_hash;
-                changed = true;
+                auto it = material_states.find(id);
+                if (it != material_states.end())
+                {
+                    changed |= track_material(it->second.material, material_states);
+                }
             }
-            else if (it->second != current_hash)
+        }
+
+        // renders that switched mesh or material
+        if (ChangeJournal::HasChanged(material_affecting_changes))
+        {
+            for (const EntityChanges& change : ChangeJournal::GetEntityChanges())
             {
-                it->second = current_hash;
-                changed = true;
+                if ((change.types & material_affecting_changes) == 0)
+                {
+                    continue;
+                }
+
+                Entity* entity     = entity_index.Get(change.handle);
+                Render* render     = entity ? entity->GetComponent<Render>() : nullptr;
+                Material* material = render ? render->GetMaterial() : nullptr;
+                if (material && entity->GetActive())
+                {
+                    changed |= track_material(material, material_states);
+                }
             }
         }
 
@@ -3214,23 +3627,52 @@ namespace spartan
     {
         lock_guard<mutex> lock(entity_access_mutex);
 
+        auto rehash = [](Entity* entity, Light* light)
+        {
+            const uint64_t id   = entity->GetObjectId();
+            size_t current_hash = compute_light_hash(light, entity);
+            auto it = light_state_hashes.find(id);
+            if (it == light_state_hashes.end())
+            {
+                light_state_hashes[id] = current_hash;
+                return true;
+            }
+            if (it->second != current_hash)
+            {
+                it->second = current_hash;
+                return true;
+            }
+            return false;
+        };
+
+        // a rebuilt light list is hashed in full, otherwise only the lights the change journal saw change
+        static uint64_t lights_revision_hashed = 0;
         bool changed = false;
-        for (Entity* entity : entities_lights)
+        if (lights_revision_hashed != entities_lights_revision)
         {
-            if (Light* light = entity->GetComponent<Light>())
+            lights_revision_hashed = entities_lights_revision;
+            for (Entity* entity : entities_lights)
             {
-                const uint64_t id   = entity->GetObjectId();
-                size_t current_hash = compute_light_hash(light, entity);
-                auto it = light_state_hashes.find(id);
-                if (it == light_state_hashes.end())
+                if (Light* light = entity->GetComponent<Light>())
                 {
-                    light_state_hashes[id] = current_hash;
-                    changed = true;
+                    changed |= rehash(entity, light);
                 }
-                else if (it->second != current_hash)
+            }
+        }
+        else if (ChangeJournal::HasChanged(light_affecting_changes))
+        {
+            for (const EntityChanges& change : ChangeJournal::GetEntityChanges())
+            {
+                if ((change.types & light_affecting_changes) == 0)
                 {
-                    it->second = current_hash;
-                    changed = true;
+                    continue;
+                }
+
+                Entity* entity = entity_index.Get(change.handle);
+                Light* light   = entity ? entity->GetComponent<Light>() : nullptr;
+                if (light && entity->GetActive())
+                {
+                    changed |= rehash(entity, light);
                 }
             }
         }
@@ -3283,6 +3725,12 @@ namespace spartan
 
     bool World::ReadMetadata(const string& world_file_path, WorldMetadata& metadata)
     {
+        // the binary header and metadata section are enough, the body is never touched
+        if (WorldFile::IsBinary(world_file_path))
+        {
+            return WorldFile::ReadMetadata(world_file_path, metadata);
+        }
+
         // load xml document
         pugi::xml_document doc;
         pugi::xml_parse_result result = doc.load_file(world_file_path.c_str());
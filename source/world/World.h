@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ===================
 #include "../math/BoundingBox.h"
+#include <span>
 #include <string>
 #include <functional>
 #include <sol/forward.hpp>
@@ -41,6 +42,18 @@ namespace spartan
         std::string description;
     };
 
+    // a generational reference to an entity, it resolves to nothing once the entity is gone
+    // instead of dangling like an Entity* would, see World::GetEntity()
+    struct EntityHandle
+    {
+        uint32_t index      = 0;
+        uint32_t generation = 0; // live slots never use 0, so a default handle is always invalid
+
+        bool IsValid() const                          { return generation != 0; }
+        bool operator==(const EntityHandle& rhs) const { return index == rhs.index && generation == rhs.generation; }
+        bool operator!=(const EntityHandle& rhs) const { return !(*this == rhs); }
+    };
+
     // owns every entity, its serialization and the cached per-component entity lists the renderer reads
     class World
     {
@@ -79,6 +92,10 @@ namespace spartan
         static sol::state_view GetLuaState();
         static Entity* CreateEntity();
 
+        // clones source and its descendants count times, the clones are built on workers and published in one commit,
+        // transforms (empty, or one per instance) become the local transform of each instance root
+        static void InstantiateBatch(Entity* source, uint32_t count, std::span<const math::Matrix> transforms, std::vector<Entity*>& instances_out, Entity* parent = nullptr);
+
         // drain freshly created entities into the live lists, a caller that must render what it just
         // built in the same frame has to do this because the renderer only reads the live lists
         static void ProcessPendingAdditions();
@@ -93,7 +110,10 @@ namespace spartan
         static void GetRootEntities(std::vector<Entity*>& entities);
         static void MoveEntityToIndex(Entity* entity, uint32_t index);
         static void MoveRootEntityNear(Entity* entity_to_move, Entity* target_entity, bool insert_after);
-        static Entity* GetEntityById(uint64_t id);
+        static Entity* GetEntityById(uint64_t id); // o(1), doesn't lock
+        static Entity* GetEntity(EntityHandle handle); // o(1), doesn't lock, null once the entity is removed
+        static bool IsAlive(EntityHandle handle);
+        static void OnEntityIdChanged(Entity* entity, uint64_t id_previous); // keeps GetEntityById() in sync, e.g. on load
         static const std::vector<Entity*>& GetEntities();
         static const std::vector<Entity*>& GetEntitiesLights();
         static const std::vector<Entity*>& GetEntitiesWithRender();
@@ -101,7 +121,7 @@ namespace spartan
         static const std::vector<Entity*>& GetEntitiesWithIcon();
         static const std::vector<Entity*>& GetEntitiesWithParticles();
 
-        // true while play mode is still spreading Entity::Start across frames
+        // true while play mode is still spreading component starts across frames
         static bool IsPlayBooting();
 
         // misc
@@ -133,9 +153,9 @@ namespace spartan
         static bool ReadMetadata(const std::string& world_file_path, WorldMetadata& metadata);
 
     private:
-        // when defer_xml_write is true, resource and entity serialization runs on the caller
-        // and only the xml file write is posted to the thread pool
-        static bool SaveToFileInternal(std::string file_path, bool defer_xml_write);
+        // when defer_file_write is true, resource and entity serialization runs on the caller
+        // and only the file write is posted to the thread pool
+        static bool SaveToFileInternal(std::string file_path, bool defer_file_write);
         static void ProcessPendingRemovals();
     };
 }
@@ -0,0 +1,756 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===================
+#include "pch.h"
+#include "WorldFile.h"
+#include "World.h"
+#include "../core/ThreadPool.h"
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <unordered_map>
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+SP_WARNINGS_OFF
+#include "../io/pugixml.hpp"
+SP_WARNINGS_ON
+//==============================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace spartan::math;
+//============================
+
+namespace spartan
+{
+    namespace
+    {
+        constexpr char file_magic[8]       = { 'S', 'P', 'W', 'O', 'R', 'L', 'D', 'B' };
+        constexpr uint32_t file_version    = 1;
+        constexpr uint32_t decode_range    = 256; // records per document when decoding in parallel
+        constexpr uint32_t node_depth_max  = 64;
+        constexpr uint32_t record_active   = 1 << 0;
+
+        enum class section_type : uint32_t
+        {
+            Metadata,
+            ConsoleVariables,
+            Strings,
+            Entities,
+            Blobs,
+            Max
+        };
+
+        // everything is little endian and written as is
+        struct file_header
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t section_count;
+            uint64_t toc_offset;
+            uint64_t reserved;
+        };
+        static_assert(sizeof(file_header) == 32);
+
+        struct toc_entry
+        {
+            section_type type;
+            uint32_t reserved;
+            uint64_t offset;
+            uint64_t size;
+        };
+        static_assert(sizeof(toc_entry) == 24);
+
+        // strings are offsets into the string section, the blob holds the record's element trees
+        struct entity_record
+        {
+            uint64_t id;
+            uint32_t parent_index;
+            uint32_t flags;
+            float position[3];
+            float rotation[4];
+            float scale[3];
+            uint32_t name;
+            uint32_t tags;
+            uint64_t blob_offset;
+            uint32_t blob_size;
+            uint32_t node_count;
+        };
+        static_assert(sizeof(entity_record) == 80);
+
+        //= WRITING ==========================================================================
+
+        // null terminated and deduplicated, offset 0 is the empty string
+        struct string_pool
+        {
+            vector<char> data = { '\0' };
+            unordered_map<string, uint32_t> offsets;
+
+            uint32_t add(const char* text)
+            {
+                if (!text || text[0] == '\0')
+                {
+                    return 0;
+                }
+
+                auto [it, inserted] = offsets.try_emplace(text, static_cast<uint32_t>(data.size()));
+                if (inserted)
+                {
+                    data.insert(data.end(), text, text + strlen(text) + 1);
+                }
+
+                return it->second;
+            }
+        };
+
+        template <typename T>
+        void write_value(vector<char>& bytes, const T& value)
+        {
+            const char* data = reinterpret_cast<const char*>(&value);
+            bytes.insert(bytes.end(), data, data + sizeof(T));
+        }
+
+        // the same "x y z" text Entity::Load reads, missing values keep their defaults
+        void parse_floats(const char* text, float* values, const uint32_t count)
+        {
+            for (uint32_t i = 0; i < count && text; i++)
+            {
+                char* end   = nullptr;
+                float value = strtof(text, &end);
+                if (end == text)
+                {
+                    return;
+                }
+
+                values[i] = value;
+                text      = end;
+            }
+        }
+
+        // element name, attribute count, child count, the attributes as name/value pairs, then the children
+        void encode_node(const pugi::xml_node& node, string_pool& strings, vector<char>& blob)
+        {
+            uint32_t attribute_count = 0;
+            for (pugi::xml_attribute attribute = node.first_attribute(); attribute; attribute = attribute.next_attribute())
+            {
+                attribute_count++;
+            }
+
+            uint32_t child_count = 0;
+            for (pugi::xml_node child = node.first_child(); child; child = child.next_sibling())
+            {
+                child_count += child.type() == pugi::node_element ? 1 : 0;
+            }
+
+            write_value(blob, strings.add(node.name()));
+            write_value(blob, attribute_count);
+            write_value(blob, child_count);
+
+            for (pugi::xml_attribute attribute = node.first_attribute(); attribute; attribute = attribute.next_attribute())
+            {
+                write_value(blob, strings.add(attribute.name()));
+                write_value(blob, strings.add(attribute.value()));
+            }
+
+            for (pugi::xml_node child = node.first_child(); child; child = child.next_sibling())
+            {
+                if (child.type() == pugi::node_element)
+                {
+                    encode_node(child, strings, blob);
+                }
+            }
+        }
+
+        //= READING ==========================================================================
+
+        // read only view of a whole file, unmapped on destruction
+        class file_mapping
+        {
+        public:
+            ~file_mapping()
+            {
+            #if defined(_WIN32)
+                if (m_data)
+                {
+                    UnmapViewOfFile(m_data);
+                }
+                if (m_mapping)
+                {
+                    CloseHandle(m_mapping);
+                }
+                if (m_file != INVALID_HANDLE_VALUE)
+                {
+                    CloseHandle(m_file);
+                }
+            #else
+                if (m_data)
+                {
+                    munmap(const_cast<char*>(m_data), m_size);
+                }
+            #endif
+            }
+
+            bool map(const string& file_path)
+            {
+            #if defined(_WIN32)
+                m_file = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+                if (m_file == INVALID_HANDLE_VALUE)
+                {
+                    return false;
+                }
+
+                LARGE_INTEGER size = {};
+                if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+                {
+                    return false;
+                }
+
+                m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (!m_mapping)
+                {
+                    return false;
+                }
+
+                m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+                m_size = static_cast<size_t>(size.QuadPart);
+            #else
+                const int file = open(file_path.c_str(), O_RDONLY);
+                if (file < 0)
+                {
+                    return false;
+                }
+
+                struct stat status = {};
+                if (fstat(file, &status) != 0 || status.st_size == 0)
+                {
+                    close(file);
+                    return false;
+                }
+
+                void* data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+                close(file); // the mapping keeps the file alive
+                if (data == MAP_FAILED)
+                {
+                    return false;
+                }
+
+                m_data = static_cast<const char*>(data);
+                m_size = static_cast<size_t>(status.st_size);
+            #endif
+
+                return m_data != nullptr;
+            }
+
+            const char* data() const { return m_data; }
+            size_t size() const      { return m_size; }
+
+        private:
+            const char* m_data = nullptr;
+            size_t m_size      = 0;
+        #if defined(_WIN32)
+            HANDLE m_file    = INVALID_HANDLE_VALUE;
+            HANDLE m_mapping = nullptr;
+        #endif
+        };
+
+        // the sections of a mapped file, bounds checked once so decoding only checks the blobs
+        struct file_view
+        {
+            const char* sections[static_cast<uint32_t>(section_type::Max)] = {};
+            uint64_t sizes[static_cast<uint32_t>(section_type::Max)]       = {};
+
+            const char* section(const section_type type) const { return sections[static_cast<uint32_t>(type)]; }
+            uint64_t size(const section_type type) const       { return sizes[static_cast<uint32_t>(type)]; }
+
+            // the string section ends with a terminator, so any offset inside it is a valid c string
+            const char* get_string(const uint32_t offset) const
+            {
+                return offset < size(section_type::Strings) ? section(section_type::Strings) + offset : "";
+            }
+        };
+
+        bool open_view(const char* data, const size_t size, file_view& view)
+        {
+            file_header header = {};
+            if (size < sizeof(file_header))
+            {
+                return false;
+            }
+
+            memcpy(&header, data, sizeof(file_header));
+            if (memcmp(header.magic, file_magic, sizeof(file_magic)) != 0 || header.version != file_version)
+            {
+                return false;
+            }
+
+            if (header.toc_offset > size || header.section_count > (size - header.toc_offset) / sizeof(toc_entry))
+            {
+                return false;
+            }
+
+            for (uint32_t i = 0; i < header.section_count; i++)
+            {
+                toc_entry entry = {};
+                memcpy(&entry, data + header.toc_offset + i * sizeof(toc_entry), sizeof(toc_entry));
+                if (entry.offset > size || entry.size > size - entry.offset)
+                {
+                    return false;
+                }
+
+                // sections from newer minor revisions are skipped
+                if (entry.type < section_type::Max)
+                {
+                    view.sections[static_cast<uint32_t>(entry.type)] = data + entry.offset;
+                    view.sizes[static_cast<uint32_t>(entry.type)]    = entry.size;
+                }
+            }
+
+            const uint64_t strings_size = view.size(section_type::Strings);
+            if (strings_size == 0 || view.section(section_type::Strings)[strings_size - 1] != '\0')
+            {
+                return false;
+            }
+
+            return view.size(section_type::Entities) % sizeof(entity_record) == 0;
+        }
+
+        template <typename T>
+        bool read_value(const char*& cursor, const char* end, T& value)
+        {
+            if (static_cast<size_t>(end - cursor) < sizeof(T))
+            {
+                return false;
+            }
+
+            memcpy(&value, cursor, sizeof(T));
+            cursor += sizeof(T);
+            return true;
+        }
+
+        bool decode_node(const file_view& view, const char*& cursor, const char* end, pugi::xml_node parent, const uint32_t depth)
+        {
+            uint32_t name            = 0;
+            uint32_t attribute_count = 0;
+            uint32_t child_count     = 0;
+            if (depth >= node_depth_max || !read_value(cursor, end, name) || !read_value(cursor, end, attribute_count) || !read_value(cursor, end, child_count))
+            {
+                return false;
+            }
+
+            pugi::xml_node node = parent.append_child(view.get_string(name));
+            for (uint32_t i = 0; i < attribute_count; i++)
+            {
+                uint32_t attribute_name  = 0;
+                uint32_t attribute_value = 0;
+                if (!read_value(cursor, end, attribute_name) || !read_value(cursor, end, attribute_value))
+                {
+                    return false;
+                }
+
+                node.append_attribute(view.get_string(attribute_name)).set_value(view.get_string(attribute_value));
+            }
+
+            for (uint32_t i = 0; i < child_count; i++)
+            {
+                if (!decode_node(view, cursor, end, node, depth + 1))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        void read_metadata(const file_view& view, string& name, string& description)
+        {
+            const char* cursor = view.section(section_type::Metadata);
+            const char* end    = cursor + view.size(section_type::Metadata);
+            uint32_t name_offset        = 0;
+            uint32_t description_offset = 0;
+            if (cursor && read_value(cursor, end, name_offset) && read_value(cursor, end, description_offset))
+            {
+                name        = view.get_string(name_offset);
+                description = view.get_string(description_offset);
+            }
+        }
+    }
+
+    bool WorldFile::IsBinary(const string& file_path)
+    {
+        ifstream file(file_path, ios::binary);
+        char magic[sizeof(file_magic)] = {};
+        return file.read(magic, sizeof(magic)) && memcmp(magic, file_magic, sizeof(file_magic)) == 0;
+    }
+
+    void WorldFile::Serialize(const pugi::xml_node& world_node, vector<char>& bytes)
+    {
+        string_pool strings;
+
+        // metadata
+        vector<char> metadata;
+        write_value(metadata, strings.add(world_node.attribute("name").as_string()));
+        write_value(metadata, strings.add(world_node.attribute("description").as_string()));
+
+        // console variables
+        vector<char> console_variables;
+        {
+            vector<pair<uint32_t, uint32_t>> variables;
+            for (pugi::xml_node variable = world_node.child("ConsoleVariables").child("Variable"); variable; variable = variable.next_sibling("Variable"))
+            {
+                variables.emplace_back(strings.add(variable.attribute("name").as_string()), strings.add(variable.attribute("value").as_string()));
+            }
+
+            write_value(console_variables, static_cast<uint32_t>(variables.size()));
+            for (const auto& [name, value] : variables)
+            {
+                write_value(console_variables, name);
+                write_value(console_variables, value);
+            }
+        }
+
+        // entities, flattened depth first so parents precede their children
+        vector<entity_record> records;
+        vector<char> blobs;
+        function<void(const pugi::xml_node&, uint32_t)> collect = [&](const pugi::xml_node& node, uint32_t parent_index)
+        {
+            entity_record record = {};
+            record.id           = node.attribute("id").as_ullong();
+            record.parent_index = parent_index;
+            record.flags        = node.attribute("active").as_bool(true) ? record_active : 0;
+            record.name         = strings.add(node.attribute("name").as_string());
+            record.tags         = strings.add(node.attribute("tags").as_string());
+            record.rotation[3]  = 1.0f;
+            record.scale[0]     = record.scale[1] = record.scale[2] = 1.0f;
+            parse_floats(node.attribute("position").as_string(), record.position, 3);
+            parse_floats(node.attribute("rotation").as_string(), record.rotation, 4);
+            parse_floats(node.attribute("scale").as_string(), record.scale, 3);
+
+            // components, prefab and prefab_override elements, child entities get their own records
+            record.blob_offset = blobs.size();
+            for (pugi::xml_node child = node.first_child(); child; child = child.next_sibling())
+            {
+                if (child.type() == pugi::node_element && strcmp(child.name(), "Entity") != 0)
+                {
+                    encode_node(child, strings, blobs);
+                    record.node_count++;
+                }
+            }
+            record.blob_size = static_cast<uint32_t>(blobs.size() - record.blob_offset);
+
+            const uint32_t index = static_cast<uint32_t>(records.size());
+            records.push_back(record);
+
+            for (pugi::xml_node child = node.child("Entity"); child; child = child.next_sibling("Entity"))
+            {
+                collect(child, index);
+            }
+        };
+        for (pugi::xml_node entity_node = world_node.child("Entities").child("Entity"); entity_node; entity_node = entity_node.next_sibling("Entity"))
+        {
+            collect(entity_node, UINT32_MAX);
+        }
+
+        // header, sections 8 byte aligned, then the table of contents
+        bytes.clear();
+        bytes.resize(sizeof(file_header));
+        vector<toc_entry> toc;
+        auto append_section = [&bytes, &toc](const section_type type, const char* data, const size_t size)
+        {
+            bytes.resize((bytes.size() + 7) & ~size_t(7));
+            toc.push_back({ type, 0, bytes.size(), size });
+            bytes.insert(bytes.end(), data, data + size);
+        };
+        append_section(section_type::Metadata,         metadata.data(),                                 metadata.size());
+        append_section(section_type::ConsoleVariables, console_variables.data(),                        console_variables.size());
+        append_section(section_type::Strings,          strings.data.data(),                             strings.data.size());
+        append_section(section_type::Entities,         reinterpret_cast<const char*>(records.data()),   records.size() * sizeof(entity_record));
+        append_section(section_type::Blobs,            blobs.data(),                                    blobs.size());
+
+        bytes.resize((bytes.size() + 7) & ~size_t(7));
+        file_header header   = {};
+        memcpy(header.magic, file_magic, sizeof(file_magic));
+        header.version       = file_version;
+        header.section_count = static_cast<uint32_t>(toc.size());
+        header.toc_offset    = bytes.size();
+        bytes.insert(bytes.end(), reinterpret_cast<const char*>(toc.data()), reinterpret_cast<const char*>(toc.data() + toc.size()));
+        memcpy(bytes.data(), &header, sizeof(file_header));
+    }
+
+    bool WorldFile::Write(const string& file_path, const pugi::xml_node& world_node)
+    {
+        vector<char> bytes;
+        Serialize(world_node, bytes);
+
+        ofstream out(file_path, ios::binary | ios::trunc);
+        if (!out || !out.write(bytes.data(), static_cast<streamsize>(bytes.size())))
+        {
+            SP_LOG_ERROR("Failed to write world file \"%s\"", file_path.c_str());
+            return false;
+        }
+
+        return true;
+    }
+
+    bool WorldFile::Read(const string& file_path, WorldFileContents& contents)
+    {
+        file_mapping mapping;
+        if (!mapping.map(file_path) || !Deserialize(mapping.data(), mapping.size(), contents))
+        {
+            SP_LOG_ERROR("Failed to read world file \"%s\"", file_path.c_str());
+            return false;
+        }
+
+        return true;
+    }
+
+    bool WorldFile::Deserialize(const char* data, const size_t size, WorldFileContents& contents)
+    {
+        file_view view;
+        if (!open_view(data, size, view))
+        {
+            SP_LOG_ERROR("Not a valid version %u binary world", file_version);
+            return false;
+        }
+
+        read_metadata(view, contents.name, contents.description);
+
+        // console variables
+        contents.console_variables.clear();
+        if (const char* cursor = view.section(section_type::ConsoleVariables))
+        {
+            const char* end = cursor + view.size(section_type::ConsoleVariables);
+            uint32_t count  = 0;
+            read_value(cursor, end, count);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                uint32_t name  = 0;
+                uint32_t value = 0;
+                if (!read_value(cursor, end, name) || !read_value(cursor, end, value))
+                {
+                    break;
+                }
+
+                contents.console_variables.emplace_back(view.get_string(name), view.get_string(value));
+            }
+        }
+
+        // entities, every range decodes into its own document since pugixml documents aren't thread safe
+        const uint32_t record_count = static_cast<uint32_t>(view.size(section_type::Entities) / sizeof(entity_record));
+        const uint32_t range_count  = (record_count + decode_range - 1) / decode_range;
+        contents.records.assign(record_count, EntityRecord());
+        contents.nodes.assign(record_count, pugi::xml_node());
+        contents.documents.resize(range_count);
+        for (shared_ptr<pugi::xml_document>& document : contents.documents)
+        {
+            document = make_shared<pugi::xml_document>();
+        }
+
+        const char* records = view.section(section_type::Entities);
+        const char* blobs   = view.section(section_type::Blobs);
+        const uint64_t blobs_size = view.size(section_type::Blobs);
+        atomic<bool> corrupt = false;
+        ThreadPool::ParallelFor(range_count, [&](uint32_t range_start, uint32_t range_end)
+        {
+            for (uint32_t range = range_start; range < range_end; range++)
+            {
+                pugi::xml_document& document = *contents.documents[range];
+                const uint32_t index_end     = min(record_count, (range + 1) * decode_range);
+                for (uint32_t i = range * decode_range; i < index_end; i++)
+                {
+                    entity_record record = {};
+                    memcpy(&record, records + static_cast<size_t>(i) * sizeof(entity_record), sizeof(entity_record));
+
+                    EntityRecord& entity = contents.records[i];
+                    entity.id            = record.id;
+                    entity.parent_index  = record.parent_index;
+                    entity.active        = (record.flags & record_active) != 0;
+                    entity.name          = view.get_string(record.name);
+                    entity.tags          = view.get_string(record.tags);
+                    entity.position      = Vector3(record.position[0], record.position[1], record.position[2]);
+                    entity.rotation      = Quaternion(record.rotation[0], record.rotation[1], record.rotation[2], record.rotation[3]);
+                    entity.scale         = Vector3(record.scale[0], record.scale[1], record.scale[2]);
+
+                    // the loader wires parents in record order
+                    const bool parent_valid = record.parent_index == UINT32_MAX || record.parent_index < i;
+                    const bool blob_valid   = record.blob_offset <= blobs_size && record.blob_size <= blobs_size - record.blob_offset;
+                    if (!parent_valid || !blob_valid)
+                    {
+                        corrupt.store(true, memory_order_relaxed);
+                        continue;
+                    }
+
+                    pugi::xml_node node = document.append_child("Entity");
+                    const char* cursor  = blobs + record.blob_offset;
+                    const char* end     = cursor + record.blob_size;
+                    for (uint32_t n = 0; n < record.node_count; n++)
+                    {
+                        if (!decode_node(view, cursor, end, node, 0))
+                        {
+                            corrupt.store(true, memory_order_relaxed);
+                            break;
+                        }
+                    }
+                    contents.nodes[i] = node;
+                }
+            }
+        });
+
+        if (corrupt.load(memory_order_relaxed))
+        {
+            SP_LOG_ERROR("The world has corrupt entity records");
+            return false;
+        }
+
+        return true;
+    }
+
+    bool WorldFile::ReadMetadata(const string& file_path, WorldMetadata& metadata)
+    {
+        file_mapping mapping;
+        file_view view;
+        if (!mapping.map(file_path) || !open_view(mapping.data(), mapping.size(), view))
+        {
+            SP_LOG_ERROR("\"%s\" is not a valid version %u binary world", file_path.c_str(), file_version);
+            return false;
+        }
+
+        metadata.file_path = file_path;
+        read_metadata(view, metadata.name, metadata.description);
+
+        return true;
+    }
+
+    bool WorldFile::ReadAsXml(const string& file_path, pugi::xml_document& doc)
+    {
+        if (!IsBinary(file_path))
+        {
+            pugi::xml_parse_result result = doc.load_file(file_path.c_str());
+            if (!result)
+            {
+                SP_LOG_ERROR("Failed to load XML file: %s", result.description());
+                return false;
+            }
+
+            return true;
+        }
+
+        WorldFileContents contents;
+        if (!Read(file_path, contents))
+        {
+            return false;
+        }
+
+        doc.reset();
+        pugi::xml_node world_node = doc.append_child("World");
+        world_node.append_attribute("name")        = contents.name.c_str();
+        world_node.append_attribute("description") = contents.description.c_str();
+
+        if (!contents.console_variables.empty())
+        {
+            pugi::xml_node cvars_node = world_node.append_child("ConsoleVariables");
+            for (const auto& [name, value] : contents.console_variables)
+            {
+                pugi::xml_node var_node = cvars_node.append_child("Variable");
+                var_node.append_attribute("name")  = name.c_str();
+                var_node.append_attribute("value") = value.c_str();
+            }
+        }
+
+        // same layout Entity::Save writes, components first and child entities after them
+        pugi::xml_node entities_node = world_node.append_child("Entities");
+        vector<pugi::xml_node> entity_nodes(contents.records.size());
+        for (size_t i = 0; i < contents.records.size(); i++)
+        {
+            const EntityRecord& record = contents.records[i];
+            pugi::xml_node parent      = record.parent_index == UINT32_MAX ? entities_node : entity_nodes[record.parent_index];
+            pugi::xml_node node        = parent.append_child("Entity");
+
+            char position[96];
+            char rotation[128];
+            char scale[96];
+            snprintf(position, sizeof(position), "%g %g %g", record.position.x, record.position.y, record.position.z);
+            snprintf(rotation, sizeof(rotation), "%g %g %g %g", record.rotation.x, record.rotation.y, record.rotation.z, record.rotation.w);
+            snprintf(scale, sizeof(scale), "%g %g %g", record.scale.x, record.scale.y, record.scale.z);
+
+            node.append_attribute("name")     = record.name.c_str();
+            node.append_attribute("id")       = record.id;
+            node.append_attribute("active")   = record.active;
+            node.append_attribute("position") = position;
+            node.append_attribute("rotation") = rotation;
+            node.append_attribute("scale")    = scale;
+            if (!record.tags.empty())
+            {
+                node.append_attribute("tags") = record.tags.c_str();
+            }
+
+            for (pugi::xml_node child = contents.nodes[i].first_child(); child; child = child.next_sibling())
+            {
+                node.append_copy(child);
+            }
+
+            entity_nodes[i] = node;
+        }
+
+        return true;
+    }
+
+    bool WorldFile::ConvertXmlToBinary(const string& xml_path, const string& binary_path)
+    {
+        pugi::xml_document doc;
+        if (!ReadAsXml(xml_path, doc))
+        {
+            return false;
+        }
+
+        pugi::xml_node world_node = doc.child("World");
+        if (!world_node)
+        {
+            SP_LOG_ERROR("No 'World' node found in: %s", xml_path.c_str());
+            return false;
+        }
+
+        return Write(binary_path, world_node);
+    }
+
+    bool WorldFile::ConvertBinaryToXml(const string& binary_path, const string& xml_path)
+    {
+        pugi::xml_document doc;
+        if (!ReadAsXml(binary_path, doc))
+        {
+            return false;
+        }
+
+        if (!doc.save_file(xml_path.c_str(), " ", pugi::format_indent))
+        {
+            SP_LOG_ERROR("Failed to save XML file \"%s\"", xml_path.c_str());
+            return false;
+        }
+
+        return true;
+    }
+}
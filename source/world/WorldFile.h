@@ -0,0 +1,90 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ===================
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../math/Vector3.h"
+#include "../math/Quaternion.h"
+//==============================
+
+namespace pugi
+{
+    class xml_document;
+    class xml_node;
+}
+
+namespace spartan
+{
+    struct WorldMetadata;
+
+    // an entity's identity and transform, read straight from its fixed size record
+    struct EntityRecord
+    {
+        uint64_t id               = 0;
+        uint32_t parent_index     = UINT32_MAX; // into the same record array, UINT32_MAX is a root
+        bool active               = true;
+        std::string name;
+        std::string tags;
+        math::Vector3 position    = math::Vector3::Zero;
+        math::Quaternion rotation = math::Quaternion::Identity;
+        math::Vector3 scale       = math::Vector3::One;
+    };
+
+    // a decoded binary world, every record comes with a node that holds what the <Entity> element holds
+    // besides its child entities (components, prefab and prefab_override elements), for Entity::Load
+    struct WorldFileContents
+    {
+        std::string name;
+        std::string description;
+        std::vector<std::pair<std::string, std::string>> console_variables;
+        std::vector<EntityRecord> records; // parents come before their children
+        std::vector<pugi::xml_node> nodes;
+        std::vector<std::shared_ptr<pugi::xml_document>> documents; // own the nodes, one per decoded range
+    };
+
+    // versioned binary world container: header, table of contents, then sections for metadata, console variables,
+    // a deduplicated string pool, fixed size entity records and the component blobs the records point into
+    // the file is memory mapped so metadata reads never touch the body and entity ranges decode in parallel
+    // xml remains the import/export format, see the converters below
+    class WorldFile
+    {
+    public:
+        static bool IsBinary(const std::string& file_path);
+
+        // world_node is the <World> element World::SaveToFile() builds
+        static void Serialize(const pugi::xml_node& world_node, std::vector<char>& bytes);
+        static bool Write(const std::string& file_path, const pugi::xml_node& world_node);
+        static bool Read(const std::string& file_path, WorldFileContents& contents);
+        static bool Deserialize(const char* data, size_t size, WorldFileContents& contents); // bytes as Serialize() wrote them
+        static bool ReadMetadata(const std::string& file_path, WorldMetadata& metadata);
+
+        // the whole world as an xml document, whichever format the file is in
+        static bool ReadAsXml(const std::string& file_path, pugi::xml_document& doc);
+
+        static bool ConvertXmlToBinary(const std::string& xml_path, const std::string& binary_path);
+        static bool ConvertBinaryToXml(const std::string& binary_path, const std::string& xml_path);
+    };
+}
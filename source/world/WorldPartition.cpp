@@ -0,0 +1,909 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ========================
+#include "pch.h"
+#include <filesystem>
+#include <fstream>
+#include <unordered_set>
+#include "WorldPartition.h"
+#include "Entity.h"
+#include "WorldFile.h"
+#include "components/Camera.h"
+#include "components/Light.h"
+#include "components/Physics.h"
+#include "../car/Car.h"
+#include "../core/Event.h"
+#include "../core/ThreadPool.h"
+#include "../core/Timer.h"
+#include "../profiling/Profiler.h"
+SP_WARNINGS_OFF
+#include "../io/pugixml.hpp"
+SP_WARNINGS_ON
+//===================================
+
+//= NAMESPACES =====
+using namespace std;
+using namespace spartan::math;
+//==================
+
+namespace spartan
+{
+    namespace
+    {
+        const char* index_file_name = "partition.index";
+
+        // streaming tunables, the index of each world can override the radii and the budget
+        float cell_size                   = 128.0f;
+        float load_radius                 = 384.0f;
+        float unload_margin               = 64.0f;  // hysteresis, a cell unloads at load_radius + unload_margin
+        double min_residency_sec          = 5.0;    // hysteresis in time, a loaded cell stays at least this long
+        float prefetch_sec                = 2.0f;   // cells ahead of the focus velocity load early
+        float instantiate_budget_ms       = 2.0f;   // main thread time spent creating cell entities per frame
+        uint64_t memory_budget            = 512ull * 1024 * 1024;
+
+        // decoded on a worker, the main thread only polls completed
+        struct CellRead
+        {
+            uint32_t cell_index = 0;
+            WorldFileContents contents;
+            atomic<bool> completed = false;
+            bool succeeded         = false;
+        };
+
+        vector<WorldCell> cells;
+        vector<shared_ptr<const vector<char>>> cell_edits; // per cell, editor edits of an unloaded cell that only SaveCells() writes out
+        vector<bool> cell_played;                          // per cell, resident at some point during play, reloaded from its pre-play bytes on stop
+        unordered_map<uint64_t, uint32_t> cell_lookup;     // packed cell coordinates to index into cells
+        unordered_set<uint64_t> streamed_root_ids;
+        string cells_directory;
+        bool active = false;
+
+        // one cell is in flight at a time, either reading or instantiating
+        shared_ptr<CellRead> read_in_flight;
+        vector<Entity*> instantiated;
+        uint32_t instantiate_cursor = 0;
+        bool instantiating          = false;
+
+        EntityHandle focus_handle;
+
+        uint64_t cell_key(const int32_t x, const int32_t z)
+        {
+            return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(z);
+        }
+
+        int32_t cell_coordinate(const float value)
+        {
+            return static_cast<int32_t>(floor(value / cell_size));
+        }
+
+        string cell_file_path(const string& directory, const WorldCell& cell)
+        {
+            return directory + "cell_" + to_string(cell.x) + "_" + to_string(cell.z) + EXTENSION_WORLD;
+        }
+
+        string world_path_to_cells_directory(const string& world_file_path)
+        {
+            // the resource directory can be shared between worlds, so the cells get a folder named after the world
+            return World::GetResourceDirectory(world_file_path) + FileSystem::GetFileNameWithoutExtensionFromFilePath(world_file_path) + "_cells/";
+        }
+
+        WorldCell make_cell(const int32_t x, const int32_t z)
+        {
+            WorldCell cell;
+            cell.x      = x;
+            cell.z      = z;
+            cell.bounds = BoundingBox(
+                Vector3(x * cell_size, -FLT_MAX, z * cell_size),
+                Vector3((x + 1) * cell_size, FLT_MAX, (z + 1) * cell_size)
+            );
+            return cell;
+        }
+
+        float distance_xz(const WorldCell& cell, const Vector3& position)
+        {
+            const Vector3& bounds_min = cell.bounds.GetMin();
+            const Vector3& bounds_max = cell.bounds.GetMax();
+            const float dx            = max(max(bounds_min.x - position.x, 0.0f), position.x - bounds_max.x);
+            const float dz            = max(max(bounds_min.z - position.z, 0.0f), position.z - bounds_max.z);
+            return sqrt(dx * dx + dz * dz);
+        }
+
+        uint64_t get_file_size(const string& path)
+        {
+            error_code error;
+            const uintmax_t size = filesystem::file_size(path, error);
+            return error ? 0 : static_cast<uint64_t>(size);
+        }
+
+        // a subtree streams only if every component in it is self contained, managers, scripts,
+        // cameras and anything that other entities reference by id stay in the world file
+        bool is_streamable(Entity* entity)
+        {
+            if (entity->IsTransient() || entity->HasPrefabData() || entity->IsPrefabOwned())
+            {
+                return false;
+            }
+
+            for (uint32_t i = 0; i < static_cast<uint32_t>(ComponentType::Max); i++)
+            {
+                if (!entity->GetAllComponents()[i])
+                {
+                    continue;
+                }
+
+                switch (static_cast<ComponentType>(i))
+                {
+                    case ComponentType::AudioSource:
+                    case ComponentType::Physics:
+                    case ComponentType::Render:
+                    case ComponentType::Volume:
+                    case ComponentType::ParticleSystem:
+                    case ComponentType::Text3D:
+                        break;
+                    case ComponentType::Light:
+                        if (entity->GetComponent<Light>()->GetLightType() == LightType::Directional)
+                        {
+                            return false;
+                        }
+                        break;
+                    default:
+                        return false;
+                }
+            }
+
+            for (Entity* child : entity->GetChildren())
+            {
+                if (!is_streamable(child))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        void serialize_cell(const WorldCell& cell, const vector<Entity*>& roots, vector<char>& bytes)
+        {
+            pugi::xml_document doc;
+            pugi::xml_node world_node = doc.append_child("World");
+            world_node.append_attribute("name") = ("cell_" + to_string(cell.x) + "_" + to_string(cell.z)).c_str();
+            pugi::xml_node entities_node = world_node.append_child("Entities");
+            for (Entity* root : roots)
+            {
+                pugi::xml_node entity_node = entities_node.append_child("Entity");
+                root->Save(entity_node);
+            }
+
+            WorldFile::Serialize(world_node, bytes);
+        }
+
+        bool write_bytes(const string& path, const vector<char>& bytes)
+        {
+            ofstream out(path, ios::binary | ios::trunc);
+            return out && out.write(bytes.data(), static_cast<streamsize>(bytes.size()));
+        }
+
+        bool write_cell(const string& path, const WorldCell& cell, const vector<Entity*>& roots)
+        {
+            vector<char> bytes;
+            serialize_cell(cell, roots, bytes);
+            return write_bytes(path, bytes);
+        }
+
+        // the cell as the editor last left it, unsaved edits first and the file otherwise
+        bool read_cell(const uint32_t cell_index, WorldFileContents& contents)
+        {
+            if (const shared_ptr<const vector<char>>& edits = cell_edits[cell_index])
+            {
+                return WorldFile::Deserialize(edits->data(), edits->size(), contents);
+            }
+
+            return WorldFile::Read(cell_file_path(cells_directory, cells[cell_index]), contents);
+        }
+
+        bool write_index(const string& directory)
+        {
+            pugi::xml_document doc;
+            pugi::xml_node partition_node = doc.append_child("Partition");
+            partition_node.append_attribute("cell_size")     = cell_size;
+            partition_node.append_attribute("load_radius")   = load_radius;
+            partition_node.append_attribute("unload_margin") = unload_margin;
+            partition_node.append_attribute("memory_budget") = memory_budget;
+            for (const WorldCell& cell : cells)
+            {
+                pugi::xml_node cell_node = partition_node.append_child("Cell");
+                cell_node.append_attribute("x")     = cell.x;
+                cell_node.append_attribute("z")     = cell.z;
+                cell_node.append_attribute("bytes") = cell.bytes;
+            }
+
+            return doc.save_file((directory + index_file_name).c_str());
+        }
+
+        void get_cell_roots(const WorldCell& cell, vector<Entity*>& roots_out)
+        {
+            roots_out.clear();
+            for (const EntityHandle handle : cell.roots)
+            {
+                if (Entity* root = World::GetEntity(handle))
+                {
+                    roots_out.push_back(root);
+                }
+            }
+        }
+
+        bool get_focus(Vector3& position_out, Vector3& velocity_out)
+        {
+            velocity_out = Vector3::Zero;
+
+            if (Entity* entity = World::GetEntity(focus_handle))
+            {
+                position_out = entity->GetPosition();
+                if (Physics* physics = entity->GetComponent<Physics>())
+                {
+                    velocity_out = physics->GetLinearVelocity();
+                }
+                return true;
+            }
+
+            for (Car* car : Car::GetAll())
+            {
+                if (car && car->IsOccupied() && car->GetRootEntity())
+                {
+                    position_out = car->GetRootEntity()->GetPosition();
+                    if (Physics* physics = car->GetRootEntity()->GetComponent<Physics>())
+                    {
+                        velocity_out = physics->GetLinearVelocity();
+                    }
+                    return true;
+                }
+            }
+
+            if (Camera* camera = World::GetCamera())
+            {
+                position_out = camera->GetEntity()->GetPosition();
+                return true;
+            }
+
+            return false;
+        }
+
+        // drops the entities of a cell without serializing them
+        void release_cell(WorldCell& cell, const vector<Entity*>& roots)
+        {
+            // listeners drop their references while the entities and their physics bodies still exist
+            SP_FIRE_EVENT_DATA(EventType::WorldCellUnloaded, static_cast<void*>(&cell));
+
+            for (Entity* root : roots)
+            {
+                streamed_root_ids.erase(root->GetObjectId());
+                World::RemoveEntity(root);
+            }
+            cell.roots.clear();
+            cell.state = WorldCellState::Unloaded;
+        }
+
+        void unload_cell(WorldCell& cell)
+        {
+            // in the editor the cell is the source of truth for its entities, so edits are kept in memory until
+            // the world is saved, the file on disk only changes on a save, during play the edits still hold
+            // the pre-play state that OnPlayStart() serialized, so simulated state is simply dropped
+            vector<Entity*> roots;
+            get_cell_roots(cell, roots);
+            if (!Engine::IsFlagSet(EngineMode::Playing))
+            {
+                shared_ptr<vector<char>> edits = make_shared<vector<char>>();
+                serialize_cell(cell, roots, *edits);
+                cell.bytes = edits->size();
+                cell_edits[&cell - cells.data()] = move(edits);
+            }
+
+            release_cell(cell, roots);
+        }
+
+        void begin_read(const uint32_t cell_index)
+        {
+            WorldCell& cell = cells[cell_index];
+            cell.state      = WorldCellState::Reading;
+
+            shared_ptr<CellRead> read = make_shared<CellRead>();
+            read->cell_index          = cell_index;
+            read_in_flight            = read;
+
+            // the worker holds its own references, a shutdown mid read just lets it finish into nothing
+            ThreadPool::AddTask([read, edits = cell_edits[cell_index], path = cell_file_path(cells_directory, cell)]()
+            {
+                read->succeeded = edits ? WorldFile::Deserialize(edits->data(), edits->size(), read->contents) : WorldFile::Read(path, read->contents);
+                read->completed.store(true, memory_order_release);
+            });
+        }
+
+        // creates entities from the decoded cell until the frame budget runs out, parents precede their children
+        // in the file so every entity can attach as soon as it exists
+        void instantiate_step()
+        {
+            CellRead& read  = *read_in_flight;
+            WorldCell& cell = cells[read.cell_index];
+            const uint32_t record_count = static_cast<uint32_t>(read.contents.records.size());
+
+            // entities created during play aren't in the world's play snapshot, the whole cell goes back on stop
+            if (Engine::IsFlagSet(EngineMode::Playing))
+            {
+                cell_played[read.cell_index] = true;
+            }
+
+            const Stopwatch timer;
+            instantiating = true;
+            while (instantiate_cursor < record_count && timer.GetElapsedTimeMs() < instantiate_budget_ms)
+            {
+                const uint32_t i     = instantiate_cursor++;
+                EntityRecord& record = read.contents.records[i];
+
+                Entity* entity = World::CreateEntity();
+                entity->Load(record, read.contents.nodes[i]);
+                instantiated[i] = entity;
+
+                if (record.parent_index == UINT32_MAX)
+                {
+                    cell.roots.push_back(entity->GetHandle());
+                    streamed_root_ids.insert(entity->GetObjectId());
+                }
+                else
+                {
+                    SP_ASSERT(record.parent_index < i);
+                    entity->SetParent(instantiated[record.parent_index]);
+                }
+            }
+            instantiating = false;
+
+            if (instantiate_cursor < record_count)
+            {
+                return;
+            }
+
+            // play mode already started everything else, the cell joins the running simulation
+            if (Engine::IsFlagSet(EngineMode::Playing))
+            {
+                for (Entity* entity : instantiated)
+                {
+                    entity->Start();
+                }
+            }
+
+            cell.state           = WorldCellState::Loaded;
+            cell.time_loaded_sec = Timer::GetTimeSec();
+            instantiated.clear();
+            instantiate_cursor = 0;
+            read_in_flight.reset();
+
+            SP_FIRE_EVENT_DATA(EventType::WorldCellLoaded, static_cast<void*>(&cell));
+        }
+
+        void reset()
+        {
+            read_in_flight.reset();
+            instantiated.clear();
+            instantiate_cursor = 0;
+            cells.clear();
+            cell_edits.clear();
+            cell_played.clear();
+            cell_lookup.clear();
+            streamed_root_ids.clear();
+            cells_directory.clear();
+            focus_handle = EntityHandle();
+            active       = false;
+        }
+    }
+
+    bool WorldCell::Contains(const Vector3& position) const
+    {
+        const Vector3& bounds_min = bounds.GetMin();
+        const Vector3& bounds_max = bounds.GetMax();
+        return position.x >= bounds_min.x && position.x < bounds_max.x && position.z >= bounds_min.z && position.z < bounds_max.z;
+    }
+
+    void WorldPartition::Tick()
+    {
+        if (!active)
+        {
+            return;
+        }
+
+        SP_PROFILE_CPU();
+
+        // finish what is in flight before deciding anything new
+        if (read_in_flight)
+        {
+            CellRead& read = *read_in_flight;
+            WorldCell& cell = cells[read.cell_index];
+            if (cell.state == WorldCellState::Reading && read.completed.load(memory_order_acquire))
+            {
+                if (read.succeeded)
+                {
+                    cell.state = WorldCellState::Instantiating;
+                    instantiated.assign(read.contents.records.size(), nullptr);
+                    instantiate_cursor = 0;
+                }
+                else
+                {
+                    SP_LOG_ERROR("Failed to read world cell %d, %d", cell.x, cell.z);
+                    cell.state = WorldCellState::Unloaded;
+                    cell.bytes = 0; // never retried, a broken file would otherwise be read every frame
+                    read_in_flight.reset();
+                }
+            }
+
+            if (read_in_flight && cell.state == WorldCellState::Instantiating)
+            {
+                instantiate_step();
+            }
+        }
+
+        Vector3 focus;
+        Vector3 velocity;
+        if (!get_focus(focus, velocity))
+        {
+            return;
+        }
+        velocity.y = 0.0f;
+        const Vector3 focus_ahead = focus + velocity * prefetch_sec;
+
+        // unload, past the outer radius and loaded long enough
+        const double time_sec = Timer::GetTimeSec();
+        for (WorldCell& cell : cells)
+        {
+            if (cell.state != WorldCellState::Loaded)
+            {
+                continue;
+            }
+
+            const bool outside = distance_xz(cell, focus) > load_radius + unload_margin && distance_xz(cell, focus_ahead) > load_radius + unload_margin;
+            if (outside && time_sec - cell.time_loaded_sec >= min_residency_sec)
+            {
+                unload_cell(cell);
+            }
+        }
+
+        if (read_in_flight)
+        {
+            return;
+        }
+
+        // load, the nearest wanted cell first
+        uint32_t candidate     = UINT32_MAX;
+        float candidate_distance = FLT_MAX;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(cells.size()); i++)
+        {
+            const WorldCell& cell = cells[i];
+            if (cell.state != WorldCellState::Unloaded || cell.bytes == 0)
+            {
+                continue;
+            }
+
+            const float distance = min(distance_xz(cell, focus), distance_xz(cell, focus_ahead));
+            if (distance <= load_radius && distance < candidate_distance)
+            {
+                candidate          = i;
+                candidate_distance = distance;
+            }
+        }
+
+        if (candidate == UINT32_MAX)
+        {
+            return;
+        }
+
+        // over budget, evict loaded cells that are farther than the candidate, farthest first,
+        // a candidate that only nearer cells could make room for waits until the focus moves
+        while (GetResidentBytes() + cells[candidate].bytes > memory_budget)
+        {
+            WorldCell* farthest   = nullptr;
+            float farthest_distance = candidate_distance;
+            for (WorldCell& cell : cells)
+            {
+                const float distance = distance_xz(cell, focus);
+                if (cell.state == WorldCellState::Loaded && distance > farthest_distance)
+                {
+                    farthest          = &cell;
+                    farthest_distance = distance;
+                }
+            }
+
+            if (!farthest)
+            {
+                return;
+            }
+
+            unload_cell(*farthest);
+        }
+
+        begin_read(candidate);
+    }
+
+    void WorldPartition::Shutdown()
+    {
+        // the world deletes the entities, only the bookkeeping goes
+        reset();
+    }
+
+    bool WorldPartition::Build(const float cell_size_)
+    {
+        const string& world_file_path = World::GetFilePath();
+        if (world_file_path.empty())
+        {
+            SP_LOG_ERROR("Save the world before partitioning it");
+            return false;
+        }
+
+        if (active)
+        {
+            SP_LOG_ERROR("World \"%s\" is already partitioned", world_file_path.c_str());
+            return false;
+        }
+
+        if (Engine::IsFlagSet(EngineMode::Playing))
+        {
+            SP_LOG_ERROR("Can't partition a world during play mode");
+            return false;
+        }
+
+        const Stopwatch timer;
+        reset();
+        cell_size       = max(cell_size_, 1.0f);
+        cells_directory = world_path_to_cells_directory(world_file_path);
+        FileSystem::CreateDirectory_(cells_directory);
+
+        // bucket streamable roots by the cell their position falls in
+        vector<Entity*> root_entities;
+        World::GetRootEntities(root_entities);
+        unordered_map<uint64_t, vector<Entity*>> roots_per_cell;
+        uint32_t streamed_count = 0;
+        for (Entity* root : root_entities)
+        {
+            if (!is_streamable(root))
+            {
+                continue;
+            }
+
+            const Vector3 position = root->GetPosition();
+            const int32_t x        = cell_coordinate(position.x);
+            const int32_t z        = cell_coordinate(position.z);
+            const uint64_t key     = cell_key(x, z);
+            if (cell_lookup.find(key) == cell_lookup.end())
+            {
+                cell_lookup[key] = static_cast<uint32_t>(cells.size());
+                cells.push_back(make_cell(x, z));
+            }
+            roots_per_cell[key].push_back(root);
+            streamed_count++;
+        }
+
+        cell_edits.resize(cells.size());
+        cell_played.resize(cells.size());
+
+        for (WorldCell& cell : cells)
+        {
+            const string path           = cell_file_path(cells_directory, cell);
+            const vector<Entity*>& roots = roots_per_cell[cell_key(cell.x, cell.z)];
+            if (!write_cell(path, cell, roots))
+            {
+                SP_LOG_ERROR("Failed to write world cell %d, %d", cell.x, cell.z);
+                reset();
+                return false;
+            }
+            cell.bytes = get_file_size(path);
+        }
+
+        if (!write_index(cells_directory))
+        {
+            SP_LOG_ERROR("Failed to write the partition index");
+            reset();
+            return false;
+        }
+
+        // the index only stays if the world file drops the streamed roots too, otherwise the next open would
+        // find them in both places, so the roots count as streamed while the world is saved
+        for (auto& [key, roots] : roots_per_cell)
+        {
+            for (Entity* root : roots)
+            {
+                streamed_root_ids.insert(root->GetObjectId());
+            }
+        }
+        active = true;
+        if (!World::SaveToFile(world_file_path))
+        {
+            SP_LOG_ERROR("Failed to save the world, it is left unpartitioned");
+            FileSystem::Delete(cells_directory + index_file_name);
+            reset();
+            return false;
+        }
+
+        // the cells own these entities now, the ones near the focus stream back in over the next frames
+        for (auto& [key, roots] : roots_per_cell)
+        {
+            for (Entity* root : roots)
+            {
+                streamed_root_ids.erase(root->GetObjectId());
+                World::RemoveEntity(root);
+            }
+        }
+
+        SP_LOG_INFO("Partitioned %u root entities into %zu cells of %.0f m, duration %.2f ms", streamed_count, cells.size(), cell_size, timer.GetElapsedTimeMs());
+
+        return true;
+    }
+
+    bool WorldPartition::Open(const string& world_file_path)
+    {
+        reset();
+
+        const string directory = world_path_to_cells_directory(world_file_path);
+        pugi::xml_document doc;
+        if (!FileSystem::Exists(directory + index_file_name) || !doc.load_file((directory + index_file_name).c_str()))
+        {
+            return false;
+        }
+
+        pugi::xml_node partition_node = doc.child("Partition");
+        cell_size       = max(partition_node.attribute("cell_size").as_float(cell_size), 1.0f);
+        load_radius     = partition_node.attribute("load_radius").as_float(load_radius);
+        unload_margin   = partition_node.attribute("unload_margin").as_float(unload_margin);
+        memory_budget   = partition_node.attribute("memory_budget").as_ullong(memory_budget);
+        cells_directory = directory;
+
+        for (pugi::xml_node cell_node = partition_node.child("Cell"); cell_node; cell_node = cell_node.next_sibling("Cell"))
+        {
+            WorldCell cell = make_cell(cell_node.attribute("x").as_int(), cell_node.attribute("z").as_int());
+            cell.bytes     = cell_node.attribute("bytes").as_ullong();
+            cell_lookup[cell_key(cell.x, cell.z)] = static_cast<uint32_t>(cells.size());
+            cells.push_back(cell);
+        }
+        cell_edits.resize(cells.size());
+        cell_played.resize(cells.size());
+
+        active = true;
+        SP_LOG_INFO("World \"%s\" streams %zu cells", world_file_path.c_str(), cells.size());
+
+        return true;
+    }
+
+    void WorldPartition::OnPlayStart()
+    {
+        if (!active)
+        {
+            return;
+        }
+
+        // resident cells are captured as the editor left them, a cell that unloads or gets simulated during
+        // play comes back from these bytes, so neither editor edits nor play state are lost or leaked
+        vector<Entity*> roots;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(cells.size()); i++)
+        {
+            WorldCell& cell = cells[i];
+            if (cell.state == WorldCellState::Loaded)
+            {
+                get_cell_roots(cell, roots);
+                shared_ptr<vector<char>> edits = make_shared<vector<char>>();
+                serialize_cell(cell, roots, *edits);
+                cell.bytes    = edits->size();
+                cell_edits[i] = move(edits);
+            }
+
+            // an instantiating cell reads from its edits or its file, both still pre-play
+            cell_played[i] = cell.state == WorldCellState::Loaded || cell.state == WorldCellState::Instantiating;
+        }
+    }
+
+    void WorldPartition::OnPlayStop()
+    {
+        if (!active)
+        {
+            return;
+        }
+
+        // every cell that was resident during play is dropped and streams back in from its pre-play bytes,
+        // the removals are deferred so this runs before the world processes them, a cell that is only
+        // reading decodes pre-play bytes already and is left alone
+        vector<Entity*> roots;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(cells.size()); i++)
+        {
+            WorldCell& cell = cells[i];
+            if (!cell_played[i])
+            {
+                continue;
+            }
+            cell_played[i] = false;
+
+            if (cell.state == WorldCellState::Instantiating)
+            {
+                read_in_flight.reset();
+                instantiated.clear();
+                instantiate_cursor = 0;
+            }
+
+            if (cell.state == WorldCellState::Loaded || cell.state == WorldCellState::Instantiating)
+            {
+                get_cell_roots(cell, roots);
+                release_cell(cell, roots);
+            }
+        }
+    }
+
+    bool WorldPartition::IsStreamed(const Entity* entity)
+    {
+        return active && streamed_root_ids.find(entity->GetObjectId()) != streamed_root_ids.end();
+    }
+
+    bool WorldPartition::SaveCells(const string& world_file_path)
+    {
+        if (!active)
+        {
+            return true;
+        }
+
+        // save as, unloaded cells without edits are only on disk so they are copied over as they are
+        const string directory = world_path_to_cells_directory(world_file_path);
+        if (directory != cells_directory)
+        {
+            FileSystem::CreateDirectory_(directory);
+            for (uint32_t i = 0; i < static_cast<uint32_t>(cells.size()); i++)
+            {
+                if (cells[i].state != WorldCellState::Loaded && !cell_edits[i])
+                {
+                    FileSystem::CopyFileFromTo(cell_file_path(cells_directory, cells[i]), cell_file_path(directory, cells[i]));
+                }
+            }
+        }
+
+        // loaded cells are written from their entities, unloaded ones from the edits they were unloaded with
+        bool succeeded = true;
+        vector<Entity*> roots;
+        vector<char> bytes;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(cells.size()); i++)
+        {
+            WorldCell& cell = cells[i];
+            if (cell.state == WorldCellState::Loaded)
+            {
+                get_cell_roots(cell, roots);
+                serialize_cell(cell, roots, bytes);
+            }
+            else if (cell_edits[i])
+            {
+                bytes = *cell_edits[i];
+            }
+            else
+            {
+                continue;
+            }
+
+            const string path = cell_file_path(directory, cell);
+            if (write_bytes(path, bytes))
+            {
+                cell.bytes = bytes.size();
+                cell_edits[i].reset(); // a read in flight holds its own reference
+            }
+            else
+            {
+                SP_LOG_ERROR("Failed to write world cell %d, %d", cell.x, cell.z);
+                succeeded = false;
+            }
+        }
+
+        succeeded       = write_index(directory) && succeeded;
+        cells_directory = directory;
+
+        return succeeded;
+    }
+
+    void WorldPartition::GetUnloadedResourcePaths(vector<string>& paths_out)
+    {
+        if (!active)
+        {
+            return;
+        }
+
+        // streamed out entities still reference their meshes and materials, without these a save would prune them
+        for (uint32_t i = 0; i < static_cast<uint32_t>(cells.size()); i++)
+        {
+            if (cells[i].state == WorldCellState::Loaded)
+            {
+                continue;
+            }
+
+            WorldFileContents contents;
+            if (!read_cell(i, contents))
+            {
+                continue;
+            }
+
+            vector<pugi::xml_node> pending = contents.nodes;
+            while (!pending.empty())
+            {
+                const pugi::xml_node node = pending.back();
+                pending.pop_back();
+                for (pugi::xml_node child = node.first_child(); child; child = child.next_sibling())
+                {
+                    pending.push_back(child);
+                }
+
+                for (const char* attribute : { "mesh_path", "material_path" })
+                {
+                    const string path = node.attribute(attribute).as_string();
+                    if (!path.empty())
+                    {
+                        paths_out.push_back(path);
+                    }
+                }
+            }
+        }
+    }
+
+    void WorldPartition::SetFocus(Entity* entity)
+    {
+        focus_handle = entity ? entity->GetHandle() : EntityHandle();
+    }
+
+    void WorldPartition::SetMemoryBudget(const uint64_t bytes)
+    {
+        memory_budget = bytes;
+    }
+
+    bool WorldPartition::IsActive()
+    {
+        return active;
+    }
+
+    bool WorldPartition::IsInstantiating()
+    {
+        return instantiating;
+    }
+
+    bool WorldPartition::IsLoadedAt(const Vector3& position)
+    {
+        if (!active)
+        {
+            return true;
+        }
+
+        auto it = cell_lookup.find(cell_key(cell_coordinate(position.x), cell_coordinate(position.z)));
+        return it == cell_lookup.end() || cells[it->second].state == WorldCellState::Loaded;
+    }
+
+    const vector<WorldCell>& WorldPartition::GetCells()
+    {
+        return cells;
+    }
+
+    uint64_t WorldPartition::GetResidentBytes()
+    {
+        uint64_t bytes = 0;
+        for (const WorldCell& cell : cells)
+        {
+            if (cell.state != WorldCellState::Unloaded)
+            {
+                bytes += cell.bytes;
+            }
+        }
+        return bytes;
+    }
+}
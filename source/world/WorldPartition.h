@@ -0,0 +1,94 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ===================
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "World.h"
+//==============================
+
+namespace spartan
+{
+    class Entity;
+
+    enum class WorldCellState : uint8_t
+    {
+        Unloaded,
+        Reading,       // the cell file is decoding on a worker
+        Instantiating, // entities are being created on the main thread, a few per frame
+        Loaded
+    };
+
+    // one square of the partition grid on the xz plane, passed as the void* data of WorldCellLoaded/WorldCellUnloaded
+    struct WorldCell
+    {
+        int32_t x                    = 0;
+        int32_t z                    = 0;
+        math::BoundingBox bounds;    // the grid square, infinite in y
+        uint64_t bytes               = 0; // size of the cell file, the streaming budget is spent in these
+        WorldCellState state         = WorldCellState::Unloaded;
+        double time_loaded_sec       = 0.0;
+        std::vector<EntityHandle> roots;
+
+        bool Contains(const math::Vector3& position) const;
+    };
+
+    // splits a world into a uniform grid of cells that are serialized separately and streamed in and out
+    // around the player car, or the camera when nobody drives, under a memory budget
+    // a cell loads once the focus comes within the load radius and unloads only past the load radius plus a
+    // margin and after a minimum residency, so driving along a cell border doesn't thrash
+    // files are decoded on a worker, entities are created on the main thread under a per-frame time budget
+    class WorldPartition
+    {
+    public:
+        static void Tick();
+        static void Shutdown();
+
+        // moves every streamable root entity of the current world into per-cell files next to it, the entities
+        // are removed from the world and stream back in on demand, the world file is saved without them
+        static bool Build(float cell_size);
+
+        // reads the cell index of a world that was partitioned with Build(), no-op for worlds that weren't
+        static bool Open(const std::string& world_file_path);
+
+        // play mode, resident cells are captured on start and every cell resident during play is reloaded on stop
+        static void OnPlayStart();
+        static void OnPlayStop();
+
+        // save support, loaded cells and the edits of unloaded ones are written to their own files and skipped by the world file
+        static bool IsStreamed(const Entity* entity);
+        static bool SaveCells(const std::string& world_file_path);
+        static void GetUnloadedResourcePaths(std::vector<std::string>& paths_out);
+
+        // streaming focus, defaults to the occupied car or the active camera
+        static void SetFocus(Entity* entity);
+        static void SetMemoryBudget(uint64_t bytes);
+
+        static bool IsActive();
+        static bool IsInstantiating(); // true while cell entities are being created, they aren't play mode spawns
+        static bool IsLoadedAt(const math::Vector3& position); // true for positions outside the partition grid
+        static const std::vector<WorldCell>& GetCells();
+        static uint64_t GetResidentBytes();
+    };
+}
@@ -55,6 +55,7 @@ namespace spartan
         // component interface
         void Initialize() override;
         void Start() override;
+        bool IsStartThreadSafe() const override { return true; } // only creates its own sdl stream, sdl locks streams internally
         void Stop() override;
         void Remove() override;
         void Tick() override;
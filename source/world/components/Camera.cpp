@@ -434,6 +434,8 @@ namespace spartan
         const Ray ray(pick_ray.GetStart(), pick_ray.GetDirection() - pick_ray.GetStart());
 
         m_pick_hits.clear();
+        m_pick_candidates.clear();
+        m_pick_boxes.Clear();
 
         const vector<Entity*>& entities = World::GetEntities();
         for (Entity* entity : entities)
@@ -450,6 +452,22 @@ namespace spartan
             }
 
             const BoundingBox& aabb = render->GetBoundingBox();
+            m_pick_candidates.push_back(entity);
+            m_pick_boxes.Add(aabb.GetCenter(), aabb.GetExtents());
+        }
+
+        // the ray never leaves the view pyramid, so one batched frustum test rejects most boxes before the ray tests,
+        // depth is ignored since the ray starts before the near plane and runs past the far one
+        m_frustum.CullBatch(m_pick_boxes, m_pick_visibility, true);
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_pick_candidates.size()); i++)
+        {
+            if (!((m_pick_visibility[i >> 6] >> (i & 63)) & 1))
+            {
+                continue;
+            }
+
+            Entity* entity          = m_pick_candidates[i];
+            const BoundingBox& aabb = entity->GetComponent<Render>()->GetBoundingBox();
             float distance          = ray.HitDistance(aabb);
             if (distance == numeric_limits<float>::infinity())
             {
@@ -232,6 +232,7 @@ namespace spartan
         // frustum
         bool IsInViewFrustum(const math::BoundingBox& bounding_box) const;
         bool IsInViewFrustum(std::shared_ptr<Render> render) const;
+        const math::Frustum& GetFrustum() const { return m_frustum; }
 
         // flags
         bool GetFlag(const CameraFlags flag) { return m_flags & flag; }
@@ -334,6 +335,9 @@ namespace spartan
         std::vector<math::RayHitResult> m_pick_hits;
         std::vector<uint32_t> m_pick_indices;
         std::vector<RHI_Vertex_PosTexNorTan> m_pick_vertices;
+        std::vector<Entity*> m_pick_candidates;
+        math::FrustumBatch m_pick_boxes;
+        std::vector<uint64_t> m_pick_visibility;
 
         // what the last cursor resolve landed on, an instance index and the renderable that owns it
         int m_pick_instance                 = -1;
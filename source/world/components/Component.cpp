@@ -41,6 +41,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Text3D.h"
 #include "Animator.h"
 #include "Ragdoll.h"
+#include "../Entity.h"
 SP_WARNINGS_OFF
 #include <sol/sol.hpp>
 SP_WARNINGS_ON
@@ -63,6 +64,11 @@ namespace spartan
         return sol::nil;
     }
 
+    void Component::RecordAttributeChange(Component* component)
+    {
+        ChangeJournal::Record(component->GetEntity(), ChangeType::Attributes);
+    }
+
     template <typename T>
     ComponentType Component::TypeToEnum() { return ComponentType::Max; }
 
@@ -23,9 +23,15 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ========================
 #include <any>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <span>
 #include <vector>
 #include <functional>
 #include <string>
+#include <typeinfo>
+#include <type_traits>
 #include <sol/forward.hpp>
 #include "../../core/SpartanObject.h"
 //===================================
@@ -75,12 +81,34 @@ namespace spartan
         Max
     };
 
+    class Component;
+
+    // a component type as a bit, for Component::GetStartDependencies()
+    constexpr uint64_t StartDependency(const ComponentType type)
+    {
+        return 1ull << static_cast<uint32_t>(type);
+    }
+
+    // describes one reflected member, built once per component type and shared by every instance
+    // used by clone, copy/paste and the mcp commands, while saving still goes through each component's Save()/Load()
     struct Attribute
     {
         std::string name;
         std::string type;
-        std::function<std::any()> getter;
-        std::function<void(std::any)> setter;
+        const std::type_info* type_id = nullptr;
+
+        std::any (*get)(Component* component)                    = nullptr;
+        void (*set)(Component* component, const std::any& value) = nullptr;
+        void (*copy)(Component* destination, Component* source)  = nullptr; // typed, no std::any round trip
+    };
+
+    struct AttributeTable
+    {
+        static constexpr uint32_t capacity = 64;
+
+        std::array<Attribute, capacity> attributes;
+        std::atomic<uint32_t> count = 0;
+        std::mutex mutex;
     };
 
     class Component : public SpartanObject
@@ -98,6 +126,11 @@ namespace spartan
         // called every time the simulation starts
         virtual void Start() {}
 
+        // play mode schedules Start by these, a thread safe Start runs on the job system next to other ones and
+        // a component starts only after every component of the types it depends on has started, see World::Tick
+        virtual bool IsStartThreadSafe() const { return false; }
+        virtual uint64_t GetStartDependencies() const { return 0; }
+
         // called every time the simulation stops
         virtual void Stop() {}
 
@@ -145,42 +178,101 @@ namespace spartan
         ComponentType GetType()          const { return m_type; }
         void SetType(ComponentType type)       { m_type = type; }
 
-        const auto& GetAttributes() const { return m_attributes; }
-        void SetAttributes(const std::vector<Attribute>& attributes)
+        std::span<const Attribute> GetAttributes() const
         {
-            for (uint32_t i = 0; i < static_cast<uint32_t>(m_attributes.size()); i++)
+            if (!m_attribute_table)
+                return {};
+
+            return std::span<const Attribute>(m_attribute_table->attributes.data(), m_attribute_table->count.load(std::memory_order_acquire));
+        }
+
+        // copies every attribute from a component of the same type
+        void CopyAttributes(Component* source)
+        {
+            if (!source || source->m_attribute_table != m_attribute_table)
+                return;
+
+            for (const Attribute& attribute : GetAttributes())
             {
-                m_attributes[i].setter(attributes[i].getter());
+                attribute.copy(this, source);
             }
+
+            // the typed copies write members directly, journal them once like a reflected set would
+            RecordAttributeChange(this);
         }
 
         Entity* GetEntity() const { return m_entity_ptr; }
 
     protected:
-        #define SP_REGISTER_ATTRIBUTE_GET_SET(getter, setter, type) RegisterAttribute(  \
-        #getter, #type,                                                                 \
-        [this]()                        { return getter(); },                           \
-        [this](const std::any& valueIn) { setter(std::any_cast<type>(valueIn)); });     \
-
-        #define SP_REGISTER_ATTRIBUTE_VALUE_SET(value, setter, type) RegisterAttribute( \
-        #value, #type,                                                                  \
-        [this]()                        { return value; },                              \
-        [this](const std::any& valueIn) { setter(std::any_cast<type>(valueIn)); });     \
-
-        #define SP_REGISTER_ATTRIBUTE_VALUE_VALUE(value, type) RegisterAttribute(       \
-        #value, #type,                                                                  \
-        [this]()                        { return value; },                              \
-        [this](const std::any& valueIn) { value = std::any_cast<type>(valueIn); });     \
-
-        // registers an attribute
-        void RegisterAttribute(const char* name, const char* type, std::function<std::any()>&& getter, std::function<void(std::any)>&& setter)
+        #define SP_REGISTER_ATTRIBUTE_GET_SET(getter, setter, type) RegisterAttribute(this, \
+        #getter, #type,                                                                     \
+        [](auto* self) -> decltype(auto)        { return self->getter(); },                 \
+        [](auto* self, const auto& value_in)    { self->setter(value_in); });               \
+
+        #define SP_REGISTER_ATTRIBUTE_VALUE_SET(value, setter, type) RegisterAttribute(this, \
+        #value, #type,                                                                      \
+        [](auto* self) -> auto&                 { return self->value; },                    \
+        [](auto* self, const auto& value_in)    { self->setter(value_in); });               \
+
+        #define SP_REGISTER_ATTRIBUTE_VALUE_VALUE(value, type) RegisterAttribute(this,       \
+        #value, #type,                                                                      \
+        [](auto* self) -> auto&                 { return self->value; },                    \
+        [](auto* self, const auto& value_in)    { self->value = value_in; });               \
+
+        // for values kept outside the component (e.g. in a ComponentStorage), name is what tools see
+        #define SP_REGISTER_ATTRIBUTE_VALUE_NAMED(name, value, type) RegisterAttribute(this, \
+        name, #type,                                                                        \
+        [](auto* self) -> auto&                 { return self->value; },                    \
+        [](auto* self, const auto& value_in)    { self->value = value_in; });               \
+
+        // registers an attribute, the first instance of a type fills the shared table and the rest only advance their cursor
+        // this runs in constructors, so the accessors are only named in unevaluated context and never called on self
+        template <typename Self, typename Getter, typename Setter>
+        void RegisterAttribute(Self* self, const char* name, const char* type, Getter, Setter)
         {
-            Attribute attribute;
-            attribute.name   = name;
-            attribute.type   = type;
-            attribute.getter = std::move(getter);
-            attribute.setter = std::move(setter);
-            m_attributes.emplace_back(attribute);
+            using value_type = std::decay_t<decltype(Getter{}(self))>;
+
+            AttributeTable& table = GetAttributeTable<Self>();
+            m_attribute_table     = &table;
+            const uint32_t index  = m_attribute_cursor++;
+            if (index < table.count.load(std::memory_order_acquire))
+                return;
+
+            std::lock_guard<std::mutex> lock(table.mutex);
+            if (index < table.count.load(std::memory_order_relaxed))
+                return;
+
+            SP_ASSERT_MSG(index < AttributeTable::capacity, "Too many attributes, increase AttributeTable::capacity");
+
+            Attribute& attribute = table.attributes[index];
+            attribute.name       = name;
+            attribute.type       = type;
+            attribute.type_id    = &typeid(value_type);
+
+            attribute.get = [](Component* component) -> std::any
+            {
+                return value_type(Getter{}(static_cast<Self*>(component)));
+            };
+
+            attribute.set = [](Component* component, const std::any& value)
+            {
+                Setter{}(static_cast<Self*>(component), std::any_cast<value_type>(value));
+                RecordAttributeChange(component);
+            };
+
+            attribute.copy = [](Component* destination, Component* source)
+            {
+                Setter{}(static_cast<Self*>(destination), value_type(Getter{}(static_cast<Self*>(source))));
+            };
+
+            table.count.store(index + 1, std::memory_order_release);
+        }
+
+        template <typename Self>
+        static AttributeTable& GetAttributeTable()
+        {
+            static AttributeTable table;
+            return table;
         }
 
         // the type of the component
@@ -191,7 +283,11 @@ namespace spartan
         Entity* m_entity_ptr = nullptr;
 
     private:
-        // the attributes of the component
-        std::vector<Attribute> m_attributes;
+        // tools write through the reflected setters, which may bypass the setters that record into the change journal
+        static void RecordAttributeChange(Component* component);
+
+        // the attributes of the component, shared by all components of the same type
+        AttributeTable* m_attribute_table = nullptr;
+        uint32_t m_attribute_cursor       = 0;
     };
 }
@@ -0,0 +1,143 @@
+/*
+Copyright(c) 2015-2026 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==================
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "../../core/ThreadPool.h"
+//=============================
+
+namespace spartan
+{
+    // contiguous storage for the hot per-frame state of one component type, components keep a pointer to their
+    // slot and their getters read through it, so systems stream through the states instead of chasing entities
+    // chunks never move, so a slot stays valid while loader threads add components, freed slots are reused
+    template <typename State>
+    class ComponentStorage
+    {
+    public:
+        uint32_t Add()
+        {
+            std::lock_guard lock(m_mutex);
+
+            uint32_t slot = 0;
+            if (!m_slots_free.empty())
+            {
+                slot = m_slots_free.back();
+                m_slots_free.pop_back();
+            }
+            else
+            {
+                slot = m_size.load(std::memory_order_relaxed);
+                const uint32_t chunk_index = slot >> chunk_shift;
+                SP_ASSERT_MSG(chunk_index < chunk_count_max, "component storage is full");
+                if (!m_chunks[chunk_index])
+                {
+                    m_chunks[chunk_index] = std::make_unique<chunk>();
+                }
+                m_size.store(slot + 1, std::memory_order_release);
+            }
+
+            Get(slot) = State();
+            GetChunk(slot).alive[slot & chunk_mask].store(true, std::memory_order_release);
+
+            return slot;
+        }
+
+        // allocates the chunks the next count adds will land in, so a batch of adds from workers never allocates
+        void Reserve(const uint32_t count)
+        {
+            std::lock_guard lock(m_mutex);
+
+            const uint32_t reused = std::min(count, static_cast<uint32_t>(m_slots_free.size()));
+            const uint32_t end    = m_size.load(std::memory_order_relaxed) + (count - reused);
+            for (uint32_t chunk_index = m_size.load(std::memory_order_relaxed) >> chunk_shift; end > 0 && chunk_index <= (end - 1) >> chunk_shift; chunk_index++)
+            {
+                SP_ASSERT_MSG(chunk_index < chunk_count_max, "component storage is full");
+                if (!m_chunks[chunk_index])
+                {
+                    m_chunks[chunk_index] = std::make_unique<chunk>();
+                }
+            }
+        }
+
+        void Remove(const uint32_t slot)
+        {
+            std::lock_guard lock(m_mutex);
+
+            GetChunk(slot).alive[slot & chunk_mask].store(false, std::memory_order_release);
+            Get(slot) = State();
+            m_slots_free.push_back(slot);
+        }
+
+        State& Get(const uint32_t slot)
+        {
+            return GetChunk(slot).states[slot & chunk_mask];
+        }
+
+        bool IsAlive(const uint32_t slot) const
+        {
+            return m_chunks[slot >> chunk_shift]->alive[slot & chunk_mask].load(std::memory_order_acquire);
+        }
+
+        // every slot handed out so far, freed ones included
+        uint32_t GetSize() const { return m_size.load(std::memory_order_acquire); }
+
+        // function(state) for every live slot, in slot order so each worker walks contiguous memory
+        template <typename Function>
+        void ParallelForEach(Function&& function, const uint32_t min_chunk = 256)
+        {
+            ThreadPool::ParallelFor(GetSize(), [this, &function](uint32_t start, uint32_t end)
+            {
+                for (uint32_t slot = start; slot < end; slot++)
+                {
+                    if (IsAlive(slot))
+                    {
+                        function(Get(slot));
+                    }
+                }
+            }, min_chunk);
+        }
+
+    private:
+        static constexpr uint32_t chunk_shift     = 10;
+        static constexpr uint32_t chunk_size      = 1 << chunk_shift;
+        static constexpr uint32_t chunk_mask      = chunk_size - 1;
+        static constexpr uint32_t chunk_count_max = 4096; // 4m components
+
+        struct chunk
+        {
+            State states[chunk_size];
+            std::atomic<bool> alive[chunk_size] = {};
+        };
+
+        chunk& GetChunk(const uint32_t slot) { return *m_chunks[slot >> chunk_shift]; }
+
+        std::unique_ptr<chunk> m_chunks[chunk_count_max];
+        std::atomic<uint32_t> m_size = 0;
+        std::vector<uint32_t> m_slots_free;
+        std::mutex m_mutex;
+    };
+}
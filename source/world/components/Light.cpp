@@ -399,6 +399,8 @@ namespace spartan
 
         if (enabled || disabled)
         {
+            ChangeJournal::Record(m_entity_ptr, ChangeType::Light);
+
             if (disabled)
             {
                 // if the shadows have been disabled, disable properties which rely on them
@@ -435,17 +437,20 @@ namespace spartan
         }
 
         UpdateMatrices();
+        ChangeJournal::Record(m_entity_ptr, ChangeType::Light);
     }
 
     void Light::SetTemperature(const float temperature_kelvin)
     {
         m_temperature_kelvin = temperature_kelvin;
         m_color_rgb          = Color(temperature_kelvin);
+        ChangeJournal::Record(m_entity_ptr, ChangeType::Light);
     }
 
     void Light::SetColor(const Color& rgb)
     {
         m_color_rgb = rgb;
+        ChangeJournal::Record(m_entity_ptr, ChangeType::Light);
 
         if (rgb == Color::light_sky_clear)
         {
@@ -587,6 +592,7 @@ namespace spartan
         {
             m_intensity_photometric = 0.0f;
         }
+        ChangeJournal::Record(m_entity_ptr, ChangeType::Light);
 
         if (update_range)
         {
@@ -599,6 +605,7 @@ namespace spartan
         const bool update_range = is_sensible_range(m_range, m_light_type, m_intensity_photometric, m_angle_rad);
         m_intensity_photometric = photometric_intensity;
         m_intensity             = LightIntensity::custom;
+        ChangeJournal::Record(m_entity_ptr, ChangeType::Light);
 
         if (update_range)
         {
@@ -677,6 +684,7 @@ namespace spartan
     void Light::SetCloudCoverage(const float coverage)
     {
         m_cloud_coverage = clamp(coverage, 0.0f, 1.0f);
+        ChangeJournal::Record(m_entity_ptr, ChangeType::Light);
     }
 
     float Light::GetIntensityRadiometric() const
@@ -851,6 +859,7 @@ namespace spartan
         UpdateViewMatrix();
         UpdateProjectionMatrix();
         UpdateBoundingBox();
+        ChangeJournal::Record(m_entity_ptr, ChangeType::Light);
     }
 
     void Light::UpdateViewMatrix()
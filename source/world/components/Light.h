@@ -157,6 +157,7 @@ namespace spartan
 
         // frustum
         bool IsInViewFrustum(Render* render, const uint32_t array_index) const;
+        const math::Frustum& GetFrustum(const uint32_t array_index) const { return m_frustums[array_index]; }
 
         // index
         void SetIndex(const uint32_t index) { m_index = index; }
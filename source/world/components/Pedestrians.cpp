@@ -34,6 +34,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../../resource/ResourceCache.h"
 #include "../Entity.h"
 #include "../World.h"
+#include "../WorldPartition.h"
 #include "../../io/pugixml.hpp"
 
 using namespace std;
@@ -75,10 +76,25 @@ namespace spartan
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_max_animated, uint32_t);
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_animation_radius, float);
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_walk_speed, float);
+
+        // walkers follow the ground of streamed world cells, they hide with a cell and come back with it
+        m_cell_loaded_handle   = SP_SUBSCRIBE_TO_EVENT(EventType::WorldCellLoaded, SP_EVENT_HANDLER_VARIANT(OnWorldCellLoaded));
+        m_cell_unloaded_handle = SP_SUBSCRIBE_TO_EVENT(EventType::WorldCellUnloaded, SP_EVENT_HANDLER_VARIANT(OnWorldCellUnloaded));
     }
 
     Pedestrians::~Pedestrians()
     {
+        if (m_cell_loaded_handle != 0)
+        {
+            SP_UNSUBSCRIBE_FROM_EVENT(EventType::WorldCellLoaded, m_cell_loaded_handle);
+            m_cell_loaded_handle = 0;
+        }
+        if (m_cell_unloaded_handle != 0)
+        {
+            SP_UNSUBSCRIBE_FROM_EVENT(EventType::WorldCellUnloaded, m_cell_unloaded_handle);
+            m_cell_unloaded_handle = 0;
+        }
+
         // never RemoveEntity here, World::Shutdown/RemoveEntity may already hold entity_access_mutex
         CancelPreload();
         for (Walker& walker : m_walkers)
@@ -236,8 +252,15 @@ namespace spartan
                 continue;
             }
 
-            if (walker.dead)
+            if (walker.dead || walker.parked)
+            {
+                continue;
+            }
+
+            // a walker that wandered off the streamed cells would float, it waits for its cell instead
+            if (!WorldPartition::IsLoadedAt(walker.entity->GetPosition()))
             {
+                SetParked(walker, true);
                 continue;
             }
 
@@ -770,6 +793,52 @@ namespace spartan
         entity->SetPosition(position);
     }
 
+    void Pedestrians::SetParked(Walker& walker, const bool parked)
+    {
+        if (walker.parked == parked || !walker.entity)
+        {
+            return;
+        }
+
+        walker.parked = parked;
+        walker.entity->SetActive(!parked);
+
+        // the ground under it may have been replaced, sample on the next update
+        if (!parked)
+        {
+            walker.ground_sample_timer = 0.0f;
+            Vector3 ground;
+            if (SampleGround(walker.entity->GetPosition(), ground))
+            {
+                walker.ground_y = ground.y;
+            }
+        }
+    }
+
+    void Pedestrians::OnWorldCellLoaded(const sp_variant& data)
+    {
+        const WorldCell* cell = static_cast<const WorldCell*>(get<void*>(data));
+        for (Walker& walker : m_walkers)
+        {
+            if (walker.parked && walker.entity && cell->Contains(walker.entity->GetPosition()))
+            {
+                SetParked(walker, false);
+            }
+        }
+    }
+
+    void Pedestrians::OnWorldCellUnloaded(const sp_variant& data)
+    {
+        const WorldCell* cell = static_cast<const WorldCell*>(get<void*>(data));
+        for (Walker& walker : m_walkers)
+        {
+            if (walker.entity && !walker.dead && cell->Contains(walker.entity->GetPosition()))
+            {
+                SetParked(walker, true);
+            }
+        }
+    }
+
     void Pedestrians::UpdateAnimationLod()
     {
         Camera* camera = World::GetCamera();
@@ -22,6 +22,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 #include "Component.h"
+#include "../../core/Event.h"
 #include "../../math/Vector3.h"
 #include <atomic>
 #include <cstdint>
@@ -43,6 +44,8 @@ namespace spartan
         ~Pedestrians() override;
 
         void Start() override;
+        // walkers are placed on the static colliders, so physics has to be up first
+        uint64_t GetStartDependencies() const override { return StartDependency(ComponentType::Physics); }
         void Stop() override;
         void Tick() override;
         void Save(pugi::xml_node& node) override;
@@ -64,6 +67,7 @@ namespace spartan
             float ground_sample_timer = 0.0f;
             bool animating = false;
             bool dead = false;
+            bool parked = false; // its world cell is streamed out, hidden until the cell is back
         };
 
         struct PreloadState
@@ -87,6 +91,9 @@ namespace spartan
         void UpdateWalker(Walker& walker, float delta_time);
         void UpdateWalkerFar(Walker& walker, float delta_time);
         void UpdateAnimationLod();
+        void SetParked(Walker& walker, bool parked);
+        void OnWorldCellLoaded(const sp_variant& data);
+        void OnWorldCellUnloaded(const sp_variant& data);
         float NextFloat();
         uint32_t NextUInt();
 
@@ -105,5 +112,7 @@ namespace spartan
         bool m_spawn_ready = false;
         bool m_physics_ready = false;
         std::shared_ptr<PreloadState> m_preload_state;
+        subscription_handle m_cell_loaded_handle = 0;
+        subscription_handle m_cell_unloaded_handle = 0;
     };
 }
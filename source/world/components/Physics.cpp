@@ -4377,6 +4377,7 @@ namespace spartan
         vector<RHI_Vertex_PosTexNorTan> cloth_mesh_vertices = vertices;
         vector<uint32_t> cloth_mesh_indices = indices;
         cloth_mesh->AddGeometry(cloth_mesh_vertices, cloth_mesh_indices, false, source_sub_mesh_index);
+        cloth_mesh->SetDynamic(true); // rewritten in place through the cached offset below, so the block has to stay put
         cloth_mesh->CreateGpuBuffers();
         render->SetMesh(cloth_mesh.get(), source_sub_mesh_index);
         m_cloth_mesh = move(cloth_mesh);
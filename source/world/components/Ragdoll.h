@@ -62,6 +62,7 @@ namespace spartan
         void Initialize() override;
         void Remove() override;
         void Start() override;
+        uint64_t GetStartDependencies() const override { return StartDependency(ComponentType::Animator) | StartDependency(ComponentType::Physics); }
         void Stop() override;
         void PreTick() override;
         void Tick() override;
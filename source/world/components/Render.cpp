@@ -21,9 +21,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ================================
 #include "pch.h"
+#include <bit>
 #include <sstream>
 #include "Render.h"
 #include "Camera.h"
+#include "ComponentStorage.h"
 #include "../Entity.h"
 #include "../rhi/RHI_Buffer.h"
 #include "../rhi/RHI_Device.h"
@@ -33,7 +35,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../../rendering/Renderer.h"
 #include "../../rendering/Material.h"
 #include "../../rendering/GeometryBuffer.h"
+#include "../../profiling/Profiler.h"
 #include "../../geometry/Mesh.h"
+#include "../../math/AabbTree.h"
 SP_WARNINGS_OFF
 #include <sol/sol.hpp>
 #include "../io/pugixml.hpp"
@@ -64,31 +68,331 @@ namespace spartan
 
             return &sub_mesh.lods[lod];
         }
+
+        // every render's hot state, slot order rather than entity order
+        ComponentStorage<RenderState> render_states;
+        uint32_t visibility_pass = 1;
+
+        // culling tree over the render states, leaves carry the state slot and the max render distance as reach
+        // it only changes on the main thread at the start of a visibility pass, renders that moved out of their
+        // leaf or were destroyed queue themselves from any thread in between
+        struct tree_removal
+        {
+            uint32_t slot;
+            uint32_t proxy;
+            bool is_unbounded;
+        };
+        AabbTree render_tree;
+        vector<uint32_t> tree_queue;
+        vector<tree_removal> tree_removals;
+        mutex tree_mutex;
+        vector<uint32_t> unbounded_slots;
+
+        // candidates the tree returned this pass and last pass, one bit per slot, the difference is what went out of view
+        vector<uint64_t> visible_bits;
+        vector<uint64_t> visible_bits_previous;
+        vector<uint32_t> visible_slots;
+
+        // the candidates' exact boxes, tested against the frustum and their max distance in one batch
+        FrustumBatch candidate_boxes;
+        vector<uint64_t> candidate_visibility;
+
+        // camera inputs shared by every render in a pass
+        struct visibility_camera
+        {
+            Camera* camera     = nullptr;
+            Vector3 position   = Vector3::Zero;
+            float tan_half_fov = 0.0f;
+        };
+
+        visibility_camera get_visibility_camera()
+        {
+            visibility_camera view;
+            view.camera = World::GetCamera();
+            if (view.camera)
+            {
+                view.position     = view.camera->GetEntity()->GetPosition();
+                view.tan_half_fov = tan(view.camera->GetFovVerticalRad() * 0.5f);
+            }
+
+            return view;
+        }
+
+        void queue_tree_update(const uint32_t slot, RenderState& state)
+        {
+            if (state.tree_queued)
+            {
+                return;
+            }
+
+            const bool in_tree = state.tree_proxy != AabbTree::invalid && render_tree.Fits(state.tree_proxy, state.bounding_box, state.max_distance_render);
+            if (in_tree || (state.is_unbounded && state.bounding_box.IsInfinite()))
+            {
+                return;
+            }
+
+            state.tree_queued = true;
+            lock_guard lock(tree_mutex);
+            tree_queue.push_back(slot);
+        }
+
+        void mark_bit(vector<uint64_t>& bits, const uint32_t slot)
+        {
+            bits[slot >> 6] |= 1ull << (slot & 63);
+        }
+
+        // applies destroyed renders first, a queued slot may already belong to a new render, then inserts and moves leaves
+        void update_tree()
+        {
+            vector<uint32_t> queue;
+            vector<tree_removal> removals;
+            {
+                lock_guard lock(tree_mutex);
+                queue.swap(tree_queue);
+                removals.swap(tree_removals);
+            }
+
+            for (const tree_removal& removal : removals)
+            {
+                if (removal.proxy != AabbTree::invalid)
+                {
+                    render_tree.Remove(removal.proxy);
+                }
+
+                if (removal.is_unbounded)
+                {
+                    unbounded_slots.erase(remove(unbounded_slots.begin(), unbounded_slots.end(), removal.slot), unbounded_slots.end());
+                }
+            }
+
+            for (const uint32_t slot : queue)
+            {
+                if (slot >= render_states.GetSize() || !render_states.IsAlive(slot))
+                {
+                    continue;
+                }
+
+                RenderState& state = render_states.Get(slot);
+                state.tree_queued  = false;
+
+                // whatever was visible before the move gets re-evaluated even if the tree no longer returns it
+                mark_bit(visible_bits_previous, slot);
+
+                const BoundingBox& bounding_box = state.bounding_box;
+                const bool is_infinite          = bounding_box.IsInfinite();
+                const bool is_finite            = !is_infinite && !bounding_box.GetCenter().IsNaN() && !bounding_box.GetExtents().IsNaN();
+
+                if (is_infinite != state.is_unbounded)
+                {
+                    if (is_infinite)
+                    {
+                        unbounded_slots.push_back(slot);
+                    }
+                    else
+                    {
+                        unbounded_slots.erase(remove(unbounded_slots.begin(), unbounded_slots.end(), slot), unbounded_slots.end());
+                    }
+                    state.is_unbounded = is_infinite;
+                }
+
+                if (!is_finite)
+                {
+                    // unbounded renders skip the tree and are always visible, a non finite bbox would poison it so it's invisible
+                    if (state.tree_proxy != AabbTree::invalid)
+                    {
+                        render_tree.Remove(state.tree_proxy);
+                        state.tree_proxy = AabbTree::invalid;
+                    }
+
+                    if (!is_infinite)
+                    {
+                        Entity* entity = state.owner ? state.owner->GetEntity() : nullptr;
+                        SP_LOG_WARNING("non finite bbox on '%s', marking invisible", entity ? entity->GetObjectName().c_str() : "?");
+                        state.is_visible       = false;
+                        state.distance_squared = 0.0f;
+                    }
+                    continue;
+                }
+
+                if (state.tree_proxy == AabbTree::invalid)
+                {
+                    state.tree_proxy = render_tree.Insert(bounding_box, state.max_distance_render, slot);
+                }
+                else
+                {
+                    render_tree.Update(state.tree_proxy, bounding_box, state.max_distance_render);
+                }
+            }
+        }
+
+        void update_culling(RenderState& state, const visibility_camera& view)
+        {
+            if (!view.camera)
+            {
+                state.distance_squared = 0.0f;
+                state.is_visible       = true;
+                return;
+            }
+
+            const BoundingBox& bounding_box = state.bounding_box;
+            const Vector3 center  = bounding_box.GetCenter();
+            const Vector3 extents = bounding_box.GetExtents();
+
+            // a non finite bbox would crash the frustum culler assert, treat it as invisible
+            if (center.IsNaN() || extents.IsNaN())
+            {
+                Entity* entity = state.owner ? state.owner->GetEntity() : nullptr;
+                SP_LOG_WARNING("non finite bbox on '%s', marking invisible", entity ? entity->GetObjectName().c_str() : "?");
+                state.is_visible       = false;
+                state.distance_squared = 0.0f;
+                return;
+            }
+
+            const Vector3& camera_position = view.position;
+            const float max_distance       = state.max_distance_render;
+            const float max_distance_sq    = max_distance * max_distance;
+
+            // cheap reject before the 6-plane frustum test, center farther than max range plus radius cannot be visible
+            const float radius = max(extents.x, max(extents.y, extents.z)) * 1.7320508f;
+            const float reject_distance = max_distance + radius;
+            const float center_distance_sq = Vector3::DistanceSquared(camera_position, center);
+            if (center_distance_sq > reject_distance * reject_distance)
+            {
+                state.is_visible       = false;
+                state.distance_squared = center_distance_sq;
+                return;
+            }
+
+            if (!view.camera->IsInViewFrustum(bounding_box))
+            {
+                state.is_visible       = false;
+                state.distance_squared = center_distance_sq;
+                return;
+            }
+
+            state.distance_squared = Vector3::DistanceSquared(camera_position, bounding_box.GetClosestPoint(camera_position));
+            state.is_visible       = state.distance_squared <= max_distance_sq;
+        }
+
+        void update_lod(RenderState& state, const visibility_camera& view)
+        {
+            // screen coverage handles distance, object size and fov uniformly with no per-type special cases
+
+            const uint32_t lod_count = state.lod_count;
+            if (lod_count == 0)
+            {
+                state.lod_index = 0;
+                return;
+            }
+
+            if (!view.camera)
+            {
+                state.lod_index = lod_count - 1;
+                return;
+            }
+
+            const BoundingBox& box         = state.bounding_box;
+            const Vector3& camera_position = view.position;
+
+            // camera inside bounding box = maximum detail
+            if (box.Contains(camera_position))
+            {
+                state.lod_index = 0;
+                return;
+            }
+
+            // distance from camera to closest point on bounding box
+            Vector3 closest_point = box.GetClosestPoint(camera_position);
+            float distance        = max((closest_point - camera_position).Length(), 0.001f);
+
+            // an instanced renderable's box spans every instance it carries, so a tile of trees measures
+            // hundreds of metres across and scores full coverage from any distance, which pins the whole
+            // tile at lod 0 forever, the coverage has to come from the size of one instance while the box
+            // keeps supplying the distance
+            const Vector3 measured_extents = state.is_instanced ? state.lod_extents : box.GetExtents();
+
+            // compute screen-space coverage: fraction of vertical screen space the object covers
+            // screen_fraction = (object_diameter) / (visible_height_at_distance)
+            // visible_height_at_distance = 2 * distance * tan(fov_v / 2)
+            float bounding_diameter = measured_extents.Length() * 2.0f;
+            float screen_fraction   = bounding_diameter / (2.0f * distance * view.tan_half_fov);
+
+            // screen height coverage each lod requires, calibrated so the transitions stay imperceptible
+            static constexpr array<float, 5> screen_thresholds =
+            {
+                0.05f,   // lod0: object covers >= 5% of screen height
+                0.025f,  // lod1: object covers >= 2.5% of screen height
+                0.012f,  // lod2: object covers >= 1.2% of screen height
+                0.006f,  // lod3: object covers >= 0.6% of screen height
+                0.003f   // lod4: object covers >= 0.3% of screen height
+            };
+
+            // hysteresis against lod popping, a change requires passing the threshold by 10 percent in either direction
+            constexpr float hysteresis = 1.1f;
+
+            uint32_t new_lod = lod_count - 1;
+            for (uint32_t i = 0; i < min(lod_count, static_cast<uint32_t>(screen_thresholds.size())); i++)
+            {
+                float threshold = screen_thresholds[i];
+
+                // apply hysteresis based on relationship to current lod
+                if (i < state.lod_index)
+                {
+                    // upgrading to higher detail: raise the bar
+                    threshold *= hysteresis;
+                }
+                else if (i == state.lod_index)
+                {
+                    // staying at current lod: lower the bar (easier to stay)
+                    threshold /= hysteresis;
+                }
+
+                if (screen_fraction >= threshold)
+                {
+                    new_lod = i;
+                    break;
+                }
+            }
+
+            state.lod_index = clamp(new_lod, 0u, lod_count - 1);
+        }
     }
 
     Render::Render(Entity* entity) : Component(entity)
     {
+        m_state_slot   = render_states.Add();
+        m_state        = &render_states.Get(m_state_slot);
+        m_state->owner = this;
+
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_material_default, bool);
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_material, Material*);
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_flags, uint32_t);
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_mesh, Mesh*);
-        SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_bounding_box, BoundingBox);
+        SP_REGISTER_ATTRIBUTE_VALUE_NAMED("m_bounding_box", m_state->bounding_box, BoundingBox);
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_bounding_box_mesh, BoundingBox);
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_sub_mesh_index, uint32_t);
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_bounding_box_dirty, bool);
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_instances, vector<Instance>);
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_transform_previous, Matrix);
-        SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_max_distance_render, float);
+        SP_REGISTER_ATTRIBUTE_VALUE_NAMED("m_max_distance_render", m_state->max_distance_render, float);
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_max_distance_shadow, float);
-        SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_distance_squared, float);
-        SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_is_visible, bool);
-        SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_lod_index, uint32_t);
+        SP_REGISTER_ATTRIBUTE_VALUE_NAMED("m_distance_squared", m_state->distance_squared, float);
+        SP_REGISTER_ATTRIBUTE_VALUE_NAMED("m_is_visible", m_state->is_visible, bool);
+        SP_REGISTER_ATTRIBUTE_VALUE_NAMED("m_lod_index", m_state->lod_index, uint32_t);
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_previous_lights, uint64_t);
     }
 
     Render::~Render()
     {
         m_mesh = nullptr;
+        GeometryBuffer::Free(GeometryPool::Instance, m_global_instance_offset);
+
+        if (m_state->tree_proxy != AabbTree::invalid || m_state->is_unbounded)
+        {
+            lock_guard lock(tree_mutex);
+            tree_removals.push_back({ m_state_slot, m_state->tree_proxy, m_state->is_unbounded });
+        }
+        render_states.Remove(m_state_slot);
     }
 
     void Render::Save(pugi::xml_node& node)
@@ -127,7 +431,7 @@ namespace spartan
         node.append_attribute("flags") = m_flags;
 
         // distances
-        node.append_attribute("max_render_distance") = m_max_distance_render;
+        node.append_attribute("max_render_distance") = m_state->max_distance_render;
         node.append_attribute("max_shadow_distance") = m_max_distance_shadow;
 
         // instances
@@ -247,7 +551,7 @@ namespace spartan
         m_flags = node.attribute("flags").as_uint();
 
         // distances
-        m_max_distance_render = node.attribute("max_render_distance").as_float(FLT_MAX);
+        m_state->max_distance_render = node.attribute("max_render_distance").as_float(FLT_MAX);
         m_max_distance_shadow = node.attribute("max_shadow_distance").as_float(FLT_MAX);
 
         // per-render material overrides, missing attributes keep the nan default which means inherit
@@ -313,84 +617,163 @@ namespace spartan
 
     void Render::Tick()
     {
-        // deferred default material assignment (renderer may not be ready during load)
-        if (m_needs_default_material)
-        {
-            if (Renderer::GetStandardMaterial())
-            {
-                SetDefaultMaterial();
-                m_needs_default_material = false;
-            }
-        }
-
-        UpdateAabb();
+        UpdateBounds();
         UpdateFrustumAndDistanceCulling();
 
         // lod only matters for visible geometry, off-screen props skip the coverage math
-        if (m_is_visible)
+        if (m_state->is_visible)
         {
-            UpdateLodIndices();
+            update_lod(*m_state, get_visibility_camera());
         }
     }
 
-    void Render::UpdateFrustumAndDistanceCulling()
+    void Render::TickBounds()
+    {
+        UpdateBounds();
+        m_state->visibility_pass = visibility_pass;
+        queue_tree_update(m_state_slot, *m_state);
+    }
+
+    void Render::ReserveStates(const uint32_t count)
     {
-        Camera* camera = World::GetCamera();
-        if (!camera)
+        render_states.Reserve(count);
+    }
+
+    void Render::TickVisibility()
+    {
+        SP_PROFILE_CPU();
+
+        const visibility_camera view = get_visibility_camera();
+        const uint32_t pass          = visibility_pass;
+        visibility_pass++;
+
+        const size_t word_count = (render_states.GetSize() + 63) / 64;
+        visible_bits_previous.resize(word_count, 0);
+        visible_bits.assign(word_count, 0);
+
+        update_tree();
+
+        // without a camera everything is visible, there is nothing to cull against
+        if (!view.camera)
         {
-            m_distance_squared = 0.0f;
-            m_is_visible       = true;
+            render_states.ParallelForEach([&view, pass](RenderState& state)
+            {
+                if (state.visibility_pass == pass)
+                {
+                    update_culling(state, view);
+                    update_lod(state, view);
+                }
+            });
+
             return;
         }
 
-        const BoundingBox& bounding_box = GetBoundingBox();
-        const Vector3 center  = bounding_box.GetCenter();
-        const Vector3 extents = bounding_box.GetExtents();
+        // hierarchical frustum and distance cull, renders the world didn't tick this frame (inactive, or still loading) keep their state
+        visible_slots.clear();
+        render_tree.Cull(view.camera->GetFrustum(), &view.position, false, visible_slots);
+        visible_slots.insert(visible_slots.end(), unbounded_slots.begin(), unbounded_slots.end());
+        visible_slots.erase(remove_if(visible_slots.begin(), visible_slots.end(), [pass](const uint32_t slot)
+        {
+            return render_states.Get(slot).visibility_pass != pass;
+        }), visible_slots.end());
 
-        // a non finite bbox would crash the frustum culler assert, treat it as invisible
-        if (center.IsNaN() || extents.IsNaN())
+        // candidates only touch the frustum with their fat leaf, the exact boxes settle visibility in one batch
+        candidate_boxes.Clear();
+        candidate_boxes.Reserve(static_cast<uint32_t>(visible_slots.size()));
+        for (const uint32_t slot : visible_slots)
         {
-            SP_LOG_WARNING("non finite bbox on '%s', marking invisible", GetEntity() ? GetEntity()->GetObjectName().c_str() : "?");
-            m_is_visible       = false;
-            m_distance_squared = 0.0f;
-            return;
+            mark_bit(visible_bits, slot);
+
+            const RenderState& state = render_states.Get(slot);
+            candidate_boxes.Add(state.bounding_box.GetCenter(), state.bounding_box.GetExtents(), state.max_distance_render);
         }
+        view.camera->GetFrustum().CullBatch(candidate_boxes, candidate_visibility, false, &view.position);
 
-        const Vector3 camera_position = camera->GetEntity()->GetPosition();
-        const float max_distance = m_max_distance_render;
-        const float max_distance_sq = max_distance * max_distance;
+        // distances and lods for whatever survived
+        ThreadPool::ParallelFor(static_cast<uint32_t>(visible_slots.size()), [&view](uint32_t start, uint32_t end)
+        {
+            for (uint32_t i = start; i < end; i++)
+            {
+                RenderState& state = render_states.Get(visible_slots[i]);
+                if (state.is_unbounded)
+                {
+                    state.distance_squared = 0.0f;
+                    state.is_visible       = true;
+                }
+                else
+                {
+                    state.is_visible = (candidate_visibility[i >> 6] >> (i & 63)) & 1;
+                    if (state.is_visible)
+                    {
+                        state.distance_squared = Vector3::DistanceSquared(view.position, state.bounding_box.GetClosestPoint(view.position));
+                    }
+                }
+
+                // lod only matters for visible geometry, off-screen props skip the coverage math
+                if (state.is_visible)
+                {
+                    update_lod(state, view);
+                }
+            }
+        }, 256);
 
-        // distance-culled static props stay culled until the camera moves a few meters
-        if (!m_is_visible && m_distance_squared > max_distance_sq)
+        // whatever was a candidate last pass and isn't anymore went out of view, everything else was never in it
+        for (size_t word = 0; word < word_count; word++)
         {
-            const float cam_move_sq = Vector3::DistanceSquared(camera_position, m_cull_camera_position);
-            if (cam_move_sq < 4.0f)
+            uint64_t gone = visible_bits_previous[word] & ~visible_bits[word];
+            while (gone)
             {
-                return;
+                const uint32_t slot = static_cast<uint32_t>(word * 64 + countr_zero(gone));
+                gone &= gone - 1;
+
+                if (slot < render_states.GetSize() && render_states.IsAlive(slot))
+                {
+                    RenderState& state = render_states.Get(slot);
+                    if (state.visibility_pass == pass)
+                    {
+                        state.is_visible = false;
+                    }
+                }
             }
         }
-        m_cull_camera_position = camera_position;
+        visible_bits_previous.swap(visible_bits);
+    }
 
-        // cheap reject before the 6-plane frustum test, center farther than max range plus radius cannot be visible
-        const float radius = max(extents.x, max(extents.y, extents.z)) * 1.7320508f;
-        const float reject_distance = max_distance + radius;
-        const float center_distance_sq = Vector3::DistanceSquared(camera_position, center);
-        if (center_distance_sq > reject_distance * reject_distance)
+    void Render::UpdateBounds()
+    {
+        // deferred default material assignment (renderer may not be ready during load)
+        if (m_needs_default_material)
         {
-            m_is_visible       = false;
-            m_distance_squared = center_distance_sq;
-            return;
+            if (Renderer::GetStandardMaterial())
+            {
+                SetDefaultMaterial();
+                m_needs_default_material = false;
+            }
         }
 
-        if (!camera->IsInViewFrustum(bounding_box))
+        UpdateAabb();
+        UpdateLodInputs();
+    }
+
+    void Render::UpdateLodInputs()
+    {
+        m_state->lod_count    = GetLodCount();
+        m_state->is_instanced = HasInstancing();
+        if (m_state->is_instanced)
         {
-            m_is_visible = false;
-            m_distance_squared = center_distance_sq;
-            return;
+            const Vector3 scale        = GetEntity()->GetScale();
+            const Vector3 mesh_extents = GetLodAabb(0).GetExtents();
+            m_state->lod_extents       = Vector3(
+                mesh_extents.x * abs(scale.x),
+                mesh_extents.y * abs(scale.y),
+                mesh_extents.z * abs(scale.z)
+            );
         }
+    }
 
-        m_distance_squared = Vector3::DistanceSquared(camera_position, bounding_box.GetClosestPoint(camera_position));
-        m_is_visible       = m_distance_squared <= max_distance_sq;
+    void Render::UpdateFrustumAndDistanceCulling()
+    {
+        update_culling(*m_state, get_visibility_camera());
     }
 
     void Render::RegisterForScripting(sol::state_view State)
@@ -466,6 +849,7 @@ namespace spartan
         // set mesh
         m_mesh           = mesh;
         m_sub_mesh_index = sub_mesh_index;
+        ChangeJournal::Record(m_entity_ptr, ChangeType::Mesh);
 
         // compute and set bounding box (GetGeometry validates bounds internally)
         vector<RHI_Vertex_PosTexNorTan> vertices;
@@ -490,7 +874,8 @@ namespace spartan
         m_sub_mesh_index    = 0;
         m_bounding_box_mesh = BoundingBox::Unit;
         m_bounding_box_dirty = true;
-        m_lod_index          = 0;
+        m_state->lod_index   = 0;
+        ChangeJournal::Record(m_entity_ptr, ChangeType::Mesh);
     }
 
     void Render::GetGeometry(vector<uint32_t>* indices, vector<RHI_Vertex_PosTexNorTan>* vertices) const
@@ -596,6 +981,7 @@ namespace spartan
             SP_LOG_ERROR("Material was unable to be cached, and failed to be set.")
             return;
         }
+        ChangeJournal::Record(m_entity_ptr, ChangeType::Material);
 
         // pack textures, generate mips, compress, upload to GPU
         if (m_material->GetResourceState() == ResourceState::Max)
@@ -805,6 +1191,9 @@ namespace spartan
 
     void Render::SetInstances(const vector<Instance>& instances)
     {
+        // the previous block goes back to the pool, offset 0 is the shared identity and is left alone
+        GeometryBuffer::Free(GeometryPool::Instance, m_global_instance_offset);
+
         if (instances.empty())
         {
             m_instances.clear();
@@ -816,7 +1205,19 @@ namespace spartan
         m_instances = instances;
 
         // append into the global instance pool so the indirect path can read instance attrs by offset + sv_instanceid
-        m_global_instance_offset = GeometryBuffer::AppendInstances(m_instances.data(), static_cast<uint32_t>(m_instances.size()));
+        // the defragmenter may move the block, the instances are re-uploaded from m_instances as long as it still matches
+        const uint32_t count     = static_cast<uint32_t>(m_instances.size());
+        m_global_instance_offset = GeometryBuffer::AppendInstances(m_instances.data(), count, [this, count](const uint32_t offset)
+        {
+            if (m_instances.size() != count)
+            {
+                return false;
+            }
+
+            GeometryBuffer::UpdateInstances(m_instances.data(), offset, count);
+            m_global_instance_offset = offset;
+            return true;
+        });
 
         m_bounding_box_dirty = true;
         Tick(); // update bounding boxes, frustum and distance culling
@@ -876,7 +1277,7 @@ namespace spartan
 
     void Render::SetBoundingBoxOverride(const BoundingBox& world_box)
     {
-        m_bounding_box = world_box;
+        m_state->bounding_box   = world_box;
         m_bounding_box_override = true;
         m_bounding_box_dirty = false;
         UpdateFrustumAndDistanceCulling();
@@ -907,7 +1308,7 @@ namespace spartan
         const Matrix transform = (GetEntity() && GetEntity()->GetActive()) ? GetEntity()->GetMatrix() : Matrix::Identity;
 
         // refuse to fold a non finite transform into the world bbox, doing so would
-        // poison m_bounding_box with NaN and trip the frustum culler assert downstream
+        // poison the world bbox with NaN and trip the frustum culler assert downstream
         if (!transform.IsFinite())
         {
             SP_LOG_WARNING("non finite world matrix on '%s', keeping last bbox", GetEntity() ? GetEntity()->GetObjectName().c_str() : "?");
@@ -918,15 +1319,16 @@ namespace spartan
         {
             if (m_instances.empty()) // non-instanced
             {
-                m_bounding_box = m_bounding_box_mesh * transform;
+                m_state->bounding_box = m_bounding_box_mesh * transform;
             }
             else // instanced
             {
-                m_bounding_box = BoundingBox(Vector3::Infinity, Vector3::InfinityNeg);
+                BoundingBox& bounding_box = m_state->bounding_box;
+                bounding_box = BoundingBox(Vector3::Infinity, Vector3::InfinityNeg);
                 for (const Instance& instance : m_instances)
                 {
                     Matrix world_instance = instance.GetMatrix() * transform;
-                    m_bounding_box.Merge(m_bounding_box_mesh * world_instance);
+                    bounding_box.Merge(m_bounding_box_mesh * world_instance);
                 }
             }
             m_transform_previous = transform;
@@ -936,96 +1338,7 @@ namespace spartan
 
     void Render::UpdateLodIndices()
     {
-        // screen coverage handles distance, object size and fov uniformly with no per-type special cases
-
-        const uint32_t lod_count = GetLodCount();
-        if (lod_count == 0)
-        {
-            m_lod_index = 0;
-            return;
-        }
-
-        Camera* camera = World::GetCamera();
-        if (!camera)
-        {
-            m_lod_index = lod_count - 1;
-            return;
-        }
-
-        const BoundingBox& box        = GetBoundingBox();
-        const Vector3 camera_position = camera->GetEntity()->GetPosition();
-
-        // camera inside bounding box = maximum detail
-        if (box.Contains(camera_position))
-        {
-            m_lod_index = 0;
-            return;
-        }
-
-        // distance from camera to closest point on bounding box
-        Vector3 closest_point = box.GetClosestPoint(camera_position);
-        float distance        = max((closest_point - camera_position).Length(), 0.001f);
-
-        // an instanced renderable's box spans every instance it carries, so a tile of trees measures
-        // hundreds of metres across and scores full coverage from any distance, which pins the whole
-        // tile at lod 0 forever, the coverage has to come from the size of one instance while the box
-        // keeps supplying the distance
-        Vector3 measured_extents = box.GetExtents();
-        if (HasInstancing())
-        {
-            const Vector3 scale        = GetEntity()->GetScale();
-            const Vector3 mesh_extents = GetLodAabb(0).GetExtents();
-            measured_extents           = Vector3(
-                mesh_extents.x * abs(scale.x),
-                mesh_extents.y * abs(scale.y),
-                mesh_extents.z * abs(scale.z)
-            );
-        }
-
-        // compute screen-space coverage: fraction of vertical screen space the object covers
-        // screen_fraction = (object_diameter) / (visible_height_at_distance)
-        // visible_height_at_distance = 2 * distance * tan(fov_v / 2)
-        float bounding_diameter = measured_extents.Length() * 2.0f;
-        float tan_half_fov      = tan(camera->GetFovVerticalRad() * 0.5f);
-        float screen_fraction   = bounding_diameter / (2.0f * distance * tan_half_fov);
-
-        // screen height coverage each lod requires, calibrated so the transitions stay imperceptible
-        static constexpr array<float, 5> screen_thresholds =
-        {
-            0.05f,   // lod0: object covers >= 5% of screen height
-            0.025f,  // lod1: object covers >= 2.5% of screen height
-            0.012f,  // lod2: object covers >= 1.2% of screen height
-            0.006f,  // lod3: object covers >= 0.6% of screen height
-            0.003f   // lod4: object covers >= 0.3% of screen height
-        };
-
-        // hysteresis against lod popping, a change requires passing the threshold by 10 percent in either direction
-        constexpr float hysteresis = 1.1f;
-
-        uint32_t new_lod = lod_count - 1;
-        for (uint32_t i = 0; i < min(lod_count, static_cast<uint32_t>(screen_thresholds.size())); i++)
-        {
-            float threshold = screen_thresholds[i];
-
-            // apply hysteresis based on relationship to current lod
-            if (i < m_lod_index)
-            {
-                // upgrading to higher detail: raise the bar
-                threshold *= hysteresis;
-            }
-            else if (i == m_lod_index)
-            {
-                // staying at current lod: lower the bar (easier to stay)
-                threshold /= hysteresis;
-            }
-
-            if (screen_fraction >= threshold)
-            {
-                new_lod = i;
-                break;
-            }
-        }
-
-        m_lod_index = clamp(new_lod, 0u, lod_count - 1);
+        UpdateLodInputs();
+        update_lod(*m_state, get_visibility_camera());
     }
 }
@@ -27,6 +27,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <limits>
 #include "../../math/Matrix.h"
 #include "../../math/BoundingBox.h"
+#include "../../math/Frustum.h"
 #include "../geometry/Mesh.h"
 #include "../rendering/Renderer_Definitions.h"
 #include "../../rendering/Instance.h"
@@ -35,6 +36,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 namespace spartan
 {
     class Material;
+    class Render;
 
     enum RenderFlags : uint32_t
     {
@@ -59,6 +61,24 @@ namespace spartan
         static float unset()         { return std::numeric_limits<float>::quiet_NaN(); }
     };
 
+    // per-frame culling and lod state, kept contiguous across every render so the visibility pass streams through it
+    struct RenderState
+    {
+        math::BoundingBox bounding_box     = math::BoundingBox::Unit;
+        math::Vector3 lod_extents          = math::Vector3::Zero; // one instance's extents, instanced boxes span the whole batch
+        float max_distance_render          = FLT_MAX;
+        float distance_squared             = 0.0f; // refreshed while visible, off-screen states keep the last value
+        uint32_t lod_index                 = 0;
+        uint32_t lod_count                 = 0;
+        uint32_t visibility_pass           = 0; // the pass this state was queued for by TickBounds()
+        uint32_t tree_proxy                = UINT32_MAX; // leaf in the culling tree, none while unbounded or not yet inserted
+        bool tree_queued                   = false; // bounds or reach left the tree's leaf, resolved by the next visibility pass
+        bool is_unbounded                  = false; // infinite bounds, always visible and kept out of the tree
+        bool is_visible                    = false;
+        bool is_instanced                  = false;
+        Render* owner                      = nullptr;
+    };
+
     // makes an entity drawable, it owns the mesh, the material and the per-frame lod and visibility state
     class Render : public Component
     {
@@ -71,6 +91,15 @@ namespace spartan
         void Load(pugi::xml_node& node) override;
         void Tick() override;
 
+        // split tick for the world, TickBounds() runs per entity and TickVisibility() then culls
+        // and picks lods for every render queued this frame straight from the contiguous states
+        // culling walks a bounding volume hierarchy of every render, so it costs what is visible rather than what exists
+        void TickBounds();
+        static void TickVisibility();
+
+        // batch instantiation reserves state slots before workers construct the components
+        static void ReserveStates(uint32_t count);
+
         static void RegisterForScripting(sol::state_view State);
         sol::reference AsLua(sol::state_view state) override;
 
@@ -80,7 +109,7 @@ namespace spartan
         void ClearMesh();
         void GetGeometry(std::vector<uint32_t>* indices, std::vector<RHI_Vertex_PosTexNorTan>* vertices) const;
         uint32_t GetLodCount() const;
-        uint32_t GetLodIndex() const { return m_lod_index; }
+        uint32_t GetLodIndex() const { return m_state->lod_index; }
         uint32_t GetIndexOffset(const uint32_t lod = 0) const;
         uint32_t GetIndexCount(const uint32_t lod = 0) const;
         uint32_t GetVertexOffset(const uint32_t lod = 0) const;
@@ -107,7 +136,7 @@ namespace spartan
         bool GetAllowBlasUpdate() const { return m_allow_blas_update; }
 
         // bounding box
-        const math::BoundingBox& GetBoundingBox() const     { return m_bounding_box; }
+        const math::BoundingBox& GetBoundingBox() const     { return m_state->bounding_box; }
         const math::BoundingBox& GetBoundingBoxMesh() const { return m_bounding_box_mesh; }
         // world aabb that ignores entity transform, for ragdoll/cloth etc
         void SetBoundingBoxOverride(const math::BoundingBox& world_box);
@@ -145,17 +174,17 @@ namespace spartan
         void SetInstances(const std::vector<math::Matrix>& transforms);
 
         // render distance
-        float GetMaxRenderDistance() const                         { return m_max_distance_render; }
-        void SetMaxRenderDistance(const float max_render_distance) { m_max_distance_render = max_render_distance; }
+        float GetMaxRenderDistance() const                         { return m_state->max_distance_render; }
+        void SetMaxRenderDistance(const float max_render_distance) { m_state->max_distance_render = max_render_distance; }
 
         // shadow distance
         float GetMaxShadowDistance() const                         { return m_max_distance_shadow; }
         void SetMaxShadowDistance(const float max_shadow_distance) { m_max_distance_shadow = max_shadow_distance; }
 
         // distance & visibility
-        float GetDistanceSquared() const    { return m_distance_squared; }
-        bool IsVisible() const              { return m_is_visible; }
-        void SetVisible(const bool visible) { m_is_visible = visible; }
+        float GetDistanceSquared() const    { return m_state->distance_squared; }
+        bool IsVisible() const              { return m_state->is_visible; }
+        void SetVisible(const bool visible) { m_state->is_visible = visible; }
 
         // flags
         bool HasFlag(const RenderFlags flag) const { return m_flags & flag; }
@@ -170,6 +199,8 @@ namespace spartan
         void UpdateLodIndices();
 
     private:
+        void UpdateBounds();
+        void UpdateLodInputs();
 
         // geometry/mesh
         Mesh* m_mesh                          = nullptr;
@@ -177,7 +208,6 @@ namespace spartan
         bool m_bounding_box_dirty             = true;
         bool m_bounding_box_override          = false;
         math::BoundingBox m_bounding_box_mesh = math::BoundingBox::Unit;
-        math::BoundingBox m_bounding_box      = math::BoundingBox::Unit;
 
         // material
         bool m_material_default = false;
@@ -199,13 +229,10 @@ namespace spartan
         // deferred default material assignment (renderer may not be ready during load)
         bool m_needs_default_material = false;
 
-        // visibility & lods
-        float m_max_distance_render = FLT_MAX;
+        // visibility & lods, the hot part lives in the contiguous render states
+        uint32_t m_state_slot       = 0;
+        RenderState* m_state        = nullptr;
         float m_max_distance_shadow = FLT_MAX;
-        float m_distance_squared    = 0.0f;
-        bool m_is_visible           = false;
-        uint32_t m_lod_index        = 0;
         uint64_t m_previous_lights  = 0; // lights whose frustums this entity was in last frame
-        math::Vector3 m_cull_camera_position = math::Vector3::Zero;
     };
 }
@@ -4,6 +4,7 @@
 #include "world/Entity.h"
 #include "world/World.h"
 #include "Light.h"
+#include "../../profiling/Profiler.h"
 
 using namespace spartan;
 
@@ -46,6 +47,48 @@ namespace
         }
     }
 
+    template<typename... Args>
+    void call_checked(const sol::protected_function& function, Args&&... args)
+    {
+        if (!function.valid())
+        {
+            return;
+        }
+
+        sol::protected_function_result result = function(std::forward<Args>(args)...);
+        if (!result.valid())
+        {
+            sol::error error = result;
+            SP_LOG_ERROR("[LUA SCRIPT ERROR] - %s", error.what())
+        }
+    }
+
+    // the profiler keeps the name pointer of every time block, so names live as long as the process
+    const char* intern_profile_name(const std::string& path)
+    {
+        static std::set<std::string> names;
+        return names.insert("Script: " + FileSystem::GetFileNameFromFilePath(path)).first->c_str();
+    }
+
+    // every instance of a system script, by file, the views table is reused across frames
+    struct system_group
+    {
+        std::vector<Script*> scripts;
+        sol::table views;
+        uint32_t view_count = 0;
+    };
+    std::unordered_map<std::string, system_group> system_groups;
+
+    void unregister_system(Script* instance)
+    {
+        // empty groups go right away, their views table must not outlive the lua state
+        for (auto it = system_groups.begin(); it != system_groups.end();)
+        {
+            std::erase(it->second.scripts, instance);
+            it = it->second.scripts.empty() ? system_groups.erase(it) : std::next(it);
+        }
+    }
+
     void save_lua_table(pugi::xml_node& node, const sol::table& table)
     {
         for (auto& [key, value] : table)
@@ -63,15 +106,79 @@ namespace
 Script::Script(Entity* Entity)
     :Component(Entity)
 {
-    RegisterAttribute("file_path", "std::string",
-        [this]()
+    SP_REGISTER_ATTRIBUTE_VALUE_SET(file_path, LoadScriptFile, std::string);
+}
+
+Script::~Script()
+{
+    unregister_system(this);
+}
+
+void Script::RegisterForScripting(sol::state_view state)
+{
+    state.new_usertype<TransformView>("TransformView",
+        sol::no_constructor,
+        "GetEntity",        &TransformView::GetEntity,
+        "IsValid",          &TransformView::IsValid,
+        "GetPosition",      &TransformView::GetPosition,
+        "SetPosition",      &TransformView::SetPosition,
+        "GetPositionLocal", &TransformView::GetPositionLocal,
+        "SetPositionLocal", &TransformView::SetPositionLocal,
+        "GetRotation",      &TransformView::GetRotation,
+        "SetRotation",      &TransformView::SetRotation,
+        "GetScale",         &TransformView::GetScale,
+        "SetScale",         &TransformView::SetScale,
+        "GetForward",       &TransformView::GetForward,
+        "Translate",        &TransformView::Translate
+    );
+}
+
+void Script::TickSystems()
+{
+    if (!is_simulation_active() || system_groups.empty())
+    {
+        return;
+    }
+
+    sol::state_view lua = World::GetLuaState();
+    for (auto& [path, group] : system_groups)
+    {
+        if (group.scripts.empty())
         {
-            return file_path;
-        },
-        [this](const std::any& value)
+            continue;
+        }
+
+        if (!group.views.valid())
         {
-            LoadScriptFile(std::any_cast<std::string>(value));
-        });
+            group.views = lua.create_table(static_cast<int>(group.scripts.size()), 0);
+        }
+
+        // the table is reused across frames, stale slots past the new count are cleared so ipairs stops at count
+        uint32_t count = 0;
+        for (Script* instance : group.scripts)
+        {
+            Entity* entity = instance->GetEntity();
+            if (entity && entity->GetActive())
+            {
+                group.views[++count] = TransformView{ entity->GetHandle() };
+            }
+        }
+        for (uint32_t i = count + 1; i <= group.view_count; i++)
+        {
+            group.views[i] = sol::lua_nil;
+        }
+        group.view_count = count;
+
+        if (count == 0)
+        {
+            continue;
+        }
+
+        Script* first = group.scripts.front();
+        SP_PROFILE_CPU_START(first->m_profile_name);
+        call_checked(first->m_tick_system, first->script, group.views, count);
+        SP_PROFILE_CPU_END();
+    }
 }
 
 sol::reference Script::AsLua(sol::state_view state)
@@ -103,94 +210,73 @@ void Script::LoadScriptFile(std::string_view path)
     file_path.assign(path.data(), path.size());
 
     script = ReturnValue;
-
+    ResolveFunctions();
 }
 
-void Script::Initialize()
+void Script::ResolveFunctions()
 {
-    if (script.valid())
+    unregister_system(this);
+
+    m_initialize   = script["Initialize"];
+    m_start        = script["Start"];
+    m_stop         = script["Stop"];
+    m_remove       = script["Remove"];
+    m_pre_tick     = script["PreTick"];
+    m_tick         = script["Tick"];
+    m_tick_system  = script["TickSystem"];
+    m_save         = script["Save"];
+    m_load         = script["Load"];
+    m_profile_name = intern_profile_name(file_path);
+
+    if (m_tick_system.valid())
     {
-        sol::protected_function TickFunction = script["Initialize"];
-        if (TickFunction.valid())
-        {
-            (void)TickFunction(script, GetEntity());
-        }
+        system_groups[file_path].scripts.push_back(this);
     }
 }
 
+void Script::Initialize()
+{
+    call_checked(m_initialize, script, GetEntity());
+}
+
 void Script::Start()
 {
-    if (script.valid())
-    {
-        sol::protected_function TickFunction = script["Start"];
-        if (TickFunction.valid())
-        {
-            (void)TickFunction(script, GetEntity());
-        }
-    }
+    call_checked(m_start, script, GetEntity());
 }
 
 void Script::Stop()
 {
-    if (script.valid())
-    {
-        sol::protected_function TickFunction = script["Stop"];
-        if (TickFunction.valid())
-        {
-            (void)TickFunction(script, GetEntity());
-        }
-    }
+    call_checked(m_stop, script, GetEntity());
 }
 
 void Script::Remove()
 {
-    if (script.valid())
-    {
-        sol::protected_function TickFunction = script["Remove"];
-        if (TickFunction.valid())
-        {
-            (void)TickFunction(script, GetEntity());
-        }
-    }
+    call_checked(m_remove, script, GetEntity());
 }
 
 void Script::PreTick()
 {
-    if (!is_simulation_active())
+    if (!is_simulation_active() || !m_pre_tick.valid())
     {
         return;
     }
 
-    if (script.valid())
-    {
-        sol::protected_function TickFunction = script["PreTick"];
-        if (TickFunction.valid())
-        {
-            (void)TickFunction(script, GetEntity());
-        }
-    }
+    SP_PROFILE_CPU_START(m_profile_name);
+    call_checked(m_pre_tick, script, GetEntity());
+    SP_PROFILE_CPU_END();
 }
 
 void Script::Tick()
 {
-    if (!is_simulation_active())
+    // system scripts are ticked together from TickSystems()
+    if (!is_simulation_active() || !m_tick.valid() || m_tick_system.valid())
     {
         return;
     }
 
-    if (script.valid())
-    {
-        sol::protected_function TickFunction = script["Tick"];
-        if (TickFunction.valid())
-        {
-            sol::protected_function_result Result = TickFunction(script, GetEntity());
-            if (!Result.valid())
-            {
-                sol::error Error = Result;
-                SP_LOG_ERROR("[LUA SCRIPT ERROR] - %s", Error.what())
-            }
-        }
-    }
+    SP_PROFILE_CPU_START(m_profile_name);
+    call_checked(m_tick, script, GetEntity());
+    SP_PROFILE_CPU_END();
 }
 
 void Script::Save(pugi::xml_node& node)
@@ -199,10 +285,9 @@ void Script::Save(pugi::xml_node& node)
 
     if (script.valid())
     {
-        sol::protected_function TickFunction = script["Save"];
-        if (TickFunction.valid())
+        if (m_save.valid())
         {
-            sol::protected_function_result Result = TickFunction(script, GetEntity());
+            sol::protected_function_result Result = m_save(script, GetEntity());
             if (!Result.valid())
             {
                 sol::error Error = Result;
@@ -302,26 +387,87 @@ void Script::LoadInternal(pugi::xml_node& node)
         }
 
         // run the load-time builder hook now that the script file and its properties are in place
-        sol::protected_function InitializeFunction = script["Initialize"];
-        if (InitializeFunction.valid())
-        {
-            sol::protected_function_result Result = InitializeFunction(script, GetEntity());
-            if (!Result.valid())
-            {
-                sol::error Error = Result;
-                SP_LOG_ERROR("[LUA SCRIPT ERROR] - %s", Error.what())
-            }
-        }
+        call_checked(m_initialize, script, GetEntity());
+        call_checked(m_load, script, GetEntity(), saved_data);
+    }
+}
 
-        sol::protected_function TickFunction = script["Load"];
-        if (TickFunction.valid())
-        {
-            sol::protected_function_result Result = TickFunction(script, GetEntity(), saved_data);
-            if (!Result.valid())
-            {
-                sol::error Error = Result;
-                SP_LOG_ERROR("[LUA SCRIPT ERROR] - %s", Error.what())
-            }
-        }
+Entity* TransformView::GetEntity() const
+{
+    return World::GetEntity(handle);
+}
+
+bool TransformView::IsValid() const
+{
+    return World::IsAlive(handle);
+}
+
+math::Vector3 TransformView::GetPosition() const
+{
+    Entity* entity = World::GetEntity(handle);
+    return entity ? entity->GetPosition() : math::Vector3::Zero;
+}
+
+void TransformView::SetPosition(const math::Vector3& position) const
+{
+    if (Entity* entity = World::GetEntity(handle))
+    {
+        entity->SetPosition(position);
+    }
+}
+
+math::Vector3 TransformView::GetPositionLocal() const
+{
+    Entity* entity = World::GetEntity(handle);
+    return entity ? entity->GetPositionLocal() : math::Vector3::Zero;
+}
+
+void TransformView::SetPositionLocal(const math::Vector3& position) const
+{
+    if (Entity* entity = World::GetEntity(handle))
+    {
+        entity->SetPositionLocal(position);
+    }
+}
+
+math::Quaternion TransformView::GetRotation() const
+{
+    Entity* entity = World::GetEntity(handle);
+    return entity ? entity->GetRotation() : math::Quaternion::Identity;
+}
+
+void TransformView::SetRotation(const math::Quaternion& rotation) const
+{
+    if (Entity* entity = World::GetEntity(handle))
+    {
+        entity->SetRotation(rotation);
+    }
+}
+
+math::Vector3 TransformView::GetScale() const
+{
+    Entity* entity = World::GetEntity(handle);
+    return entity ? entity->GetScale() : math::Vector3::One;
+}
+
+void TransformView::SetScale(const math::Vector3& scale) const
+{
+    if (Entity* entity = World::GetEntity(handle))
+    {
+        entity->SetScale(scale);
+    }
+}
+
+math::Vector3 TransformView::GetForward() const
+{
+    Entity* entity = World::GetEntity(handle);
+    return entity ? entity->GetForward() : math::Vector3::Forward;
+}
+
+void TransformView::Translate(const math::Vector3& delta) const
+{
+    if (Entity* entity = World::GetEntity(handle))
+    {
+        entity->Translate(delta);
     }
 }
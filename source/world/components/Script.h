@@ -1,17 +1,46 @@
 #pragma once
 
 #include "Component.h"
+#include "../World.h"
+#include "../../math/Quaternion.h"
 SP_WARNINGS_OFF
 #include "sol/sol.hpp"
 SP_WARNINGS_ON
 
 namespace spartan
 {
+    // a typed view of an entity transform for lua, holds a generational handle instead of the full Entity binding
+    // so hot per-frame transform reads and writes go through a handful of direct calls, a removed entity reads as identity
+    struct TransformView
+    {
+        EntityHandle handle;
+
+        Entity* GetEntity() const;
+        bool IsValid() const;
+        math::Vector3 GetPosition() const;
+        void SetPosition(const math::Vector3& position) const;
+        math::Vector3 GetPositionLocal() const;
+        void SetPositionLocal(const math::Vector3& position) const;
+        math::Quaternion GetRotation() const;
+        void SetRotation(const math::Quaternion& rotation) const;
+        math::Vector3 GetScale() const;
+        void SetScale(const math::Vector3& scale) const;
+        math::Vector3 GetForward() const;
+        void Translate(const math::Vector3& delta) const;
+    };
+
     class Script : public Component
     {
     public:
 
         Script(Entity* Entity);
+        ~Script() override;
+
+        static void RegisterForScripting(sol::state_view state);
+
+        // scripts whose table defines TickSystem(self, views, count) don't tick per entity, every instance
+        // of the same file is gathered into one array of TransformViews and updated with a single lua call
+        static void TickSystems();
 
         sol::reference AsLua(sol::state_view state) override;
 
@@ -24,6 +53,7 @@ namespace spartan
         void Tick() override;
         void Save(pugi::xml_node& node) override;
         void Load(pugi::xml_node& node) override;
+        bool IsSystem() const { return m_tick_system.valid(); }
 
 
         std::string file_path;
@@ -32,5 +62,19 @@ namespace spartan
     private:
         // loads the script file, applies serialized properties and runs the lua initialize and load hooks
         void LoadInternal(pugi::xml_node& node);
+
+        // looked up by name once per script load instead of on every call
+        void ResolveFunctions();
+
+        sol::protected_function m_initialize;
+        sol::protected_function m_start;
+        sol::protected_function m_stop;
+        sol::protected_function m_remove;
+        sol::protected_function m_pre_tick;
+        sol::protected_function m_tick;
+        sol::protected_function m_tick_system;
+        sol::protected_function m_save;
+        sol::protected_function m_load;
+        const char* m_profile_name = "Script";
     };
 }
@@ -258,6 +258,7 @@ namespace spartan
         trail.mesh->SetFlag(static_cast<uint32_t>(MeshFlags::PostProcessOptimize), false);
         trail.mesh->SetFlag(static_cast<uint32_t>(MeshFlags::PostProcessNormalizeScale), false);
         trail.mesh->AddGeometry(vertices, indices, false);
+        trail.mesh->SetDynamic(true); // quads are written in place through a cached offset, so the block has to stay put
         trail.mesh->CreateGpuBuffers();
 
         // a standalone, identity-transform entity so world-space vertices are not transformed twice
@@ -801,9 +801,11 @@ namespace spartan
 
         const Matrix instance_world_matrix   = m_entity_ptr->GetMatrix();
         const Matrix instance_inverse_matrix = instance_world_matrix.Inverted();
+        const Vector3 instance_scale         = template_entity ? template_entity->GetScaleLocal() : Vector3::One;
 
+        // place every instance first, so template clones can be instantiated as one batch
+        vector<Matrix> transforms;
         float next_spawn_distance = 0.0f;
-        uint32_t spawned          = 0;
 
         for (uint32_t i = 0; i < frames.size(); i++)
         {
@@ -829,23 +831,6 @@ namespace spartan
 
             for (int side : sides)
             {
-                Entity* instance = nullptr;
-                if (template_entity)
-                {
-                    instance = template_entity->Clone();
-                }
-                else
-                {
-                    instance = World::CreateEntity();
-                    Render* render = instance->AddComponent<Render>();
-                    render->SetMesh(MeshType::Cylinder);
-                    render->SetDefaultMaterial();
-                }
-
-                instance->SetObjectName(prefix_instance + to_string(spawned));
-                instance->SetParent(m_entity_ptr);
-                instance->SetTransient(true);
-
                 // base position + lateral offset + optional random jitter
                 Vector3 final_position = position + right * (m_instance_lateral_offset * static_cast<float>(side));
                 if (m_instance_random_offset > 0.0f)
@@ -854,8 +839,6 @@ namespace spartan
                     final_position = final_position + right * jitter;
                 }
 
-                instance->SetPositionLocal(final_position);
-
                 // rotation: face inward overrides align-to-spline; optional random yaw on top
                 Quaternion rotation = Quaternion::Identity;
                 if (m_instance_face_inward)
@@ -887,56 +870,85 @@ namespace spartan
                     float yaw = math::random<float>(-m_instance_random_yaw, m_instance_random_yaw);
                     rotation  = rotation * Quaternion::FromAxisAngle(Vector3::Up, yaw * math::deg_to_rad);
                 }
-                instance->SetRotationLocal(rotation);
 
                 // random scale
+                Vector3 scale = instance_scale;
                 if (m_instance_random_scale_min != 1.0f || m_instance_random_scale_max != 1.0f)
                 {
-                    float scale = math::random<float>(m_instance_random_scale_min, m_instance_random_scale_max);
-                    instance->SetScaleLocal(Vector3(scale, scale, scale));
+                    float scale_random = math::random<float>(m_instance_random_scale_min, m_instance_random_scale_max);
+                    scale              = Vector3(scale_random, scale_random, scale_random);
                 }
 
-                // the lateral offset moves the instance off the centerline, so it needs its own ground
-                // sample, and it has to rest on its base rather than on whatever the pivot happens to be
-                if (m_conform_to_terrain)
-                {
-                    Vector3 world_position = instance_world_matrix * final_position;
-                    float ground_height    = 0.0f;
-                    bool grounded          = false;
+                transforms.emplace_back(final_position, rotation, scale);
+            }
 
-                    if (Terrain* terrain = Terrain::FindActive())
-                    {
-                        grounded = terrain->SampleHeight(world_position.x, world_position.z, ground_height);
-                    }
+            next_spawn_distance += m_instance_spacing;
+        }
 
-                    if (!grounded)
-                    {
-                        PhysicsRaycastHit hit;
-                        if (PhysicsWorld::RaycastStatic(
-                            Vector3(world_position.x, world_position.y + 500.0f, world_position.z),
-                            Vector3::Down,
-                            5000.0f,
-                            hit,
-                            m_entity_ptr
-                        ))
-                        {
-                            ground_height = hit.position.y;
-                            grounded      = true;
-                        }
-                    }
+        vector<Entity*> instances;
+        if (template_entity)
+        {
+            World::InstantiateBatch(template_entity, static_cast<uint32_t>(transforms.size()), transforms, instances, m_entity_ptr);
+        }
+        else
+        {
+            for (const Matrix& transform : transforms)
+            {
+                Entity* instance = World::CreateEntity();
+                Render* render   = instance->AddComponent<Render>();
+                render->SetMesh(MeshType::Cylinder);
+                render->SetDefaultMaterial();
+                instance->SetParent(m_entity_ptr);
+                instance->SetPositionLocal(transform.GetTranslation());
+                instance->SetRotationLocal(transform.GetRotation());
+                instance->SetScaleLocal(transform.GetScale());
+                instances.push_back(instance);
+            }
+        }
 
-                    if (grounded)
+        uint32_t spawned = 0;
+        for (Entity* instance : instances)
+        {
+            instance->SetObjectName(prefix_instance + to_string(spawned));
+            instance->SetTransient(true);
+
+            // the lateral offset moves the instance off the centerline, so it needs its own ground
+            // sample, and it has to rest on its base rather than on whatever the pivot happens to be
+            if (m_conform_to_terrain)
+            {
+                Vector3 world_position = instance_world_matrix * instance->GetPositionLocal();
+                float ground_height    = 0.0f;
+                bool grounded          = false;
+
+                if (Terrain* terrain = Terrain::FindActive())
+                {
+                    grounded = terrain->SampleHeight(world_position.x, world_position.z, ground_height);
+                }
+
+                if (!grounded)
+                {
+                    PhysicsRaycastHit hit;
+                    if (PhysicsWorld::RaycastStatic(
+                        Vector3(world_position.x, world_position.y + 500.0f, world_position.z),
+                        Vector3::Down,
+                        5000.0f,
+                        hit,
+                        m_entity_ptr
+                    ))
                     {
-                        world_position.y = ground_height + m_terrain_offset + pivot_to_bottom(instance);
-                        final_position   = instance_inverse_matrix * world_position;
-                        instance->SetPositionLocal(final_position);
+                        ground_height = hit.position.y;
+                        grounded      = true;
                     }
                 }
 
-                spawned++;
+                if (grounded)
+                {
+                    world_position.y = ground_height + m_terrain_offset + pivot_to_bottom(instance);
+                    instance->SetPositionLocal(instance_inverse_matrix * world_position);
+                }
             }
 
-            next_spawn_distance += m_instance_spacing;
+            spawned++;
         }
 
         SP_LOG_INFO("spawned %u instances along spline (%.1f m, spacing %.1f m)", spawned, spline_length, m_instance_spacing);
@@ -55,7 +55,12 @@ namespace spartan
     void SplineFollower::SetSplineEntityId(uint64_t id)
     {
         m_spline_entity_id = id;
-        m_spline_entity    = nullptr; // invalidate so it gets resolved on next tick
+        m_spline_entity    = EntityHandle(); // invalidate so it gets resolved on next tick
+    }
+
+    Entity* SplineFollower::GetSplineEntity() const
+    {
+        return World::GetEntity(m_spline_entity);
     }
 
     void SplineFollower::Start()
@@ -69,7 +74,7 @@ namespace spartan
 
     void SplineFollower::Stop()
     {
-        m_spline_entity   = nullptr;
+        m_spline_entity   = EntityHandle();
         m_wheels_resolved = false;
         m_wheels.clear();
     }
@@ -287,18 +292,20 @@ namespace spartan
 
     Spline* SplineFollower::GetValidSpline()
     {
-        // resolve the spline entity pointer if needed
-        if (!m_spline_entity)
+        // resolve the spline entity handle if needed, a removed spline entity resolves again by id
+        Entity* spline_entity = World::GetEntity(m_spline_entity);
+        if (!spline_entity)
         {
             ResolveSplineEntity();
-            if (!m_spline_entity)
+            spline_entity = World::GetEntity(m_spline_entity);
+            if (!spline_entity)
             {
                 return nullptr;
             }
         }
 
         // grab the spline component from the referenced entity
-        Spline* spline = m_spline_entity->GetComponent<Spline>();
+        Spline* spline = spline_entity->GetComponent<Spline>();
         if (!spline || spline->GetControlPointCount() < 2)
         {
             return nullptr;
@@ -337,7 +344,7 @@ namespace spartan
         m_max_steer_angle  = node.attribute("max_steer_angle").as_float(35.0f);
 
         // the entity pointer will be resolved on the first tick or when play starts
-        m_spline_entity   = nullptr;
+        m_spline_entity   = EntityHandle();
         m_wheels_resolved = false;
     }
 
@@ -345,7 +352,8 @@ namespace spartan
     {
         if (m_spline_entity_id != 0)
         {
-            m_spline_entity = World::GetEntityById(m_spline_entity_id);
+            Entity* spline_entity = World::GetEntityById(m_spline_entity_id);
+            m_spline_entity       = spline_entity ? spline_entity->GetHandle() : EntityHandle();
         }
     }
 }
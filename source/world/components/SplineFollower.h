@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =====================
 #include "Component.h"
+#include "../World.h"
 #include "../../math/Quaternion.h"
 #include <vector>
 //================================
@@ -48,6 +49,7 @@ namespace spartan
 
         // lifecycle
         void Start() override;
+        bool IsStartThreadSafe() const override { return true; } // resets itself and resolves its spline by id
         void Stop() override;
         void Tick() override;
 
@@ -58,7 +60,7 @@ namespace spartan
         // spline entity reference
         uint64_t GetSplineEntityId() const            { return m_spline_entity_id; }
         void SetSplineEntityId(uint64_t id);
-        Entity* GetSplineEntity() const               { return m_spline_entity; }
+        Entity* GetSplineEntity() const;
 
         // movement properties
         float GetSpeed() const                        { return m_speed; }
@@ -108,7 +110,7 @@ namespace spartan
         uint64_t m_spline_entity_id = 0;
 
         // runtime pointer to the spline entity (not persisted)
-        Entity* m_spline_entity = nullptr;
+        EntityHandle m_spline_entity; // resolves to null once the spline entity is removed
 
         // movement speed in world units per second
         float m_speed = 5.0f;
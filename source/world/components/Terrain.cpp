@@ -775,29 +775,16 @@ namespace spartan
             SP_ASSERT(!tile_triangle_data.empty());
 
             // compute tile bounds using parallel reduction
-            uint32_t tri_count_bounds = static_cast<uint32_t>(tile_triangle_data.size());
-            uint32_t num_chunks = min(tri_count_bounds, static_cast<uint32_t>(thread::hardware_concurrency()));
-            if (num_chunks == 0)
-            {
-                num_chunks = 1;
-            }
-            
             struct Bounds { float min_x, max_x, min_z, max_z; };
-            vector<Bounds> chunk_bounds(num_chunks, { 
-                numeric_limits<float>::max(), numeric_limits<float>::lowest(),
-                numeric_limits<float>::max(), numeric_limits<float>::lowest() 
-            });
-            
-            uint32_t chunk_size = (tri_count_bounds + num_chunks - 1) / num_chunks;
-            auto parallel_bounds = [&](uint32_t start, uint32_t end)
+            const Bounds bounds_empty =
             {
-                for (uint32_t c = start; c < end; c++)
+                numeric_limits<float>::max(), numeric_limits<float>::lowest(),
+                numeric_limits<float>::max(), numeric_limits<float>::lowest()
+            };
+            const Bounds tile_bounds = ThreadPool::ParallelReduce(static_cast<uint32_t>(tile_triangle_data.size()), bounds_empty,
+                [&tile_triangle_data](uint32_t start, uint32_t end, Bounds& b)
                 {
-                    uint32_t chunk_start = c * chunk_size;
-                    uint32_t chunk_end   = min(chunk_start + chunk_size, tri_count_bounds);
-                    Bounds& b            = chunk_bounds[c];
-                    
-                    for (uint32_t i = chunk_start; i < chunk_end; i++)
+                    for (uint32_t i = start; i < end; i++)
                     {
                         const auto& tri = tile_triangle_data[i];
                         b.min_x = min(b.min_x, tri.centroid.x);
@@ -805,22 +792,20 @@ namespace spartan
                         b.min_z = min(b.min_z, tri.centroid.z);
                         b.max_z = max(b.max_z, tri.centroid.z);
                     }
-                }
-            };
-            ThreadPool::ParallelLoop(parallel_bounds, num_chunks);
-            
-            // merge chunk results
-            float tile_min_x = numeric_limits<float>::max();
-            float tile_max_x = numeric_limits<float>::lowest();
-            float tile_min_z = numeric_limits<float>::max();
-            float tile_max_z = numeric_limits<float>::lowest();
-            for (const auto& b : chunk_bounds)
-            {
-                tile_min_x = min(tile_min_x, b.min_x);
-                tile_max_x = max(tile_max_x, b.max_x);
-                tile_min_z = min(tile_min_z, b.min_z);
-                tile_max_z = max(tile_max_z, b.max_z);
-            }
+                },
+                [](Bounds& b, const Bounds& partial)
+                {
+                    b.min_x = min(b.min_x, partial.min_x);
+                    b.max_x = max(b.max_x, partial.max_x);
+                    b.min_z = min(b.min_z, partial.min_z);
+                    b.max_z = max(b.max_z, partial.max_z);
+                },
+                1024
+            );
+            float tile_min_x = tile_bounds.min_x;
+            float tile_max_x = tile_bounds.max_x;
+            float tile_min_z = tile_bounds.min_z;
+            float tile_max_z = tile_bounds.max_z;
 
             // filter triangles that meet spawn criteria
             const float edge_epsilon = 0.01f;
@@ -3398,23 +3383,31 @@ namespace spartan
                 heights[i] = m_positions[i].y;
             }
         };
-        ThreadPool::ParallelLoop(copy_world_y, sample_count);
-
-        m_height_bake_min = m_positions[0].y;
-        m_height_bake_max = m_positions[0].y;
-        float min_x = m_positions[0].x;
-        float max_x = m_positions[0].x;
-        float min_z = m_positions[0].z;
-        float max_z = m_positions[0].z;
-        for (const Vector3& position : m_positions)
-        {
-            m_height_bake_min = min(m_height_bake_min, position.y);
-            m_height_bake_max = max(m_height_bake_max, position.y);
-            min_x = min(min_x, position.x);
-            max_x = max(max_x, position.x);
-            min_z = min(min_z, position.z);
-            max_z = max(max_z, position.z);
-        }
+        ThreadPool::ParallelFor(sample_count, copy_world_y, 4096);
+
+        struct Extents { Vector3 min, max; };
+        const Extents extents = ThreadPool::ParallelReduce(static_cast<uint32_t>(m_positions.size()), Extents{ Vector3::Infinity, Vector3::InfinityNeg },
+            [this](uint32_t start, uint32_t end, Extents& e)
+            {
+                for (uint32_t i = start; i < end; i++)
+                {
+                    e.min = Vector3::Min(e.min, m_positions[i]);
+                    e.max = Vector3::Max(e.max, m_positions[i]);
+                }
+            },
+            [](Extents& e, const Extents& partial)
+            {
+                e.min = Vector3::Min(e.min, partial.min);
+                e.max = Vector3::Max(e.max, partial.max);
+            },
+            4096
+        );
+        m_height_bake_min = extents.min.y;
+        m_height_bake_max = extents.max.y;
+        const float min_x = extents.min.x;
+        const float max_x = extents.max.x;
+        const float min_z = extents.min.z;
+        const float max_z = extents.max.z;
 
         m_world_mapping = Vector4(
             min_x,
@@ -33,6 +33,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../../resource/ResourceCache.h"
 #include "../Entity.h"
 #include "../World.h"
+#include "../WorldPartition.h"
 #include "../../io/pugixml.hpp"
 #include <unordered_set>
 
@@ -103,10 +104,19 @@ namespace spartan
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_simulation_frequency, float);
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_physics_radius, float);
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_physics_exit_radius, float);
+
+        // cars on a cell that streams out lose the road under them
+        m_cell_unloaded_handle = SP_SUBSCRIBE_TO_EVENT(EventType::WorldCellUnloaded, SP_EVENT_HANDLER_VARIANT(OnWorldCellUnloaded));
     }
 
     Traffic::~Traffic()
     {
+        if (m_cell_unloaded_handle != 0)
+        {
+            SP_UNSUBSCRIBE_FROM_EVENT(EventType::WorldCellUnloaded, m_cell_unloaded_handle);
+            m_cell_unloaded_handle = 0;
+        }
+
         Stop();
     }
 
@@ -200,7 +210,8 @@ namespace spartan
                 continue;
             }
 
-            if (has_player)
+            // without its cell there is no collision geometry, the car stays on its spline until the cell is back
+            if (has_player && WorldPartition::IsLoadedAt(driver.entity->GetPosition()))
             {
                 Vector3 offset = driver.entity->GetPosition() - player_position;
                 offset.y = 0.0f;
@@ -531,6 +542,18 @@ namespace spartan
         telemetry.drive_acceleration *= telemetry.response_factor;
     }
 
+    void Traffic::OnWorldCellUnloaded(const sp_variant& data)
+    {
+        const WorldCell* cell = static_cast<const WorldCell*>(get<void*>(data));
+        for (Driver& driver : m_drivers)
+        {
+            if (driver.physics_active && driver.entity && cell->Contains(driver.entity->GetPosition()))
+            {
+                SetPhysicsActive(driver, false);
+            }
+        }
+    }
+
     bool Traffic::GetPlayerState(Vector3& position, Vector3& velocity) const
     {
         const vector<Car*> cars = Car::GetAll();
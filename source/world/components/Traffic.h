@@ -22,6 +22,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 #include "Component.h"
+#include "../../core/Event.h"
 #include "../../math/Vector3.h"
 #include "../../math/Quaternion.h"
 #include <array>
@@ -45,6 +46,8 @@ namespace spartan
         ~Traffic() override;
 
         void Start() override;
+        // spawning raycasts against the static colliders, so physics has to be up first
+        uint64_t GetStartDependencies() const override { return StartDependency(ComponentType::Physics); }
         void Stop() override;
         void Tick() override;
         void Save(pugi::xml_node& node) override;
@@ -165,6 +168,7 @@ namespace spartan
         void UpdateSplineDriver(Driver& driver, float delta_time);
         bool CreateSpline(Driver& driver);
         void SetPhysicsActive(Driver& driver, bool active);
+        void OnWorldCellUnloaded(const sp_variant& data);
         bool GetPlayerState(math::Vector3& position, math::Vector3& velocity) const;
         Trajectory EvaluateTrajectory(const Driver& driver, float steering, bool reverse = false) const;
         bool IsTrafficCorridorClear(const Driver& driver, const math::Vector3& start, const math::Vector3& end, float radius) const;
@@ -186,5 +190,6 @@ namespace spartan
         uint32_t m_next_spawn_index = 0;
         std::string m_car_path;
         std::shared_ptr<PreloadState> m_preload_state;
+        subscription_handle m_cell_unloaded_handle = 0;
     };
 }
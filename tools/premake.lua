@@ -108,12 +108,14 @@ function solution_configuration()
             buildoptions { "-mavx2" }
 end
 
-function spartan_project_configuration()
-    project(SOLUTION_NAME)
+-- the engine and editor as a windowed app, and the same sources as a headless console benchmark
+-- the benchmark never creates a window or a gpu device, so it runs on gpu-less ci machines
+function spartan_project_configuration(project_name, project_kind, target_name, excluded_entry_point)
+    project(project_name)
         location "../"
-        objdir(OBJ_DIR)
+        objdir(OBJ_DIR .. "/" .. project_name)
         cppdialect(CPP_VERSION)
-        kind "WindowedApp"
+        kind(project_kind)
         staticruntime "On"
         defines { API_CPP_DEFINE }
         libdirs { LIBRARY_DIR }
@@ -127,6 +129,9 @@ function spartan_project_configuration()
         }
         files(lzma_sdk.sources())
 
+        -- each executable has its own main
+        removefiles { SOURCE_DIR .. "/" .. excluded_entry_point }
+
         if ARG_API_GRAPHICS == "d3d12" then
             removefiles { SOURCE_DIR .. "/rhi/vulkan/**" }
         elseif ARG_API_GRAPHICS == "vulkan" then
@@ -222,7 +227,7 @@ function spartan_project_configuration()
 
         -- Release configuration
         filter { "configurations:release" }
-            targetname(EXECUTABLE_NAME)
+            targetname(target_name)
             targetdir(TARGET_DIR)
             debugdir(TARGET_DIR)
             links { "dxcompiler", "assimp", "FreeImageLib", "freetype", "SDL3", "meshoptimizer", "openxr_loader", "lua" }
@@ -245,7 +250,7 @@ function spartan_project_configuration()
 
         -- Debug configuration
         filter { "configurations:debug" }
-            targetname(EXECUTABLE_NAME .. "_debug")
+            targetname(target_name .. "_debug")
             targetdir(TARGET_DIR)
             debugdir(TARGET_DIR)
             links { "dxcompiler" }
@@ -271,10 +276,12 @@ function spartan_project_configuration()
         filter { "configurations:debug", "system:linux" }
             links { "assimp", "FreeImageLib", "freetype", "SDL3" }
 
+        filter {}
 end
 
 if generation_actions[_ACTION] then
     configure_graphics_api()
     solution_configuration()
-    spartan_project_configuration()
+    spartan_project_configuration(SOLUTION_NAME, "WindowedApp", EXECUTABLE_NAME, "testing/BenchmarkMain.cpp")
+    spartan_project_configuration(SOLUTION_NAME .. "Benchmark", "ConsoleApp", EXECUTABLE_NAME .. "_benchmark", "editor/main.cpp")
 end